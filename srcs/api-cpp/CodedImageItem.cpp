@@ -232,7 +232,7 @@ HEIF::ErrorCode CodedImageItem::loadItemData()
             delete[] mBuffer;
             mBuffer = nullptr;
             mBuffer = new std::uint8_t[mBufferSize];
-            error   = getHeif()->getReaderInstance()->getItemData(getId(), mBuffer, mBufferSize, false);
+            error   = getHeif()->getReaderInstance()->getItemData(getSourceId(), mBuffer, mBufferSize, false);
             if (HEIF::ErrorCode::OK != error)
             {
                 // Could not get the data. fail.
@@ -282,6 +282,7 @@ void CodedImageItem::setItemData(const std::uint8_t* aData, std::uint64_t aSize)
     mBuffer = nullptr;
     mBuffer = new std::uint8_t[aSize];
     std::memcpy(mBuffer, aData, mBufferSize);
+    setSourceId(Heif::InvalidItem);
 }
 
 HEIF::ErrorCode CodedImageItem::load(HEIF::Reader* aReader, const HEIF::ImageId& aId)
@@ -346,7 +347,22 @@ HEIF::ErrorCode CodedImageItem::load(HEIF::Reader* aReader, const HEIF::ImageId&
 HEIF::ErrorCode CodedImageItem::save(HEIF::Writer* aWriter)
 {
     HEIF::ErrorCode error = HEIF::ErrorCode::OK;
-    if (mBuffer == nullptr)
+    // Data already in the updated file is referred to instead of fed again, see Heif::updateMetadata().
+    std::uint64_t existingOffset = 0;
+    std::uint64_t existingSize   = 0;
+    const bool existingData      = getHeif()->getExistingDataLocation(getSourceId(), existingOffset, existingSize);
+    // Data not loaded yet is read for the save only and released right after, so that saving holds the data of one
+    // item at a time instead of the whole file.
+    const bool readForSave = !existingData && (mBuffer == nullptr) && (getHeif()->getReaderInstance() != nullptr);
+    if (readForSave)
+    {
+        error = loadItemData();
+        if (HEIF::ErrorCode::OK != error)
+        {
+            return error;
+        }
+    }
+    if ((mBuffer == nullptr) && !existingData)
     {
         // TODO: actual error is NO_MEDIA
         return HEIF::ErrorCode::BUFFER_SIZE_TOO_SMALL;
@@ -376,27 +392,44 @@ HEIF::ErrorCode CodedImageItem::save(HEIF::Writer* aWriter)
     }
 
 
-    std::uint64_t size = 0;
-    std::uint8_t* data = nullptr;
-
-    if (!getBitstream(data, size))
+    if (existingData)
     {
-        return HEIF::ErrorCode::INVALID_MEDIA_FORMAT;
+        // JPEG data is parsed for the image dimensions, so it is loaded by Heif::updateMetadata().
+        fr.size        = existingSize;
+        fr.data        = (mFormat == HEIF::MediaFormat::JPEG) ? mBuffer : nullptr;
+        fr.mediaFormat = mFormat;
+        error          = aWriter->feedExistingMediaData(fr, existingOffset, mediaDataId);
     }
-    fr.size        = size;
-    fr.data        = data;
-    fr.mediaFormat = mFormat;
-
-    if (fr.data == nullptr)
+    else
     {
-        // mediadata not set, or corrupted.
-        return HEIF::ErrorCode::INVALID_MEDIA_FORMAT;
-    }
+        std::uint64_t size = 0;
+        std::uint8_t* data = nullptr;
 
-    error = aWriter->feedMediaData(fr, mediaDataId);
+        const bool converted = getBitstream(data, size);
+        if (readForSave)
+        {
+            delete[] mBuffer;
+            mBuffer = nullptr;
+        }
+        if (!converted)
+        {
+            return HEIF::ErrorCode::INVALID_MEDIA_FORMAT;
+        }
+        fr.size        = size;
+        fr.data        = data;
+        fr.mediaFormat = mFormat;
 
-    // free temporary data.
-    delete[] fr.data;
+        if (fr.data == nullptr)
+        {
+            // mediadata not set, or corrupted.
+            return HEIF::ErrorCode::INVALID_MEDIA_FORMAT;
+        }
+
+        error = aWriter->feedMediaData(fr, mediaDataId);
+
+        // free temporary data.
+        delete[] fr.data;
+    }
 
     if (HEIF::ErrorCode::OK != error)
     {
@@ -36,6 +36,10 @@ namespace HEIFPP
         {
             return Result::HIDDEN_PRIMARY_ITEM;
         }
+        else if (error == HEIF::ErrorCode::NOT_APPLICABLE)
+        {
+            return Result::NOT_APPLICABLE;
+        }
         else
         {
             return Result::ERROR_UNDEFINED;
@@ -28,6 +28,7 @@ namespace HEIFPP
         ALREADY_IN_GROUP     = 7,
         ALREADY_SET          = 8,
         INVALID_CONFIG       = 9,
+        NOT_APPLICABLE       = 10,
         ERROR_UNDEFINED      = 999
     };
 
@@ -48,7 +48,23 @@ HEIF::ErrorCode ExifItem::load(HEIF::Reader* aReader, const HEIF::ImageId& aId)
 }
 HEIF::ErrorCode ExifItem::save(HEIF::Writer* aWriter)
 {
-    if (mBuffer == nullptr)
+    HEIF::ErrorCode error = HEIF::ErrorCode::OK;
+    // Data already in the updated file is referred to, and data not loaded yet is read for the save only, see
+    // CodedImageItem::save().
+    std::uint64_t existingOffset = 0;
+    std::uint64_t existingSize   = 0;
+    const bool existingData      = getHeif()->getExistingDataLocation(getSourceId(), existingOffset, existingSize);
+
+    const bool readForSave = !existingData && (mBuffer == nullptr) && (getHeif()->getReaderInstance() != nullptr);
+    if (readForSave)
+    {
+        error = loadData();
+        if (HEIF::ErrorCode::OK != error)
+        {
+            return error;
+        }
+    }
+    if ((mBuffer == nullptr) && !existingData)
     {
         // TODO: actual error is NO_MEDIA
         return HEIF::ErrorCode::BUFFER_SIZE_TOO_SMALL;
@@ -57,11 +73,17 @@ HEIF::ErrorCode ExifItem::save(HEIF::Writer* aWriter)
     HEIF::MediaDataId mediaDataId;
     HEIF::Data fr;
     fr.mediaFormat     = HEIF::MediaFormat::EXIF;
-    fr.size            = mBufferSize;
-    fr.data            = mBuffer;
+    fr.size            = existingData ? existingSize : mBufferSize;
+    fr.data            = existingData ? nullptr : mBuffer;
     fr.decoderConfigId = 0;
 
-    HEIF::ErrorCode error = aWriter->feedMediaData(fr, mediaDataId);
+    error = existingData ? aWriter->feedExistingMediaData(fr, existingOffset, mediaDataId)
+                         : aWriter->feedMediaData(fr, mediaDataId);
+    if (readForSave)
+    {
+        delete[] mBuffer;
+        mBuffer = nullptr;
+    }
     if (HEIF::ErrorCode::OK != error)
     {
         return error;
@@ -95,6 +117,7 @@ void ExifItem::setData(const std::uint8_t* aData, std::uint64_t aDataSize)
     mBuffer = new std::uint8_t[aDataSize];
     std::memcpy(mBuffer, aData, aDataSize);
     mBufferSize = aDataSize;
+    setSourceId(Heif::InvalidItem);
 }
 
 HEIF::ErrorCode ExifItem::loadData()
@@ -111,7 +134,7 @@ HEIF::ErrorCode ExifItem::loadData()
             delete[] mBuffer;
             mBuffer = nullptr;
             mBuffer = new std::uint8_t[mBufferSize];
-            error   = getHeif()->getReaderInstance()->getItemData(getId(), mBuffer, mBufferSize, false);
+            error   = getHeif()->getReaderInstance()->getItemData(getSourceId(), mBuffer, mBufferSize, false);
             if (HEIF::ErrorCode::OK != error)
             {
                 return error;
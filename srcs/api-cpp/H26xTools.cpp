@@ -12,6 +12,8 @@
 
 #include "H26xTools.h"
 
+#include "nalutil.hpp"
+
 #include <cstring>
 
 using namespace HEIFPP;
@@ -125,6 +127,14 @@ bool NAL_State::parse_byte_stream(const std::uint8_t*& nal_unit, std::uint64_t&
     std::uint64_t bytes_left = mLength;
     while (bytes_left)
     {
+        // Both sequences begin with a zero byte, so bytes up to the next zero byte belong to the NAL unit.
+        const std::uint64_t skipped = findZeroByte(src, bytes_left);
+        src += skipped;
+        bytes_left -= skipped;
+        if (bytes_left == 0)
+        {
+            break;
+        }
         if ((bytes_left >= 3) && ((src[0] == 0) && (src[1] == 0) && ((src[2] == 0) || (src[2] == 1))))
         {
             break;
@@ -193,29 +203,8 @@ bool NAL_State::convertToByteStream(std::uint8_t* aData, std::uint64_t aLength)
 {
     // convert nal stream to byte stream
     // ie. overwrite nal_lengths with byte stream header (use a simple 0 0 0 1 replacement)
-    for (std::uint32_t i = 0; i < aLength;)
-    {
-        if ((aLength - i) < 4)
-        {
-            return false;
-        }
-
-        std::uint32_t len;
-        len = static_cast<std::uint32_t>(aData[i + 0] << 24u);
-        len |= static_cast<std::uint32_t>(aData[i + 1] << 16u);
-        len |= static_cast<std::uint32_t>(aData[i + 2] << 8u);
-        len |= static_cast<std::uint32_t>(aData[i + 3]);
-        if ((aLength - i) < len)
-        {
-            return false;
-        }
-        aData[i + 0] = 0;
-        aData[i + 1] = 0;
-        aData[i + 2] = 0;
-        aData[i + 3] = 1;
-        i += len + 4;
-    }
-    return true;
+    std::uint64_t size = aLength;
+    return convertLengthPrefixedToByteStream(aData, size, aLength, 4);
 }
 
 bool NAL_State::convertFromByteStream(uint8_t* aBuffer,
@@ -12,6 +12,12 @@
 
 #include "Heif.h"
 
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
 #include <heifreader.h>
 #include <heifstreaminterface.h>
 #include <heifwriter.h>
@@ -54,6 +60,55 @@ const HEIF::MediaDataId Heif::InvalidMediaData(static_cast<std::uint32_t>(0));
 #define ISPE_AS_RAW_PROPERTY 0
 #define DECODER_CONFIG_AS_RAW_PROPERTY 0
 
+namespace
+{
+    enum class FileIdentity
+    {
+        SAME,
+        DIFFERENT,
+        UNKNOWN
+    };
+
+    /** Tells if writing to the file aTargetName would overwrite the file aSourceName. The names are compared by the
+     *  identity of the files they refer to, so different names of the same file are detected too.
+     *  @param [in] aSourceName Name of the source file, or an empty string if it is not known.
+     *  @param [in] aTargetName Name of the target file.
+     *  @return FileIdentity: DIFFERENT if the target does not exist or is another file, UNKNOWN if that can not be
+     *                        determined. */
+    FileIdentity compareFiles(const std::string& aSourceName, const char* aTargetName)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        struct _stat64 target;
+        if (_stat64(aTargetName, &target) != 0)
+        {
+            return (errno == ENOENT) ? FileIdentity::DIFFERENT : FileIdentity::UNKNOWN;
+        }
+        // Links are not resolved from the full paths, so different paths may still refer to the same file.
+        char sourcePath[_MAX_PATH];
+        char targetPath[_MAX_PATH];
+        if (aSourceName.empty() || (_fullpath(sourcePath, aSourceName.c_str(), _MAX_PATH) == nullptr) ||
+            (_fullpath(targetPath, aTargetName, _MAX_PATH) == nullptr))
+        {
+            return FileIdentity::UNKNOWN;
+        }
+        return (_stricmp(sourcePath, targetPath) == 0) ? FileIdentity::SAME : FileIdentity::UNKNOWN;
+#else
+        struct stat target;
+        if (stat(aTargetName, &target) != 0)
+        {
+            return (errno == ENOENT) ? FileIdentity::DIFFERENT : FileIdentity::UNKNOWN;
+        }
+        struct stat source;
+        if (aSourceName.empty() || (stat(aSourceName.c_str(), &source) != 0))
+        {
+            return FileIdentity::UNKNOWN;
+        }
+        const bool same = (source.st_dev == target.st_dev) && (source.st_ino == target.st_ino);
+        return same ? FileIdentity::SAME : FileIdentity::DIFFERENT;
+#endif
+    }
+}  // namespace
+
 
 Heif::Heif()
     : mFileinfo{}
@@ -72,6 +127,7 @@ Heif::Heif()
     , mDecoderConfigsLoad()
     , mContext(nullptr)
     , mReader(nullptr)
+    , mFileName()
 {
 }
 
@@ -136,6 +192,7 @@ void Heif::reset()
         HEIF::Reader::Destroy(mReader);
         mReader = nullptr;
     }
+    mFileName.clear();
 }
 
 /** Custom user data can be bound to objects. */
@@ -180,9 +237,13 @@ Result Heif::save(const char* aFileName, HEIF::OutputStreamInterface* aStream)
         }
     }
 
-    if (mReader != nullptr)
+    // Data not loaded yet is read from mReader while saving, one item or sample at a time. The file being read
+    // can't be overwritten though, so all the data is loaded first and the file closed if the saved file may be the
+    // loaded one. A stream may read any file, so then only a new file is known to be another one.
+    const bool loaded = !mFileName.empty() || (mReader != nullptr);
+    if ((aFileName != nullptr) && loaded && (compareFiles(mFileName, aFileName) != FileIdentity::DIFFERENT))
     {
-        if (mPreLoadMode != PreloadMode::LOAD_ALL_DATA)
+        if ((mReader != nullptr) && (mPreLoadMode != PreloadMode::LOAD_ALL_DATA))
         {
             for (auto* item : mItems)
             {
@@ -212,8 +273,12 @@ Result Heif::save(const char* aFileName, HEIF::OutputStreamInterface* aStream)
                 }
             }
         }
-        HEIF::Reader::Destroy(mReader);
-        mReader = nullptr;
+        if (mReader != nullptr)
+        {
+            HEIF::Reader::Destroy(mReader);
+            mReader = nullptr;
+        }
+        mFileName.clear();
     }
 
     HEIF::ErrorCode error = HEIF::ErrorCode::OK;
@@ -231,132 +296,264 @@ Result Heif::save(const char* aFileName, HEIF::OutputStreamInterface* aStream)
     error = writer->initialize(output);
     if (HEIF::ErrorCode::OK == error)
     {
-        // Invalidate all id's since writer will create new ones.
-        for (auto* item : mItems)
-        {
-            // set an "invalid" id.
-            item->setId(InvalidItem);
-        }
-        for (auto* property : mProperties)
-        {
-            // set an "invalid" id.
-            property->setId(InvalidProperty);
-        }
-        for (auto* config : mDecoderConfigs)
-        {
-            // set an "invalid" id.
-            config->setId(InvalidDecoderConfig);
-        }
-        for (auto* track : mTracks)
-        {
-            track->setId(InvalidSequence);
-        }
-        for (auto* sample : mSamples)
-        {
-            sample->setId(InvalidSequenceImage);
-        }
-        for (auto grp : mGroups)
-        {
-            grp->setId(InvalidGroup);
-        }
+        error = saveContent(writer);
+    }
+    HEIF::Writer::Destroy(writer);
+    return convertErrorCode(error);
+}
 
-        HEIF::Array<int32_t> matrix(9);
-        for (size_t i = 0; i < 9; i++)
-        {
-            matrix[i] = mMatrix[i];
-        }
-        error = writer->setMatrix(matrix);
+HEIF::ErrorCode Heif::saveContent(HEIF::Writer* aWriter)
+{
+    // Invalidate all id's since writer will create new ones.
+    for (auto* item : mItems)
+    {
+        // set an "invalid" id.
+        item->setId(InvalidItem);
+    }
+    for (auto* property : mProperties)
+    {
+        // set an "invalid" id.
+        property->setId(InvalidProperty);
+    }
+    for (auto* config : mDecoderConfigs)
+    {
+        // set an "invalid" id.
+        config->setId(InvalidDecoderConfig);
+    }
+    for (auto* track : mTracks)
+    {
+        track->setId(InvalidSequence);
+    }
+    for (auto* sample : mSamples)
+    {
+        sample->setId(InvalidSequenceImage);
+    }
+    for (auto grp : mGroups)
+    {
+        grp->setId(InvalidGroup);
+    }
+
+    HEIF::Array<int32_t> matrix(9);
+    for (size_t i = 0; i < 9; i++)
+    {
+        matrix[i] = mMatrix[i];
+    }
+    HEIF::ErrorCode error = aWriter->setMatrix(matrix);
 
 
-        if (HEIF::ErrorCode::OK == error)
+    if (HEIF::ErrorCode::OK == error)
+    {
+        for (auto* item : mItems)
         {
-            for (auto* item : mItems)
+            if (item->getId() == Heif::InvalidItem)
             {
-                if (item->getId() == Heif::InvalidItem)
+                error = item->save(aWriter);
+                if (HEIF::ErrorCode::OK != error)
                 {
-                    error = item->save(writer);
-                    if (HEIF::ErrorCode::OK != error)
-                    {
-                        break;
-                    }
+                    break;
                 }
             }
         }
-        if ((HEIF::ErrorCode::OK == error) && (mPrimaryItem))
-        {
-            error = writer->setPrimaryItem(mPrimaryItem->getId());
-        }
+    }
+    if ((HEIF::ErrorCode::OK == error) && (mPrimaryItem))
+    {
+        error = aWriter->setPrimaryItem(mPrimaryItem->getId());
+    }
 
-        // write samples?/tracks?
-        if (HEIF::ErrorCode::OK == error)
+    // write samples?/tracks?
+    if (HEIF::ErrorCode::OK == error)
+    {
+        for (auto* track : mTracks)
         {
-            for (auto* track : mTracks)
+            if (track->getId() == Heif::InvalidSequence)
             {
-                if (track->getId() == Heif::InvalidSequence)
+                error = track->save(aWriter);
+                if (HEIF::ErrorCode::OK != error)
                 {
-                    error = track->save(writer);
-                    if (HEIF::ErrorCode::OK != error)
-                    {
-                        break;
-                    }
+                    break;
                 }
             }
         }
-        // save groups.
-        if (HEIF::ErrorCode::OK == error)
+    }
+    // save groups.
+    if (HEIF::ErrorCode::OK == error)
+    {
+        for (auto grp : mGroups)
         {
-            for (auto grp : mGroups)
+            auto type = grp->getType();
+            HEIF::GroupId gid;
+            error = aWriter->createEntityGroup(type, gid);
+            if (HEIF::ErrorCode::OK != error)
             {
-                auto type = grp->getType();
-                HEIF::GroupId gid;
-                error = writer->createEntityGroup(type, gid);
-                if (HEIF::ErrorCode::OK != error)
+                break;
+            }
+            grp->setId(gid);
+
+            for (std::uint32_t i = 0; i < grp->getEntityCount(); i++)
+            {
+                if (grp->isItem(i))
                 {
-                    break;
+                    error = aWriter->addToGroup(gid, grp->getItem(i)->getId());
                 }
-                grp->setId(gid);
-
-                for (std::uint32_t i = 0; i < grp->getEntityCount(); i++)
+                else if (grp->isTrack(i))
                 {
-                    if (grp->isItem(i))
-                    {
-                        error = writer->addToGroup(gid, grp->getItem(i)->getId());
-                    }
-                    else if (grp->isTrack(i))
-                    {
-                        error = writer->addToGroup(gid, grp->getTrack(i)->getId());
-                    }
-                    else if (grp->isSample(i))
+                    error = aWriter->addToGroup(gid, grp->getTrack(i)->getId());
+                }
+                else if (grp->isSample(i))
+                {
+                    Sample* smp = grp->getSample(i);
+                    if (type == "eqiv")
                     {
-                        Sample* smp = grp->getSample(i);
-                        if (type == "eqiv")
-                        {
-                            HEIF::EquivalenceTimeOffset eqi;
-                            eqi.timeOffset          = static_cast<EquivalenceGroup*>(grp)->getOffset(smp);
-                            eqi.timescaleMultiplier = static_cast<EquivalenceGroup*>(grp)->getMultiplier(smp);
-                            error = writer->addToEquivalenceGroup(gid, smp->getTrack()->getId(), smp->getId(), eqi);
-                        }
-                        else
-                        {
-                            // TODO: currently there is only one way to add samples to groups..
-                        }
+                        HEIF::EquivalenceTimeOffset eqi;
+                        eqi.timeOffset          = static_cast<EquivalenceGroup*>(grp)->getOffset(smp);
+                        eqi.timescaleMultiplier = static_cast<EquivalenceGroup*>(grp)->getMultiplier(smp);
+                        error = aWriter->addToEquivalenceGroup(gid, smp->getTrack()->getId(), smp->getId(), eqi);
                     }
-                    if (HEIF::ErrorCode::OK != error)
+                    else
                     {
-                        break;
+                        // TODO: currently there is only one way to add samples to groups..
                     }
                 }
+                if (HEIF::ErrorCode::OK != error)
+                {
+                    break;
+                }
             }
         }
+    }
+
+    if (HEIF::ErrorCode::OK == error)
+    {
+        error = aWriter->finalize();
+    }
+    return error;
+}
+
+Result Heif::updateMetadata()
+{
+    // Item ids are renumbered by the writer, and track data refers to them, so tracks are not supported.
+    if (mFileName.empty() || !mTracks.empty())
+    {
+        return Result::NOT_APPLICABLE;
+    }
+    if (mPrimaryItem == nullptr)
+    {
+        return Result::PRIMARY_ITEM_NOT_SET;
+    }
+    if (mPrimaryItem->isHidden())
+    {
+        return Result::HIDDEN_PRIMARY_ITEM;
+    }
 
+    // The file is parsed again for the locations, if it was closed after loading all the data.
+    const bool keepReader = (mReader != nullptr);
+    HEIF::ErrorCode error = HEIF::ErrorCode::OK;
+    if (!keepReader)
+    {
+        mReader = HEIF::Reader::Create();
+        error   = mReader->initialize(mFileName.c_str());
+    }
+    HEIF::MetaBoxLocation metaLocation = {};
+    if (HEIF::ErrorCode::OK == error)
+    {
+        error = mReader->getMetaBoxLocation(metaLocation);
+    }
+
+    // Unchanged item data stored as one extent is kept in place. Other data, and JPEG data which the writer parses
+    // for the image dimensions, is loaded before the file is opened for writing.
+    for (auto* item : mItems)
+    {
+        if (HEIF::ErrorCode::OK != error)
+        {
+            break;
+        }
+        std::uint64_t offset = 0;
+        std::uint64_t size   = 0;
+        const bool existing  = (item->getSourceId() != InvalidItem) &&
+                               (mReader->getItemDataLocation(item->getSourceId(), offset, size) == HEIF::ErrorCode::OK);
+        if (existing)
+        {
+            mExistingData[item->getSourceId()] = std::make_pair(offset, size);
+        }
+        if (item->isImageItem() && static_cast<ImageItem*>(item)->isCodedImage())
+        {
+            auto* image     = static_cast<CodedImageItem*>(item);
+            const bool load = !existing || (image->getMediaFormat() == HEIF::MediaFormat::JPEG);
+            if (load && (image->getItemData() == nullptr))
+            {
+                error = HEIF::ErrorCode::FILE_READ_ERROR;
+            }
+        }
+        else if (item->isExifItem() && !existing && (static_cast<ExifItem*>(item)->getData() == nullptr))
+        {
+            error = HEIF::ErrorCode::FILE_READ_ERROR;
+        }
+        else if (item->isMimeItem() && !existing && (static_cast<MimeItem*>(item)->getData() == nullptr))
+        {
+            error = HEIF::ErrorCode::FILE_READ_ERROR;
+        }
+    }
+    HEIF::Reader::Destroy(mReader);
+    mReader = nullptr;
+
+    if (HEIF::ErrorCode::OK == error)
+    {
+        HEIF::Writer* writer = HEIF::Writer::Create();
+        HEIF::OutputConfig output;
+        output.fileName         = mFileName.c_str();
+        output.updateFile       = true;
+        output.updateMetaOffset = metaLocation.offset;
+        output.updateMetaSpace  = metaLocation.space;
+        output.updateFileSize   = metaLocation.fileSize;
+        error                   = writer->initialize(output);
         if (HEIF::ErrorCode::OK == error)
         {
-            error = writer->finalize();
+            error = saveContent(writer);
+        }
+        HEIF::Writer::Destroy(writer);
+    }
+    mExistingData.clear();
+
+    if (HEIF::ErrorCode::OK == error)
+    {
+        // Item data not loaded yet is now read with the new ids of the updated file.
+        for (auto* item : mItems)
+        {
+            item->setSourceId(item->getId());
+        }
+    }
+    if (keepReader || (HEIF::ErrorCode::OK == error))
+    {
+        mReader                   = HEIF::Reader::Create();
+        HEIF::ErrorCode openError = mReader->initialize(mFileName.c_str());
+        if (HEIF::ErrorCode::OK == openError)
+        {
+            openError = mReader->getFileInformation(mFileinfo);
+        }
+        if (HEIF::ErrorCode::OK == error)
+        {
+            error = openError;
+        }
+        if (!keepReader || (HEIF::ErrorCode::OK != openError))
+        {
+            HEIF::Reader::Destroy(mReader);
+            mReader = nullptr;
         }
     }
-    HEIF::Writer::Destroy(writer);
     return convertErrorCode(error);
 }
+
+bool Heif::getExistingDataLocation(const HEIF::ImageId& aSourceId, std::uint64_t& aOffset, std::uint64_t& aSize) const
+{
+    const auto location = mExistingData.find(aSourceId);
+    if (location == mExistingData.end())
+    {
+        return false;
+    }
+    aOffset = location->second.first;
+    aSize   = location->second.second;
+    return true;
+}
 const HEIF::FileInformation* Heif::getFileInformation() const
 {
     return &mFileinfo;
@@ -442,6 +639,10 @@ Result Heif::load(const char* aFilename, HEIF::StreamInterface* aStream, Preload
     }
     if (HEIF::ErrorCode::OK == error)
     {
+        if ((aStream == nullptr) && (aFilename != nullptr))
+        {
+            mFileName = aFilename;
+        }
         mPreLoadMode = loadMode;
         error        = load(mReader);
     }
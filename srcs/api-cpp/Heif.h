@@ -119,15 +119,29 @@ namespace HEIFPP
         Result load(HEIF::StreamInterface* stream, PreloadMode loadMode = LOAD_ALL_DATA);
 
         /** Save content to file.
+         *  Data not loaded to memory is read from the loaded file while saving. If fileName refers to the loaded file,
+         *  also by another name or link, all data is loaded to memory and the loaded file closed before it is
+         *  overwritten. This is done also when that can not be determined, e.g. when fileName is an existing file and
+         *  the content was loaded from a stream.
          *  @param [in] fileName Name of the saved file.
          *  @return Result: Possible error code */
         Result save(const char* fileName);
 
         /** Save content to stream.
+         *  Data not loaded to memory is read from the loaded file or stream while saving, so the stream must not
+         *  write to it.
          *  @param [in] stream Stream to save the file to.
          *  @return Result: Possible error code */
         Result save(HEIF::OutputStreamInterface* stream);
 
+        /** Save the changes to the file the content was loaded from, by rewriting only its metadata.
+         *  Item data already in the file is kept in place, new and changed item data is appended to the file. The
+         *  'meta' box is rewritten in place if it fits, otherwise it is moved to the end of the file. The file is not
+         *  copied first, so a failure while the 'meta' box is rewritten can leave it unreadable.
+         *  @return Result: Possible error code, NOT_APPLICABLE if the content was not loaded from a file, the file has
+         *                  been overwritten with save(), or the content has tracks */
+        Result updateMetadata();
+
         /** Clears the container to initial state. */
         void reset();
 
@@ -411,8 +425,15 @@ namespace HEIFPP
         Result load(const char* aFilename, HEIF::StreamInterface* aStream, PreloadMode loadMode);
         Result save(const char* aFilename, HEIF::OutputStreamInterface* aStream);
         HEIF::ErrorCode load(HEIF::Reader* aReader);
+        HEIF::ErrorCode saveContent(HEIF::Writer* aWriter);
+        bool getExistingDataLocation(const HEIF::ImageId& aSourceId,
+                                     std::uint64_t& aOffset,
+                                     std::uint64_t& aSize) const;
         const void* mContext;
         HEIF::Reader* mReader;
+        std::string mFileName;  ///< Name of the loaded file, empty if loaded from a stream or the file was overwritten.
+        std::map<HEIF::ImageId, std::pair<std::uint64_t, std::uint64_t>>
+            mExistingData;  ///< Offset and size of item data kept in the file by updateMetadata(), by source id.
 
     private:
         Heif& operator=(const Heif&) = delete;
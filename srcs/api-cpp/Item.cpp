@@ -25,6 +25,7 @@ using namespace HEIFPP;
 Item::Item(Heif* aHeif, const HEIF::FourCC& aType, bool aIsImageItem)
     : mHeif(aHeif)
     , mId(Heif::InvalidItem)
+    , mSourceId(Heif::InvalidItem)
     , mType(aType)
     , mIsProtected(false)
     , mIsImageItem(aIsImageItem)
@@ -132,6 +133,14 @@ const HEIF::ImageId& Item::getId() const
 {
     return mId;
 }
+const HEIF::ImageId& Item::getSourceId() const
+{
+    return mSourceId;
+}
+void Item::setSourceId(const HEIF::ImageId& id)
+{
+    mSourceId = id;
+}
 const std::string& Item::getName() const
 {
     return mName;
@@ -178,8 +187,9 @@ HEIF::ErrorCode Item::load(HEIF::Reader* aReader, const HEIF::ImageId& aId)
     HEIF::ErrorCode error = HEIF::ErrorCode::OK;
 
     HEIF::FourCC type;
-    mId   = aId;
-    error = aReader->getItemType(aId, type);
+    mId       = aId;
+    mSourceId = aId;
+    error     = aReader->getItemType(aId, type);
     if (HEIF::ErrorCode::OK != error)
     {
         return error;
@@ -107,6 +107,14 @@ namespace HEIFPP
 
         void setId(const HEIF::ImageId&);
 
+        /** Gets the id of the item in the loaded file, used to read the item data on demand. Unlike getId() it is
+         * not changed by saving. */
+        const HEIF::ImageId& getSourceId() const;
+
+        /** Sets the id of the item in the loaded file. Set to Heif::InvalidItem when the item data is replaced, so the
+         * data in the file is no longer used. */
+        void setSourceId(const HEIF::ImageId&);
+
         Item(Heif* aHeif, const HEIF::FourCC& aType, bool aIsImage);
 
         /** Gets the content type of the MimeItem */
@@ -127,6 +135,7 @@ namespace HEIFPP
     private:
         Heif* mHeif;
         HEIF::ImageId mId;
+        HEIF::ImageId mSourceId;
         HEIF::FourCC mType;
         bool mIsProtected;
         bool mIsImageItem;
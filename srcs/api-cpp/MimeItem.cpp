@@ -68,12 +68,27 @@ HEIF::ErrorCode MimeItem::load(HEIF::Reader* aReader, const HEIF::ImageId& aId)
 }
 HEIF::ErrorCode MimeItem::save(HEIF::Writer* aWriter)
 {
-    if (mBuffer == nullptr)
+    HEIF::ErrorCode error = HEIF::ErrorCode::OK;
+    // Data already in the updated file is referred to, and data not loaded yet is read for the save only, see
+    // CodedImageItem::save().
+    std::uint64_t existingOffset = 0;
+    std::uint64_t existingSize   = 0;
+    const bool existingData      = getHeif()->getExistingDataLocation(getSourceId(), existingOffset, existingSize);
+
+    const bool readForSave = !existingData && (mBuffer == nullptr) && (getHeif()->getReaderInstance() != nullptr);
+    if (readForSave)
+    {
+        error = loadData();
+        if (HEIF::ErrorCode::OK != error)
+        {
+            return error;
+        }
+    }
+    if ((mBuffer == nullptr) && !existingData)
     {
         // TODO: actual error is NO_MEDIA
         return HEIF::ErrorCode::BUFFER_SIZE_TOO_SMALL;
     }
-    HEIF::ErrorCode error = HEIF::ErrorCode::OK;
 
     HEIF::MediaDataId mediaDataId;
     HEIF::Data fr;
@@ -84,12 +99,18 @@ HEIF::ErrorCode MimeItem::save(HEIF::Writer* aWriter)
     }
     // TODO: this should not be needed. actual contenttype is written Item::save
     fr.mediaFormat     = HEIF::MediaFormat::MPEG7;
-    fr.size            = mBufferSize;
-    fr.data            = mBuffer;
+    fr.size            = existingData ? existingSize : mBufferSize;
+    fr.data            = existingData ? nullptr : mBuffer;
     fr.decoderConfigId = 0;
 
     // TODO: re-use of data?
-    error = aWriter->feedMediaData(fr, mediaDataId);
+    error = existingData ? aWriter->feedExistingMediaData(fr, existingOffset, mediaDataId)
+                         : aWriter->feedMediaData(fr, mediaDataId);
+    if (readForSave)
+    {
+        delete[] mBuffer;
+        mBuffer = nullptr;
+    }
     if (HEIF::ErrorCode::OK != error)
     {
         return error;
@@ -123,6 +144,7 @@ void MimeItem::setData(const std::uint8_t* aData, std::uint64_t aDataSize)
     mBuffer = new std::uint8_t[aDataSize];
     std::memcpy(mBuffer, aData, aDataSize);
     mBufferSize = aDataSize;
+    setSourceId(Heif::InvalidItem);
 }
 
 HEIF::ErrorCode MimeItem::loadData()
@@ -139,7 +161,7 @@ HEIF::ErrorCode MimeItem::loadData()
             delete[] mBuffer;
             mBuffer = nullptr;
             mBuffer = new std::uint8_t[mBufferSize];
-            error   = getHeif()->getReaderInstance()->getItemData(getId(), mBuffer, mBufferSize, false);
+            error   = getHeif()->getReaderInstance()->getItemData(getSourceId(), mBuffer, mBufferSize, false);
             if (HEIF::ErrorCode::OK != error)
             {
                 return error;
@@ -28,6 +28,8 @@ Sample::Sample(Heif* aHeif)
     : mHeif(aHeif)
     , mType(HEIF::FourCC(static_cast<uint32_t>(0)))
     , mId(Heif::InvalidSequenceImage)
+    , mSourceTrackId(Heif::InvalidSequence)
+    , mSourceId(Heif::InvalidSequenceImage)
     , mSampleType(HEIF::SampleType::OUTPUT_REFERENCE_FRAME)
     , mDuration(0)
     , mCompositionOffset(0)
@@ -293,7 +295,7 @@ std::uint64_t Sample::getTimeStamp(uint32_t aIndex) const
     return 0;
 }
 
-HEIF::ErrorCode Sample::loadSampleData(const HEIF::SequenceId& aTrackId)
+HEIF::ErrorCode Sample::loadSampleData()
 {
     HEIF::ErrorCode error = HEIF::ErrorCode::OK;
     if (mBufferSize == 0)
@@ -307,7 +309,8 @@ HEIF::ErrorCode Sample::loadSampleData(const HEIF::SequenceId& aTrackId)
             delete[] mBuffer;
             mBuffer = nullptr;
             mBuffer = new std::uint8_t[mBufferSize];
-            error   = getHeif()->getReaderInstance()->getItemData(aTrackId, getId(), mBuffer, mBufferSize, false);
+            error   = getHeif()->getReaderInstance()->getItemData(mSourceTrackId, mSourceId, mBuffer, mBufferSize,
+                                                                    false);
             if (HEIF::ErrorCode::OK != error)
             {
                 // Could not get the data. fail.
@@ -364,7 +367,7 @@ const std::uint8_t* Sample::getSampleData()
 {
     if (mBuffer == nullptr)
     {
-        loadSampleData(mTrack->getId());
+        loadSampleData();
     }
     return mBuffer;
 }
@@ -422,10 +425,12 @@ HEIF::ErrorCode Sample::load(HEIF::Reader* aReader,
     }
     mCompositionOffset = aInfo.sampleCompositionOffsetTs;
 
-    mBufferSize = aInfo.size;
+    mSourceTrackId = aTrackId;
+    mSourceId      = aInfo.sampleId;
+    mBufferSize    = aInfo.size;
     if (getHeif()->mPreLoadMode == Heif::PreloadMode::LOAD_ALL_DATA)
     {
-        error = loadSampleData(aTrackId);
+        error = loadSampleData();
     }
     return error;
 }
@@ -439,6 +444,17 @@ HEIF::ErrorCode Sample::save(HEIF::Writer* aWriter)
     std::uint64_t aSize = 0;
     HEIF::Data data;
 
+    // Data not loaded yet is read for the save only, see CodedImageItem::save().
+    const bool readForSave = (mBuffer == nullptr) && (getHeif()->getReaderInstance() != nullptr);
+    if (readForSave)
+    {
+        err = loadSampleData();
+        if (HEIF::ErrorCode::OK != err)
+        {
+            return err;
+        }
+    }
+
     data.mediaFormat = mConfig->getMediaFormat();
     switch (data.mediaFormat)
     {
@@ -449,7 +465,12 @@ HEIF::ErrorCode Sample::save(HEIF::Writer* aWriter)
                         ? HEIF::ErrorCode::OK
                         : HEIF::ErrorCode::MEDIA_PARSING_ERROR;
         data.data = aData;
-        data.size = mBufferSize;
+        data.size = aSize;
+        if (readForSave)
+        {
+            delete[] mBuffer;
+            mBuffer = nullptr;
+        }
         break;
     }
     default:
@@ -507,6 +528,11 @@ HEIF::ErrorCode Sample::save(HEIF::Writer* aWriter)
 
     // free temp buffer
     delete[] aData;
+    if (readForSave)
+    {
+        delete[] mBuffer;
+        mBuffer = nullptr;
+    }
 
     if (HEIF::ErrorCode::OK != err)
     {
@@ -121,6 +121,8 @@ namespace HEIFPP
 
         HEIF::FourCC mType;
         HEIF::SequenceImageId mId;
+        HEIF::SequenceId mSourceTrackId;  ///< Id of the track in the loaded file, used to read the data on demand.
+        HEIF::SequenceImageId mSourceId;  ///< Id of the sample in the loaded file, used to read the data on demand.
         HEIF::SampleType mSampleType;
         std::uint64_t mDuration;
         std::int64_t mCompositionOffset;
@@ -146,7 +148,7 @@ namespace HEIFPP
         const void* mContext;
 
     private:
-        HEIF::ErrorCode loadSampleData(const HEIF::SequenceId& aTrackId);
+        HEIF::ErrorCode loadSampleData();
 
     private:
         Sample& operator=(const Sample&) = delete;
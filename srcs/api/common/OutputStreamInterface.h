@@ -54,6 +54,6 @@ namespace HEIF
         OutputStreamInterface(OutputStreamInterface&&)            = delete;       // move ctor
     };
 
-    OutputStreamInterface* ConstructFileStream(const char* aFilename);
+    OutputStreamInterface* ConstructFileStream(const char* aFilename, bool aUpdate = false);
 }  // namespace HEIF
 #endif
@@ -63,7 +63,8 @@ namespace HEIF
         PROTECTED_ITEM,
         UNINITIALIZED,
         UNPROTECTED_ITEM,
-        UNSUPPORTED_CODE_TYPE
+        UNSUPPORTED_CODE_TYPE,
+        MEMORY_ALLOCATION_FAILED
     };
 
     struct HEIF_DLL_PUBLIC FourCC
@@ -459,6 +460,26 @@ namespace HEIF
                                      ///< true. Zero means infinite looping.
         Array<EditUnit> editUnits;   ///< Edit units in the order they should be applied.
     };
+
+    /**
+     * @brief Counters of a public method or an internal processing phase of Reader or Writer.
+     * Calls made from within another public method are not counted separately. Counters of a phase are also included
+     * in the counters of the public method during which the phase ran. */
+    struct HEIF_DLL_PUBLIC CallStatistics
+    {
+        const char* name             = nullptr;  ///< Name of the method, e.g. "getItemData", or of the phase.
+        std::uint64_t count          = 0;        ///< Number of calls.
+        std::uint64_t timeNs         = 0;        ///< Total wall clock time in nanoseconds.
+        std::uint64_t allocations    = 0;        ///< Allocations made through the library allocator.
+        std::uint64_t allocatedBytes = 0;        ///< Bytes allocated through the library allocator.
+        std::uint64_t streamReads    = 0;        ///< read() and readAt() calls of input streams (Reader).
+        std::uint64_t streamSeeks    = 0;        ///< absoluteSeek() calls of input streams, seekp() calls of output.
+        std::uint64_t streamWrites   = 0;        ///< write() calls of the output stream (Writer).
+        std::uint64_t bytesRead      = 0;        ///< Bytes returned by read() and readAt() calls.
+        std::uint64_t bytesWritten   = 0;        ///< Bytes passed to write() calls.
+        std::uint64_t boxesParsed    = 0;        ///< Boxes parsed, including boxes inside other boxes.
+        std::uint64_t boxesWritten   = 0;        ///< Boxes serialized, including boxes inside other boxes.
+    };
 }  // namespace HEIF
 
 #endif /* HEIFCOMMONDATATYPES_H */
@@ -66,6 +66,38 @@ namespace HEIF
             StreamInterface::IndeterminateSize if the file size cannot be determined.
          */
         virtual offset_t size() = 0;
+
+        /** Reads data from the given offset without using or changing the
+            current offset of the stream, like POSIX pread(). Implementations
+            overriding this must allow calling it concurrently from multiple
+            threads, which lets a single reader instance serve item and sample
+            data to several threads at once. A 'moov' box skipped with
+            ReaderConfig::lazyTrackParsing is still read with absoluteSeek()
+            and read(), by the first thread which needs track information,
+            while other threads needing it wait.
+
+            The default implementation returns -1, in which case the reader
+            falls back to serialized absoluteSeek() and read() calls.
+
+            @param [offset] Offset to read from
+            @param [buffer] The buffer to write the data into
+            @param [size]   The number of bytes to read from the stream
+            @returns The number of bytes read, 0 on EOF, or -1 if positional
+            reads are not supported by the stream.
+         */
+        virtual offset_t readAt(offset_t offset, char* buffer, offset_t size);
+
+        /** Retrieve a pointer to the complete contents of the stream, if the
+            stream is backed by memory (ie. a memory mapped file). The pointer
+            must remain valid for the lifetime of the stream object. This
+            allows the reader to hand out item data without copying it.
+
+            The default implementation returns nullptr.
+
+            @returns Pointer to the first byte of the stream, or nullptr if
+            the stream contents are not directly addressable.
+         */
+        virtual const char* data();
     };
 }  // namespace HEIF
 
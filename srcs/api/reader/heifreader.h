@@ -24,6 +24,34 @@ namespace HEIF
 {
     class StreamInterface;
 
+    /** Sequential reader of the samples of an image sequence or video track, created with
+     *  Reader::createSampleReader(). A background thread reads the samples in decoding order ahead of the consumer to
+     *  a bounded set of reusable buffers, so that nextSample() does not wait for I/O unless the consumer is faster than
+     *  the input stream. */
+    class HEIF_DLL_PUBLIC SampleReader
+    {
+    public:
+        /** Stop the background thread and destroy an instance returned by Reader::createSampleReader(). */
+        static void Destroy(SampleReader* sampleReader);
+
+        /** Get the next sample in decoding order. Waits only if the sample has not been read ahead yet.
+         *  @param [out] sample  Id, timestamp and data of the sample. The data stays valid until the next call of
+         *                       nextSample() or seek(), or until the sample reader is destroyed.
+         *  @return ErrorCode: OK, NOT_APPLICABLE when all samples have been returned, FILE_READ_ERROR,
+         *                     MEMORY_ALLOCATION_FAILED if a buffer for the sample could not be allocated. The sample
+         *                     has no data on error, and the following samples can still be read. */
+        virtual ErrorCode nextSample(SampleData& sample) = 0;
+
+        /** Continue from a sample, e.g. from a sync sample when seeking in playback. Samples read ahead are discarded.
+         *  @param [in] sampleId  Sample to be returned by the next call of nextSample(). The first occurrence of the
+         *                        sample in decoding order is used.
+         *  @return ErrorCode: OK, INVALID_SEQUENCE_IMAGE_ID */
+        virtual ErrorCode seek(const SequenceImageId& sampleId) = 0;
+
+    protected:
+        virtual ~SampleReader() = default;
+    };
+
     /** Interface for reading an High Efficiency Image File Format (HEIF) file. */
     class HEIF_DLL_PUBLIC Reader
     {
@@ -68,6 +96,18 @@ namespace HEIF
          *  @return ErrorCode: OK, FILE_HEADER_ERROR, FILE_READ_ERROR */
         virtual ErrorCode initialize(StreamInterface* input) = 0;
 
+        /** Open a file for reading and read the file header information.
+         *  @param [in] fileName File to open.
+         *  @param [in] config   Reader options, see ReaderConfig.
+         *  @return ErrorCode: OK, FILE_OPEN_ERROR, FILE_READ_ERROR, FILE_HEADER_ERROR */
+        virtual ErrorCode initialize(const char* fileName, const ReaderConfig& config) = 0;
+
+        /** Open an input stream for reading and read the header information.
+         *  @param input         Stream to open.
+         *  @param [in] config   Reader options, see ReaderConfig.
+         *  @return ErrorCode: OK, FILE_HEADER_ERROR, FILE_READ_ERROR */
+        virtual ErrorCode initialize(StreamInterface* input, const ReaderConfig& config) = 0;
+
         /** Reset reader internal state. */
         virtual void close() = 0;
 
@@ -297,6 +337,52 @@ namespace HEIF
                                       uint64_t& memoryBufferSize,
                                       bool bytestreamHeaders = true) = 0;
 
+        /** Get read-only views to the data of an item without copying it.
+         *  Views are returned for items stored with construction method 0 (file offset) or 1 (item data box 'idat').
+         *  File offset items are accessible only if the input stream exposes its contents through
+         *  StreamInterface::data(), as is the case for files opened with initialize(const char*) and
+         *  ReaderConfig::memoryMapFile on platforms supporting memory mapping. Data is returned as stored in the
+         *  file, i.e. nal-length values are not substituted and protected item data is not decrypted. The views stay
+         *  valid until close() is called or the reader is destroyed.
+         *  @param [in]  imageId  Item id of the image.
+         *  @param [out] extents  Views to the item extents, in the order they form the item data.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, INVALID_ITEM_ID, FILE_READ_ERROR, NOT_APPLICABLE if the data can not
+         *                     be accessed without copying (use getItemData() instead) */
+        virtual ErrorCode getItemDataViews(const ImageId& imageId, Array<DataView>& extents) const = 0;
+
+        /** Get the location of the data of an item in the file.
+         *  The location is available for items stored as a single extent with construction method 0 (file offset).
+         *  It allows referencing the data without reading it, e.g. when updating the 'meta' box of the file in place
+         *  with OutputConfig::updateFile of the writer.
+         *  @param [in]  imageId  Item id.
+         *  @param [out] offset   File offset of the item data.
+         *  @param [out] size     Size of the item data in bytes.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, INVALID_ITEM_ID, NOT_APPLICABLE if the item is not stored as a single
+         *                     extent of the file */
+        virtual ErrorCode getItemDataLocation(const ImageId& imageId, uint64_t& offset, uint64_t& size) const = 0;
+
+        /** Get the location of the root level 'meta' box in the file, e.g. for updating it in place with
+         *  OutputConfig::updateFile of the writer.
+         *  @param [out] location  Offset and space of the 'meta' box, and size of the file.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, NOT_APPLICABLE if the file has no root level 'meta' box */
+        virtual ErrorCode getMetaBoxLocation(MetaBoxLocation& location) const = 0;
+
+        /** Get an index cache of the file: a compact binary copy of the parsed boxes and sample tables of the file.
+         *  Storing the cache next to the file and passing it to a later initialize() with ReaderConfig::indexCache
+         *  makes opening the file skip parsing it. The cache is in the byte order of the platform and is valid only
+         *  for the version of the library which made it. A 'moov' box skipped with ReaderConfig::lazyTrackParsing is
+         *  parsed first, once and safely against concurrent calls, like getFileInformation() does.
+         *  @param [in]  contentKey  Key identifying the contents of the file, e.g. its modification time or a hash. A
+         *                           cache is used only if ReaderConfig::indexCacheKey and the size of the file match.
+         *  @param [out] indexCache  The index cache.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, FILE_READ_ERROR, NOT_APPLICABLE if the reader was set up with
+         *                     parseInitializationSegment() or has been fed media segments */
+        virtual ErrorCode getIndexCache(uint64_t contentKey, Array<uint8_t>& indexCache) const = 0;
+
         /** Get data of an image overlay item (item type 'iovl').
          *  @param [in]  imageId   Id of Image overlay item
          *  @param [out] iovlItem  Overlay derived item struct with requested data.
@@ -475,6 +561,59 @@ namespace HEIF
                                                            uint8_t* memoryBuffer,
                                                            uint64_t& memoryBufferSize) = 0;
 
+        /** Get data of an encoded image item and the parameter sets of its decoder configuration without copying the
+         *  parameter sets. The parameter sets are stored once per DecoderConfigId, e.g. once for all tiles of a grid
+         *  sharing one configuration, so the view can be compared by pointer to detect configuration changes.
+         *  This method shall not be used if the item is not of 'hvc1' or 'avc1' type.
+         *  @param [in]  imageId              Item id.
+         *  @param [out] decoderParameters    Parameter sets with bytestream headers, to be fed to the decoder before
+         *                                    the item data. Owned by the reader and valid until close() is called
+         *                                    or the reader is destroyed.
+         *  @param [in,out] memoryBuffer      Memory buffer where item data with bytestream headers is to be written to.
+         *  @param [in,out] memoryBufferSize  Memory buffer size.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, INVALID_ITEM_ID, PROTECTED_ITEM, UNSUPPORTED_CODE_TYPE,
+         *                     BUFFER_SIZE_TOO_SMALL */
+        virtual ErrorCode getItemDataWithDecoderParameters(const ImageId& imageId,
+                                                           DataView& decoderParameters,
+                                                           uint8_t* memoryBuffer,
+                                                           uint64_t& memoryBufferSize) const = 0;
+
+        /** Get data of an image sequence image and the parameter sets of its sample entry without copying the
+         *  parameter sets. The parameter sets are stored once per sample entry.
+         *  This method shall be used only for 'hvc1', 'hev1', 'avc1' or 'avc3' type images.
+         *  @param [in]  sequenceId           Image sequence ID (track ID).
+         *  @param [in]  imageId              Identifier of an image in the sequence (a sample).
+         *  @param [out] decoderParameters    Parameter sets with bytestream headers, to be fed to the decoder before
+         *                                    the sample data. Owned by the reader and valid until close() is called
+         *                                    or the reader is destroyed.
+         *  @param [in,out] memoryBuffer      Memory buffer where sample data with bytestream headers is to be written.
+         *  @param [in,out] memoryBufferSize  Memory buffer size.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, INVALID_SEQUENCE_ID, INVALID_SEQUENCE_IMAGE_ID, UNSUPPORTED_CODE_TYPE,
+         *                     BUFFER_SIZE_TOO_SMALL */
+        virtual ErrorCode getItemDataWithDecoderParameters(const SequenceId& sequenceId,
+                                                           const SequenceImageId& imageId,
+                                                           DataView& decoderParameters,
+                                                           uint8_t* memoryBuffer,
+                                                           uint64_t& memoryBufferSize) = 0;
+
+        /** Get data of all tiles of an image grid item at once.
+         *  Tile extents are resolved in one pass, and extents which are contiguous in the file are read with single
+         *  read operations. Reads are distributed over the given task runner, if any. All tiles must share the same
+         *  decoder configuration, whose parameter sets are returned once in gridTileData.decoderParameters.
+         *  @param [in]  gridId        Item id of the 'grid' item.
+         *  @param [out] gridTileData  Grid layout, decoder parameters and data of each tile with bytestream headers.
+         *  @param [in]  taskRunner    Optional - runner for doing the reads in parallel. By default reads are done in
+         *                             the calling thread.
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, INVALID_ITEM_ID, PROTECTED_ITEM, UNSUPPORTED_CODE_TYPE,
+         *                     DECODER_CONFIGURATION_ERROR if tiles use different decoder configurations,
+         *                     FILE_HEADER_ERROR, FILE_READ_ERROR */
+        virtual ErrorCode getGridTileData(const ImageId& gridId,
+                                          GridTileData& gridTileData,
+                                          TaskRunner* taskRunner = nullptr) const = 0;
+
         /** Get Protection Scheme Information Box for a protected item.
          *  @param [in] imageId               Item id.
          *  @param [in,out] memoryBuffer      Memory buffer where 'sinf' data is to be written to.
@@ -515,6 +654,20 @@ namespace HEIF
         virtual ErrorCode getItemsInDecodingOrder(const SequenceId& sequenceId,
                                                   Array<TimestampIDPair>& decodingOrder) const = 0;
 
+        /** Create a reader for playing back the samples of a track in the order of getItemsInDecodingOrder(), see
+         *  SampleReader. Sample locations are resolved here, and sample data is then read on a background thread.
+         *  The reader must not be closed or destroyed, and segments must not be parsed or invalidated, while a sample
+         *  reader created from it exists. Other methods may be called concurrently.
+         *  @param [in]  sequenceId    Image sequence ID (track ID).
+         *  @param [in]  config        Read-ahead options, see SampleReaderConfig.
+         *  @param [out] sampleReader  The created sample reader, to be destroyed with SampleReader::Destroy().
+         *  @pre initialize() has been called successfully.
+         *  @return ErrorCode: OK, UNINITIALIZED, INVALID_SEQUENCE_ID, UNSUPPORTED_CODE_TYPE if bytestream headers
+         *                     were requested for samples other than H.264, H.265, or MPEG-4 */
+        virtual ErrorCode createSampleReader(const SequenceId& sequenceId,
+                                             const SampleReaderConfig& config,
+                                             SampleReader*& sampleReader) const = 0;
+
         /** Retrieve decoding dependencies for given imageId, in decoding order.
          *  This method should be used to retrieve referenced samples of a sample in a track.
          *  @param [in]  sequenceId    Image sequence ID (track ID).
@@ -589,6 +742,17 @@ namespace HEIF
          *  @return ErrorCode: OK */
         virtual ErrorCode parseInitializationSegment(StreamInterface* streamInterface) = 0;
 
+        /** Parse Initialization Segment
+         *
+         *  Unlike the overload without config, this starts over: segments and other state parsed earlier with this
+         *  reader are discarded, because they may have been allocated from the arena that config replaces.
+         *
+         *  @param [in]  streamInterface   StreamInterface*  Interface to read initialization segment from.
+         *  @param [in]  config            Reader options used for this and following segments, see ReaderConfig.
+         *                                 lazyTrackParsing is not used for segments.
+         *  @return ErrorCode: OK */
+        virtual ErrorCode parseInitializationSegment(StreamInterface* streamInterface, const ReaderConfig& config) = 0;
+
         /** Parse Segment
          *
          *  Note that the segment id must be globally unique per an instance of
@@ -611,6 +775,7 @@ namespace HEIF
          * read.
          *
          *  Note! Must be called for all fed media segments if client is seeking.
+         *  Segments may also be invalidated automatically, see ReaderConfig::segmentMemoryBudget.
          *
          *  @pre Segment with segmentId has been parsed with reader using parseSegment.
          *  @param [in]  segmentId     uint32_t Segment Id of the Initialize Segment
@@ -637,6 +802,13 @@ namespace HEIF
         virtual ErrorCode parseSegmentIndex(StreamInterface* streamInterface,
                                             Array<SegmentInformation>& segmentIndex) = 0;
 
+        /** Get counters and timers of public method calls and parsing phases since the last initialize() or
+         *  parseInitializationSegment() call. Statistics are kept after close().
+         *  @param [out] statistics      Collected statistics.
+         *  @pre Statistics were enabled with ReaderConfig::collectStatistics.
+         *  @return ErrorCode: OK, NOT_APPLICABLE if statistics were not enabled or not built in */
+        virtual ErrorCode getStatistics(ReaderStatistics& statistics) const = 0;
+
     protected:
         virtual ~Reader() = default;
     };
@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "heifallocator.h"
 #include "heifcommondatatypes.h"
 #include "heifexport.h"
 
@@ -152,6 +153,85 @@ namespace HEIF
         Array<DecoderSpecificInfo> decoderSpecificInfo;  ///< Actual decoder specific information (type + payload).
     };
 
+    /// Read-only view to a contiguous range of item data owned by the reader.
+    struct HEIF_DLL_PUBLIC DataView
+    {
+        const uint8_t* data;  ///< Pointer to the first byte of the range.
+        uint64_t size;        ///< Length of the range in bytes.
+    };
+
+    /// Location of the root level 'meta' box in the file, see Reader::getMetaBoxLocation().
+    struct HEIF_DLL_PUBLIC MetaBoxLocation
+    {
+        uint64_t offset;    ///< File offset of the 'meta' box.
+        uint64_t space;     ///< Size of the 'meta' box and of the 'free' and 'skip' boxes directly after it.
+        uint64_t fileSize;  ///< Size of the file.
+    };
+
+    /// Location of the data of a single tile within GridTileData::data.
+    struct HEIF_DLL_PUBLIC TileData
+    {
+        ImageId imageId;  ///< Item id of the tile image.
+        uint64_t offset;  ///< Offset of the tile data in GridTileData::data.
+        uint64_t size;    ///< Size of the tile data in bytes.
+    };
+
+    /// Coded data of all tiles of an image grid ('grid') item, see Reader::getGridTileData().
+    struct HEIF_DLL_PUBLIC GridTileData
+    {
+        Grid grid;                         ///< Grid layout. Tile order of 'tiles' matches grid.imageIds.
+        FourCC decoderCodeType;            ///< Decoder code type shared by all tiles ('hvc1' or 'avc1').
+        DecoderConfigId decoderConfigId;   ///< Decoder configuration shared by all tiles.
+        Array<uint8_t> decoderParameters;  ///< Parameter sets of the shared decoder configuration with bytestream
+                                           ///< headers, to be fed to the decoder(s) before any tile data.
+        Array<TileData> tiles;             ///< Location of data of each tile in 'data'.
+        Array<uint8_t> data;               ///< Data of all tiles with bytestream headers.
+    };
+
+    /** Interface for running independent tasks of batch data access methods in parallel, e.g. on an existing
+     *  thread pool of the application. */
+    class HEIF_DLL_PUBLIC TaskRunner
+    {
+    public:
+        typedef void (*Task)(void* context, uint64_t index);
+
+        /** Run task(context, index) for every index in range [0, count) and return when all of them have completed.
+         *  The tasks are independent of each other and may be run concurrently in any order.
+         *  @param [in] task     Function to run.
+         *  @param [in] context  Context argument for the function.
+         *  @param [in] count    Number of tasks to run. */
+        virtual void run(Task task, void* context, uint64_t count) = 0;
+
+    protected:
+        virtual ~TaskRunner() = default;
+    };
+
+    /// Options of a SampleReader, see Reader::createSampleReader().
+    struct HEIF_DLL_PUBLIC SampleReaderConfig
+    {
+        /**
+         * Number of samples read ahead of the consumer. Buffers for this many samples are allocated once and reused for
+         * the whole track, so memory use is bounded by the number times the largest sample size. At least 2. */
+        uint32_t prefetchCount = 8;
+
+        /**
+         * Upper limit in bytes for merging the reads of samples which follow each other both in decoding order and in
+         * the file, e.g. samples of the same chunk. 0 reads each sample separately. */
+        uint64_t maxMergedReadSize = 4 * 1024 * 1024;
+
+        /// Whether to substitute H.264/H.265 nal-length values with bytestream headers (0001), as in getItemData().
+        bool bytestreamHeaders = true;
+    };
+
+    /// A sample returned by SampleReader::nextSample().
+    struct HEIF_DLL_PUBLIC SampleData
+    {
+        SequenceImageId sampleId;  ///< Identifier of the sample in the sequence.
+        int64_t timeStamp;         ///< Timestamp of the sample as in Reader::getItemsInDecodingOrder().
+        const uint8_t* data;       ///< Sample data, owned by the SampleReader.
+        uint64_t size;             ///< Size of the sample data in bytes.
+    };
+
     typedef uint32_t FeatureBitMask;
 
     struct HEIF_DLL_PUBLIC ItemInformation
@@ -377,6 +457,91 @@ namespace HEIF
         bool startsWithSAP;        ///< indicates whether the segment start with a Stream Access Point (SAP)
         uint8_t SAPType;           ///< SAP type as specified in 8.16.3.3 of ISO/IEC 14496-12:2015(E)
     };
+
+    struct HEIF_DLL_PUBLIC ReaderConfig
+    {
+        /**
+         * If true: initialize(const char*) memory maps the file when possible, so that getItemDataViews() can return
+         * views to file offset items and reads are plain memory copies. The file must then not be truncated or
+         * rewritten while it is open: accessing a mapped page beyond the new end of the file terminates the process
+         * (SIGBUS on POSIX systems) instead of returning FILE_READ_ERROR. If false, the file is read with buffered
+         * reads. Not used by initialize(StreamInterface*). */
+        bool memoryMapFile = false;
+
+        /**
+         * If true: initialize() only records the location of the 'moov' box. Track information, sample tables and
+         * timestamps are parsed when first needed, by getFileInformation(), getTrackInformations() or a method taking
+         * a SequenceId. Items of the root level 'meta' box can then be read without parsing 'moov' at all.
+         * Errors in the 'moov' box are reported by the method which triggered the parsing. The box is parsed only
+         * once: when such methods are called concurrently, the others wait until the first one has parsed it. */
+        bool lazyTrackParsing = false;
+
+        /**
+         * Size in bytes of the read-ahead block used when walking boxes of the input stream. When non-zero, box headers
+         * and small boxes are served from blocks read from the stream, so that opening a file takes a handful of reads
+         * instead of several small reads per box. Recommended for streams with a high per-read latency, such as
+         * network backed streams, e.g. 65536. 0 disables read-ahead. Not used for streams which provide
+         * StreamInterface::data(). */
+        std::uint32_t readAheadSize = 0;
+
+        /**
+         * Upper limit in bytes for the sample tables of media segments fed with Reader::parseSegment(). When a parsed
+         * segment takes the total over the limit, the least recently used segments are invalidated as if
+         * Reader::invalidateSegment() had been called, until the total is within the limit again. The segment being
+         * parsed is never invalidated. A segment is used when its samples are accessed. Evicted segments can be fed
+         * again with parseSegment(). 0 means no limit. */
+        std::uint64_t segmentMemoryBudget = 0;
+
+        /**
+         * If true: counters and timers of public method calls and parsing phases are collected, and can be read with
+         * Reader::getStatistics(). When false, the only cost is a thread local check per allocation, stream access and
+         * parsed box. Building with the CMake option HEIF_DISABLE_STATISTICS removes these checks, and this is then
+         * ignored. */
+        bool collectStatistics = false;
+
+        /**
+         * Allocator for the parse state of this reader: boxes, sample tables and indexes built by initialize(),
+         * parseInitializationSegment() and lazy track parsing. Lets readers of one process use different allocators.
+         * Data returned by other methods and the state of media segments fed with parseSegment() use the allocator set
+         * with Reader::SetCustomAllocator(). nullptr uses that allocator for the parse state too. Without
+         * arenaBlockSize, each block taken from another allocator is tracked in a process-wide table, so that it is
+         * returned to that allocator wherever it is freed. This makes parsing slower than with the default allocator,
+         * while an arena tracks only its own blocks. The allocator must stay valid until the reader is destroyed or
+         * initialized with another parseAllocator. */
+        CustomAllocator* parseAllocator = nullptr;
+
+        /**
+         * When non-zero: the parse state is allocated from a per-reader arena taking blocks of this size in bytes from
+         * parseAllocator. Allocations then only bump a pointer, freeing individual objects does nothing, and all of
+         * the parse state is released in one go by close(), initialize() or destroying the reader. The blocks are kept
+         * for the next file until the reader is destroyed, so reusing one reader for many files does not allocate
+         * them again. Allocations larger than a quarter of the block size, such as large sample tables, are made from
+         * parseAllocator directly. Recommended when many files are opened and closed at a high rate, e.g. 65536.
+         * 0 disables the arena. */
+        std::uint32_t arenaBlockSize = 0;
+
+        /**
+         * Index cache of the file, made earlier with Reader::getIndexCache(). When set, initialize() restores the
+         * parsed boxes and sample tables from the cache instead of parsing them from the file, so that the file is
+         * only read for item and sample data. The cache is used only if it was made by this version of the library,
+         * for a file of the same size and with the same indexCacheKey. Otherwise the file is parsed as usual. The
+         * data is copied during initialize(), so it can be e.g. a memory mapped cache file unmapped right after. */
+        const std::uint8_t* indexCache = nullptr;
+        std::uint64_t indexCacheSize   = 0;  ///< Size of indexCache in bytes.
+        std::uint64_t indexCacheKey    = 0;  ///< Content key given to Reader::getIndexCache() when the cache was made.
+    };
+
+    struct HEIF_DLL_PUBLIC ReaderStatistics
+    {
+        CallStatistics total;         ///< Sum of all public method calls.
+        Array<CallStatistics> calls;  ///< Public methods, in the order they were first called.
+
+        /**
+         * Parsing phases, in the order they first ran: "parse ftyp", "parse meta", "parse moov" and "parse moof" for
+         * parsing of the respective boxes, "parse sidx" for segment indexes, and "load index cache" for restoring
+         * them from ReaderConfig::indexCache. */
+        Array<CallStatistics> phases;
+    };
 }  // namespace HEIF
 
 #endif /* HEIFFILEDATATYPES_H */
@@ -95,7 +95,8 @@ namespace HEIF
 
         /**
          * Finalize the file writing.
-         * @return ErrorCode: OK, UNINITIALIZED or BRANDS_NOT_SET
+         * @return ErrorCode: OK, UNINITIALIZED, BRANDS_NOT_SET or FILE_HEADER_ERROR if a box was not written with the
+         *         size its file offsets were computed for
          */
         virtual ErrorCode finalize() = 0;
 
@@ -126,6 +127,36 @@ namespace HEIF
          */
         virtual ErrorCode feedMediaData(const Data& data, MediaDataId& mediaDataId) = 0;
 
+        /**
+         * Refer to media data which is already in the file updated with OutputConfig::updateFile = true, instead of
+         * feeding it again with feedMediaData(). The data is not written.
+         * @param data        [in]  Data struct. Only the size is used, except for JPEG data whose header is parsed for
+         *                          the image dimensions. data.data can be nullptr for other media formats.
+         * @param offset      [in]  File offset of the data, e.g. from Reader::getItemDataLocation().
+         * @param mediaDataId [out] MediaDataId for the data. This can then be for example referred by addImage().
+         * @return ErrorCode: OK, UNINITIALIZED, NOT_APPLICABLE if the file is not updated, INVALID_FUNCTION_PARAMETER
+         *                    if the data is not within the file, INVALID_DECODER_CONFIG_ID, INVALID_MEDIA_FORMAT or
+         *                    MEDIA_PARSING_ERROR
+         */
+        virtual ErrorCode feedExistingMediaData(const Data& data, std::uint64_t offset, MediaDataId& mediaDataId) = 0;
+
+        /**
+         * Get counters of media data fed with feedMediaData() after initialize(), including deduplication of identical
+         * media data. Counters are kept until the next initialize() call.
+         * @param statistics [out] Media data statistics.
+         * @return ErrorCode: OK
+         */
+        virtual ErrorCode getMediaDataStatistics(MediaDataStatistics& statistics) const = 0;
+
+        /**
+         * Get counters and timers of public method calls and finalization phases since initialize(), including
+         * media data statistics. Statistics are kept after finalize(), until the next initialize() call.
+         * @param statistics [out] Collected statistics.
+         * @return ErrorCode: OK, NOT_APPLICABLE if statistics were not enabled with OutputConfig::collectStatistics or
+         *                    not built in
+         */
+        virtual ErrorCode getStatistics(WriterStatistics& statistics) const = 0;
+
         ///////////////////////////////////
         // HEIF Image Collection Methods //
         ///////////////////////////////////
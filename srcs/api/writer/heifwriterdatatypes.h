@@ -49,6 +49,90 @@ namespace HEIF
          * When parsing generated file whole file needs to be available for parsing to be possible. */
         bool progressiveFile = true;
 
+        /**
+         * If true and progressiveFile = true: media data fed with feedMediaData() is written to a temporary spill file
+         * instead of being kept in memory, and copied after 'meta' and 'moov' boxes in finalize(). Memory use of the
+         * writer then does not depend on the amount of media data. */
+        bool spillMediaData = false;
+
+        /**
+         * Name of the spill file used when spillMediaData = true. If not set, an anonymous temporary file is used.
+         * The spill file is removed in finalize(). */
+        const char* spillFileName = nullptr;
+
+        /**
+         * If true: the file is written as a fragmented file, and progressiveFile is ignored. 'ftyp' and 'moov' boxes
+         * are written together with the first movie fragment, or in finalize() if no fragment was written. After that,
+         * media data is written as 'moof' and 'mdat' box pairs, each holding the samples added since the previous
+         * fragment, and kept in memory only until its fragment has been written.
+         * A fragment is written before a sync sample is added to a track which has reached fragmentSampleCount samples
+         * or fragmentDuration milliseconds of media since the previous fragment, and in finalize().
+         *
+         * Limitations of fragmented files:
+         * - Image items and other root level 'meta' box content can not be added.
+         * - Tracks and decoder configurations of a track can not be added after the first fragment has been written.
+         *   A track that has no samples by then gets no sample description, so samples can not be added to it later.
+         * - Samples can not reference media data or samples that are already written to a fragment.
+         * - Sample metadata and equivalence groups are not supported. */
+        bool fragmentedFile = false;
+
+        /**
+         * Maximum number of samples of a track in one movie fragment, before the fragment is written on the next sync
+         * sample. 0 means no limit. Either fragmentSampleCount or fragmentDuration must be set for fragmented files. */
+        std::uint32_t fragmentSampleCount = 0;
+
+        /**
+         * Maximum duration of samples of a track in one movie fragment in milliseconds, before the fragment is written
+         * on the next sync sample. 0 means no limit. */
+        std::uint32_t fragmentDuration = 0;
+
+        /**
+         * If true: a Segment Index Box ('sidx') indexing the fragment is written before each movie fragment of a
+         * fragmented file. */
+        bool fragmentSegmentIndex = false;
+
+        /**
+         * If true: media data fed with feedMediaData() that is identical to earlier fed media data of the same format
+         * and decoder configuration is stored only once, and the earlier MediaDataId is returned. Set to false to skip
+         * hashing of fed data when it is known to be unique. Not used for fragmented files. Data found by its hash is
+         * compared byte by byte. When media data is written directly to the output, i.e. progressiveFile is false or
+         * updateFile is true, it is read back from the output file for the comparison. An outputStream can not be read
+         * back, so then only data kept in memory up to deduplicationMemoryLimit is deduplicated. */
+        bool deduplicateMediaData = true;
+
+        /**
+         * Maximum total size in bytes of copies of fed media data kept in memory for deduplicateMediaData, when media
+         * data is written directly to outputStream. Data fed after the limit is reached is written as it is, and later
+         * identical data is not deduplicated against it, but it is still compared with the copies kept before that.
+         * 0 keeps no copies, so data written to an outputStream is not deduplicated. Not used when writing to
+         * fileName, as the file is read back instead. */
+        std::uint64_t deduplicationMemoryLimit = 0;
+
+        /**
+         * If true: the root level 'meta' box of the existing file fileName is rewritten, and the rest of the file is
+         * kept as is. Data already in the file is referenced with Writer::feedExistingMediaData() instead of being fed
+         * again, and new media data fed with feedMediaData() is appended to the file in a new MediaDataBox ('mdat').
+         * The new 'meta' box replaces the old one at updateMetaOffset if it fits into updateMetaSpace, and the rest of
+         * the space is marked as a 'free' box. Otherwise the new 'meta' box is appended to the end of the file, and the
+         * old one is then turned into a 'free' box. The location is given by Reader::getMetaBoxLocation().
+         * The file is modified in place: the old boxes are kept until finalize(), so abandoning the update before it
+         * leaves the original content readable, but an error or interruption while finalize() overwrites the old
+         * 'meta' box can leave the file unreadable. Update a copy of the file when that is not acceptable.
+         * Brands are not changed, and tracks can not be added. progressiveFile and spillMediaData are ignored. */
+        bool updateFile = false;
+
+        /**
+         * File offset of the root level 'meta' box to replace when updateFile = true. */
+        std::uint64_t updateMetaOffset = 0;
+
+        /**
+         * Size of the 'meta' box and of the 'free' boxes directly after it when updateFile = true. */
+        std::uint64_t updateMetaSpace = 0;
+
+        /**
+         * Size of the existing file when updateFile = true. */
+        std::uint64_t updateFileSize = 0;
+
         /**
          * Brand four character code information stored to 'ftyp' box at the start of the file indicating content of the
          * file. If progressiveFile = false, then this information needs to be available when initialize() is called. If
@@ -63,6 +147,13 @@ namespace HEIF
          * image item. If false: Creation time properties are not created and associated automatically.
          */
         bool itemCreationTimes = false;
+
+        /**
+         * If true: counters and timers of public method calls and finalization phases are collected, and can be read
+         * with Writer::getStatistics(). When false, the only cost is a thread local check per allocation, stream access
+         * and written box. Building with the CMake option HEIF_DISABLE_STATISTICS removes these checks, and this is
+         * then ignored. */
+        bool collectStatistics = false;
     };
 
     enum class MediaFormat
@@ -91,6 +182,28 @@ namespace HEIF
             0;  // required for MediaFormat values: AVC, HEVC, JPEG and AAC. Not needed for EXIF,XMP or MPEG7 metadata.
     };
 
+    struct HEIF_DLL_PUBLIC MediaDataStatistics
+    {
+        std::uint64_t fedCount          = 0;  ///< Number of feedMediaData() calls.
+        std::uint64_t fedBytes          = 0;  ///< Bytes fed with feedMediaData().
+        std::uint64_t deduplicatedCount = 0;  ///< Number of fed media data which were found to be duplicates.
+        std::uint64_t deduplicatedBytes = 0;  ///< Bytes not stored because they were duplicates.
+        std::uint64_t hashCollisions    = 0;  ///< Content hash matches which were not duplicates.
+    };
+
+    struct HEIF_DLL_PUBLIC WriterStatistics
+    {
+        CallStatistics total;           ///< Sum of all public method calls.
+        Array<CallStatistics> calls;    ///< Public methods, in the order they were first called.
+        MediaDataStatistics mediaData;  ///< Counters of fed and deduplicated media data.
+
+        /**
+         * Phases, in the order they first ran: "build meta" and "build moov" for creating the 'meta' and 'moov' boxes
+         * from added content, "write meta" and "write moov" for serializing and writing them, "write mdat" for
+         * writing media data kept in memory or in the spill file, and "write fragment" for movie fragments. */
+        Array<CallStatistics> phases;
+    };
+
     struct HEIF_DLL_PUBLIC SampleInfo
     {
         uint64_t duration;          ///< duration of sample in ImageSequence timeBase units.
@@ -0,0 +1,752 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "benchgenerator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "benchutils.hpp"
+#include "heifreader.h"
+#include "heifwriter.h"
+
+using namespace HEIF;
+
+namespace HeifBench
+{
+    namespace
+    {
+        // Baseline profile AVC parameter sets, in byte stream format as expected by Writer::feedDecoderConfig().
+        const std::uint8_t AVC_SPS[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x0a, 0xf8, 0x41, 0xa2};
+        const std::uint8_t AVC_PPS[] = {0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x38, 0x80};
+
+        // Main profile HEVC parameter sets of a 64x64 picture, in byte stream format.
+        const std::uint8_t HEVC_VPS[] = {0x00, 0x00, 0x00, 0x01, 0x40, 0x01, 0x0c, 0x01, 0xff, 0xff, 0x01, 0x60, 0x00,
+                                         0x00, 0x03, 0x00, 0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x1e, 0xf0,
+                                         0x24};
+        const std::uint8_t HEVC_SPS[] = {0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00,
+                                         0x03, 0x00, 0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x1e,
+                                         0xa0, 0x20, 0x81, 0x05, 0x97, 0xe4, 0x93, 0x08, 0x20};
+        const std::uint8_t HEVC_PPS[] = {0x00, 0x00, 0x00, 0x01, 0x44, 0x01, 0xc0, 0x71, 0x80, 0x12};
+
+        const std::uint32_t TILE_SIZE            = 2048;   ///< Coded size of a grid tile
+        const std::uint32_t COLLECTION_ITEM_SIZE = 1024;   ///< Coded size of a collection image
+        const std::uint32_t SYNC_INTERVAL        = 30;     ///< Sync sample interval of sequences
+        const std::uint32_t FRAGMENT_SAMPLES     = 300;    ///< Samples per fragment of the fragmented file
+        const std::uint32_t LARGE_NAL_UNIT_SIZE  = 65536;  ///< Size of NAL units in large frames
+
+        /** Deterministic pseudo random byte generator, so that generated files do not depend on the platform. */
+        class ByteGenerator
+        {
+        public:
+            explicit ByteGenerator(const std::uint32_t seed)
+                : mState(seed * 2654435761u + 1)
+            {
+            }
+
+            std::uint8_t next()
+            {
+                mState = mState * 1664525u + 1013904223u;
+                return static_cast<std::uint8_t>(mState >> 24);
+            }
+
+        private:
+            std::uint32_t mState;
+        };
+
+        /** Make a length prefixed AVC or HEVC access unit of NAL units with at most maxNalUnitSize bytes each. Payload
+         * bytes are never zero, so the NAL units contain no start code emulation, like real emulation prevented
+         * bitstreams. */
+        std::vector<std::uint8_t> makeFrame(const std::uint32_t size,
+                                            const std::uint32_t maxNalUnitSize,
+                                            const bool isSync,
+                                            const std::uint32_t seed,
+                                            const MediaFormat format = MediaFormat::AVC)
+        {
+            // IDR or non-IDR slice for AVC, IDR_W_RADL or TRAIL_R slice for HEVC.
+            std::vector<std::uint8_t> header;
+            if (format == MediaFormat::HEVC)
+            {
+                header = {static_cast<std::uint8_t>(isSync ? 0x26 : 0x02), 0x01};
+            }
+            else
+            {
+                header = {static_cast<std::uint8_t>(isSync ? 0x65 : 0x41)};
+            }
+
+            ByteGenerator generator(seed);
+            std::vector<std::uint8_t> frame;
+            frame.reserve(size);
+            while (frame.size() + 4 + header.size() <= size)
+            {
+                const auto nalUnitSize =
+                    static_cast<std::uint32_t>(std::min<std::size_t>(maxNalUnitSize, size - frame.size() - 4));
+                frame.push_back(static_cast<std::uint8_t>(nalUnitSize >> 24));
+                frame.push_back(static_cast<std::uint8_t>(nalUnitSize >> 16));
+                frame.push_back(static_cast<std::uint8_t>(nalUnitSize >> 8));
+                frame.push_back(static_cast<std::uint8_t>(nalUnitSize));
+                frame.insert(frame.end(), header.begin(), header.end());
+                for (std::uint32_t i = static_cast<std::uint32_t>(header.size()); i < nalUnitSize; ++i)
+                {
+                    const std::uint8_t byte = generator.next();
+                    frame.push_back(byte != 0 ? byte : 1);
+                }
+            }
+            return frame;
+        }
+
+        bool feedDecoderConfig(Writer& writer,
+                               DecoderConfigId& decoderConfigId,
+                               const MediaFormat format = MediaFormat::AVC)
+        {
+            Array<DecoderSpecificInfo> decoderConfig(format == MediaFormat::HEVC ? 3 : 2);
+            if (format == MediaFormat::HEVC)
+            {
+                decoderConfig[0].decSpecInfoType = DecoderSpecInfoType::HEVC_VPS;
+                decoderConfig[0].decSpecInfoData = Array<std::uint8_t>(std::begin(HEVC_VPS), std::end(HEVC_VPS));
+                decoderConfig[1].decSpecInfoType = DecoderSpecInfoType::HEVC_SPS;
+                decoderConfig[1].decSpecInfoData = Array<std::uint8_t>(std::begin(HEVC_SPS), std::end(HEVC_SPS));
+                decoderConfig[2].decSpecInfoType = DecoderSpecInfoType::HEVC_PPS;
+                decoderConfig[2].decSpecInfoData = Array<std::uint8_t>(std::begin(HEVC_PPS), std::end(HEVC_PPS));
+            }
+            else
+            {
+                decoderConfig[0].decSpecInfoType = DecoderSpecInfoType::AVC_SPS;
+                decoderConfig[0].decSpecInfoData = Array<std::uint8_t>(std::begin(AVC_SPS), std::end(AVC_SPS));
+                decoderConfig[1].decSpecInfoType = DecoderSpecInfoType::AVC_PPS;
+                decoderConfig[1].decSpecInfoData = Array<std::uint8_t>(std::begin(AVC_PPS), std::end(AVC_PPS));
+            }
+            return writer.feedDecoderConfig(decoderConfig, decoderConfigId) == ErrorCode::OK;
+        }
+
+        bool feedFrame(Writer& writer,
+                       const DecoderConfigId& decoderConfigId,
+                       std::vector<std::uint8_t> frame,
+                       MediaDataId& mediaDataId,
+                       const MediaFormat format = MediaFormat::AVC)
+        {
+            Data data{};
+            data.data            = frame.data();
+            data.size            = frame.size();
+            data.mediaFormat     = format;
+            data.decoderConfigId = decoderConfigId;
+            return writer.feedMediaData(data, mediaDataId) == ErrorCode::OK;
+        }
+
+        /// Output stream to memory, which the writer can not read back.
+        class MemoryOutputStream : public OutputStreamInterface
+        {
+        public:
+            void seekp(const std::uint64_t position) override
+            {
+                mPosition = position;
+            }
+
+            std::uint64_t tellp() override
+            {
+                return mPosition;
+            }
+
+            void write(const void* buffer, const std::uint64_t size) override
+            {
+                if (mPosition + size > mData.size())
+                {
+                    mData.resize(static_cast<std::size_t>(mPosition + size));
+                }
+                std::memcpy(mData.data() + mPosition, buffer, static_cast<std::size_t>(size));
+                mPosition += size;
+            }
+
+            void remove() override
+            {
+                mData.clear();
+            }
+
+            const std::vector<char>& getData() const
+            {
+                return mData;
+            }
+
+        private:
+            std::vector<char> mData;
+            std::uint64_t mPosition = 0;
+        };
+
+        bool writeGrid(Writer& writer, const GeneratorConfig& config)
+        {
+            DecoderConfigId decoderConfigId;
+            if (!feedDecoderConfig(writer, decoderConfigId))
+            {
+                return false;
+            }
+
+            Grid grid;
+            grid.columns      = config.gridColumns;
+            grid.rows         = config.gridColumns;
+            grid.outputWidth  = config.gridColumns * 176;
+            grid.outputHeight = config.gridColumns * 144;
+            grid.imageIds     = Array<ImageId>(grid.columns * grid.rows);
+            for (std::uint32_t i = 0; i < grid.imageIds.size; ++i)
+            {
+                MediaDataId mediaDataId;
+                if (!feedFrame(writer, decoderConfigId, makeFrame(TILE_SIZE, TILE_SIZE, true, config.seed + i),
+                               mediaDataId) ||
+                    writer.addImage(mediaDataId, grid.imageIds[i]) != ErrorCode::OK ||
+                    writer.setImageHidden(grid.imageIds[i], true) != ErrorCode::OK)
+                {
+                    return false;
+                }
+            }
+
+            ImageId gridId;
+            return writer.addDerivedImageItem(grid, gridId) == ErrorCode::OK &&
+                   writer.setPrimaryItem(gridId) == ErrorCode::OK;
+        }
+
+        bool writeCollection(Writer& writer, const GeneratorConfig& config, GeneratedContent* content)
+        {
+            DecoderConfigId decoderConfigId;
+            if (!feedDecoderConfig(writer, decoderConfigId))
+            {
+                return false;
+            }
+
+            PropertyId rotations[4];
+            for (std::uint32_t i = 0; i < 4; ++i)
+            {
+                Rotate rotate;
+                rotate.angle = i * 90;
+                if (writer.addProperty(rotate, rotations[i]) != ErrorCode::OK)
+                {
+                    return false;
+                }
+            }
+
+            for (std::uint32_t i = 0; i < config.collectionItems; ++i)
+            {
+                const auto frame = makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, config.seed + i);
+                MediaDataId mediaDataId;
+                ImageId imageId;
+                if (!feedFrame(writer, decoderConfigId, frame, mediaDataId) ||
+                    writer.addImage(mediaDataId, imageId) != ErrorCode::OK ||
+                    writer.associateProperty(imageId, rotations[i % 4], true) != ErrorCode::OK)
+                {
+                    return false;
+                }
+                if (i == 0 && writer.setPrimaryItem(imageId) != ErrorCode::OK)
+                {
+                    return false;
+                }
+                if (content)
+                {
+                    content->items.push_back({imageId.get(), "avc1", frame});
+                }
+            }
+            return true;
+        }
+
+        bool writeSequence(Writer& writer, const GeneratorConfig& config, GeneratedContent* content)
+        {
+            DecoderConfigId decoderConfigId;
+            SequenceId sequenceId;
+            const CodingConstraints constraints{true, true, 1};
+            if (!feedDecoderConfig(writer, decoderConfigId) ||
+                writer.addImageSequence(Rational{1, 90000}, constraints, sequenceId) != ErrorCode::OK)
+            {
+                return false;
+            }
+
+            for (std::uint32_t i = 0; i < config.sequenceSamples; ++i)
+            {
+                SampleInfo sampleInfo{};
+                sampleInfo.duration     = 3000;
+                sampleInfo.isSyncSample = (i % SYNC_INTERVAL) == 0;
+
+                const auto frame =
+                    makeFrame(config.sampleSize, config.sampleSize, sampleInfo.isSyncSample, config.seed + i);
+                MediaDataId mediaDataId;
+                SequenceImageId sampleId;
+                if (!feedFrame(writer, decoderConfigId, frame, mediaDataId) ||
+                    writer.addImage(sequenceId, mediaDataId, sampleInfo, sampleId) != ErrorCode::OK)
+                {
+                    return false;
+                }
+                if (content)
+                {
+                    content->samples.push_back(frame);
+                }
+            }
+
+            for (std::uint32_t i = 0; i < config.sequenceItems; ++i)
+            {
+                const auto frame = makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, config.seed + i);
+                MediaDataId mediaDataId;
+                ImageId imageId;
+                if (!feedFrame(writer, decoderConfigId, frame, mediaDataId) ||
+                    writer.addImage(mediaDataId, imageId) != ErrorCode::OK)
+                {
+                    return false;
+                }
+                if (content)
+                {
+                    content->items.push_back({imageId.get(), "avc1", frame});
+                }
+            }
+            return true;
+        }
+
+        bool writeFragmented(Writer& writer, const GeneratorConfig& config)
+        {
+            DecoderConfigId decoderConfigId;
+            SequenceId sequenceId;
+            if (!feedDecoderConfig(writer, decoderConfigId) ||
+                writer.addVideoTrack(Rational{1, 90000}, sequenceId) != ErrorCode::OK)
+            {
+                return false;
+            }
+
+            for (std::uint32_t i = 0; i < config.sequenceSamples; ++i)
+            {
+                SampleInfo sampleInfo{};
+                sampleInfo.duration     = 3000;
+                sampleInfo.isSyncSample = (i % SYNC_INTERVAL) == 0;
+
+                const auto frame =
+                    makeFrame(config.sampleSize, config.sampleSize, sampleInfo.isSyncSample, config.seed + i);
+                MediaDataId mediaDataId;
+                SequenceImageId sampleId;
+                if (!feedFrame(writer, decoderConfigId, frame, mediaDataId) ||
+                    writer.addVideo(sequenceId, mediaDataId, sampleInfo, sampleId) != ErrorCode::OK)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool writeLargeNals(Writer& writer, const GeneratorConfig& config)
+        {
+            DecoderConfigId decoderConfigId;
+            if (!feedDecoderConfig(writer, decoderConfigId, MediaFormat::HEVC))
+            {
+                return false;
+            }
+
+            for (std::uint32_t i = 0; i < config.largeNalImages; ++i)
+            {
+                const auto frame =
+                    makeFrame(config.largeNalSize, LARGE_NAL_UNIT_SIZE, true, config.seed + i, MediaFormat::HEVC);
+                MediaDataId mediaDataId;
+                ImageId imageId;
+                if (!feedFrame(writer, decoderConfigId, frame, mediaDataId, MediaFormat::HEVC) ||
+                    writer.addImage(mediaDataId, imageId) != ErrorCode::OK)
+                {
+                    return false;
+                }
+                if (i == 0 && writer.setPrimaryItem(imageId) != ErrorCode::OK)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }  // namespace
+
+    bool checkFragmentedWriterRestrictions(const std::string& fileName)
+    {
+        OutputConfig outputConfig{};
+        outputConfig.fileName            = fileName.c_str();
+        outputConfig.fragmentedFile      = true;
+        outputConfig.fragmentSampleCount = 2;
+        outputConfig.majorBrand          = "iso6";
+        outputConfig.compatibleBrands    = Array<FourCC>{"iso6", "mp42"};
+
+        Writer* writer = Writer::Create();
+        DecoderConfigId decoderConfigId;
+        MediaDataId mediaDataId;
+        SequenceId sequenceId;
+        bool success = writer->initialize(outputConfig) == ErrorCode::OK &&
+                       feedDecoderConfig(*writer, decoderConfigId) &&
+                       feedFrame(*writer, decoderConfigId,
+                                 makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, 0), mediaDataId) &&
+                       writer->addVideoTrack(Rational{1, 90000}, sequenceId) == ErrorCode::OK;
+
+        // A fragmented file has no root level 'meta' box for items.
+        ImageId imageId;
+        MetadataItemId metadataItemId;
+        Grid grid{};
+        Overlay overlay{};
+        success = success && writer->addImage(mediaDataId, imageId) == ErrorCode::NOT_APPLICABLE &&
+                  writer->addDerivedImage(ImageId(1), imageId) == ErrorCode::NOT_APPLICABLE &&
+                  writer->addDerivedImageItem(grid, imageId) == ErrorCode::NOT_APPLICABLE &&
+                  writer->addDerivedImageItem(overlay, imageId) == ErrorCode::NOT_APPLICABLE &&
+                  writer->addMetadata(mediaDataId, metadataItemId) == ErrorCode::NOT_APPLICABLE;
+
+        // Sync samples past the fragment sample count write 'moov', after which tracks can not be added.
+        for (std::uint32_t i = 0; success && i < 3; ++i)
+        {
+            SampleInfo sampleInfo{};
+            sampleInfo.duration     = 3000;
+            sampleInfo.isSyncSample = true;
+            MediaDataId sampleDataId;
+            SequenceImageId sampleId;
+            success = feedFrame(*writer, decoderConfigId,
+                                makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, i + 1), sampleDataId) &&
+                      writer->addVideo(sequenceId, sampleDataId, sampleInfo, sampleId) == ErrorCode::OK;
+        }
+        SequenceId rejectedId;
+        const CodingConstraints constraints{true, true, 1};
+        success = success && writer->addVideoTrack(Rational{1, 90000}, rejectedId) == ErrorCode::NOT_APPLICABLE &&
+                  writer->addImageSequence(Rational{1, 90000}, constraints, rejectedId) == ErrorCode::NOT_APPLICABLE &&
+                  writer->finalize() == ErrorCode::OK;
+        Writer::Destroy(writer);
+        return success;
+    }
+
+    bool checkLargeChunkOffsets(const std::string& fileName)
+    {
+        OutputConfig outputConfig{};
+        outputConfig.fileName             = fileName.c_str();
+        outputConfig.progressiveFile      = true;
+        outputConfig.spillMediaData       = true;
+        outputConfig.deduplicateMediaData = false;
+        outputConfig.majorBrand           = "msf1";
+        outputConfig.compatibleBrands     = Array<FourCC>{"msf1", "iso8"};
+
+        // Non-sync samples up to just below 4 GiB of media data, and a sync sample which starts a new chunk there.
+        const std::uint32_t largeSize    = 64 << 20;
+        const std::uint32_t largeSamples = 64;
+        const std::uint32_t offsetMargin = 64;
+
+        const std::vector<std::uint8_t> largeFrame = makeFrame(largeSize, largeSize, false, 0);
+        const std::vector<std::uint8_t> lastFrame  = makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, 2);
+        const std::vector<std::uint8_t> lastLargeFrame =
+            makeFrame(largeSize - offsetMargin, largeSize - offsetMargin, false, 1);
+
+        Writer* writer = Writer::Create();
+        DecoderConfigId decoderConfigId;
+        SequenceId sequenceId;
+        const CodingConstraints constraints{true, true, 1};
+        bool success = writer->initialize(outputConfig) == ErrorCode::OK &&
+                       feedDecoderConfig(*writer, decoderConfigId) &&
+                       writer->addImageSequence(Rational{1, 90000}, constraints, sequenceId) == ErrorCode::OK;
+        for (std::uint32_t i = 0; success && i <= largeSamples; ++i)
+        {
+            SampleInfo sampleInfo{};
+            sampleInfo.duration     = 3000;
+            sampleInfo.isSyncSample = (i == 0) || (i == largeSamples);
+            MediaDataId mediaDataId;
+            SequenceImageId sampleId;
+            const std::vector<std::uint8_t>& frame =
+                i == largeSamples ? lastFrame : (i == largeSamples - 1 ? lastLargeFrame : largeFrame);
+            success = feedFrame(*writer, decoderConfigId, frame, mediaDataId) &&
+                      writer->addImage(sequenceId, mediaDataId, sampleInfo, sampleId) == ErrorCode::OK;
+        }
+        success = success && writer->finalize() == ErrorCode::OK;
+        Writer::Destroy(writer);
+
+        // Samples past 4 GiB are read from the right place only if their chunk offsets were written as 64 bits.
+        Reader* reader = Reader::Create();
+        Array<TrackInformation> tracks;
+        success = success && reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                  reader->getTrackInformations(tracks) == ErrorCode::OK && tracks.size == 1 &&
+                  tracks[0].sampleProperties.size == largeSamples + 1;
+        for (std::uint32_t i = largeSamples - 1; success && i <= largeSamples; ++i)
+        {
+            const std::vector<std::uint8_t>& expected = i == largeSamples ? lastFrame : lastLargeFrame;
+            std::vector<std::uint8_t> data(expected.size());
+            std::uint64_t size = data.size();
+            success = reader->getItemData(tracks[0].trackId, tracks[0].sampleProperties[i].sampleId, data.data(), size,
+                                          false) == ErrorCode::OK &&
+                      data == expected;
+        }
+        Reader::Destroy(reader);
+        return success;
+    }
+
+    bool checkMediaDataDeduplication(const std::string& fileName)
+    {
+        // Frames fed in order, where the third and fourth are duplicates of the first two.
+        const std::vector<std::uint8_t> frames[] = {makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, 0),
+                                                    makeFrame(COLLECTION_ITEM_SIZE, COLLECTION_ITEM_SIZE, true, 1)};
+        const std::uint32_t feedOrder[]          = {0, 1, 0, 1};
+
+        // Writes the frames to the file or to memory, and checks the duplicates found and the items read back.
+        auto check = [&](const bool toFile, const std::uint64_t memoryLimit, const std::uint64_t expectedDuplicates) {
+            MemoryOutputStream memory;
+            OutputConfig outputConfig{};
+            outputConfig.fileName                 = fileName.c_str();
+            outputConfig.outputStream             = toFile ? nullptr : &memory;
+            outputConfig.progressiveFile          = false;
+            outputConfig.deduplicationMemoryLimit = memoryLimit;
+            outputConfig.majorBrand               = "mif1";
+            outputConfig.compatibleBrands         = Array<FourCC>{"mif1"};
+
+            Writer* writer = Writer::Create();
+            DecoderConfigId decoderConfigId;
+            std::vector<ImageId> imageIds(sizeof(feedOrder) / sizeof(feedOrder[0]));
+            bool success = writer->initialize(outputConfig) == ErrorCode::OK &&
+                           feedDecoderConfig(*writer, decoderConfigId);
+            for (std::size_t i = 0; success && i < imageIds.size(); ++i)
+            {
+                MediaDataId mediaDataId;
+                success = feedFrame(*writer, decoderConfigId, frames[feedOrder[i]], mediaDataId) &&
+                          writer->addImage(mediaDataId, imageIds[i]) == ErrorCode::OK;
+            }
+            MediaDataStatistics statistics;
+            success = success && writer->setPrimaryItem(imageIds[0]) == ErrorCode::OK &&
+                      writer->getMediaDataStatistics(statistics) == ErrorCode::OK &&
+                      statistics.deduplicatedCount == expectedDuplicates && writer->finalize() == ErrorCode::OK;
+            Writer::Destroy(writer);
+
+            const std::vector<char> data = toFile ? readFile(fileName) : memory.getData();
+            LatencyStream stream(data, 0);
+            Reader* reader = Reader::Create();
+            success        = success && reader->initialize(&stream) == ErrorCode::OK;
+            for (std::size_t i = 0; success && i < imageIds.size(); ++i)
+            {
+                const std::vector<std::uint8_t>& expected = frames[feedOrder[i]];
+                std::vector<std::uint8_t> itemData(expected.size());
+                std::uint64_t size = itemData.size();
+                success = reader->getItemData(imageIds[i], itemData.data(), size, false) == ErrorCode::OK &&
+                          itemData == expected;
+            }
+            Reader::Destroy(reader);
+            return success;
+        };
+
+        // A file written by the writer is read back, an output stream needs copies kept in memory. With room for one
+        // copy only the first frame is kept, so only its duplicate is found.
+        const bool success = check(true, 0, 2) && check(false, 0, 0) && check(false, 1 << 20, 2) &&
+                             check(false, COLLECTION_ITEM_SIZE, 1);
+        std::remove(fileName.c_str());
+        return success;
+    }
+
+    bool checkFragmentedRoundTrip(const std::string& fileName)
+    {
+        OutputConfig outputConfig{};
+        outputConfig.fileName            = fileName.c_str();
+        outputConfig.fragmentedFile      = true;
+        outputConfig.fragmentSampleCount = 4;
+        outputConfig.majorBrand          = "iso6";
+        outputConfig.compatibleBrands    = Array<FourCC>{"iso6", "mp42"};
+
+        // Without samples only 'ftyp' and 'moov' are written, and the track is read back empty.
+        Writer* writer = Writer::Create();
+        DecoderConfigId decoderConfigId;
+        SequenceId sequenceId;
+        bool success = writer->initialize(outputConfig) == ErrorCode::OK &&
+                       feedDecoderConfig(*writer, decoderConfigId) &&
+                       writer->addVideoTrack(Rational{1, 90000}, sequenceId) == ErrorCode::OK &&
+                       writer->finalize() == ErrorCode::OK;
+        Writer::Destroy(writer);
+
+        Reader* reader = Reader::Create();
+        Array<TrackInformation> tracks;
+        success = success && reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                  reader->getTrackInformations(tracks) == ErrorCode::OK && tracks.size == 1 &&
+                  tracks[0].sampleProperties.size == 0;
+        Reader::Destroy(reader);
+
+        // A dense track, a sparse track with a sample in every seventh step, and a track which gets no samples.
+        // Fragments must be written while the last track is still empty.
+        const std::uint32_t steps = 20;
+        std::vector<std::vector<std::uint8_t>> frames[3];
+        std::vector<bool> syncSamples[3];
+        MemoryOutputStream memory;
+        outputConfig.outputStream = &memory;
+        writer                    = Writer::Create();
+        SequenceId sequenceIds[3];
+        success = success && writer->initialize(outputConfig) == ErrorCode::OK &&
+                  feedDecoderConfig(*writer, decoderConfigId);
+        for (auto& id : sequenceIds)
+        {
+            success = success && writer->addVideoTrack(Rational{1, 90000}, id) == ErrorCode::OK;
+        }
+        for (std::uint32_t i = 0; success && i < steps; ++i)
+        {
+            for (std::uint32_t track = 0; success && track < 2; ++track)
+            {
+                if (track == 1 && i % 7 != 0)
+                {
+                    continue;
+                }
+                SampleInfo sampleInfo{};
+                sampleInfo.duration     = 3000;
+                sampleInfo.isSyncSample = track == 1 || i % 3 == 0;
+                const std::uint32_t frameSize = COLLECTION_ITEM_SIZE + 16 * i + track;
+                frames[track].push_back(makeFrame(frameSize, frameSize, sampleInfo.isSyncSample, i + track * steps));
+                syncSamples[track].push_back(sampleInfo.isSyncSample);
+
+                MediaDataId mediaDataId;
+                SequenceImageId sampleId;
+                success = feedFrame(*writer, decoderConfigId, frames[track].back(), mediaDataId) &&
+                          writer->addVideo(sequenceIds[track], mediaDataId, sampleInfo, sampleId) == ErrorCode::OK;
+            }
+        }
+        success = success && !memory.getData().empty() && writer->finalize() == ErrorCode::OK;
+        Writer::Destroy(writer);
+
+        // Sample sizes, data and sync flags read back must match the fed samples.
+        LatencyStream stream(memory.getData(), 0);
+        reader  = Reader::Create();
+        success = success && reader->initialize(&stream) == ErrorCode::OK &&
+                  reader->getTrackInformations(tracks) == ErrorCode::OK && tracks.size == 3;
+        for (std::uint32_t track = 0; success && track < 3; ++track)
+        {
+            const Array<SampleInformation>& samples = tracks[track].sampleProperties;
+            success = samples.size == frames[track].size();
+            for (std::size_t i = 0; success && i < samples.size; ++i)
+            {
+                const std::vector<std::uint8_t>& expected = frames[track][i];
+                const SampleFlags& flags                  = samples[i].sampleFlags;
+                const bool isSync                         = syncSamples[track][i];
+                std::vector<std::uint8_t> data(expected.size());
+                std::uint64_t size = data.size();
+                success = samples[i].size == expected.size() && flags.flags.sample_is_non_sync_sample == !isSync &&
+                          flags.flags.sample_depends_on == (isSync ? 2u : 1u) &&
+                          reader->getItemData(tracks[track].trackId, samples[i].sampleId, data.data(), size, false) ==
+                              ErrorCode::OK &&
+                          data == expected;
+            }
+        }
+        Reader::Destroy(reader);
+        return success;
+    }
+
+    const char* fileTypeName(const FileType type)
+    {
+        switch (type)
+        {
+        case FileType::GRID:
+            return "grid";
+        case FileType::COLLECTION:
+            return "collection";
+        case FileType::SEQUENCE:
+            return "sequence";
+        case FileType::FRAGMENTED:
+            return "fragmented";
+        case FileType::LARGE_NALS:
+            return "large_nals";
+        }
+        return "unknown";
+    }
+
+    bool generateFile(const FileType type,
+                      const GeneratorConfig& config,
+                      const std::string& fileName,
+                      Timer* finalizeTimer,
+                      GeneratedContent* content)
+    {
+        const bool isTrackFile = (type == FileType::SEQUENCE) || (type == FileType::FRAGMENTED);
+
+        OutputConfig outputConfig{};
+        outputConfig.fileName        = fileName.c_str();
+        outputConfig.progressiveFile = true;
+        if (type == FileType::FRAGMENTED)
+        {
+            outputConfig.fragmentedFile      = true;
+            outputConfig.fragmentSampleCount = FRAGMENT_SAMPLES;
+            outputConfig.majorBrand          = "iso6";
+            outputConfig.compatibleBrands    = Array<FourCC>{"iso6", "mp42"};
+        }
+        else if (isTrackFile)
+        {
+            outputConfig.majorBrand       = "msf1";
+            outputConfig.compatibleBrands = Array<FourCC>{"msf1", "iso8"};
+        }
+        else
+        {
+            outputConfig.majorBrand       = "mif1";
+            outputConfig.compatibleBrands = Array<FourCC>{"mif1"};
+        }
+
+        Writer* writer = Writer::Create();
+        bool success   = writer->initialize(outputConfig) == ErrorCode::OK;
+        if (success)
+        {
+            switch (type)
+            {
+            case FileType::GRID:
+                success = writeGrid(*writer, config);
+                break;
+            case FileType::COLLECTION:
+                success = writeCollection(*writer, config, content);
+                break;
+            case FileType::SEQUENCE:
+                success = writeSequence(*writer, config, content);
+                break;
+            case FileType::FRAGMENTED:
+                success = writeFragmented(*writer, config);
+                break;
+            case FileType::LARGE_NALS:
+                success = writeLargeNals(*writer, config);
+                break;
+            }
+        }
+
+        if (success)
+        {
+            if (finalizeTimer)
+            {
+                finalizeTimer->start();
+            }
+            success = writer->finalize() == ErrorCode::OK;
+            if (finalizeTimer)
+            {
+                finalizeTimer->stop();
+            }
+        }
+        Writer::Destroy(writer);
+        return success;
+    }
+
+    bool checkGeneratedContent(const std::string& fileName, const GeneratedContent& content)
+    {
+        Reader* reader = Reader::Create();
+        FileInformation fileInformation;
+        bool success = reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                       reader->getFileInformation(fileInformation) == ErrorCode::OK;
+
+        const auto& items = fileInformation.rootMetaBoxInformation.itemInformations;
+        success           = success && items.size == content.items.size();
+        for (std::size_t i = 0; success && i < items.size; ++i)
+        {
+            const GeneratedContent::Item& expected = content.items[i];
+            std::vector<std::uint8_t> data(expected.data.size());
+            std::uint64_t size = data.size();
+            success = items[i].itemId.get() == expected.itemId && items[i].type == expected.type.c_str() &&
+                      reader->getItemData(items[i].itemId, data.data(), size, false) == ErrorCode::OK &&
+                      data == expected.data;
+        }
+
+        const auto& tracks = fileInformation.trackInformation;
+        success            = success && tracks.size == (content.samples.empty() ? 0u : 1u);
+        for (std::size_t i = 0; success && i < content.samples.size(); ++i)
+        {
+            const Array<SampleInformation>& samples   = tracks[0].sampleProperties;
+            const std::vector<std::uint8_t>& expected = content.samples[i];
+            std::vector<std::uint8_t> data(expected.size());
+            std::uint64_t size = data.size();
+            success = samples.size == content.samples.size() &&
+                      reader->getItemData(tracks[0].trackId, samples[i].sampleId, data.data(), size, false) ==
+                          ErrorCode::OK &&
+                      data == expected;
+        }
+        Reader::Destroy(reader);
+        return success;
+    }
+}  // namespace HeifBench
@@ -0,0 +1,110 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef BENCHGENERATOR_HPP
+#define BENCHGENERATOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HeifBench
+{
+    class Timer;
+
+    /** Kinds of synthetic files used by the benchmarks */
+    enum class FileType
+    {
+        GRID,        ///< A grid image item made of many coded tiles
+        COLLECTION,  ///< A large collection of image items with properties
+        SEQUENCE,    ///< A long image sequence track
+        FRAGMENTED,  ///< A fragmented file with a long video track
+        LARGE_NALS   ///< HEVC image items with large multi-NAL frames, for byte stream conversion
+    };
+
+    /** Sizes of the generated files. Same sizes and seed always produce identical files. */
+    struct GeneratorConfig
+    {
+        std::uint32_t gridColumns     = 32;       ///< Grid is gridColumns * gridColumns tiles
+        std::uint32_t collectionItems = 10000;    ///< Number of image items in the collection
+        std::uint32_t sequenceSamples = 10000;    ///< Number of samples in the image sequence and the fragmented file
+        std::uint32_t sampleSize      = 4096;     ///< Coded size of a sample of the image sequence and fragmented file
+        std::uint32_t sequenceItems   = 0;        ///< Number of image items written along with the image sequence
+        std::uint32_t largeNalImages  = 8;        ///< Number of images with large frames
+        std::uint32_t largeNalSize    = 4 << 20;  ///< Size of each large frame in bytes
+        std::uint32_t seed            = 0;        ///< Added to the seed of each frame, to vary content of same sizes
+    };
+
+    /** Image items and samples fed to the Writer by generateFile(), in the order they were added. */
+    struct GeneratedContent
+    {
+        struct Item
+        {
+            std::uint32_t itemId;            ///< ImageId returned by the Writer
+            std::string type;                ///< Expected item type
+            std::vector<std::uint8_t> data;  ///< Fed media data
+        };
+        std::vector<Item> items;
+        std::vector<std::vector<std::uint8_t>> samples;  ///< Fed media data of the samples of the only track
+    };
+
+    /** @return Name of the file type, used in benchmark names and file names. */
+    const char* fileTypeName(FileType type);
+
+    /** Write a synthetic file with the Writer API. Media data is not decodable, but it is a valid length prefixed AVC
+     * bitstream with deterministic content, and all metadata is valid.
+     * @param [in] type Kind of file to generate.
+     * @param [in] config Sizes of the file.
+     * @param [in] fileName Name of the output file.
+     * @param [in] finalizeTimer If not null, running only during Writer::finalize().
+     * @param [out] content If not null, gets the items and samples of COLLECTION and SEQUENCE files.
+     * @return False if the Writer reported an error. */
+    bool generateFile(FileType type,
+                      const GeneratorConfig& config,
+                      const std::string& fileName,
+                      Timer* finalizeTimer,
+                      GeneratedContent* content = nullptr);
+
+    /** Read a generated file back and compare its item ids, item types, item data and sample data with content.
+     * @param [in] fileName Name of the generated file.
+     * @param [in] content Items and samples given by generateFile().
+     * @return False if the file could not be read, or it has other items or samples than content. */
+    bool checkGeneratedContent(const std::string& fileName, const GeneratedContent& content);
+
+    /** Write a short fragmented file, checking that the Writer rejects adding items, and adding tracks after the
+     * 'moov' box has been written, with NOT_APPLICABLE.
+     * @param [in] fileName Name of the output file.
+     * @return False if a call did not return the expected result. */
+    bool checkFragmentedWriterRestrictions(const std::string& fileName);
+
+    /** Write fragmented files, one without samples and one with a dense, a sparse and an empty track, and check that
+     * the Reader gets the same sample count, sizes, data and sync flags back. Fragments must be written before the
+     * empty track gets samples.
+     * @param [in] fileName Name of the output file.
+     * @return False if a file could not be written or read, or the samples read back differ from the fed ones. */
+    bool checkFragmentedRoundTrip(const std::string& fileName);
+
+    /** Write an image sequence with 4 GiB of media data, so that the chunk offset of its last sample does not fit 32
+     * bits only once the size of the boxes before the media data is added, and check the samples read back from it.
+     * @param [in] fileName Name of the output file.
+     * @return False if the file could not be written, or the samples read back differ from the fed ones. */
+    bool checkLargeChunkOffsets(const std::string& fileName);
+
+    /** Write files with duplicate frames directly to the output, both to a file which the writer reads back and to an
+     * output stream with different limits for copies kept in memory, and check the duplicates found and the items.
+     * @param [in] fileName Name of the output file.
+     * @return False if the duplicates found or the items read back are not as expected. */
+    bool checkMediaDataDeduplication(const std::string& fileName);
+}  // namespace HeifBench
+
+#endif /* BENCHGENERATOR_HPP */
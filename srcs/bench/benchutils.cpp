@@ -0,0 +1,200 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "benchutils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace HeifBench
+{
+    CountingAllocator::CountingAllocator()
+        : mAllocations(0)
+        , mAllocatedBytes(0)
+    {
+    }
+
+    void* CountingAllocator::allocate(const size_t n, const size_t size)
+    {
+        ++mAllocations;
+        mAllocatedBytes += n * size;
+        return std::malloc(n * size);
+    }
+
+    void CountingAllocator::deallocate(void* ptr)
+    {
+        std::free(ptr);
+    }
+
+    std::uint64_t CountingAllocator::getAllocations() const
+    {
+        return mAllocations;
+    }
+
+    std::uint64_t CountingAllocator::getAllocatedBytes() const
+    {
+        return mAllocatedBytes;
+    }
+
+    CountingAllocator& CountingAllocator::instance()
+    {
+        static CountingAllocator allocator;
+        return allocator;
+    }
+
+    Timer::Timer()
+        : mStartTime()
+        , mElapsed(0)
+        , mStartAllocations(0)
+        , mStartAllocatedBytes(0)
+        , mAllocations(0)
+        , mAllocatedBytes(0)
+    {
+    }
+
+    void Timer::start()
+    {
+        mStartAllocations    = CountingAllocator::instance().getAllocations();
+        mStartAllocatedBytes = CountingAllocator::instance().getAllocatedBytes();
+        mStartTime           = std::chrono::steady_clock::now();
+    }
+
+    void Timer::stop()
+    {
+        mElapsed += std::chrono::steady_clock::now() - mStartTime;
+        mAllocations += CountingAllocator::instance().getAllocations() - mStartAllocations;
+        mAllocatedBytes += CountingAllocator::instance().getAllocatedBytes() - mStartAllocatedBytes;
+    }
+
+    double Timer::getElapsedMs() const
+    {
+        return std::chrono::duration<double, std::milli>(mElapsed).count();
+    }
+
+    std::uint64_t Timer::getAllocations() const
+    {
+        return mAllocations;
+    }
+
+    std::uint64_t Timer::getAllocatedBytes() const
+    {
+        return mAllocatedBytes;
+    }
+
+    LatencyStream::LatencyStream(const std::vector<char>& data,
+                                 const std::uint32_t latencyUs,
+                                 const bool positionalReads)
+        : mData(data)
+        , mLatencyUs(latencyUs)
+        , mPositionalReads(positionalReads)
+        , mPosition(0)
+        , mReadCalls(0)
+        , mSeekCalls(0)
+    {
+    }
+
+    HEIF::StreamInterface::offset_t LatencyStream::read(char* buffer, const offset_t size_)
+    {
+        const offset_t count = copy(mPosition, buffer, size_);
+        mPosition += count;
+        return count;
+    }
+
+    bool LatencyStream::absoluteSeek(const offset_t offset)
+    {
+        ++mSeekCalls;
+        if (offset < 0 || offset > size())
+        {
+            return false;
+        }
+        mPosition = offset;
+        return true;
+    }
+
+    HEIF::StreamInterface::offset_t LatencyStream::tell()
+    {
+        return mPosition;
+    }
+
+    HEIF::StreamInterface::offset_t LatencyStream::size()
+    {
+        return static_cast<offset_t>(mData.size());
+    }
+
+    HEIF::StreamInterface::offset_t LatencyStream::readAt(const offset_t offset, char* buffer, const offset_t size_)
+    {
+        if (!mPositionalReads)
+        {
+            return -1;
+        }
+        return copy(offset, buffer, size_);
+    }
+
+    std::uint64_t LatencyStream::getReadCalls() const
+    {
+        return mReadCalls;
+    }
+
+    std::uint64_t LatencyStream::getSeekCalls() const
+    {
+        return mSeekCalls;
+    }
+
+    HEIF::StreamInterface::offset_t LatencyStream::copy(const offset_t offset, char* buffer, const offset_t size_)
+    {
+        ++mReadCalls;
+        wait();
+        if (offset < 0 || offset >= size())
+        {
+            return 0;
+        }
+        const offset_t count = std::min(size_, size() - offset);
+        std::memcpy(buffer, mData.data() + offset, static_cast<size_t>(count));
+        return count;
+    }
+
+    void LatencyStream::wait() const
+    {
+        // Busy wait, as sleeping has a far coarser resolution than typical storage or network latencies.
+        const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(mLatencyUs);
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    }
+
+    std::vector<char> readFile(const std::string& fileName)
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    bool writeFile(const std::string& fileName, const std::vector<char>& data)
+    {
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    std::uint64_t fileSize(const std::string& fileName)
+    {
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (!file.good())
+        {
+            return 0;
+        }
+        return static_cast<std::uint64_t>(file.tellg());
+    }
+}  // namespace HeifBench
@@ -0,0 +1,124 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef BENCHUTILS_HPP
+#define BENCHUTILS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "heifallocator.h"
+#include "heifstreaminterface.h"
+
+namespace HeifBench
+{
+    /** Allocator which counts allocations made by the library. Set with Reader::SetCustomAllocator() before the
+     * library is used for the first time. */
+    class CountingAllocator : public HEIF::CustomAllocator
+    {
+    public:
+        CountingAllocator();
+        ~CountingAllocator() override = default;
+
+        void* allocate(size_t n, size_t size) override;
+        void deallocate(void* ptr) override;
+
+        /// @return Number of allocations made so far.
+        std::uint64_t getAllocations() const;
+
+        /// @return Number of bytes allocated so far.
+        std::uint64_t getAllocatedBytes() const;
+
+        /// @return The allocator instance of the benchmark process.
+        static CountingAllocator& instance();
+
+    private:
+        std::atomic<std::uint64_t> mAllocations;
+        std::atomic<std::uint64_t> mAllocatedBytes;
+    };
+
+    /** Accumulates time and library allocations between start() and stop() calls. */
+    class Timer
+    {
+    public:
+        Timer();
+
+        void start();
+        void stop();
+
+        /// @return Accumulated time in milliseconds.
+        double getElapsedMs() const;
+
+        /// @return Number of allocations made while the timer was running.
+        std::uint64_t getAllocations() const;
+
+        /// @return Number of bytes allocated while the timer was running.
+        std::uint64_t getAllocatedBytes() const;
+
+    private:
+        std::chrono::steady_clock::time_point mStartTime;
+        std::chrono::steady_clock::duration mElapsed;
+        std::uint64_t mStartAllocations;
+        std::uint64_t mStartAllocatedBytes;
+        std::uint64_t mAllocations;
+        std::uint64_t mAllocatedBytes;
+    };
+
+    /** Input stream reading from memory, which adds a fixed latency to each read call, like a network stream would.
+     * Counts read, readAt and seek calls. data() is not provided, so the reader accesses the stream only through
+     * read calls. Without positional reads, readAt() is not supported either, and all reads share the position. */
+    class LatencyStream : public HEIF::StreamInterface
+    {
+    public:
+        /** @param [in] data Contents of the stream.
+         *  @param [in] latencyUs Latency of each read call in microseconds.
+         *  @param [in] positionalReads False if readAt() reports that positional reads are not supported. */
+        LatencyStream(const std::vector<char>& data, std::uint32_t latencyUs, bool positionalReads = true);
+        ~LatencyStream() override = default;
+
+        offset_t read(char* buffer, offset_t size) override;
+        bool absoluteSeek(offset_t offset) override;
+        offset_t tell() override;
+        offset_t size() override;
+        offset_t readAt(offset_t offset, char* buffer, offset_t size) override;
+
+        std::uint64_t getReadCalls() const;
+        std::uint64_t getSeekCalls() const;
+
+    private:
+        offset_t copy(offset_t offset, char* buffer, offset_t size);
+        void wait() const;
+
+        const std::vector<char>& mData;
+        const std::uint32_t mLatencyUs;
+        const bool mPositionalReads;
+        offset_t mPosition;
+        std::atomic<std::uint64_t> mReadCalls;
+        std::atomic<std::uint64_t> mSeekCalls;
+    };
+
+    /** @return Contents of a file, or an empty vector if it could not be read. */
+    std::vector<char> readFile(const std::string& fileName);
+
+    /** Writes a file, replacing its contents.
+     *  @return True if the whole file was written. */
+    bool writeFile(const std::string& fileName, const std::vector<char>& data);
+
+    /** @return Size of a file in bytes, or 0 if it does not exist. */
+    std::uint64_t fileSize(const std::string& fileName);
+}  // namespace HeifBench
+
+#endif /* BENCHUTILS_HPP */
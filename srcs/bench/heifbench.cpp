@@ -0,0 +1,1258 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+/** Benchmarks of the reader, writer and HEIFPP APIs on synthetic files.
+ *
+ *  Usage: heif_bench [-o output.json] [-d work directory] [-n iterations] [-f name filter] [--quick]
+ *
+ *  Input files are generated with the Writer API into the work directory, so the results do not depend on external
+ *  content. Each benchmark is run the given number of times, and the results are written as JSON, to the output file
+ *  or to standard output. Allocation counts cover allocations made by the library through its allocator. */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ExifItem.h"
+#include "Heif.h"
+#include "ImageItem.h"
+#include "TransformativeProperty.h"
+#include "benchgenerator.hpp"
+#include "benchutils.hpp"
+#include "buildinfo.hpp"
+#include "heifreader.h"
+
+using namespace HEIF;
+using namespace HeifBench;
+
+namespace
+{
+    struct Options
+    {
+        std::string outputFile;
+        std::string workDirectory = ".";
+        std::string filter;
+        unsigned int iterations = 5;
+        bool quick              = false;
+    };
+
+    typedef std::map<std::string, std::uint64_t> Counters;
+
+    /** Measurements of one benchmark over all iterations */
+    struct Result
+    {
+        std::string name;
+        bool success = true;
+        std::vector<double> timesMs;       ///< Measured time of each iteration
+        std::uint64_t bytes          = 0;  ///< Bytes processed per iteration
+        std::uint64_t allocations    = 0;  ///< Allocations per iteration
+        std::uint64_t allocatedBytes = 0;  ///< Allocated bytes per iteration
+        Counters counters;                 ///< Benchmark specific counters of the last iteration
+    };
+
+    /** A benchmark iteration. Runs the timer around the measured code, sets the number of processed bytes and
+     * counters, and returns false on failure. */
+    typedef std::function<bool(Timer& timer, std::uint64_t& bytes, Counters& counters)> Body;
+
+    class Suite
+    {
+    public:
+        explicit Suite(const Options& options)
+            : mOptions(options)
+        {
+        }
+
+        bool isEnabled(const std::string& name) const
+        {
+            return mOptions.filter.empty() || name.find(mOptions.filter) != std::string::npos;
+        }
+
+        void run(const std::string& name, const Body& body)
+        {
+            if (!isEnabled(name))
+            {
+                return;
+            }
+
+            Result result;
+            result.name = name;
+            for (unsigned int i = 0; i < mOptions.iterations && result.success; ++i)
+            {
+                Timer timer;
+                result.bytes = 0;
+                result.counters.clear();
+                result.success = body(timer, result.bytes, result.counters);
+                result.timesMs.push_back(timer.getElapsedMs());
+                result.allocations    = timer.getAllocations();
+                result.allocatedBytes = timer.getAllocatedBytes();
+            }
+
+            std::fprintf(stderr, "%-56s %s %10.3f ms\n", name.c_str(), result.success ? "ok    " : "FAILED",
+                         median(result.timesMs));
+            mResults.push_back(result);
+        }
+
+        bool writeJson(std::FILE* output) const
+        {
+            std::fprintf(output, "{\n");
+            std::fprintf(output, "  \"library_version\": \"%s\",\n", BuildInfo::Version);
+            std::fprintf(output, "  \"iterations\": %u,\n", mOptions.iterations);
+            std::fprintf(output, "  \"quick\": %s,\n", mOptions.quick ? "true" : "false");
+            std::fprintf(output, "  \"benchmarks\": [");
+            bool success = true;
+            for (std::size_t i = 0; i < mResults.size(); ++i)
+            {
+                const Result& result  = mResults[i];
+                const double medianMs = median(result.timesMs);
+                std::fprintf(output, "%s\n    {\n", i ? "," : "");
+                std::fprintf(output, "      \"name\": \"%s\",\n", result.name.c_str());
+                std::fprintf(output, "      \"success\": %s,\n", result.success ? "true" : "false");
+                std::fprintf(output, "      \"min_ms\": %.4f,\n",
+                             *std::min_element(result.timesMs.begin(), result.timesMs.end()));
+                std::fprintf(output, "      \"median_ms\": %.4f,\n", medianMs);
+                std::fprintf(output, "      \"max_ms\": %.4f,\n",
+                             *std::max_element(result.timesMs.begin(), result.timesMs.end()));
+                std::fprintf(output, "      \"bytes\": %llu,\n", static_cast<unsigned long long>(result.bytes));
+                std::fprintf(output, "      \"mb_per_s\": %.2f,\n",
+                             medianMs > 0.0 ? static_cast<double>(result.bytes) / 1000.0 / medianMs : 0.0);
+                std::fprintf(output, "      \"allocations\": %llu,\n",
+                             static_cast<unsigned long long>(result.allocations));
+                std::fprintf(output, "      \"allocated_bytes\": %llu",
+                             static_cast<unsigned long long>(result.allocatedBytes));
+                for (const auto& counter : result.counters)
+                {
+                    std::fprintf(output, ",\n      \"%s\": %llu", counter.first.c_str(),
+                                 static_cast<unsigned long long>(counter.second));
+                }
+                std::fprintf(output, "\n    }");
+                success = success && result.success;
+            }
+            std::fprintf(output, "\n  ]\n}\n");
+            return success;
+        }
+
+    private:
+        static double median(std::vector<double> values)
+        {
+            if (values.empty())
+            {
+                return 0.0;
+            }
+            std::sort(values.begin(), values.end());
+            return values[values.size() / 2];
+        }
+
+        const Options& mOptions;
+        std::vector<Result> mResults;
+    };
+
+    /** Read an image item, growing the buffer when needed. */
+    bool readItem(Reader& reader,
+                  const ImageId& imageId,
+                  std::vector<std::uint8_t>& buffer,
+                  std::uint64_t& size,
+                  const bool bytestreamHeaders)
+    {
+        size            = buffer.size();
+        ErrorCode error = reader.getItemData(imageId, buffer.data(), size, bytestreamHeaders);
+        if (error == ErrorCode::BUFFER_SIZE_TOO_SMALL)
+        {
+            buffer.resize(static_cast<std::size_t>(size));
+            error = reader.getItemData(imageId, buffer.data(), size, bytestreamHeaders);
+        }
+        return error == ErrorCode::OK;
+    }
+
+    /** Read a track sample, growing the buffer when needed. */
+    bool readSample(Reader& reader,
+                    const SequenceId& sequenceId,
+                    const SequenceImageId& sampleId,
+                    std::vector<std::uint8_t>& buffer,
+                    std::uint64_t& size)
+    {
+        size            = buffer.size();
+        ErrorCode error = reader.getItemData(sequenceId, sampleId, buffer.data(), size, false);
+        if (error == ErrorCode::BUFFER_SIZE_TOO_SMALL)
+        {
+            buffer.resize(static_cast<std::size_t>(size));
+            error = reader.getItemData(sequenceId, sampleId, buffer.data(), size, false);
+        }
+        return error == ErrorCode::OK;
+    }
+
+    /** @return Data of the first count items, and of the first count samples of each track, or nothing if reading
+     *  any of them failed. */
+    std::vector<std::vector<std::uint8_t>> readFirstData(Reader& reader, const std::size_t count)
+    {
+        std::vector<std::vector<std::uint8_t>> data;
+        FileInformation fileInformation;
+        if (reader.getFileInformation(fileInformation) != ErrorCode::OK)
+        {
+            return {};
+        }
+        std::vector<std::uint8_t> buffer(65536);
+        std::uint64_t size = 0;
+        const auto& items  = fileInformation.rootMetaBoxInformation.itemInformations;
+        for (std::size_t i = 0; i < std::min(count, items.size); ++i)
+        {
+            if (!readItem(reader, items[i].itemId, buffer, size, false))
+            {
+                return {};
+            }
+            data.emplace_back(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(size));
+        }
+        for (const auto& track : fileInformation.trackInformation)
+        {
+            for (std::size_t i = 0; i < std::min(count, track.sampleProperties.size); ++i)
+            {
+                if (!readSample(reader, track.trackId, track.sampleProperties[i].sampleId, buffer, size))
+                {
+                    return {};
+                }
+                data.emplace_back(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(size));
+            }
+        }
+        return data;
+    }
+
+    /** Check that a generated file opens and has the item or sample count given by config. */
+    bool checkGeneratedFile(const FileType type, const GeneratorConfig& config, const std::string& fileName)
+    {
+        Reader* reader = Reader::Create();
+        FileInformation fileInformation;
+        bool success = reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                       reader->getFileInformation(fileInformation) == ErrorCode::OK;
+        if (success && type == FileType::COLLECTION)
+        {
+            success = fileInformation.rootMetaBoxInformation.itemInformations.size == config.collectionItems;
+        }
+        else if (success && type == FileType::SEQUENCE)
+        {
+            success = fileInformation.trackInformation.size == 1 &&
+                      fileInformation.trackInformation[0].sampleProperties.size == config.sequenceSamples;
+        }
+        Reader::Destroy(reader);
+        return success;
+    }
+
+    /** @return True if opening the file with the index cache restores it from the cache instead of parsing it. This
+     *  is seen from the statistics, so it is assumed when the library is built without them. */
+    bool isIndexCacheUsed(const std::string& fileName, const Array<std::uint8_t>& indexCache, const std::uint64_t key)
+    {
+        ReaderConfig readerConfig;
+        readerConfig.indexCache        = indexCache.elements;
+        readerConfig.indexCacheSize    = indexCache.size;
+        readerConfig.indexCacheKey     = key;
+        readerConfig.collectStatistics = true;
+        Reader* reader                 = Reader::Create();
+        ReaderStatistics statistics;
+        bool used                       = reader->initialize(fileName.c_str(), readerConfig) == ErrorCode::OK;
+        const ErrorCode statisticsError = used ? reader->getStatistics(statistics) : ErrorCode::OK;
+        used                            = used && (statisticsError == ErrorCode::OK ||
+                                                   statisticsError == ErrorCode::NOT_APPLICABLE);
+        if (used && statisticsError == ErrorCode::OK)
+        {
+            used = false;
+            for (const auto& phase : statistics.phases)
+            {
+                used = used || std::strcmp(phase.name, "load index cache") == 0;
+            }
+        }
+        Reader::Destroy(reader);
+        return used;
+    }
+
+    /** @return True if both readers give the same decoder parameter sets, or the same error. */
+    template <typename... Ids>
+    bool hasSameParameterSets(const Reader& parsed, const Reader& cached, const Ids&... ids)
+    {
+        DecoderConfiguration parsedConfig;
+        DecoderConfiguration cachedConfig;
+        const ErrorCode error = parsed.getDecoderParameterSets(ids..., parsedConfig);
+        if (cached.getDecoderParameterSets(ids..., cachedConfig) != error)
+        {
+            return false;
+        }
+        if (error != ErrorCode::OK)
+        {
+            return true;
+        }
+        bool same = parsedConfig.decoderConfigId == cachedConfig.decoderConfigId &&
+                    parsedConfig.decoderSpecificInfo.size == cachedConfig.decoderSpecificInfo.size;
+        for (std::size_t i = 0; same && i < parsedConfig.decoderSpecificInfo.size; ++i)
+        {
+            const DecoderSpecificInfo& parsedInfo = parsedConfig.decoderSpecificInfo[i];
+            const DecoderSpecificInfo& cachedInfo = cachedConfig.decoderSpecificInfo[i];
+            same = parsedInfo.decSpecInfoType == cachedInfo.decSpecInfoType &&
+                   parsedInfo.decSpecInfoData.size == cachedInfo.decSpecInfoData.size &&
+                   std::equal(parsedInfo.decSpecInfoData.begin(), parsedInfo.decSpecInfoData.end(),
+                              cachedInfo.decSpecInfoData.begin());
+        }
+        return same;
+    }
+
+    /** @return True if a reader restored from the index cache gives the same item and track information, timestamps,
+     *  decoder parameter sets, and data of the first item and of the first sample of each track, as a reader which
+     *  parses the file. */
+    bool isIndexCacheEquivalent(const std::string& fileName,
+                                const Array<std::uint8_t>& indexCache,
+                                const std::uint64_t key)
+    {
+        ReaderConfig readerConfig;
+        readerConfig.indexCache     = indexCache.elements;
+        readerConfig.indexCacheSize = indexCache.size;
+        readerConfig.indexCacheKey  = key;
+        Reader* parsed              = Reader::Create();
+        Reader* cached              = Reader::Create();
+        FileInformation parsedInformation;
+        FileInformation cachedInformation;
+        bool same = parsed->initialize(fileName.c_str()) == ErrorCode::OK &&
+                    cached->initialize(fileName.c_str(), readerConfig) == ErrorCode::OK &&
+                    parsed->getFileInformation(parsedInformation) == ErrorCode::OK &&
+                    cached->getFileInformation(cachedInformation) == ErrorCode::OK &&
+                    parsedInformation.features == cachedInformation.features &&
+                    parsedInformation.movieTimescale == cachedInformation.movieTimescale;
+
+        std::vector<std::uint8_t> parsedData(4096);
+        std::vector<std::uint8_t> cachedData(4096);
+        std::uint64_t parsedSize = 0;
+        std::uint64_t cachedSize = 0;
+
+        auto isSameData = [&]() {
+            return parsedSize == cachedSize &&
+                   std::memcmp(parsedData.data(), cachedData.data(), static_cast<std::size_t>(parsedSize)) == 0;
+        };
+
+        const auto& parsedItems = parsedInformation.rootMetaBoxInformation.itemInformations;
+        const auto& cachedItems = cachedInformation.rootMetaBoxInformation.itemInformations;
+        same                    = same && parsedItems.size == cachedItems.size;
+        for (std::size_t i = 0; same && i < parsedItems.size; ++i)
+        {
+            same = parsedItems[i].itemId == cachedItems[i].itemId && parsedItems[i].type == cachedItems[i].type &&
+                   parsedItems[i].features == cachedItems[i].features && parsedItems[i].size == cachedItems[i].size &&
+                   hasSameParameterSets(*parsed, *cached, parsedItems[i].itemId);
+        }
+        const auto itemWithData = std::find_if(parsedItems.begin(), parsedItems.end(),
+                                               [](const ItemInformation& item) { return item.size > 0; });
+        if (same && itemWithData != parsedItems.end())
+        {
+            same = readItem(*parsed, itemWithData->itemId, parsedData, parsedSize, false) &&
+                   readItem(*cached, itemWithData->itemId, cachedData, cachedSize, false) && isSameData();
+        }
+
+        const auto& parsedTracks = parsedInformation.trackInformation;
+        const auto& cachedTracks = cachedInformation.trackInformation;
+        same                     = same && parsedTracks.size == cachedTracks.size;
+        for (std::size_t i = 0; same && i < parsedTracks.size; ++i)
+        {
+            const SequenceId trackId  = parsedTracks[i].trackId;
+            const auto& parsedSamples = parsedTracks[i].sampleProperties;
+            const auto& cachedSamples = cachedTracks[i].sampleProperties;
+            same = trackId == cachedTracks[i].trackId && parsedTracks[i].features == cachedTracks[i].features &&
+                   parsedTracks[i].timeScale == cachedTracks[i].timeScale &&
+                   parsedSamples.size == cachedSamples.size;
+            for (std::size_t j = 0; same && j < parsedSamples.size; ++j)
+            {
+                const SampleInformation& parsedSample = parsedSamples[j];
+                const SampleInformation& cachedSample = cachedSamples[j];
+                same = parsedSample.sampleId == cachedSample.sampleId &&
+                       parsedSample.sampleEntryType == cachedSample.sampleEntryType &&
+                       parsedSample.sampleDescriptionIndex == cachedSample.sampleDescriptionIndex &&
+                       parsedSample.sampleType == cachedSample.sampleType &&
+                       parsedSample.sampleDurationTS == cachedSample.sampleDurationTS &&
+                       parsedSample.sampleCompositionOffsetTs == cachedSample.sampleCompositionOffsetTs &&
+                       parsedSample.hasClap == cachedSample.hasClap && parsedSample.hasAuxi == cachedSample.hasAuxi &&
+                       parsedSample.size == cachedSample.size &&
+                       hasSameParameterSets(*parsed, *cached, trackId, parsedSample.sampleId);
+            }
+
+            Array<TimestampIDPair> parsedTimestamps;
+            Array<TimestampIDPair> cachedTimestamps;
+            same = same && parsed->getItemTimestamps(trackId, parsedTimestamps) == ErrorCode::OK &&
+                   cached->getItemTimestamps(trackId, cachedTimestamps) == ErrorCode::OK &&
+                   parsedTimestamps.size == cachedTimestamps.size;
+            for (std::size_t j = 0; same && j < parsedTimestamps.size; ++j)
+            {
+                same = parsedTimestamps[j].timeStamp == cachedTimestamps[j].timeStamp &&
+                       parsedTimestamps[j].itemId == cachedTimestamps[j].itemId;
+            }
+
+            if (same && parsedSamples.size > 0)
+            {
+                same = readSample(*parsed, trackId, parsedSamples[0].sampleId, parsedData, parsedSize) &&
+                       readSample(*cached, trackId, parsedSamples[0].sampleId, cachedData, cachedSize) && isSameData();
+            }
+        }
+        Reader::Destroy(cached);
+        Reader::Destroy(parsed);
+        return same;
+    }
+
+    void addWriterBenchmarks(Suite& suite,
+                             const Options& options,
+                             const GeneratorConfig& config,
+                             const std::map<FileType, std::string>& files)
+    {
+        for (const auto& file : files)
+        {
+            const FileType type         = file.first;
+            const std::string& fileName = file.second;
+            suite.run(std::string("writer_finalize_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                          const bool success = generateFile(type, config, fileName, &timer);
+                          bytes              = fileSize(fileName);
+                          return success;
+                      });
+        }
+
+        // Finalizing a long track is dominated by serializing its sample tables, so the samples are kept small.
+        GeneratorConfig longTrackConfig = config;
+        longTrackConfig.sequenceSamples = options.quick ? 10000 : 100000;
+        longTrackConfig.sampleSize      = 64;
+        const std::string longTrackFile = options.workDirectory + "/bench_sequence_long.heic";
+        suite.run("writer_finalize_sequence_" + std::to_string(longTrackConfig.sequenceSamples),
+                  [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                      const bool success  = generateFile(FileType::SEQUENCE, longTrackConfig, longTrackFile, &timer);
+                      bytes               = fileSize(longTrackFile);
+                      counters["samples"] = longTrackConfig.sequenceSamples;
+                      return success;
+                  });
+        std::remove(longTrackFile.c_str());
+
+        const std::string restrictionsFile = options.workDirectory + "/bench_fragmented_restrictions.mp4";
+        suite.run("writer_fragmented_restrictions", [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+            timer.start();
+            const bool success = checkFragmentedWriterRestrictions(restrictionsFile);
+            timer.stop();
+            bytes = fileSize(restrictionsFile);
+            return success;
+        });
+        std::remove(restrictionsFile.c_str());
+
+        const std::string roundTripFile = options.workDirectory + "/bench_fragmented_round_trip.mp4";
+        suite.run("writer_fragmented_round_trip", [&](Timer& timer, std::uint64_t&, Counters&) {
+            timer.start();
+            const bool success = checkFragmentedRoundTrip(roundTripFile);
+            timer.stop();
+            return success;
+        });
+        std::remove(roundTripFile.c_str());
+
+        const std::string deduplicationFile = options.workDirectory + "/bench_deduplication.heic";
+        suite.run("writer_deduplicate_written_media_data", [&](Timer& timer, std::uint64_t&, Counters&) {
+            timer.start();
+            const bool success = checkMediaDataDeduplication(deduplicationFile);
+            timer.stop();
+            return success;
+        });
+
+        // Writes and reads back 4 GiB, so it is left out of quick runs.
+        if (!options.quick)
+        {
+            const std::string largeOffsetsFile = options.workDirectory + "/bench_large_chunk_offsets.heic";
+            suite.run("writer_finalize_large_chunk_offsets", [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                timer.start();
+                const bool success = checkLargeChunkOffsets(largeOffsetsFile);
+                timer.stop();
+                bytes = fileSize(largeOffsetsFile);
+                return success;
+            });
+            std::remove(largeOffsetsFile.c_str());
+        }
+
+        // Writers running in parallel threads must not share state, so each file is checked after all are written.
+        GeneratorConfig concurrentConfig = config;
+        concurrentConfig.collectionItems = 200;
+        concurrentConfig.sequenceSamples = 200;
+        const unsigned int threadCount   = 4;
+        const unsigned int fileCount     = options.quick ? 16 : 64;
+        suite.run("writer_concurrent_" + std::to_string(fileCount) + "_files_" + std::to_string(threadCount) +
+                      "_threads",
+                  [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                      std::vector<std::string> fileNames;
+                      for (unsigned int i = 0; i < fileCount; ++i)
+                      {
+                          fileNames.push_back(options.workDirectory + "/bench_concurrent_" + std::to_string(i) +
+                                              ".heic");
+                      }
+                      auto fileType = [](const unsigned int index) {
+                          return index % 2 ? FileType::SEQUENCE : FileType::COLLECTION;
+                      };
+
+                      // Each file gets different content, so that data mixed up between writers is detected.
+                      std::vector<char> written(fileCount, false);
+                      std::vector<GeneratedContent> contents(fileCount);
+                      std::vector<std::thread> threads;
+                      timer.start();
+                      for (unsigned int t = 0; t < threadCount; ++t)
+                      {
+                          threads.emplace_back([&, t]() {
+                              GeneratorConfig fileConfig = concurrentConfig;
+                              for (unsigned int i = t; i < fileCount; i += threadCount)
+                              {
+                                  fileConfig.seed = i * 1000;
+                                  written[i]      = generateFile(fileType(i), fileConfig, fileNames[i], nullptr,
+                                                                 &contents[i]);
+                              }
+                          });
+                      }
+                      for (auto& thread : threads)
+                      {
+                          thread.join();
+                      }
+                      timer.stop();
+
+                      bool success = true;
+                      for (unsigned int i = 0; i < fileCount; ++i)
+                      {
+                          success = success && written[i] &&
+                                    checkGeneratedFile(fileType(i), concurrentConfig, fileNames[i]) &&
+                                    checkGeneratedContent(fileNames[i], contents[i]);
+                          bytes += fileSize(fileNames[i]);
+                          std::remove(fileNames[i].c_str());
+                      }
+                      counters["files"]   = fileCount;
+                      counters["threads"] = threadCount;
+                      return success;
+                  });
+    }
+
+    void addInitializeBenchmarks(Suite& suite,
+                                 const Options& options,
+                                 const GeneratorConfig& config,
+                                 const std::map<FileType, std::string>& files)
+    {
+        for (const auto& file : files)
+        {
+            const std::string& fileName = file.second;
+            suite.run(std::string("reader_initialize_") + fileTypeName(file.first),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                          Reader* reader = Reader::Create();
+                          timer.start();
+                          const bool success = reader->initialize(fileName.c_str()) == ErrorCode::OK;
+                          timer.stop();
+                          Reader::Destroy(reader);
+                          bytes = fileSize(fileName);
+                          return success;
+                      });
+        }
+
+        // Compared with the cases above, the cost of collecting statistics. The cost of the disabled hooks is the
+        // difference of the cases above to a build with HEIF_DISABLE_STATISTICS.
+        for (const auto& file : files)
+        {
+            const std::string& fileName = file.second;
+            suite.run(std::string("reader_initialize_") + fileTypeName(file.first) + "_statistics",
+                      [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                          ReaderConfig readerConfig;
+                          readerConfig.collectStatistics = true;
+                          Reader* reader                 = Reader::Create();
+                          timer.start();
+                          const bool success = reader->initialize(fileName.c_str(), readerConfig) == ErrorCode::OK;
+                          timer.stop();
+                          Reader::Destroy(reader);
+                          bytes = fileSize(fileName);
+                          return success;
+                      });
+        }
+
+        // An index cache made by an earlier reader replaces parsing the file.
+        for (const auto& file : files)
+        {
+            const std::string& fileName = file.second;
+            Array<std::uint8_t> indexCache;
+            Reader* cacheReader = Reader::Create();
+            const bool hasCache = cacheReader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                                  cacheReader->getIndexCache(1, indexCache) == ErrorCode::OK;
+            Reader::Destroy(cacheReader);
+            if (!hasCache)
+            {
+                continue;
+            }
+            const bool cacheUsed = isIndexCacheUsed(fileName, indexCache, 1) &&
+                                   isIndexCacheEquivalent(fileName, indexCache, 1);
+            suite.run(std::string("reader_initialize_cached_") + fileTypeName(file.first),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                          ReaderConfig readerConfig;
+                          readerConfig.indexCache     = indexCache.elements;
+                          readerConfig.indexCacheSize = indexCache.size;
+                          readerConfig.indexCacheKey  = 1;
+                          Reader* reader              = Reader::Create();
+                          timer.start();
+                          const bool success = reader->initialize(fileName.c_str(), readerConfig) == ErrorCode::OK;
+                          timer.stop();
+                          Reader::Destroy(reader);
+                          bytes                         = fileSize(fileName);
+                          counters["index_cache_bytes"] = indexCache.size;
+                          return success && cacheUsed;
+                      });
+        }
+
+        const std::string& sequenceFile = files.at(FileType::SEQUENCE);
+        suite.run("reader_initialize_sequence_lazy", [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+            ReaderConfig readerConfig;
+            readerConfig.lazyTrackParsing = true;
+            Reader* reader                = Reader::Create();
+            timer.start();
+            const bool success = reader->initialize(sequenceFile.c_str(), readerConfig) == ErrorCode::OK;
+            timer.stop();
+            Reader::Destroy(reader);
+            bytes = fileSize(sequenceFile);
+            return success;
+        });
+
+        // The 'moov' box skipped by lazy parsing is parsed by the first track accessor, while other threads read
+        // items. Without positional reads all of them share the position of the stream.
+        GeneratorConfig lazyConfig     = config;
+        lazyConfig.sequenceSamples     = 200;
+        lazyConfig.sequenceItems       = 64;
+        const std::string lazyFile     = options.workDirectory + "/bench_sequence_items.heic";
+        const bool lazyFileWritten     = generateFile(FileType::SEQUENCE, lazyConfig, lazyFile, nullptr);
+        const std::vector<char> lazy   = readFile(lazyFile);
+        const unsigned int lazyThreads = 4;
+        std::remove(lazyFile.c_str());
+        suite.run("reader_lazy_concurrent_" + std::to_string(lazyThreads) + "_threads",
+                  [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                      // Item data as read by a reader which parsed the whole file during initialize().
+                      std::map<std::uint32_t, std::vector<std::uint8_t>> expected;
+                      LatencyStream plainStream(lazy, 0);
+                      Reader* plainReader = Reader::Create();
+                      Array<ImageId> imageIds;
+                      bool success = lazyFileWritten && plainReader->initialize(&plainStream) == ErrorCode::OK &&
+                                     plainReader->getItemListByType("avc1", imageIds) == ErrorCode::OK &&
+                                     imageIds.size == lazyConfig.sequenceItems;
+                      for (std::size_t i = 0; success && i < imageIds.size; ++i)
+                      {
+                          std::vector<std::uint8_t>& data = expected[imageIds[i].get()];
+                          data.resize(65536);
+                          std::uint64_t size = data.size();
+                          success = plainReader->getItemData(imageIds[i], data.data(), size, false) == ErrorCode::OK;
+                          data.resize(static_cast<std::size_t>(size));
+                      }
+                      Reader::Destroy(plainReader);
+
+                      const unsigned int rounds = 20;
+                      timer.start();
+                      for (unsigned int round = 0; success && round < rounds; ++round)
+                      {
+                          LatencyStream stream(lazy, 100, false);
+                          ReaderConfig readerConfig;
+                          readerConfig.lazyTrackParsing = true;
+                          readerConfig.readAheadSize    = 0;
+                          Reader* reader                = Reader::Create();
+                          success = reader->initialize(&stream, readerConfig) == ErrorCode::OK;
+
+                          std::vector<char> threadSuccess(lazyThreads, false);
+                          std::vector<std::thread> threads;
+                          for (unsigned int t = 0; success && t < lazyThreads; ++t)
+                          {
+                              threads.emplace_back([&, t]() {
+                                  bool ok = true;
+                                  std::vector<std::uint8_t> buffer(65536);
+                                  std::size_t index = 0;
+                                  for (const auto& item : expected)
+                                  {
+                                      // The first thread parses the tracks while the others are reading items.
+                                      if (t == 0 && index++ == expected.size() / 2)
+                                      {
+                                          Array<TrackInformation> tracks;
+                                          ok = ok && reader->getTrackInformations(tracks) == ErrorCode::OK &&
+                                               tracks.size == 1 &&
+                                               tracks[0].sampleProperties.size == lazyConfig.sequenceSamples;
+                                      }
+                                      std::uint64_t size = buffer.size();
+                                      ok = ok && reader->getItemData(item.first, buffer.data(), size, false) ==
+                                                     ErrorCode::OK &&
+                                           size == item.second.size() &&
+                                           std::equal(item.second.begin(), item.second.end(), buffer.begin());
+                                  }
+                                  threadSuccess[t] = ok;
+                              });
+                          }
+                          for (auto& thread : threads)
+                          {
+                              thread.join();
+                          }
+                          success = success && std::find(threadSuccess.begin(), threadSuccess.end(), false) ==
+                                                   threadSuccess.end();
+                          Reader::Destroy(reader);
+                      }
+                      timer.stop();
+                      bytes               = lazy.size() * rounds;
+                      counters["rounds"]  = rounds;
+                      counters["threads"] = lazyThreads;
+                      return success;
+                  });
+
+        // Opening a fragmented file walks many small boxes, and a collection has many small item properties, which is
+        // slow on streams with a high per-read latency. Read-ahead must cut the reads without changing the data read.
+        const FileType latencyTypes[] = {FileType::FRAGMENTED, FileType::COLLECTION};
+        for (const FileType type : latencyTypes)
+        {
+            // Reads and data without read-ahead, which is off by default, from a stream without latency.
+            const std::vector<char> data = readFile(files.at(type));
+            LatencyStream plainStream(data, 0);
+            Reader* plainReader    = Reader::Create();
+            const bool plainOpened = plainReader->initialize(&plainStream) == ErrorCode::OK;
+            const auto plainReads  = plainStream.getReadCalls();
+            std::vector<std::vector<std::uint8_t>> plainData;
+            if (plainOpened)
+            {
+                plainData = readFirstData(*plainReader, 16);
+            }
+            Reader::Destroy(plainReader);
+
+            for (const std::uint32_t readAheadSize : {0u, 65536u})
+            {
+                suite.run(std::string("reader_initialize_") + fileTypeName(type) + "_latency_readahead_" +
+                              std::to_string(readAheadSize),
+                          [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                              LatencyStream stream(data, 50);
+                              ReaderConfig readerConfig;
+                              readerConfig.readAheadSize = readAheadSize;
+                              Reader* reader             = Reader::Create();
+                              timer.start();
+                              bool success = reader->initialize(&stream, readerConfig) == ErrorCode::OK;
+                              timer.stop();
+                              const std::uint64_t reads = stream.getReadCalls();
+                              bytes                     = data.size();
+                              counters["stream_reads"]  = reads;
+                              counters["stream_seeks"]  = stream.getSeekCalls();
+
+                              success = success && !plainData.empty() && readFirstData(*reader, 16) == plainData &&
+                                        (readAheadSize == 0 || reads < plainReads);
+                              Reader::Destroy(reader);
+                              return success;
+                          });
+            }
+        }
+    }
+
+    void addItemDataBenchmarks(Suite& suite, const std::map<FileType, std::string>& files)
+    {
+        // Large HEVC frames read with byte stream headers measure the length prefix to start code conversion.
+        const FileType types[]       = {FileType::GRID, FileType::COLLECTION, FileType::LARGE_NALS};
+        const bool bytestreamHeaders = true;
+        for (const FileType type : types)
+        {
+            const std::string& fileName = files.at(type);
+            suite.run(std::string("reader_item_data_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                          Reader* reader = Reader::Create();
+                          Array<ImageId> imageIds;
+                          const char* itemType = type == FileType::LARGE_NALS ? "hvc1" : "avc1";
+                          bool success         = reader->initialize(fileName.c_str()) == ErrorCode::OK;
+                          success = success && reader->getItemListByType(itemType, imageIds) == ErrorCode::OK;
+                          std::vector<std::uint8_t> buffer(65536);
+                          timer.start();
+                          for (std::size_t i = 0; i < imageIds.size && success; ++i)
+                          {
+                              std::uint64_t size;
+                              success = readItem(*reader, imageIds[i], buffer, size, bytestreamHeaders);
+                              bytes += size;
+                          }
+                          timer.stop();
+                          Reader::Destroy(reader);
+                          counters["items"] = imageIds.size;
+                          return success && imageIds.size != 0;
+                      });
+        }
+
+        // Grid tiles share one decoder configuration, whose parameter sets are either copied in front of each tile or
+        // returned as a view.
+        const std::string& gridFile = files.at(FileType::GRID);
+        for (const bool view : {false, true})
+        {
+            suite.run(std::string("reader_item_data_with_decoder_parameters_") + (view ? "view_" : "copy_") +
+                          fileTypeName(FileType::GRID),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                          Reader* reader = Reader::Create();
+                          Array<ImageId> imageIds;
+                          bool success = reader->initialize(gridFile.c_str()) == ErrorCode::OK &&
+                                         reader->getItemListByType("avc1", imageIds) == ErrorCode::OK;
+                          std::vector<std::uint8_t> buffer(1024 * 1024);
+                          timer.start();
+                          for (std::size_t i = 0; i < imageIds.size && success; ++i)
+                          {
+                              std::uint64_t size = buffer.size();
+                              DataView decoderParameters;
+                              if (view)
+                              {
+                                  success = reader->getItemDataWithDecoderParameters(
+                                                imageIds[i], decoderParameters, buffer.data(), size) == ErrorCode::OK;
+                                  bytes += decoderParameters.size;
+                              }
+                              else
+                              {
+                                  success = reader->getItemDataWithDecoderParameters(imageIds[i], buffer.data(),
+                                                                                     size) == ErrorCode::OK;
+                              }
+                              bytes += size;
+                          }
+                          timer.stop();
+                          Reader::Destroy(reader);
+                          counters["items"] = imageIds.size;
+                          return success;
+                      });
+        }
+
+        // Views into a memory mapped file give the tiles without copying. Without the mapping there is nothing to view.
+        suite.run(std::string("reader_item_data_views_") + fileTypeName(FileType::GRID),
+                  [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                      ReaderConfig readerConfig;
+                      readerConfig.memoryMapFile = true;
+                      Reader* reader             = Reader::Create();
+                      Reader* unmappedReader     = Reader::Create();
+                      Array<ImageId> imageIds;
+                      Array<DataView> extents;
+                      bool success = reader->initialize(gridFile.c_str(), readerConfig) == ErrorCode::OK &&
+                                     reader->getItemListByType("avc1", imageIds) == ErrorCode::OK &&
+                                     unmappedReader->initialize(gridFile.c_str()) == ErrorCode::OK &&
+                                     imageIds.size != 0;
+                      success = success && unmappedReader->getItemDataViews(imageIds[0], extents) ==
+                                               ErrorCode::NOT_APPLICABLE;
+                      timer.start();
+                      for (std::size_t i = 0; i < imageIds.size && success; ++i)
+                      {
+                          success = reader->getItemDataViews(imageIds[i], extents) == ErrorCode::OK;
+                          for (const auto& extent : extents)
+                          {
+                              bytes += extent.size;
+                          }
+                      }
+                      timer.stop();
+                      Reader::Destroy(unmappedReader);
+                      Reader::Destroy(reader);
+                      counters["items"] = imageIds.size;
+                      return success;
+                  });
+    }
+
+    void addTrackBenchmarks(Suite& suite, const std::map<FileType, std::string>& files)
+    {
+        for (const FileType type : {FileType::SEQUENCE, FileType::FRAGMENTED})
+        {
+            const std::string& fileName = files.at(type);
+            suite.run(std::string("reader_sample_iteration_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                          Reader* reader = Reader::Create();
+                          Array<TrackInformation> tracks;
+                          bool success = reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                                         reader->getTrackInformations(tracks) == ErrorCode::OK && tracks.size > 0;
+                          std::vector<std::uint8_t> buffer(65536);
+                          timer.start();
+                          for (std::size_t i = 0; success && i < tracks[0].sampleProperties.size; ++i)
+                          {
+                              std::uint64_t size;
+                              success = readSample(*reader, tracks[0].trackId,
+                                                   tracks[0].sampleProperties[i].sampleId, buffer, size);
+                              bytes += size;
+                          }
+                          timer.stop();
+                          counters["samples"] = success ? tracks[0].sampleProperties.size : 0;
+                          Reader::Destroy(reader);
+                          return success;
+                      });
+
+            suite.run(std::string("reader_sample_reader_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters& counters) {
+                          Reader* reader = Reader::Create();
+                          Array<TrackInformation> tracks;
+                          SampleReader* sampleReader = nullptr;
+                          SampleReaderConfig config;
+                          config.bytestreamHeaders = false;
+                          bool success = reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                                         reader->getTrackInformations(tracks) == ErrorCode::OK && tracks.size > 0;
+                          timer.start();
+                          success = success && reader->createSampleReader(tracks[0].trackId, config, sampleReader) ==
+                                                   ErrorCode::OK;
+                          std::uint64_t samples = 0;
+                          SampleData sample;
+                          ErrorCode error = ErrorCode::OK;
+                          while (success && (error = sampleReader->nextSample(sample)) == ErrorCode::OK)
+                          {
+                              bytes += sample.size;
+                              ++samples;
+                          }
+                          timer.stop();
+                          success             = success && error == ErrorCode::NOT_APPLICABLE;
+                          counters["samples"] = success ? samples : 0;
+                          SampleReader::Destroy(sampleReader);
+                          Reader::Destroy(reader);
+                          return success;
+                      });
+
+            suite.run(std::string("reader_timestamps_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t&, Counters& counters) {
+                          Reader* reader = Reader::Create();
+                          Array<TrackInformation> tracks;
+                          Array<TimestampIDPair> timestamps;
+                          bool success = reader->initialize(fileName.c_str()) == ErrorCode::OK &&
+                                         reader->getTrackInformations(tracks) == ErrorCode::OK && tracks.size > 0;
+                          timer.start();
+                          success = success &&
+                                    reader->getItemTimestamps(tracks[0].trackId, timestamps) == ErrorCode::OK;
+                          timer.stop();
+                          counters["timestamps"] = timestamps.size;
+                          Reader::Destroy(reader);
+                          return success;
+                      });
+        }
+    }
+
+    /** @return Count and byte sum of the readable image data and samples of a file, to compare files regardless of
+     *  the ids and order of their items. Zeros if the file can not be opened. */
+    std::pair<std::uint64_t, std::uint64_t> contentChecksum(const std::string& fileName)
+    {
+        std::pair<std::uint64_t, std::uint64_t> checksum(0, 0);
+        std::vector<std::uint8_t> buffer;
+        auto add = [&](const ErrorCode error, const std::uint64_t size) {
+            if (error == ErrorCode::OK)
+            {
+                ++checksum.first;
+                for (std::uint64_t i = 0; i < size; ++i)
+                {
+                    checksum.second += buffer[i];
+                }
+            }
+        };
+
+        Reader* reader = Reader::Create();
+        FileInformation fileInformation;
+        if ((reader->initialize(fileName.c_str()) == ErrorCode::OK) &&
+            (reader->getFileInformation(fileInformation) == ErrorCode::OK))
+        {
+            for (const auto& item : fileInformation.rootMetaBoxInformation.itemInformations)
+            {
+                std::uint64_t size = item.size;
+                buffer.resize(size);
+                add(reader->getItemData(item.itemId, buffer.data(), size), size);
+            }
+            for (const auto& track : fileInformation.trackInformation)
+            {
+                for (const auto& sample : track.sampleProperties)
+                {
+                    std::uint64_t size = sample.size;
+                    buffer.resize(size);
+                    add(reader->getItemData(track.trackId, sample.sampleId, buffer.data(), size), size);
+                }
+            }
+        }
+        Reader::Destroy(reader);
+        return checksum;
+    }
+
+    /** @return The first Exif item of the primary image, or nullptr if there is none. */
+    HEIFPP::ExifItem* findPrimaryExif(HEIFPP::Heif& heif)
+    {
+        HEIFPP::ImageItem* primary = heif.getPrimaryItem();
+        for (std::uint32_t i = 0; (primary != nullptr) && (i < primary->getMetadataCount()); ++i)
+        {
+            HEIFPP::MetaItem* metadata = primary->getMetadata(i);
+            if (metadata->isExifItem())
+            {
+                return static_cast<HEIFPP::ExifItem*>(metadata);
+            }
+        }
+        return nullptr;
+    }
+
+    /** @return The rotation of the primary image, or nullptr if there is none. */
+    HEIFPP::RotateProperty* findPrimaryRotation(HEIFPP::Heif& heif)
+    {
+        HEIFPP::ImageItem* primary = heif.getPrimaryItem();
+        for (std::uint32_t i = 0; (primary != nullptr) && (i < primary->transformativePropertyCount()); ++i)
+        {
+            HEIFPP::TransformativeProperty* property = primary->getTransformativeProperty(i);
+            if (property->getType() == ItemPropertyType::IROT)
+            {
+                return static_cast<HEIFPP::RotateProperty*>(property);
+            }
+        }
+        return nullptr;
+    }
+
+    /** Saves a copy of a file, with an Exif item and a rotation added to its primary image. */
+    bool createUpdateInput(const std::string& sourceFileName, const std::string& fileName)
+    {
+        HEIFPP::Heif heif;
+        if ((heif.load(sourceFileName.c_str()) != HEIFPP::Result::OK) || (heif.getPrimaryItem() == nullptr))
+        {
+            return false;
+        }
+        const std::vector<std::uint8_t> exifData(1024, 0x11);
+        auto* exif = new HEIFPP::ExifItem(&heif);
+        exif->setData(exifData.data(), exifData.size());
+        heif.getPrimaryItem()->addMetadata(exif);
+        auto* rotation          = new HEIFPP::RotateProperty(&heif);
+        rotation->mRotate.angle = 90;
+        heif.getPrimaryItem()->addProperty(rotation, true);
+        return heif.save(fileName.c_str()) == HEIFPP::Result::OK;
+    }
+
+    /** Checks a file updated with Heif::updateMetadata(): it opens, the edited Exif data and rotation of the primary
+     *  image read back, the bytes of the original file outside its 'meta' box are unchanged, and the 'meta' box is
+     *  in its original space or moved after the original end of the file. */
+    bool checkUpdatedFile(const std::string& fileName,
+                          const std::vector<char>& original,
+                          const MetaBoxLocation& originalMeta,
+                          const std::vector<std::uint8_t>& exifData,
+                          const std::uint32_t angle,
+                          const bool inPlace)
+    {
+        const std::vector<char> updated = readFile(fileName);
+        const auto metaBegin            = static_cast<std::ptrdiff_t>(originalMeta.offset);
+        const auto metaEnd              = static_cast<std::ptrdiff_t>(originalMeta.offset + originalMeta.space);
+        if ((updated.size() < original.size()) ||
+            !std::equal(original.begin(), original.begin() + metaBegin, updated.begin()) ||
+            !std::equal(original.begin() + metaEnd, original.end(), updated.begin() + metaEnd))
+        {
+            return false;
+        }
+
+        Reader* reader               = Reader::Create();
+        MetaBoxLocation metaLocation = {};
+        bool success                 = reader->initialize(fileName.c_str()) == ErrorCode::OK;
+        success                      = success && (reader->getMetaBoxLocation(metaLocation) == ErrorCode::OK);
+        Reader::Destroy(reader);
+        success = success && (inPlace ? (metaLocation.offset == originalMeta.offset)
+                                      : (metaLocation.offset >= static_cast<std::uint64_t>(original.size())));
+
+        HEIFPP::Heif heif;
+        success                          = success && (heif.load(fileName.c_str()) == HEIFPP::Result::OK);
+        HEIFPP::ExifItem* exif           = success ? findPrimaryExif(heif) : nullptr;
+        HEIFPP::RotateProperty* rotation = success ? findPrimaryRotation(heif) : nullptr;
+        const std::uint8_t* data         = (exif != nullptr) ? exif->getData() : nullptr;
+        return (data != nullptr) && (rotation != nullptr) && (exif->getDataSize() == exifData.size()) &&
+               std::equal(exifData.begin(), exifData.end(), data) && (rotation->mRotate.angle == angle);
+    }
+
+    void addHeifppBenchmarks(Suite& suite, const Options& options, const std::map<FileType, std::string>& files)
+    {
+        for (const FileType type : {FileType::GRID, FileType::COLLECTION, FileType::SEQUENCE})
+        {
+            const std::string& fileName = files.at(type);
+            suite.run(std::string("heifpp_load_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                          HEIFPP::Heif heif;
+                          timer.start();
+                          const bool success = heif.load(fileName.c_str()) == HEIFPP::Result::OK;
+                          timer.stop();
+                          bytes = fileSize(fileName);
+                          return success;
+                      });
+
+            const std::string savedFileName =
+                options.workDirectory + "/bench_saved_" + fileTypeName(type) + ".heic";
+            suite.run(std::string("heifpp_save_") + fileTypeName(type),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                          HEIFPP::Heif heif;
+                          bool success = heif.load(fileName.c_str()) == HEIFPP::Result::OK;
+                          timer.start();
+                          success = success && heif.save(savedFileName.c_str()) == HEIFPP::Result::OK;
+                          timer.stop();
+                          bytes = fileSize(savedFileName);
+                          return success;
+                      });
+            std::remove(savedFileName.c_str());
+
+            // Data loaded on demand is read from the loaded file while saving, unless the saved file is the same file
+            // by another name, when it is loaded first.
+            const std::pair<std::uint64_t, std::uint64_t> expected = contentChecksum(fileName);
+            const std::string copyFileName = options.workDirectory + "/bench_copy_" + fileTypeName(type) + ".heic";
+            for (const bool sameFile : {false, true})
+            {
+                const std::string targetFileName = sameFile ? options.workDirectory + "/./bench_copy_" +
+                                                                  fileTypeName(type) + ".heic"
+                                                            : savedFileName;
+                suite.run(std::string("heifpp_save_") + fileTypeName(type) + (sameFile ? "_on_demand_in_place"
+                                                                                         : "_on_demand"),
+                          [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                              HEIFPP::Heif heif;
+                              bool success = writeFile(copyFileName, readFile(fileName)) &&
+                                             (heif.load(copyFileName.c_str(), HEIFPP::Heif::LOAD_ON_DEMAND) ==
+                                              HEIFPP::Result::OK);
+                              timer.start();
+                              success = success && (heif.save(targetFileName.c_str()) == HEIFPP::Result::OK);
+                              timer.stop();
+                              bytes = fileSize(targetFileName);
+                              return success && (expected.first != 0) && (contentChecksum(targetFileName) == expected);
+                          });
+            }
+            std::remove(copyFileName.c_str());
+            std::remove(savedFileName.c_str());
+        }
+
+        // Edits of the same size fit the space of the original 'meta' box, added items make it grow past it.
+        const std::string updateInputFileName = options.workDirectory + "/bench_update_input.heic";
+        const std::string updatedFileName     = options.workDirectory + "/bench_updated.heic";
+        const bool inputCreated               = createUpdateInput(files.at(FileType::COLLECTION), updateInputFileName);
+        const std::vector<char> updateInput   = readFile(updateInputFileName);
+        MetaBoxLocation inputMeta             = {};
+        {
+            Reader* reader = Reader::Create();
+            if ((reader->initialize(updateInputFileName.c_str()) != ErrorCode::OK) ||
+                (reader->getMetaBoxLocation(inputMeta) != ErrorCode::OK))
+            {
+                inputMeta.space = 0;
+            }
+            Reader::Destroy(reader);
+        }
+        for (const bool inPlace : {true, false})
+        {
+            suite.run(std::string("heifpp_update_metadata_") + (inPlace ? "in_place" : "moved"),
+                      [&](Timer& timer, std::uint64_t& bytes, Counters&) {
+                          HEIFPP::Heif heif;
+                          bool success = inputCreated && (inputMeta.space != 0) &&
+                                         writeFile(updatedFileName, updateInput) &&
+                                         (heif.load(updatedFileName.c_str(), HEIFPP::Heif::LOAD_ON_DEMAND) ==
+                                          HEIFPP::Result::OK);
+                          HEIFPP::ExifItem* exif           = success ? findPrimaryExif(heif) : nullptr;
+                          HEIFPP::RotateProperty* rotation = success ? findPrimaryRotation(heif) : nullptr;
+                          const std::vector<std::uint8_t> exifData(inPlace ? 1024 : 64 * 1024, 0x22);
+                          const std::uint32_t angle = 180;
+                          success                   = (exif != nullptr) && (rotation != nullptr);
+                          if (success)
+                          {
+                              exif->setData(exifData.data(), exifData.size());
+                              rotation->mRotate.angle = angle;
+                              for (std::uint32_t i = 0; !inPlace && (i < 64); ++i)
+                              {
+                                  auto* added = new HEIFPP::ExifItem(&heif);
+                                  added->setData(exifData.data(), 16);
+                                  heif.getPrimaryItem()->addMetadata(added);
+                              }
+                          }
+                          timer.start();
+                          success = success && (heif.updateMetadata() == HEIFPP::Result::OK);
+                          timer.stop();
+                          bytes = fileSize(updatedFileName);
+                          return success &&
+                                 checkUpdatedFile(updatedFileName, updateInput, inputMeta, exifData, angle, inPlace);
+                      });
+        }
+        std::remove(updateInputFileName.c_str());
+        std::remove(updatedFileName.c_str());
+    }
+
+    bool parseOptions(const int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const bool hasValue        = i + 1 < argc;
+            if (argument == "-o" && hasValue)
+            {
+                options.outputFile = argv[++i];
+            }
+            else if (argument == "-d" && hasValue)
+            {
+                options.workDirectory = argv[++i];
+            }
+            else if (argument == "-n" && hasValue)
+            {
+                options.iterations = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+            }
+            else if (argument == "-f" && hasValue)
+            {
+                options.filter = argv[++i];
+            }
+            else if (argument == "--quick")
+            {
+                options.quick = true;
+            }
+            else
+            {
+                std::fprintf(stderr,
+                             "Usage: %s [-o output.json] [-d work directory] [-n iterations] [-f name filter] "
+                             "[--quick]\n",
+                             argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    // Must be set before the library allocates anything.
+    if (Reader::SetCustomAllocator(&CountingAllocator::instance()) != ErrorCode::OK)
+    {
+        std::fprintf(stderr, "Failed to set the allocator\n");
+        return 1;
+    }
+
+    GeneratorConfig config;
+    if (options.quick)
+    {
+        config.gridColumns     = 8;
+        config.collectionItems = 500;
+        config.sequenceSamples = 600;
+        config.largeNalImages  = 2;
+        config.largeNalSize    = 1 << 20;
+    }
+
+    std::map<FileType, std::string> files;
+    for (const FileType type : {FileType::GRID, FileType::COLLECTION, FileType::SEQUENCE, FileType::FRAGMENTED,
+                                FileType::LARGE_NALS})
+    {
+        const std::string fileName =
+            options.workDirectory + "/bench_" + fileTypeName(type) + (type == FileType::FRAGMENTED ? ".mp4" : ".heic");
+        if (!generateFile(type, config, fileName, nullptr))
+        {
+            std::fprintf(stderr, "Failed to generate %s\n", fileName.c_str());
+            return 1;
+        }
+        files[type] = fileName;
+    }
+
+    Suite suite(options);
+    addWriterBenchmarks(suite, options, config, files);
+    addInitializeBenchmarks(suite, options, config, files);
+    addItemDataBenchmarks(suite, files);
+    addTrackBenchmarks(suite, files);
+    addHeifppBenchmarks(suite, options, files);
+
+    std::FILE* output = options.outputFile.empty() ? stdout : std::fopen(options.outputFile.c_str(), "w");
+    if (output == nullptr)
+    {
+        std::fprintf(stderr, "Failed to open %s\n", options.outputFile.c_str());
+        return 1;
+    }
+    const bool success = suite.writeJson(output);
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+
+    for (const auto& file : files)
+    {
+        std::remove(file.second.c_str());
+    }
+    return success ? 0 : 1;
+}
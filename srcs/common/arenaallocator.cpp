@@ -0,0 +1,177 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "arenaallocator.hpp"
+
+#include <algorithm>
+
+namespace HEIF
+{
+    ArenaAllocator::ArenaAllocator(CustomAllocator* upstream, const std::size_t blockSize)
+        : mUpstream(upstream)
+        , mBlockSize(blockSize)
+        , mUsedBlocks(nullptr)
+        , mFreeBlocks(nullptr)
+        , mLargeBlocks(nullptr)
+        , mCurrent(nullptr)
+        , mEnd(nullptr)
+    {
+    }
+
+    ArenaAllocator::~ArenaAllocator()
+    {
+        releaseBlocks(mUsedBlocks);
+        releaseBlocks(mFreeBlocks);
+        releaseBlocks(mLargeBlocks);
+    }
+
+    void* ArenaAllocator::allocate(const size_t n, const size_t size)
+    {
+        // Round up so that the next allocation stays maximally aligned.
+        const std::size_t alignment = sizeof(Block);
+        const std::size_t bytes     = (n * size + alignment - 1) / alignment * alignment;
+
+        if (bytes > static_cast<std::size_t>(mEnd - mCurrent))
+        {
+            // Large allocations get a block of their own, so that the rest of the current block is not wasted.
+            if (bytes > getLargeSize())
+            {
+                Block* block = addBlock(mLargeBlocks, bytes);
+                return block ? block + 1 : nullptr;
+            }
+
+            Block* block = mFreeBlocks;
+            if (block)
+            {
+                mFreeBlocks = block->next;
+                block->next = mUsedBlocks;
+                mUsedBlocks = block;
+            }
+            else
+            {
+                block = addBlock(mUsedBlocks, mBlockSize);
+            }
+            mCurrent = block ? reinterpret_cast<char*>(block + 1) : nullptr;
+            mEnd     = block ? mCurrent + mBlockSize : nullptr;
+            if (!block)
+            {
+                return nullptr;
+            }
+        }
+
+        void* memory = mCurrent;
+        mCurrent += bytes;
+        return memory;
+    }
+
+    void ArenaAllocator::deallocate(void* /*ptr*/)
+    {
+        // Memory is released with the whole arena.
+    }
+
+    bool ArenaAllocator::owns(const void* ptr) const
+    {
+        // Memory freed while parsing was mostly allocated recently, from the current block.
+        const char* memory = static_cast<const char*>(ptr);
+        if (mEnd && (memory >= mEnd - mBlockSize) && (memory < mEnd))
+        {
+            return true;
+        }
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        auto range         = std::upper_bound(mRanges.begin(), mRanges.end(), std::make_pair(address, UINTPTR_MAX));
+        return range != mRanges.begin() && address < (--range)->second;
+    }
+
+    void ArenaAllocator::rewind()
+    {
+        while (mUsedBlocks)
+        {
+            Block* block = mUsedBlocks;
+            mUsedBlocks  = block->next;
+            block->next  = mFreeBlocks;
+            mFreeBlocks  = block;
+        }
+        releaseBlocks(mLargeBlocks);
+        mCurrent = nullptr;
+        mEnd     = nullptr;
+    }
+
+    CustomAllocator* ArenaAllocator::getUpstream() const
+    {
+        return mUpstream;
+    }
+
+    std::size_t ArenaAllocator::getBlockSize() const
+    {
+        return mBlockSize;
+    }
+
+    std::size_t ArenaAllocator::getLargeSize() const
+    {
+        return mBlockSize / 4;
+    }
+
+    ArenaAllocator::Block* ArenaAllocator::addBlock(Block*& list, const std::size_t size)
+    {
+        auto* block = static_cast<Block*>(mUpstream->allocate(sizeof(Block) + size, 1));
+        if (block)
+        {
+            const auto first = reinterpret_cast<std::uintptr_t>(block + 1);
+            try
+            {
+                const auto range = std::make_pair(first, first + size);
+                mRanges.insert(std::upper_bound(mRanges.begin(), mRanges.end(), range), range);
+                registerAllocatorRange(this, block + 1, size);
+            }
+            catch (...)
+            {
+                removeRange(block + 1);
+                mUpstream->deallocate(block);
+                return nullptr;
+            }
+            block->next = list;
+            list        = block;
+        }
+        return block;
+    }
+
+    void ArenaAllocator::releaseBlocks(Block*& list)
+    {
+        while (list)
+        {
+            Block* next = list->next;
+            unregisterAllocatorRange(list + 1);
+            removeRange(list + 1);
+            mUpstream->deallocate(list);
+            list = next;
+        }
+    }
+
+    void ArenaAllocator::removeRange(const void* begin)
+    {
+        const auto first = reinterpret_cast<std::uintptr_t>(begin);
+        auto range       = std::lower_bound(mRanges.begin(), mRanges.end(), std::make_pair(first, std::uintptr_t(0)));
+        if (range != mRanges.end() && range->first == first)
+        {
+            mRanges.erase(range);
+        }
+    }
+
+    ArenaScope::ArenaScope(ArenaAllocator* arena, CustomAllocator* allocator)
+        : AllocatorScope(arena ? arena : allocator,
+                         arena ? arena->getUpstream() : nullptr,
+                         arena ? arena->getLargeSize() : 0,
+                         arena)
+    {
+    }
+}  // namespace HEIF
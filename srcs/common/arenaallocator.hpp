@@ -0,0 +1,101 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef ARENAALLOCATOR_HPP
+#define ARENAALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../api/common/heifallocator.h"
+#include "customallocator.hpp"
+
+namespace HEIF
+{
+    /** Monotonic allocator handing out memory from large blocks taken from an upstream allocator. deallocate() does
+     * nothing. All memory is released at once by rewind(), which keeps the blocks for reuse, or by destroying the
+     * arena. Not thread safe. */
+    class ArenaAllocator : public RangeAllocator
+    {
+    public:
+        /**
+         * @param [in] upstream   Allocator of the blocks. Must outlive the arena.
+         * @param [in] blockSize  Size of the blocks in bytes. Larger allocations get a block of their own. */
+        ArenaAllocator(CustomAllocator* upstream, std::size_t blockSize);
+        ~ArenaAllocator() override;
+
+        ArenaAllocator(const ArenaAllocator&) = delete;
+        ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+        void* allocate(size_t n, size_t size) override;
+        void deallocate(void* ptr) override;
+        bool owns(const void* ptr) const override;
+
+        /** Release all memory allocated from the arena. Blocks of blockSize are kept and reused by later allocations,
+         * so that they are not returned to and requested again from the upstream allocator. */
+        void rewind();
+
+        /// @return Allocator of the blocks.
+        CustomAllocator* getUpstream() const;
+
+        /// @return Size of the blocks in bytes.
+        std::size_t getBlockSize() const;
+
+        /// @return Allocations larger than this are better made from the upstream allocator, see ArenaScope.
+        std::size_t getLargeSize() const;
+
+    private:
+        /// Precedes the memory of every block.
+        union Block
+        {
+            Block* next;  ///< Next block in the same list.
+            std::max_align_t alignment;
+        };
+
+        /// Take a block of size bytes from the upstream allocator and push it to list. @return The block, or null.
+        Block* addBlock(Block*& list, std::size_t size);
+
+        /// Return all blocks of list to the upstream allocator.
+        void releaseBlocks(Block*& list);
+
+        /// Remove the block starting at begin from mRanges.
+        void removeRange(const void* begin);
+
+        CustomAllocator* mUpstream;
+        std::size_t mBlockSize;
+        Block* mUsedBlocks;   ///< Blocks of mBlockSize in use, the current one first.
+        Block* mFreeBlocks;   ///< Blocks of mBlockSize kept by rewind().
+        Block* mLargeBlocks;  ///< Blocks of single large allocations.
+        char* mCurrent;       ///< Next free byte of the current block.
+        char* mEnd;           ///< End of the current block.
+
+        /// Memory ranges of all blocks, ordered by their first byte. Uses the standard allocator, not the arena.
+        std::vector<std::pair<std::uintptr_t, std::uintptr_t>> mRanges;
+    };
+
+    /** Makes customAllocate() of the calling thread use an arena until the scope is destroyed. Allocations larger than
+     * ArenaAllocator::getLargeSize() are made from the upstream allocator of the arena instead, so that the buffers of
+     * growing containers are not left behind in the arena. */
+    class ArenaScope : public AllocatorScope
+    {
+    public:
+        /**
+         * @param [in] arena      Arena to use, or null to use allocator instead.
+         * @param [in] allocator  Allocator to use if there is no arena, or null to keep the current allocator. */
+        ArenaScope(ArenaAllocator* arena, CustomAllocator* allocator);
+    };
+}  // namespace HEIF
+
+#endif /* ARENAALLOCATOR_HPP */
@@ -92,8 +92,10 @@ namespace HEIF
     instance(uint32_t);
     instance(uint64_t);
     instance(Array<FourCC>);
+    instance(CallStatistics);
 
 #if HEIF_READER_LIB
+    instance(DataView);
     instance(EntityGrouping);
     instance(FourCCToIds);
     instance(SampleGrouping);
@@ -105,6 +107,7 @@ namespace HEIF
     instance(SampleToMetadataItem);
     instance(DirectReferenceSamples);
     instance(SequenceId);
+    instance(TileData);
     instance(TimestampIDPair);
     instance(TrackInformation);
     instance(EditUnit);
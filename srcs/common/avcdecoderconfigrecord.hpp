@@ -101,7 +101,7 @@ public:
     std::uint8_t getAvcLevelIndication() const;
     void setAvcLevelIndication(std::uint8_t avcLevelIndication);
 
-    std::uint8_t getLengthSizeMinus1() const;
+    std::uint8_t getLengthSizeMinus1() const override;
     void setLengthSizeMinus1(std::uint8_t lengthSizeMinus1);
 
     std::uint8_t getChromaFormat() const;
@@ -16,6 +16,7 @@
 #include <limits>
 
 #include "bitstream.hpp"
+#include "statistics.hpp"
 
 using namespace std;
 
@@ -71,6 +72,10 @@ const Vector<uint8_t>& Box::getUserType() const
 
 void Box::writeBoxHeader(ISOBMFF::BitStream& bitstr) const
 {
+    if (HEIF::ThreadCounters* counters = HEIF::getThreadCounters())
+    {
+        ++counters->boxesWritten;
+    }
     mStartLocation = bitstr.getSize();
 
     // Note that serialized size values will be dummy values until updateSize() is called.
@@ -98,6 +103,18 @@ void Box::writeBoxHeader(ISOBMFF::BitStream& bitstr) const
     }
 }
 
+uint64_t Box::getBoxHeaderSize() const
+{
+    return 8u + (mLargeSize ? 8u : 0u) + (mType == "uuid" ? 16u : 0u);
+}
+
+uint64_t Box::getSerializedSize() const
+{
+    ISOBMFF::BitStream bitstr;
+    writeBox(bitstr);
+    return bitstr.getSize();
+}
+
 void Box::updateSize(ISOBMFF::BitStream& bitstr) const
 {
     mSize = bitstr.getSize() - mStartLocation;
@@ -130,6 +147,10 @@ void Box::updateSize(ISOBMFF::BitStream& bitstr) const
 
 void Box::parseBoxHeader(ISOBMFF::BitStream& bitstr)
 {
+    if (HEIF::ThreadCounters* counters = HEIF::getThreadCounters())
+    {
+        ++counters->boxesParsed;
+    }
     mSize = bitstr.read32Bits();
     mType = bitstr.read32Bits();
 
@@ -61,6 +61,12 @@ public:
      *        structure of the box has been appended to the ISOBMFF::BitStream. */
     virtual void writeBox(ISOBMFF::BitStream& bitstr) const = 0;
 
+    /** @brief Size of the Box as serialized by writeBox().
+     * The default implementation serializes the box to a temporary bitstream. Boxes with large tables or child boxes
+     * override it to compute the size without serializing.
+     * @return Byte size of the serialized Box, 0 if writeBox() writes nothing. */
+    virtual std::uint64_t getSerializedSize() const;
+
     /** @brief Parses the Box bitstream and fills in the Box data structure.
      * This virtual method should be implemented by each class
      * that extends from Box and based on the relevant data structure
@@ -95,6 +101,9 @@ protected:
      *                        is appended. */
     void writeBoxHeader(ISOBMFF::BitStream& bitstr) const;
 
+    /** @return Byte size of the Box header written by writeBoxHeader() */
+    std::uint64_t getBoxHeaderSize() const;
+
     /** @brief Parses the Box header data structure as defined in ISOBMFF standard.
      * @param [in,out] bitstr A ISOBMFF::BitStream object that contains Box data stream. ISOBMFF::BitStream internal
      * pointers are updated accordingly. */
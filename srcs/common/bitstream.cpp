@@ -24,6 +24,8 @@ namespace ISOBMFF
 {
     BitStream::BitStream()
         : mStorage()
+        , mView(nullptr)
+        , mViewSize(0)
         , mCurrByte(0)
         , mByteOffset(0)
         , mBitOffset(0)
@@ -33,6 +35,19 @@ namespace ISOBMFF
 
     BitStream::BitStream(Vector<std::uint8_t> strData)
         : mStorage(std::move(strData))
+        , mView(nullptr)
+        , mViewSize(0)
+        , mCurrByte(0)
+        , mByteOffset(0)
+        , mBitOffset(0)
+        , mStorageAllocated(false)
+    {
+    }
+
+    BitStream::BitStream(const std::uint8_t* data, const std::uint64_t size)
+        : mStorage()
+        , mView(data)
+        , mViewSize(size)
         , mCurrByte(0)
         , mByteOffset(0)
         , mBitOffset(0)
@@ -42,6 +57,8 @@ namespace ISOBMFF
 
     BitStream::BitStream(BitStream&& other) noexcept
         : mStorage(std::move(other.mStorage))
+        , mView(other.mView)
+        , mViewSize(other.mViewSize)
         , mCurrByte(other.mCurrByte)
         , mByteOffset(other.mByteOffset)
         , mBitOffset(other.mBitOffset)
@@ -51,6 +68,8 @@ namespace ISOBMFF
         other.mByteOffset       = {};
         other.mBitOffset        = {};
         other.mStorageAllocated = {};
+        other.mView             = nullptr;
+        other.mViewSize         = 0;
         other.mStorage.clear();
     }
 
@@ -61,6 +80,8 @@ namespace ISOBMFF
         mBitOffset        = other.mBitOffset;
         mStorageAllocated = other.mStorageAllocated;
         mStorage          = std::move(other.mStorage);
+        mView             = other.mView;
+        mViewSize         = other.mViewSize;
         return *this;
     }
 
@@ -89,7 +110,7 @@ namespace ISOBMFF
 
     std::uint64_t BitStream::getSize() const
     {
-        return mStorage.size();
+        return (mView != nullptr) ? mViewSize : mStorage.size();
     }
 
     void BitStream::setSize(const std::uint64_t newSize)
@@ -97,16 +118,48 @@ namespace ISOBMFF
         mStorage.resize(newSize);
     }
 
+    void BitStream::reserve(const std::uint64_t capacity)
+    {
+        mStorage.reserve(static_cast<std::size_t>(capacity));
+    }
+
     const Vector<std::uint8_t>& BitStream::getStorage() const
     {
+        if (mView != nullptr)
+        {
+            throw RuntimeError("BitStream::getStorage called for a view");
+        }
         return mStorage;
     }
 
     Vector<std::uint8_t>& BitStream::getStorage()
     {
+        if (mView != nullptr)
+        {
+            throw RuntimeError("BitStream::getStorage called for a view");
+        }
         return mStorage;
     }
 
+    bool BitStream::isView() const
+    {
+        return mView != nullptr;
+    }
+
+    const std::uint8_t* BitStream::data() const
+    {
+        return (mView != nullptr) ? mView : mStorage.data();
+    }
+
+    void BitStream::checkRead(const std::uint64_t count) const
+    {
+        const std::uint64_t size = getSize();
+        if (count > size || mByteOffset > size - count)
+        {
+            throw RuntimeError("BitStream trying to read outside of data");
+        }
+    }
+
     void BitStream::reset()
     {
         mCurrByte   = 0;
@@ -117,6 +170,8 @@ namespace ISOBMFF
     void BitStream::clear()
     {
         mStorage.clear();
+        mView     = nullptr;
+        mViewSize = 0;
     }
 
     void BitStream::skipBytes(const std::uint64_t count)
@@ -131,21 +186,26 @@ namespace ISOBMFF
 
     std::uint8_t BitStream::getByte(const std::uint64_t offset) const
     {
-        return mStorage.at(offset);
+        if (offset >= getSize())
+        {
+            throw RuntimeError("BitStream::getByte trying to read outside of data");
+        }
+        return data()[offset];
     }
 
     std::uint64_t BitStream::numBytesLeft() const
     {
-        return mStorage.size() - mByteOffset;
+        return getSize() - mByteOffset;
     }
+
     void BitStream::extract(const std::uint64_t begin, const std::uint64_t end, BitStream& dest) const
     {
         dest.clear();
         dest.reset();
-        if (begin <= mStorage.size() && end <= mStorage.size() && begin <= end)
+        if (begin <= getSize() && end <= getSize() && begin <= end)
         {
-            dest.mStorage.insert(dest.mStorage.begin(), mStorage.begin() + static_cast<std::int64_t>(begin),
-                                 mStorage.begin() + static_cast<std::int64_t>(end));
+            dest.mView     = data() + begin;
+            dest.mViewSize = end - begin;
         }
         else
         {
@@ -155,7 +215,7 @@ namespace ISOBMFF
 
     void BitStream::writeBitStream(const BitStream& bitStr)
     {
-        mStorage.insert(mStorage.end(), bitStr.mStorage.begin(), bitStr.mStorage.end());
+        mStorage.insert(mStorage.end(), bitStr.data(), bitStr.data() + bitStr.getSize());
     }
 
 
@@ -281,72 +341,48 @@ namespace ISOBMFF
 
     std::uint8_t BitStream::read8Bits()
     {
-        const std::uint8_t ret = mStorage.at(mByteOffset);
+        checkRead(1);
+        const std::uint8_t ret = data()[mByteOffset];
         ++mByteOffset;
         return ret;
     }
 
     std::uint16_t BitStream::read16Bits()
     {
-        std::uint16_t ret = mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        return ret;
+        checkRead(2);
+        const std::uint8_t* bytes = data() + mByteOffset;
+        mByteOffset += 2;
+        return static_cast<std::uint16_t>((bytes[0] << 8) | bytes[1]);
     }
 
     std::uint32_t BitStream::read24Bits()
     {
-        unsigned int ret = mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        return ret;
+        checkRead(3);
+        const std::uint8_t* bytes = data() + mByteOffset;
+        mByteOffset += 3;
+        return (static_cast<std::uint32_t>(bytes[0]) << 16) | (static_cast<std::uint32_t>(bytes[1]) << 8) | bytes[2];
     }
 
     std::uint32_t BitStream::read32Bits()
     {
-        unsigned int ret = mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        return ret;
+        checkRead(4);
+        const std::uint8_t* bytes = data() + mByteOffset;
+        mByteOffset += 4;
+        return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16) |
+               (static_cast<std::uint32_t>(bytes[2]) << 8) | bytes[3];
     }
 
     std::uint64_t BitStream::read64Bits()
     {
-        unsigned long long int ret = mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-        ret = (ret << 8) | mStorage.at(mByteOffset);
-        mByteOffset++;
-
-        return ret;
+        const std::uint64_t high = read32Bits();
+        return (high << 32) | read32Bits();
     }
 
     void BitStream::read8BitsArray(Vector<std::uint8_t>& bits, const std::uint64_t len)
     {
-        if (static_cast<std::size_t>(mByteOffset + len) <= mStorage.size())
+        if (static_cast<std::size_t>(mByteOffset + len) <= getSize())
         {
-            bits.insert(bits.end(), mStorage.begin() + static_cast<std::int64_t>(mByteOffset),
-                        mStorage.begin() + static_cast<std::int64_t>(mByteOffset + len));
+            bits.insert(bits.end(), data() + mByteOffset, data() + mByteOffset + len);
             mByteOffset += len;
         }
         else
@@ -357,9 +393,9 @@ namespace ISOBMFF
 
     void BitStream::readByteArrayToBuffer(char* buffer, const std::uint64_t len)
     {
-        if (static_cast<std::size_t>(mByteOffset + len) <= mStorage.size())
+        if (static_cast<std::size_t>(mByteOffset + len) <= getSize())
         {
-            std::memcpy(buffer, mStorage.data() + mByteOffset, len);
+            std::memcpy(buffer, data() + mByteOffset, len);
             mByteOffset += len;
         }
         else
@@ -380,28 +416,28 @@ namespace ISOBMFF
 
         if (numBitsLeftInByte >= len)
         {
-            returnBits = static_cast<unsigned int>((mStorage).at(mByteOffset) >> (numBitsLeftInByte - len)) &
+            returnBits = static_cast<unsigned int>(getByte(mByteOffset) >> (numBitsLeftInByte - len)) &
                          static_cast<unsigned int>((1 << len) - 1);
             mBitOffset += static_cast<unsigned int>(len);
         }
         else
         {
             std::uint32_t numBitsToGo = len - numBitsLeftInByte;
-            returnBits = (mStorage).at(mByteOffset) & ((static_cast<unsigned int>(1) << numBitsLeftInByte) - 1);
+            returnBits = getByte(mByteOffset) & ((static_cast<unsigned int>(1) << numBitsLeftInByte) - 1);
             mByteOffset++;
             mBitOffset = 0;
             while (numBitsToGo > 0)
             {
                 if (numBitsToGo >= 8)
                 {
-                    returnBits = (returnBits << 8) | (mStorage).at(mByteOffset);
+                    returnBits = (returnBits << 8) | getByte(mByteOffset);
                     mByteOffset++;
                     numBitsToGo -= 8;
                 }
                 else
                 {
                     returnBits = (returnBits << numBitsToGo) |
-                                 (static_cast<unsigned int>((mStorage).at(mByteOffset) >> (8 - numBitsToGo)) &
+                                 (static_cast<unsigned int>(getByte(mByteOffset) >> (8 - numBitsToGo)) &
                                   ((static_cast<unsigned int>(1) << numBitsToGo) - 1));
                     mBitOffset += static_cast<unsigned int>(numBitsToGo);
                     numBitsToGo = 0;
@@ -443,7 +479,7 @@ namespace ISOBMFF
         std::uint8_t currChar = 0xff;
         dstString.clear();
 
-        while (mByteOffset < mStorage.size())
+        while (mByteOffset < getSize())
         {
             currChar = read8Bits();
             if (currChar != 0)
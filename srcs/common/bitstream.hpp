@@ -24,12 +24,22 @@ namespace ISOBMFF
     /** @brief ISOBMFF compliant stream manipulation class.
      *  @details This class provides the necessary functionality to generate, modify and read an ISOBMFF compliant byte
      * stream.
+     *
+     * A BitStream either owns its data storage, or is a read-only view to data owned by someone else. Sub-box
+     * BitStreams returned by readSubBoxBitStream() and extract() are views to the data of the parent BitStream, so a
+     * whole box tree is parsed from a single buffer. A view must not be written to, and it is valid only as long as the
+     * viewed data is neither modified nor released.
      */
     class BitStream
     {
     public:
         BitStream();
         BitStream(Vector<std::uint8_t> strData);
+
+        /** @brief Construct a read-only view to existing data. The data is not copied.
+         *  @param data Pointer to the data, which must stay valid while the view is used.
+         *  @param size Size of the data in bytes. */
+        BitStream(const std::uint8_t* data, std::uint64_t size);
         BitStream(const BitStream&) = default;
         BitStream& operator=(const BitStream&) = default;
         BitStream(BitStream&&) noexcept;
@@ -56,12 +66,19 @@ namespace ISOBMFF
          *  @param newSize Byte size of the bitstream */
         void setSize(std::uint64_t newSize);
 
-        /// @return Reference to the stored data inside the bitstream
+        /** @brief Reserve storage, so that writing up to the given size does not reallocate.
+         *  @param capacity Total byte size of the bitstream to reserve storage for. */
+        void reserve(std::uint64_t capacity);
+
+        /// @return Reference to the stored data inside the bitstream. Not available for views.
         const Vector<std::uint8_t>& getStorage() const;
 
-        /// @return Reference to the stored data inside the bitstream
+        /// @return Reference to the stored data inside the bitstream. Not available for views.
         Vector<std::uint8_t>& getStorage();
 
+        /// @return True if the bitstream is a read-only view to data it does not own.
+        bool isView() const;
+
         /// @brief Reset any bit and byte offsets used in the bitstream access
         void reset();
 
@@ -185,14 +202,14 @@ namespace ISOBMFF
         /** Get BitStream of a sub Box. First 32 bits read defines size, next 32 bits boxType.
          * Read pointer of BitStream is incremented by size.
          * @param boxType [out] Type of the read sub-box
-         * @return Sub-box BitStream */
+         * @return Sub-box BitStream, a view to the data of this BitStream. */
         BitStream readSubBoxBitStream(FourCCInt& boxType);
 
         /// @return Number of bytes left to process in the current bitstream data storage
         std::uint64_t numBytesLeft() const;
 
         /**
-         * Clear destination BitStream and copy part of BitStream to it.
+         * Set destination BitStream to be a view to a part of this BitStream. The data is not copied.
          *
          * @param [in] begin Start offset from the bitstream begin
          * @param [in] end   End offset from the bitstream begin
@@ -202,10 +219,23 @@ namespace ISOBMFF
         /// @return True if current bit offset location inside a byte is zero, false otherwise.
         bool isByteAligned() const;
 
+        /// @return Pointer to the first byte of the data, either the storage or the viewed data.
+        const std::uint8_t* data() const;
+
     private:
+        /** @brief Check that a read of a number of bytes from the current byte offset stays inside the data.
+         *  @param count Number of bytes to be read. */
+        void checkRead(std::uint64_t count) const;
+
         /// @brief Bitstream data storage as a vector of unsigned integers
         Vector<std::uint8_t> mStorage;
 
+        /// @brief Viewed data, or nullptr if the bitstream owns its data in mStorage.
+        const std::uint8_t* mView;
+
+        /// @brief Size of the viewed data in bytes.
+        std::uint64_t mViewSize;
+
         /// @brief The value of the current processed byte
         unsigned int mCurrByte;
 
@@ -72,6 +72,12 @@ void ChunkOffsetBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t ChunkOffsetBox::getSerializedSize() const
+{
+    const std::uint64_t offsetSize = (getType() == "stco") ? 4 : 8;
+    return getFullBoxHeaderSize() + 4 + offsetSize * static_cast<std::uint64_t>(mChunkOffsets.size());
+}
+
 void ChunkOffsetBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
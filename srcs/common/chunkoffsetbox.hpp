@@ -46,6 +46,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the chunk count
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses a Chunk Offset Box bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
@@ -127,6 +127,12 @@ void CompositionOffsetBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t CompositionOffsetBox::getSerializedSize() const
+{
+    const std::size_t entryCount = mEntryVersion0.empty() ? mEntryVersion1.size() : mEntryVersion0.size();
+    return getFullBoxHeaderSize() + 4 + 8 * static_cast<std::uint64_t>(entryCount);
+}
+
 void CompositionOffsetBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
@@ -64,6 +64,10 @@ public:
      *  @throws Runtime Error if the write operation is unsuccessful */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the entry count
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses a Composition Offset Box bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
@@ -13,7 +13,16 @@
 
 #include "customallocator.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "../api/common/heifallocator.h"
+#include "statistics.hpp"
 
 namespace
 {
@@ -32,9 +41,53 @@ namespace
             free(ptr);
         }
     };
+
+    /// Block of a RangeAllocator, see registerAllocatorRange().
+    struct AllocatorRange
+    {
+        std::uintptr_t begin;
+        std::uintptr_t end;
+        HEIF::CustomAllocator* owner;
+    };
+
+    bool operator<(const std::uintptr_t address, const AllocatorRange& range)
+    {
+        return address < range.begin;
+    }
+
+    /// Memory handed out by an allocator other than getCustomAllocator(). Uses the standard allocator, as it is
+    /// updated from customAllocate().
+    struct TrackedMemory
+    {
+        /// Ranges registered with registerAllocatorRange(), ordered by their first byte.
+        std::vector<AllocatorRange> ranges;
+        /// Single blocks allocated in an AllocatorScope, unregistered when deallocated.
+        std::unordered_map<std::uintptr_t, HEIF::CustomAllocator*> blocks;
+
+        size_t size() const
+        {
+            return ranges.size() + blocks.size();
+        }
+    };
+
+    TrackedMemory& getTrackedMemory()
+    {
+        static TrackedMemory trackedMemory;
+        return trackedMemory;
+    }
 }  // namespace
 static DefaultAllocator defaultAllocator;
 static HEIF::CustomAllocator* customAllocator;
+static std::mutex trackedMemoryMutex;
+// Number of tracked ranges and blocks and of active AllocatorScopes, so that the default paths need neither the mutex
+// nor the thread local allocators while no other allocator is used.
+static std::atomic<size_t> trackedMemoryCount(0);
+static std::atomic<size_t> activeScopeCount(0);
+// Allocators of the innermost AllocatorScope of the thread, null when there is none.
+static thread_local HEIF::CustomAllocator* threadAllocator;
+static thread_local HEIF::CustomAllocator* threadLargeAllocator;
+static thread_local size_t threadLargeSize;
+static thread_local RangeAllocator* threadRangeAllocator;
 
 bool setCustomAllocator(HEIF::CustomAllocator* customAllocator_)
 {
@@ -65,10 +118,139 @@ HEIF::CustomAllocator* getCustomAllocator()
 
 void* customAllocate(size_t size)
 {
-    return getCustomAllocator()->allocate(size, 1);
+    if (HEIF::ThreadCounters* counters = HEIF::getThreadCounters())
+    {
+        ++counters->allocations;
+        counters->allocatedBytes += size;
+    }
+    if (activeScopeCount.load(std::memory_order_relaxed) == 0 || !threadAllocator)
+    {
+        return getCustomAllocator()->allocate(size, 1);
+    }
+
+    HEIF::CustomAllocator* allocator = threadAllocator;
+    if (threadLargeAllocator && size > threadLargeSize)
+    {
+        allocator = threadLargeAllocator;
+    }
+    void* ptr = allocator->allocate(size, 1);
+    // customDeallocate() returns untracked blocks to getCustomAllocator(), and finds blocks of a RangeAllocator from
+    // its ranges.
+    if (ptr && (allocator != getCustomAllocator()) && (allocator != threadRangeAllocator))
+    {
+        try
+        {
+            std::lock_guard<std::mutex> lock(trackedMemoryMutex);
+            TrackedMemory& tracked                                = getTrackedMemory();
+            tracked.blocks[reinterpret_cast<std::uintptr_t>(ptr)] = allocator;
+            trackedMemoryCount                                    = tracked.size();
+        }
+        catch (...)
+        {
+            allocator->deallocate(ptr);
+            return nullptr;
+        }
+    }
+    return ptr;
 }
 
 void customDeallocate(void* ptr)
 {
+    if (!ptr)
+    {
+        return;
+    }
+    if (trackedMemoryCount.load(std::memory_order_relaxed) != 0)
+    {
+        // Most blocks freed while parsing come from the allocator of the scope, which needs no lock to check.
+        if (activeScopeCount.load(std::memory_order_relaxed) != 0 && threadRangeAllocator &&
+            threadRangeAllocator->owns(ptr))
+        {
+            threadRangeAllocator->deallocate(ptr);
+            return;
+        }
+
+        HEIF::CustomAllocator* owner = nullptr;
+        {
+            const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+            std::lock_guard<std::mutex> lock(trackedMemoryMutex);
+            TrackedMemory& tracked = getTrackedMemory();
+            auto block             = tracked.blocks.find(address);
+            if (block != tracked.blocks.end())
+            {
+                owner = block->second;
+                tracked.blocks.erase(block);
+                trackedMemoryCount = tracked.size();
+            }
+            else
+            {
+                auto range = std::upper_bound(tracked.ranges.begin(), tracked.ranges.end(), address);
+                if (range != tracked.ranges.begin() && address < (--range)->end)
+                {
+                    owner = range->owner;
+                }
+            }
+        }
+        if (owner)
+        {
+            owner->deallocate(ptr);
+            return;
+        }
+    }
     getCustomAllocator()->deallocate(ptr);
 }
+
+void registerAllocatorRange(HEIF::CustomAllocator* owner, const void* begin, size_t size)
+{
+    const auto first = reinterpret_cast<std::uintptr_t>(begin);
+    std::lock_guard<std::mutex> lock(trackedMemoryMutex);
+    TrackedMemory& tracked = getTrackedMemory();
+    tracked.ranges.insert(std::upper_bound(tracked.ranges.begin(), tracked.ranges.end(), first),
+                          {first, first + size, owner});
+    trackedMemoryCount = tracked.size();
+}
+
+void unregisterAllocatorRange(const void* begin)
+{
+    const auto first = reinterpret_cast<std::uintptr_t>(begin);
+    std::lock_guard<std::mutex> lock(trackedMemoryMutex);
+    TrackedMemory& tracked = getTrackedMemory();
+    auto range             = std::upper_bound(tracked.ranges.begin(), tracked.ranges.end(), first);
+    if (range != tracked.ranges.begin() && (--range)->begin == first)
+    {
+        tracked.ranges.erase(range);
+    }
+    trackedMemoryCount = tracked.size();
+}
+
+AllocatorScope::AllocatorScope(HEIF::CustomAllocator* allocator,
+                               HEIF::CustomAllocator* largeAllocator,
+                               const size_t largeSize,
+                               RangeAllocator* rangeAllocator)
+    : mPreviousAllocator(threadAllocator)
+    , mPreviousLargeAllocator(threadLargeAllocator)
+    , mPreviousLargeSize(threadLargeSize)
+    , mPreviousRangeAllocator(threadRangeAllocator)
+    , mActive(allocator != nullptr)
+{
+    if (mActive)
+    {
+        threadAllocator      = allocator;
+        threadLargeAllocator = largeAllocator;
+        threadLargeSize      = largeSize;
+        threadRangeAllocator = rangeAllocator;
+        ++activeScopeCount;
+    }
+}
+
+AllocatorScope::~AllocatorScope()
+{
+    if (mActive)
+    {
+        threadAllocator      = mPreviousAllocator;
+        threadLargeAllocator = mPreviousLargeAllocator;
+        threadLargeSize      = mPreviousLargeSize;
+        threadRangeAllocator = mPreviousRangeAllocator;
+        --activeScopeCount;
+    }
+}
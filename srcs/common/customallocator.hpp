@@ -19,19 +19,65 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-namespace HEIF
-{
-    class CustomAllocator;
-}
+#include "../api/common/heifallocator.h"
+
 HEIF::CustomAllocator* getDefaultAllocator();
 bool setCustomAllocator(HEIF::CustomAllocator* customAllocator);
 HEIF::CustomAllocator* getCustomAllocator();
 
+/** Allocate from the allocator of the calling thread, see AllocatorScope. Outside of scopes this is a plain call to
+ * getCustomAllocator(). Blocks of other allocators are tracked, so that customDeallocate() returns them to the same
+ * allocator regardless of the thread or scope it is called in. */
 void* customAllocate(size_t size);
 void customDeallocate(void* ptr);
 
+/** Make customDeallocate() return pointers within [begin, begin + size) to owner. Used by allocators that hand out
+ * memory from larger blocks of their own, e.g. ArenaAllocator, so that their allocations need not be tracked one by
+ * one. Ranges must not overlap. */
+void registerAllocatorRange(HEIF::CustomAllocator* owner, const void* begin, size_t size);
+void unregisterAllocatorRange(const void* begin);
+
+/** Allocator handing out memory from larger blocks of its own, which it registers with registerAllocatorRange(). */
+class RangeAllocator : public HEIF::CustomAllocator
+{
+public:
+    /// @return True if ptr points into the blocks of the allocator. Lets customDeallocate() skip the shared ranges.
+    virtual bool owns(const void* ptr) const = 0;
+};
+
+/** Makes customAllocate() of the calling thread use other allocators until the scope is destroyed, e.g. a per-reader
+ * allocator while parsing. Scopes may be nested. */
+class AllocatorScope
+{
+public:
+    /**
+     * @param allocator       Allocator to use. Null keeps the allocators of the enclosing scope.
+     * @param largeAllocator  If not null, used instead of allocator for allocations larger than largeSize bytes. Lets
+     *                        the large buffers of growing containers bypass an arena, which would not reuse them.
+     * @param largeSize       Size limit for allocator.
+     * @param rangeAllocator  If not null, deallocations in the scope ask it first whether it owns the memory. Set to
+     *                        allocator if that is a RangeAllocator, so that its allocations are not tracked one by
+     *                        one. */
+    explicit AllocatorScope(HEIF::CustomAllocator* allocator,
+                            HEIF::CustomAllocator* largeAllocator = nullptr,
+                            size_t largeSize                      = 0,
+                            RangeAllocator* rangeAllocator        = nullptr);
+    ~AllocatorScope();
+
+    AllocatorScope(const AllocatorScope&) = delete;
+    AllocatorScope& operator=(const AllocatorScope&) = delete;
+
+private:
+    HEIF::CustomAllocator* mPreviousAllocator;
+    HEIF::CustomAllocator* mPreviousLargeAllocator;
+    size_t mPreviousLargeSize;
+    RangeAllocator* mPreviousRangeAllocator;
+    bool mActive;  ///< True if the scope changed the allocators.
+};
+
 template <typename T>
 T* customAllocateArray(size_t n)
 {
@@ -179,6 +225,9 @@ using Set = std::set<T, Compare, Allocator<T>>;
 template <typename K, typename V, typename Compare = std::less<K>>
 using Map = std::map<K, V, Compare, Allocator<std::pair<const K, V>>>;
 
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+using UnorderedMap = std::unordered_map<K, V, Hash, KeyEqual, Allocator<std::pair<const K, V>>>;
+
 typedef std::basic_istringstream<char, std::char_traits<char>, Allocator<char>> IStringStream;
 typedef std::basic_ostringstream<char, std::char_traits<char>, Allocator<char>> OStringStream;
 
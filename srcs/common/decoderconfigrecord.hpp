@@ -39,6 +39,12 @@ public:
 
     /* @brief Returns configuration parameter map for this record */
     virtual void getConfigurationMap(ConfigurationMap& aMap) const = 0;
+
+    /* @brief Returns size of NAL unit length fields in samples minus one. 3 for formats not made of NAL units. */
+    virtual std::uint8_t getLengthSizeMinus1() const
+    {
+        return 3;
+    }
 };
 
 #endif /* end of include guard: DECODERCONFIGRECORD_HPP*/
@@ -50,6 +50,11 @@ void FullBox::writeFullBoxHeader(ISOBMFF::BitStream& bitstr) const
     bitstr.write24Bits(mFlags);
 }
 
+uint64_t FullBox::getFullBoxHeaderSize() const
+{
+    return getBoxHeaderSize() + 4;
+}
+
 void FullBox::parseFullBoxHeader(ISOBMFF::BitStream& bitstr)
 {
     parseBoxHeader(bitstr);
@@ -63,6 +63,9 @@ protected:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeFullBoxHeader(ISOBMFF::BitStream& bitstr) const;
 
+    /** @return Byte size of the full box header written by writeFullBoxHeader() */
+    std::uint64_t getFullBoxHeaderSize() const;
+
 private:
     std::uint8_t mVersion;  // version field of the full box header
     std::uint32_t mFlags;   // Flags field of the full box header. Only 24 bits are used.
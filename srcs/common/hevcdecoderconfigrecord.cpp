@@ -358,6 +358,11 @@ std::uint8_t HevcDecoderConfigurationRecord::getGeneralLevelIdc() const
     return mGeneralLevelIdc;
 }
 
+std::uint8_t HevcDecoderConfigurationRecord::getLengthSizeMinus1() const
+{
+    return mLengthSizeMinus1;
+}
+
 void HevcDecoderConfigurationRecord::getConfigurationMap(ConfigurationMap& aMap) const
 {
     Vector<std::uint8_t> sps;
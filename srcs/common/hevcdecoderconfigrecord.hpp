@@ -89,6 +89,11 @@ public:
     /* @brief Returns configuration parameter map for this record */
     void getConfigurationMap(ConfigurationMap& aMap) const override;
 
+    /**
+     * @return Size of NAL unit length fields in samples minus one.
+     */
+    std::uint8_t getLengthSizeMinus1() const override;
+
     /**
      * @return Returns chroma_format_idc value.
      */
@@ -44,6 +44,16 @@ bool ItemDataBox::read(uint8_t* destination, const std::uint64_t offset, const s
     return true;
 }
 
+const std::uint8_t* ItemDataBox::getData(const std::uint64_t offset, const std::uint64_t length) const
+{
+    if ((offset + length) > mData.size() || (offset + length) < offset)
+    {
+        return nullptr;
+    }
+
+    return mData.data() + offset;
+}
+
 std::uint64_t ItemDataBox::addData(const Vector<std::uint8_t>& data)
 {
     const std::uint64_t offset = mData.size();
@@ -65,6 +75,12 @@ void ItemDataBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t ItemDataBox::getSerializedSize() const
+{
+    // An empty box is not written at all
+    return mData.empty() ? 0 : getBoxHeaderSize() + mData.size();
+}
+
 void ItemDataBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseBoxHeader(bitstr);
@@ -44,6 +44,15 @@ public:
      */
     bool read(uint8_t* destination, const std::uint64_t offset, const std::uint64_t length) const;
 
+    /**
+     * @brief getData     Access data of the box without copying it.
+     * @param offset      Offset to the data, bytes from the beginning of data[].
+     * @param length      Count of bytes to be accessed.
+     * @return Pointer to the data, valid as long as the box is not modified. nullptr if requested amount of bytes
+     *         was not available.
+     */
+    const std::uint8_t* getData(std::uint64_t offset, std::uint64_t length) const;
+
     /**
      * @brief addData Add item data to the box.
      * @param data    The data to be added.
@@ -55,6 +64,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the data size
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses an ItemDataBox bitstream and fills in member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
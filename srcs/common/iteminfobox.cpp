@@ -13,6 +13,7 @@
 
 #include "iteminfobox.hpp"
 
+#include <cstring>
 #include <stdexcept>
 
 using namespace std;
@@ -26,6 +27,7 @@ ItemInfoBox::ItemInfoBox(const uint8_t version)
     : FullBox("iinf", version, 0)
     , mItemInfoList()
     , mItemIds()
+    , mItemIndex()
 {
 }
 
@@ -36,38 +38,37 @@ const Vector<std::uint32_t>& ItemInfoBox::getItemIds() const
 
 void ItemInfoBox::addItemInfoEntry(const ItemInfoEntry& infoEntry)
 {
+    // In case of duplicate IDs lookups return the first entry.
+    mItemIndex.insert(std::make_pair(infoEntry.getItemID(), mItemInfoList.size()));
     mItemInfoList.push_back(infoEntry);
     mItemIds.push_back(infoEntry.getItemID());
 }
 
-ItemInfoEntry ItemInfoBox::getItemById(const uint32_t itemId) const
+std::size_t ItemInfoBox::indexOf(const uint32_t itemId) const
 {
-    for (const auto& item : mItemInfoList)
+    const auto iter = mItemIndex.find(itemId);
+    if (iter == mItemIndex.cend())
     {
-        if (item.getItemID() == itemId)
-        {
-            return item;
-        }
+        throw RuntimeError("Requested ItemInfoEntry not found.");
     }
-    throw RuntimeError("Requested ItemInfoEntry not found.");
+    return iter->second;
+}
+
+const ItemInfoEntry& ItemInfoBox::getItemById(const uint32_t itemId) const
+{
+    return mItemInfoList[indexOf(itemId)];
 }
 
 ItemInfoEntry& ItemInfoBox::getItemById(const uint32_t itemId)
 {
-    for (auto& item : mItemInfoList)
-    {
-        if (item.getItemID() == itemId)
-        {
-            return item;
-        }
-    }
-    throw RuntimeError("Requested ItemInfoEntry not found.");
+    return mItemInfoList[indexOf(itemId)];
 }
 
 void ItemInfoBox::clear()
 {
     mItemInfoList.clear();
     mItemIds.clear();
+    mItemIndex.clear();
 }
 
 void ItemInfoBox::writeBox(ISOBMFF::BitStream& bitstr) const
@@ -91,6 +92,16 @@ void ItemInfoBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t ItemInfoBox::getSerializedSize() const
+{
+    std::uint64_t size = getFullBoxHeaderSize() + (getVersion() == 0 ? 2 : 4);
+    for (auto& entry : mItemInfoList)
+    {
+        size += entry.getSerializedSize();
+    }
+    return size;
+}
+
 void ItemInfoBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseFullBoxHeader(bitstr);
@@ -115,6 +126,7 @@ void ItemInfoBox::parseBox(ISOBMFF::BitStream& bitstr)
 
     mItemInfoList.reserve(entryCount);
     mItemIds.reserve(entryCount);
+    mItemIndex.reserve(entryCount);
     for (size_t i = 0; i < entryCount; ++i)
     {
         // Extract contained box bitstream and type
@@ -264,6 +276,30 @@ void ItemInfoEntry::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t ItemInfoEntry::getSerializedSize() const
+{
+    if (getVersion() < 2)
+    {
+        // Size of the item info extension is known only by serializing it.
+        return Box::getSerializedSize();
+    }
+
+    // Strings are written up to the first null character, which is always written.
+    const auto stringSize = [](const String& string) { return std::strlen(string.c_str()) + 1; };
+
+    std::uint64_t size = getFullBoxHeaderSize() + (getVersion() == 3 ? 4 : (getVersion() == 2 ? 2 : 0)) + 2 + 4 +
+                         stringSize(mItemName);
+    if (mItemType == "mime")
+    {
+        size += stringSize(mContentType) + stringSize(mContentEncoding);
+    }
+    else if (mItemType == "uri ")
+    {
+        size += stringSize(mItemUriType);
+    }
+    return size;
+}
+
 void FDItemInfoExtension::write(ISOBMFF::BitStream& bitstr)
 {
     bitstr.writeZeroTerminatedString(mContentLocation);
@@ -50,6 +50,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the sizes of the entries
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses a ItemInfoBox bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
@@ -64,7 +68,7 @@ public:
      * @param [in] itemId ID of an Item
      * @return ItemInfoEntry with the desired itemId
      * @throws Runtime Exception if the requested ItemInfoEntry is not found. */
-    ItemInfoEntry getItemById(uint32_t itemId) const;
+    const ItemInfoEntry& getItemById(uint32_t itemId) const;
 
     /** @brief Return an ItemInfoEntry of an item with a desired itemId
      * @param [in] itemId ID of an Item
@@ -75,6 +79,11 @@ public:
 private:
     Vector<ItemInfoEntry> mItemInfoList;  ///< Vector of the ItemInfoEntry Boxes
     Vector<std::uint32_t> mItemIds;
+    UnorderedMap<std::uint32_t, std::size_t> mItemIndex;  ///< Item ID to index of the first entry in mItemInfoList
+
+    /** @return Index of the entry of the item in mItemInfoList
+     *  @throws Runtime Exception if the requested ItemInfoEntry is not found. */
+    std::size_t indexOf(std::uint32_t itemId) const;
 };
 
 /** @brief Item Information Entry Box. Extends from FullBox.
@@ -156,6 +165,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size of version 2 and 3 entries from the field sizes
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses an ItemInfoEntry bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
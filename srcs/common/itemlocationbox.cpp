@@ -87,6 +87,7 @@ ItemLocationBox::ItemLocationBox()
     , mBaseOffsetSize(4)
     , mIndexSize(0)
     , mItemLocations()
+    , mItemIndex()
 {
 }
 
@@ -142,6 +143,8 @@ void ItemLocationBox::addLocation(const ItemLocation& itemLoc)
     {
         setVersion(1);
     }
+    // In case of duplicate IDs lookups return the first entry.
+    mItemIndex.insert(std::make_pair(itemLoc.getItemID(), mItemLocations.size()));
     mItemLocations.push_back(itemLoc);
 }
 
@@ -241,6 +244,24 @@ void ItemLocationBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t ItemLocationBox::getSerializedSize() const
+{
+    const bool hasConstructionMethod = (getVersion() == 1) || (getVersion() == 2);
+    const std::uint64_t idSize       = (getVersion() < 2) ? 2 : ((getVersion() == 2) ? 4 : 0);
+    const std::uint64_t indexSize    = (hasConstructionMethod && (mIndexSize > 0)) ? mIndexSize : 0;
+    const std::uint64_t extentSize   = indexSize + mOffsetSize + mLengthSize;
+
+    // Field sizes, item count and for each item the id, construction method, data reference index, base offset and
+    // extent count.
+    std::uint64_t size = getFullBoxHeaderSize() + 2 + idSize;
+    for (const auto& itemLoc : mItemLocations)
+    {
+        size += idSize + (hasConstructionMethod ? 2 : 0) + 2 + mBaseOffsetSize + 2;
+        size += extentSize * itemLoc.getExtentList().size();
+    }
+    return size;
+}
+
 void ItemLocationBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     unsigned int itemCount = 0;
@@ -329,14 +350,20 @@ const ItemLocationExtent& ItemLocation::getExtent(const unsigned int i) const
 
 ItemLocationVector::const_iterator ItemLocationBox::findItem(const std::uint32_t itemId) const
 {
-    auto iter = std::find_if(mItemLocations.cbegin(), mItemLocations.cend(),
-                             [itemId](const ItemLocation& itemLocation) { return itemLocation.getItemID() == itemId; });
-    return iter;
+    const auto index = mItemIndex.find(itemId);
+    if (index == mItemIndex.cend())
+    {
+        return mItemLocations.cend();
+    }
+    return mItemLocations.cbegin() + static_cast<std::ptrdiff_t>(index->second);
 }
 
 ItemLocationVector::iterator ItemLocationBox::findItem(const std::uint32_t itemId)
 {
-    auto iter = std::find_if(mItemLocations.begin(), mItemLocations.end(),
-                             [itemId](const ItemLocation& itemLocation) { return itemLocation.getItemID() == itemId; });
-    return iter;
+    const auto index = mItemIndex.find(itemId);
+    if (index == mItemIndex.cend())
+    {
+        return mItemLocations.end();
+    }
+    return mItemLocations.begin() + static_cast<std::ptrdiff_t>(index->second);
 }
@@ -176,7 +176,8 @@ public:
      *  @return TRUE if item with item ID is found and data reference is set, FALSE if item with item Id not found */
     bool setItemDataReferenceIndex(std::uint32_t itemId, std::uint16_t dataReferenceIndex);
 
-    /** @brief Get the item location vector
+    /** @brief Get the item location vector. Entries must not be added, removed or have their item ID changed
+     *  through the returned reference, as that would invalidate the item ID index; use addLocation() instead.
      *  @return Item Location vector of Item Location entries */
     ItemLocationVector& getItemLocations();
 
@@ -184,6 +185,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the field sizes and the number of items and extents
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses an ItemLocationBox bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
@@ -200,6 +205,7 @@ private:
     std::uint8_t mBaseOffsetSize;       ///< Base offset size {0,4, or 8}
     std::uint8_t mIndexSize;            ///< Index size {0,4, or 8} and only if version == 1, otherwise reserved
     ItemLocationVector mItemLocations;  ///< Vector of item location entries
+    UnorderedMap<std::uint32_t, std::size_t> mItemIndex;  ///< Item ID to index of the first entry in mItemLocations
 
     ItemLocationVector::const_iterator
     findItem(std::uint32_t itemId) const;  ///< Find an item with given itemId and return as a const
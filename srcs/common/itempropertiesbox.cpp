@@ -29,15 +29,14 @@ const Box* ItemPropertiesBox::getPropertyByIndex(const std::uint32_t index) cons
 
 std::uint32_t ItemPropertiesBox::findPropertyIndex(const PropertyType type, const std::uint32_t itemId) const
 {
-    for (const auto& ipma : mAssociationBoxes)
+    const auto properties = mItemProperties.find(itemId);
+    if (properties != mItemProperties.end())
     {
-        const ItemPropertyAssociation::AssociationEntries& propertyIndexVector = ipma.getAssociationEntries(itemId);
-        for (const auto& entry : propertyIndexVector)
+        for (const auto& propertyInfo : properties->second)
         {
-            const Box* itemproperty = mContainer.getProperty(static_cast<size_t>(entry.index - 1));
-            if (itemproperty && getPropertyType(itemproperty) == type)
+            if (propertyInfo.type == type)
             {
-                return entry.index;
+                return propertyInfo.index + 1;
             }
         }
     }
@@ -46,6 +45,13 @@ std::uint32_t ItemPropertiesBox::findPropertyIndex(const PropertyType type, cons
 
 Vector<std::uint8_t> ItemPropertiesBox::getPropertyDataByIndex(std::uint32_t index) const
 {
+    const std::uint8_t* data;
+    std::uint64_t size;
+    if (mContainer.getPropertyData(index, data, size))
+    {
+        return Vector<std::uint8_t>(data, data + size);
+    }
+
     BitStream serialized;
     const Box* property = mContainer.getProperty(index);
     if (property != nullptr)
@@ -56,10 +62,21 @@ Vector<std::uint8_t> ItemPropertiesBox::getPropertyDataByIndex(std::uint32_t ind
     return serialized.getStorage();
 }
 
+bool ItemPropertiesBox::getPropertyDataView(const std::uint32_t index,
+                                            const std::uint8_t*& data,
+                                            std::uint64_t& size) const
+{
+    return mContainer.getPropertyData(index, data, size);
+}
+
 ItemPropertiesBox::PropertyType ItemPropertiesBox::getPropertyType(const Box* property) const
 {
-    const FourCCInt boxType = property->getType();
-    const Map<FourCCInt, PropertyType> TYPE_MAPPING{
+    struct TypeMapping
+    {
+        FourCCInt boxType;
+        PropertyType propertyType;
+    };
+    static const TypeMapping TYPE_MAPPING[] = {
         {"altt", PropertyType::ALTT}, {"auxC", PropertyType::AUXC}, {"avcC", PropertyType::AVCC},
         {"clap", PropertyType::CLAP}, {"colr", PropertyType::COLR}, {"crtt", PropertyType::CRTT},
         {"free", PropertyType::FREE}, {"hvcC", PropertyType::HVCC}, {"imir", PropertyType::IMIR},
@@ -69,56 +86,67 @@ ItemPropertiesBox::PropertyType ItemPropertiesBox::getPropertyType(const Box* pr
         {"skip", PropertyType::FREE}, {"udes", PropertyType::UDES},
     };
 
-    const auto found = TYPE_MAPPING.find(boxType);
-    if (found == TYPE_MAPPING.end())
+    const FourCCInt boxType = property->getType();
+    for (const auto& mapping : TYPE_MAPPING)
     {
-        return PropertyType::RAW;
+        if (mapping.boxType == boxType)
+        {
+            return mapping.propertyType;
+        }
     }
 
-    return found->second;
+    return PropertyType::RAW;
 }
 
-ItemPropertiesBox::PropertyInfos ItemPropertiesBox::getItemProperties(const std::uint32_t itemId) const
+const ItemPropertiesBox::PropertyInfos& ItemPropertiesBox::getItemProperties(const std::uint32_t itemId) const
 {
-    PropertyInfos propertyInfoVector;
-    for (const auto& ipma : mAssociationBoxes)
+    if (mItemsWithInvalidProperties.count(itemId))
     {
-        const ItemPropertyAssociation::AssociationEntries& associations = ipma.getAssociationEntries(itemId);
+        throw RuntimeError("ItemPropertiesBox::getItemProperties() invalid property index");
+    }
 
-        for (const auto& entry : associations)
+    const auto properties = mItemProperties.find(itemId);
+    if (properties == mItemProperties.end())
+    {
+        static const PropertyInfos empty;
+        return empty;
+    }
+
+    return properties->second;
+}
+
+void ItemPropertiesBox::indexAssociations(const std::uint32_t itemId,
+                                          const ItemPropertyAssociation::AssociationEntries& associations)
+{
+    PropertyInfos& propertyInfoVector = mItemProperties[itemId];
+    for (const auto& entry : associations)
+    {
+        if (entry.index == 0)
         {
-            if (entry.index == 0)
-            {
-                // Index value 0 indicates no property is associated.
-                continue;
-            }
+            // Index value 0 indicates no property is associated.
+            continue;
+        }
 
-            PropertyInfo propertyInfo;
-            const Box* itemproperty = mContainer.getProperty(static_cast<size_t>(entry.index - 1));
-            if (itemproperty)
-            {
-                propertyInfo.type = getPropertyType(itemproperty);
-                if (propertyInfo.type == PropertyType::FREE)
-                {
-                    // Ignore a FreeSpaceBox property. It should not have any associations.
-                    continue;
-                }
-                propertyInfo.index     = static_cast<std::uint32_t>(entry.index - 1);
-                propertyInfo.essential = entry.essential;
-                propertyInfoVector.push_back(propertyInfo);
-            }
-            else
+        PropertyInfo propertyInfo;
+        const Box* itemproperty = mContainer.getProperty(static_cast<size_t>(entry.index - 1));
+        if (itemproperty)
+        {
+            propertyInfo.type = getPropertyType(itemproperty);
+            if (propertyInfo.type == PropertyType::FREE)
             {
-                throw RuntimeError("ItemPropertiesBox::getItemProperties() invalid property index");
+                // Ignore a FreeSpaceBox property. It should not have any associations.
+                continue;
             }
+            propertyInfo.index     = static_cast<std::uint32_t>(entry.index - 1);
+            propertyInfo.essential = entry.essential;
+            propertyInfoVector.push_back(propertyInfo);
         }
-        if (associations.size() > 0)
+        else
         {
-            break;
+            // Reported when properties of the item are requested.
+            mItemsWithInvalidProperties.insert(itemId);
         }
     }
-
-    return propertyInfoVector;
 }
 
 uint16_t ItemPropertiesBox::addProperty(std::shared_ptr<Box> box,
@@ -147,6 +175,11 @@ void ItemPropertiesBox::associateProperty(const std::uint16_t index,
     for (const auto itemId : itemIds)
     {
         mAssociationBoxes.at(0).addEntry(itemId, index, essential);
+
+        ItemPropertyAssociation::Entry entry;
+        entry.essential = essential;
+        entry.index     = index;
+        indexAssociations(itemId, {entry});
     }
 }
 
@@ -174,6 +207,14 @@ void ItemPropertiesBox::writeBox(BitStream& output) const
     updateSize(output);
 }
 
+std::uint64_t ItemPropertiesBox::getSerializedSize() const
+{
+    // Writing multiple ipma boxes fails, so only the first one is counted.
+    const std::uint64_t associationSize = mAssociationBoxes.empty() ? ItemPropertyAssociation().getSerializedSize()
+                                                                    : mAssociationBoxes.at(0).getSerializedSize();
+    return getBoxHeaderSize() + mContainer.getSerializedSize() + associationSize;
+}
+
 void ItemPropertiesBox::parseBox(BitStream& input)
 {
     parseBoxHeader(input);
@@ -193,4 +234,16 @@ void ItemPropertiesBox::parseBox(BitStream& input)
         ipma.parseBox(subBitStream);
         mAssociationBoxes.push_back(ipma);
     }
+
+    for (const auto& ipma : mAssociationBoxes)
+    {
+        for (const auto& association : ipma.getAssociations())
+        {
+            // Only the first ipma box with associations for the item is used.
+            if (!association.second.empty() && !mItemProperties.count(association.first))
+            {
+                indexAssociations(association.first, association.second);
+            }
+        }
+    }
 }
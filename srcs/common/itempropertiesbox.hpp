@@ -39,6 +39,13 @@ public:
      *  @return Data of the property, including header. An empty vector if property in index was not found. */
     Vector<std::uint8_t> getPropertyDataByIndex(std::uint32_t index) const;
 
+    /** Get an item property raw box from the ItemPropertyContainer by index, without copying or serializing it.
+     *  @param [in] index 0-based index to to ItemPropertyContainerBox
+     *  @param [out] data Pointer to the data of the property, including header. Valid as long as this box is.
+     *  @param [out] size Size of the data in bytes.
+     *  @return False if property in index was not found, or it was not parsed from a file. */
+    bool getPropertyDataView(std::uint32_t index, const std::uint8_t*& data, std::uint64_t& size) const;
+
     /**  Item Property and Item Full Property types recognized by ItemPropertiesBox */
     enum class PropertyType
     {
@@ -80,7 +87,7 @@ public:
      * @param [in] itemId Item ID of the item
      * @return PropertyInfo structs for this this itemId. An empty vector if the item has no properties, or if the
      *         item ID does not exist). */
-    PropertyInfos getItemProperties(std::uint32_t itemId) const;
+    const PropertyInfos& getItemProperties(std::uint32_t itemId) const;
 
     /** Find property index based on item id and property type.
      * @param [in] type Type of the property to find
@@ -105,6 +112,10 @@ public:
      *  @see Box::writeBox() */
     void writeBox(ISOBMFF::BitStream& output) const override;
 
+    /** Compute the size of the box from the sizes of the contained boxes.
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** Read box from ISOBMFF::BitStream.
      *  @see Box::parseBox() */
     void parseBox(ISOBMFF::BitStream& input) override;
@@ -116,7 +127,17 @@ private:
     /** ItemPropertyAssociation boxes contain information about property and item associations. */
     Vector<ItemPropertyAssociation> mAssociationBoxes;
 
+    /** PropertyInfos of each item, collected from mAssociationBoxes when they are parsed or added to. Only the first
+     * ItemPropertyAssociation box which has associations for an item is used. */
+    Map<std::uint32_t, PropertyInfos> mItemProperties;
+
+    /** Items with associations to properties which are not in the ItemPropertyContainer. */
+    Set<std::uint32_t> mItemsWithInvalidProperties;
+
     PropertyType getPropertyType(const Box* property) const;
+
+    /** Add association entries of an item to mItemProperties. */
+    void indexAssociations(std::uint32_t itemId, const ItemPropertyAssociation::AssociationEntries& associations);
 };
 
 #endif /* ITEMPROPERTIESBOX_HPP */
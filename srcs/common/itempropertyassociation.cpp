@@ -62,6 +62,11 @@ ItemPropertyAssociation::getAssociationEntries(const std::uint32_t itemId) const
     return empty;
 }
 
+const Map<std::uint32_t, ItemPropertyAssociation::AssociationEntries>& ItemPropertyAssociation::getAssociations() const
+{
+    return mAssociations;
+}
+
 void ItemPropertyAssociation::writeBox(BitStream& bitstream) const
 {
     writeFullBoxHeader(bitstream);
@@ -98,6 +103,20 @@ void ItemPropertyAssociation::writeBox(BitStream& bitstream) const
     updateSize(bitstream);
 }
 
+std::uint64_t ItemPropertyAssociation::getSerializedSize() const
+{
+    // Each association is an essential bit and a property index, in total one byte or two bytes with flag 1.
+    const std::uint64_t itemIdSize      = (getVersion() < 1) ? 2 : 4;
+    const std::uint64_t associationSize = (getFlags() & 1) ? 2 : 1;
+
+    std::uint64_t size = getFullBoxHeaderSize() + 4;
+    for (const auto& entry : mAssociations)
+    {
+        size += itemIdSize + 1 + associationSize * entry.second.size();
+    }
+    return size;
+}
+
 void ItemPropertyAssociation::parseBox(BitStream& bitstream)
 {
     parseFullBoxHeader(bitstream);
@@ -41,6 +41,10 @@ public:
      */
     const AssociationEntries& getAssociationEntries(std::uint32_t itemId) const;
 
+    /** Get association information of all items.
+     * @return Association entries by item id. */
+    const Map<std::uint32_t, AssociationEntries>& getAssociations() const;
+
     /** Add a property association for an item.
      * @param [in] itemId Item ID of the item.
      * @param [in] index 1-based index of the property to associate from the Item Property Container Box. Value 0
@@ -53,6 +57,10 @@ public:
      *  @see Box::writeBox() */
     void writeBox(ISOBMFF::BitStream& bitstream) const override;
 
+    /** Compute the size of the box from the number of associations.
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** Read box from ISOBMFF::BitStream.
      *  @see Box::parseBox() */
     void parseBox(ISOBMFF::BitStream& bitstream) override;
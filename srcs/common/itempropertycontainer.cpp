@@ -36,9 +36,22 @@ Box* ItemPropertyContainer::getProperty(const size_t index)
     return const_cast<Box*>(static_cast<const ItemPropertyContainer*>(this)->getProperty(index));
 }
 
+bool ItemPropertyContainer::getPropertyData(const size_t index, const std::uint8_t*& data, std::uint64_t& size) const
+{
+    if (mPropertyExtents.size() <= index || mPropertyExtents.at(index).size == 0)
+    {
+        return false;
+    }
+    const PropertyExtent& extent = mPropertyExtents.at(index);
+    data                         = mData.data() + extent.offset;
+    size                         = extent.size;
+    return true;
+}
+
 std::uint16_t ItemPropertyContainer::addProperty(const std::shared_ptr<Box>& box)
 {
     mProperties.push_back(box);
+    mPropertyExtents.push_back({0, 0});
     return static_cast<std::uint16_t>(mProperties.size());
 }
 
@@ -53,6 +66,16 @@ void ItemPropertyContainer::writeBox(BitStream& bitstream) const
     updateSize(bitstream);
 }
 
+std::uint64_t ItemPropertyContainer::getSerializedSize() const
+{
+    std::uint64_t size = getBoxHeaderSize();
+    for (auto& property : mProperties)
+    {
+        size += property->getSerializedSize();
+    }
+    return size;
+}
+
 void ItemPropertyContainer::parseBox(BitStream& bitstream)
 {
     parseBoxHeader(bitstream);
@@ -63,10 +86,17 @@ void ItemPropertyContainer::parseBox(BitStream& bitstream)
 
     BoxFactory boxFactory;
 
+    // Keep a copy of the box data, so that raw properties can be returned without serializing them again.
+    mData.assign(bitstream.data(), bitstream.data() + bitstream.getSize());
+    mPropertyExtents.clear();
+    mProperties.clear();
+
     while (bitstream.numBytesLeft() > 0)
     {
         FourCCInt boxType;
+        const std::uint64_t offset    = bitstream.getPos();
         BitStream subBitStream        = bitstream.readSubBoxBitStream(boxType);
+        mPropertyExtents.push_back({offset, subBitStream.getSize()});
         std::shared_ptr<Box> property = boxFactory.makeNewBox(boxType);
         if (property == nullptr)
         {
@@ -41,6 +41,16 @@ public:
      */
     Box* getProperty(size_t index);
 
+    /**
+     * Get raw data of a parsed Property or FullProperty, without serializing it again.
+     * @param [in] index 0-based index of the item.
+     * @param [out] data Pointer to the property data, including the box header. It is valid until the container is
+     *                   parsed again or destroyed.
+     * @param [out] size Size of the property data in bytes.
+     * @return False if index is invalid, or if the property was added with addProperty() instead of being parsed.
+     */
+    bool getPropertyData(size_t index, const std::uint8_t*& data, std::uint64_t& size) const;
+
     /**
      * Add a Property or FullProperty
      * @param [in] box Pointer to the Box to add
@@ -53,6 +63,10 @@ public:
      *  @see Box::writeBox() */
     void writeBox(ISOBMFF::BitStream& bitstream) const override;
 
+    /** Compute the size of the box from the sizes of the properties.
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** Deserialize box data from the ISOBMFF::BitStream.
      *  @see Box::parseBox() */
     void parseBox(ISOBMFF::BitStream& bitstream) override;
@@ -63,6 +77,19 @@ private:
      * @todo Preferably unique_ptr should be used here.
      */
     Vector<std::shared_ptr<Box>> mProperties;
+
+    /** Offset and size of a property in mData. */
+    struct PropertyExtent
+    {
+        std::uint64_t offset;
+        std::uint64_t size;  ///< 0 for properties which were not parsed
+    };
+
+    /** Data of the parsed 'ipco' box, kept for raw property access. */
+    Vector<std::uint8_t> mData;
+
+    /** Location of each property of mProperties in mData. */
+    Vector<PropertyExtent> mPropertyExtents;
 };
 
 #endif /* ITEMPROPERTYCONTAINER_HPP */
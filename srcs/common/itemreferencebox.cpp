@@ -15,7 +15,6 @@
 
 #include <algorithm>
 #include <limits>
-#include <list>
 #include <stdexcept>
 
 #include "bitstream.hpp"
@@ -81,6 +80,12 @@ void SingleItemTypeReferenceBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SingleItemTypeReferenceBox::getSerializedSize() const
+{
+    const std::uint64_t idSize = mIsLarge ? 4 : 2;
+    return getBoxHeaderSize() + idSize + 2 + idSize * mToItemIds.size();
+}
+
 const Vector<uint32_t>& SingleItemTypeReferenceBox::getToItemIds() const
 {
     return mToItemIds;
@@ -88,27 +93,48 @@ const Vector<uint32_t>& SingleItemTypeReferenceBox::getToItemIds() const
 
 ItemReferenceBox::ItemReferenceBox()
     : FullBox("iref", 0, 0)
-    , mReferenceList()
+    , mReferencesByType()
+    , mReferenceOrder()
+    , mReferenceIndex()
+{
+}
+
+std::uint64_t ItemReferenceBox::referenceKey(FourCCInt type, const std::uint32_t fromId)
 {
+    return (static_cast<std::uint64_t>(type.getUInt32()) << 32) | fromId;
 }
 
 void ItemReferenceBox::addItemRef(const SingleItemTypeReferenceBox& ref)
 {
-    mReferenceList.push_back(ref);
+    auto& references = mReferencesByType[ref.getType()];
+    // In case of duplicate entries lookups return the first one.
+    mReferenceIndex.insert(std::make_pair(referenceKey(ref.getType(), ref.getFromItemID()), references.size()));
+    mReferenceOrder.push_back(std::make_pair(ref.getType(), references.size()));
+    references.push_back(ref);
 }
 
 void ItemReferenceBox::writeBox(ISOBMFF::BitStream& bitstr) const
 {
     writeFullBoxHeader(bitstr);  // parent box
 
-    for (auto& i : mReferenceList)
+    for (const auto& position : mReferenceOrder)
     {
-        i.writeBox(bitstr);
+        mReferencesByType.at(position.first)[position.second].writeBox(bitstr);
     }
 
     updateSize(bitstr);
 }
 
+std::uint64_t ItemReferenceBox::getSerializedSize() const
+{
+    std::uint64_t size = getFullBoxHeaderSize();
+    for (const auto& position : mReferenceOrder)
+    {
+        size += mReferencesByType.at(position.first)[position.second].getSerializedSize();
+    }
+    return size;
+}
+
 void ItemReferenceBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseFullBoxHeader(bitstr);
@@ -152,17 +178,26 @@ void SingleItemTypeReferenceBox::parseBox(ISOBMFF::BitStream& bitstr)
     }
 }
 
-Vector<SingleItemTypeReferenceBox> ItemReferenceBox::getReferencesOfType(FourCCInt type) const
+const Vector<SingleItemTypeReferenceBox>& ItemReferenceBox::getReferencesOfType(FourCCInt type) const
 {
-    Vector<SingleItemTypeReferenceBox> references;
-    for (const auto& reference : mReferenceList)
+    static const Vector<SingleItemTypeReferenceBox> noReferences;
+
+    const auto references = mReferencesByType.find(type);
+    if (references == mReferencesByType.cend())
     {
-        if (reference.getType() == type)
-        {
-            references.push_back(reference);
-        }
+        return noReferences;
+    }
+    return references->second;
+}
+
+const SingleItemTypeReferenceBox* ItemReferenceBox::findReference(FourCCInt type, const std::uint32_t fromId) const
+{
+    const auto index = mReferenceIndex.find(referenceKey(type, fromId));
+    if (index == mReferenceIndex.cend())
+    {
+        return nullptr;
     }
-    return references;
+    return &mReferencesByType.at(type)[index->second];
 }
 
 void ItemReferenceBox::add(FourCCInt type, const std::uint32_t fromId, const std::uint32_t toId)
@@ -175,13 +210,10 @@ void ItemReferenceBox::add(FourCCInt type, const std::uint32_t fromId, const std
     }
 
     // Add to an existing entry if one exists for this type & fromId pair
-    auto reference =
-        std::find_if(mReferenceList.begin(), mReferenceList.end(), [&](const SingleItemTypeReferenceBox& entry) {
-            return (entry.getType() == type) && (entry.getFromItemID() == fromId);
-        });
-    if (reference != mReferenceList.end())
+    const auto index = mReferenceIndex.find(referenceKey(type, fromId));
+    if (index != mReferenceIndex.end())
     {
-        reference->addToItemID(toId);
+        mReferencesByType.at(type)[index->second].addToItemID(toId);
     }
     else
     {
@@ -190,6 +222,6 @@ void ItemReferenceBox::add(FourCCInt type, const std::uint32_t fromId, const std
         ref.setType(type);
         ref.setFromItemID(fromId);
         ref.addToItemID(toId);
-        mReferenceList.push_back(ref);
+        addItemRef(ref);
     }
 }
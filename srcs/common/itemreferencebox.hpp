@@ -15,7 +15,6 @@
 #define ITEMREFERENCEBOX_HPP
 
 #include <cstdint>
-#include <list>
 
 #include "bbox.hpp"
 #include "customallocator.hpp"
@@ -67,6 +66,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the number of referenced items
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses a SingleItemTypeReferenceBox bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
@@ -94,8 +97,14 @@ public:
 
     /** @brief Returns the vector of item references of a particular reference type.
      *  @param [in] type Type of the item reference
-     *  @return vector of item references with the requested reference type */
-    Vector<SingleItemTypeReferenceBox> getReferencesOfType(FourCCInt type) const;
+     *  @return vector of item references with the requested reference type, valid until the box is modified */
+    const Vector<SingleItemTypeReferenceBox>& getReferencesOfType(FourCCInt type) const;
+
+    /** @brief Find the item reference of a particular reference type and "from-item" item Id.
+     *  @param [in] type   Type of the item reference
+     *  @param [in] fromId "From-Id" field value of the item reference
+     *  @return Pointer to the item reference, valid until the box is modified, or nullptr if not found */
+    const SingleItemTypeReferenceBox* findReference(FourCCInt type, std::uint32_t fromId) const;
 
     /** @brief Parses an ItemReferenceBox bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data */
@@ -105,11 +114,23 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the sizes of the contained boxes
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
 private:
     void addItemRef(const SingleItemTypeReferenceBox& ref);  ///< Add an item reference to the ItemReferenceBox
 
-    List<SingleItemTypeReferenceBox>
-        mReferenceList;  ///< List of item references of SingleItemTypeReferenceBox data structure
+    typedef std::pair<FourCCInt, std::size_t> ReferencePosition;  ///< Reference type and index within that type
+
+    /** @return Key for mReferenceIndex */
+    static std::uint64_t referenceKey(FourCCInt type, std::uint32_t fromId);
+
+    Map<FourCCInt, Vector<SingleItemTypeReferenceBox>>
+        mReferencesByType;                     ///< Item references of SingleItemTypeReferenceBox data structure by type
+    Vector<ReferencePosition> mReferenceOrder;  ///< Order of the item references in the box
+    UnorderedMap<std::uint64_t, std::size_t>
+        mReferenceIndex;  ///< Reference type and "from-item" Id to index of the first such reference of the type
 };
 
 #endif /* end of include guard: ITEMREFERENCEBOX_HPP */
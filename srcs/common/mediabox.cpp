@@ -68,6 +68,12 @@ void MediaBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t MediaBox::getSerializedSize() const
+{
+    return getBoxHeaderSize() + mMediaHeaderBox.getSerializedSize() + mHandlerBox.getSerializedSize() +
+           mMediaInformationBox.getSerializedSize();
+}
+
 void MediaBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
@@ -12,6 +12,7 @@
  */
 
 #include "mediadatabox.hpp"
+#include "nalutil.hpp"
 
 #include <fstream>
 #include <limits>
@@ -119,6 +120,25 @@ std::uint64_t MediaDataBox::addData(const uint8_t* buffer, const uint64_t buffer
     return offset;
 }
 
+const Vector<uint8_t>& MediaDataBox::getLastData() const
+{
+    return mMediaData.back();
+}
+
+std::uint64_t MediaDataBox::addExternalData(const std::uint64_t dataSize)
+{
+    std::uint64_t offset =
+        mHeaderData.getSize() + mTotalDataSize;  // offset from the beginning of the box (including header)
+
+    mDataOffsetArray.push_back(offset);    // current offset
+    mDataLengthArray.push_back(dataSize);  // length of the data to be added
+
+    mTotalDataSize += dataSize;
+
+    updateSize(mHeaderData);
+    return offset;
+}
+
 void MediaDataBox::addNalData(const Vector<Vector<uint8_t>>& srcData)
 {
     std::uint64_t totalLen = 0;
@@ -139,11 +159,6 @@ void MediaDataBox::addNalData(const Vector<Vector<uint8_t>>& srcData)
 
 void MediaDataBox::addNalData(const Vector<uint8_t>& srcData)
 {
-    std::uint64_t startCodeLen;
-    std::uint64_t startCodePos;
-    std::uint64_t currPos  = 0;
-    std::uint64_t totalLen = 0;
-
     mDataOffsetArray.push_back(static_cast<std::uint64_t>(
         mHeaderData.getSize() + mTotalDataSize));  // record offset for the picture to be added
 
@@ -151,27 +166,7 @@ void MediaDataBox::addNalData(const Vector<uint8_t>& srcData)
     mediaDataEntry.reserve(srcData.size());
 
     // replace start codes with nal length fields
-    startCodeLen = findStartCode(srcData, 0, startCodePos);
-    currPos += startCodeLen;
-    while (currPos < srcData.size())
-    {
-        startCodeLen =
-            findStartCode(srcData, currPos, startCodePos);  // find next start code to determine NAL unit size
-        const std::uint64_t nalLen = startCodePos - currPos;
-
-        // write length field
-        mediaDataEntry.push_back(static_cast<uint8_t>((uint32_t(nalLen) >> 24) & 0xff));
-        mediaDataEntry.push_back(static_cast<uint8_t>((uint32_t(nalLen) >> 16) & 0xff));
-        mediaDataEntry.push_back(static_cast<uint8_t>((uint32_t(nalLen) >> 8) & 0xff));
-        mediaDataEntry.push_back(static_cast<uint8_t>(uint32_t(nalLen) & 0xff));
-
-        auto sourceIt = srcData.begin() + static_cast<Vector<uint8_t>::difference_type>(currPos);
-        mediaDataEntry.insert(mediaDataEntry.end(), sourceIt,
-                              sourceIt + static_cast<Vector<uint8_t>::difference_type>(nalLen));
-
-        currPos = startCodePos + startCodeLen;
-        totalLen += (nalLen + 4);
-    }
+    const std::uint64_t totalLen = appendByteStreamAsLengthPrefixed(srcData.data(), srcData.size(), mediaDataEntry);
 
     mMediaData.push_back(std::move(mediaDataEntry));
     mTotalDataSize += mMediaData.back().size();
@@ -180,44 +175,3 @@ void MediaDataBox::addNalData(const Vector<uint8_t>& srcData)
 
     updateSize(mHeaderData);
 }
-
-std::uint64_t MediaDataBox::findStartCode(const Vector<uint8_t>& srcData,
-                                          const std::uint64_t searchStartPos,
-                                          std::uint64_t& startCodePos)
-{
-    std::uint64_t i          = searchStartPos;
-    std::uint64_t len        = 0;
-    bool startCodeFound      = false;
-    const size_t srcDataSize = srcData.size();
-
-    while (i < srcDataSize && !startCodeFound)
-    {
-        const uint8_t byte = srcData[i];
-        if (byte == 0)
-        {
-            ++len;
-        }
-        else if (len > 1 && byte == 1)
-        {
-            ++len;
-            startCodeFound = true;
-        }
-        else
-        {
-            len = 0;
-        }
-        ++i;
-    }
-
-    if (startCodeFound)
-    {
-        startCodePos = i - len;
-    }
-    else
-    {
-        startCodePos = i;
-        len          = 0;
-    }
-
-    return len;
-}
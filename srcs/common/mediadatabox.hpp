@@ -41,6 +41,15 @@ public:
      *  @return Byte offset of the  start location of the media data with respect to the media data box. */
     std::uint64_t addData(const uint8_t* buffer, const uint64_t bufferSize);
 
+    /** @return Media data block added by the latest addData() call. */
+    const Vector<std::uint8_t>& getLastData() const;
+
+    /** @brief Account for media data which is stored outside the media data container.
+     *  @details Only box size is updated. The caller writes the data itself after the serialized box header.
+     *  @param [in] dataSize Size of the media data in bytes.
+     *  @return Byte offset of the  start location of the media data with respect to the media data box. */
+    std::uint64_t addExternalData(std::uint64_t dataSize);
+
     /** @brief Add a vector of NAL data to the media data container.
      *  @details Multiple NAL units can be written to the media data box at once by using this method.
      *           The data is inserted to the mData private member but not serialized until writeBox() is called.
@@ -75,12 +84,6 @@ private:
 
     Vector<std::uint64_t> mDataOffsetArray;  // offsets relative to the beginning of the media data box
     Vector<std::uint64_t> mDataLengthArray;  // vector of data lengths which are inserted to the media box
-
-    /** Returns the number of bytes in start code
-     * start code consists of any number of zero bytes (0x00) followed by a one (0x01) byte */
-    std::uint64_t findStartCode(const Vector<std::uint8_t>& srcData,
-                                std::uint64_t initPos,
-                                std::uint64_t& startCodePos);
 };
 
 #endif /* end of include guard: MEDIADATABOX_HPP */
@@ -119,6 +119,31 @@ void MediaInformationBox::writeBox(BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t MediaInformationBox::getSerializedSize() const
+{
+    std::uint64_t size = getBoxHeaderSize() + mDataInformationBox.getSerializedSize() +
+                         mSampleTableBox.getSerializedSize();
+    switch (mMediaType)
+    {
+    case MediaType::Null:
+    {
+        size += mNullMediaHeaderBox.getSerializedSize();
+        break;
+    }
+    case MediaType::Video:
+    {
+        size += mVideoMediaHeaderBox.getSerializedSize();
+        break;
+    }
+    case MediaType::Sound:
+    {
+        size += mSoundMediaHeaderBox.getSerializedSize();
+        break;
+    }
+    }
+    return size;
+}
+
 void MediaInformationBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
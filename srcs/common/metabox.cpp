@@ -252,6 +252,15 @@ void MetaBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t MetaBox::getSerializedSize() const
+{
+    return getFullBoxHeaderSize() + mHandlerBox.getSerializedSize() + mPrimaryItemBox.getSerializedSize() +
+           mItemLocationBox.getSerializedSize() + mItemProtectionBox.getSerializedSize() +
+           mItemInfoBox.getSerializedSize() + mItemReferenceBox.getSerializedSize() +
+           mItemDataBox.getSerializedSize() + mItemPropertiesBox.getSerializedSize() +
+           mGroupsListBox.getSerializedSize();
+}
+
 void MetaBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseFullBoxHeader(bitstr);
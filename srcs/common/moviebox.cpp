@@ -27,6 +27,7 @@ void MovieBox::clear()
 {
     mMovieHeaderBox = {};
     mTracks.clear();
+    mMovieExtendsBox.reset();
 }
 
 MovieHeaderBox& MovieBox::getMovieHeaderBox()
@@ -87,9 +88,28 @@ void MovieBox::writeBox(ISOBMFF::BitStream& bitstr) const
         track->writeBox(bitstr);
     }
 
+    if (mMovieExtendsBox)
+    {
+        mMovieExtendsBox->writeBox(bitstr);
+    }
+
     updateSize(bitstr);
 }
 
+std::uint64_t MovieBox::getSerializedSize() const
+{
+    std::uint64_t size = getBoxHeaderSize() + mMovieHeaderBox.getSerializedSize();
+    for (auto& track : mTracks)
+    {
+        size += track->getSerializedSize();
+    }
+    if (mMovieExtendsBox)
+    {
+        size += mMovieExtendsBox->getSerializedSize();
+    }
+    return size;
+}
+
 void MovieBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseBoxHeader(bitstr);
@@ -66,6 +66,12 @@ public:
      */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /**
+     * @brief Compute the serialized size from the sizes of the contained boxes.
+     * @see Box::getSerializedSize()
+     */
+    std::uint64_t getSerializedSize() const override;
+
     /**
      * @brief Deserialize box data from the ISOBMFF::BitStream.
      * @see Box::parseBox()
@@ -13,6 +13,245 @@
 
 #include "nalutil.hpp"
 
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NALUTIL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NALUTIL_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NALUTIL_NEON
+#endif
+
+std::uint64_t findZeroByte(const std::uint8_t* data, const std::uint64_t size)
+{
+    std::uint64_t i = 0;
+
+    // Skip blocks without zero bytes, the block with a zero byte is scanned byte by byte below.
+#if defined(NALUTIL_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero)) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(NALUTIL_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero)) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(NALUTIL_NEON)
+    for (; i + 16 <= size; i += 16)
+    {
+        if (vmaxvq_u8(vceqzq_u8(vld1q_u8(data + i))) != 0)
+        {
+            break;
+        }
+    }
+#else
+    const std::uint64_t ones  = 0x0101010101010101ull;
+    const std::uint64_t highs = 0x8080808080808080ull;
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (((word - ones) & ~word & highs) != 0)
+        {
+            break;
+        }
+    }
+#endif
+
+    while (i < size && data[i] != 0)
+    {
+        ++i;
+    }
+    return i;
+}
+
+std::uint64_t findNextStartCode(const std::uint8_t* data,
+                                const std::uint64_t size,
+                                const std::uint64_t searchStartPos,
+                                std::uint64_t& startCodePos)
+{
+    std::uint64_t i   = searchStartPos;
+    std::uint64_t len = 0;
+
+    while (i < size)
+    {
+        if (len == 0)
+        {
+            i += findZeroByte(data + i, size - i);
+            if (i == size)
+            {
+                break;
+            }
+        }
+
+        const std::uint8_t byte = data[i];
+        ++i;
+        if (byte == 0)
+        {
+            ++len;
+        }
+        else if (len > 1 && byte == 1)
+        {
+            ++len;
+            startCodePos = i - len;
+            return len;
+        }
+        else
+        {
+            len = 0;
+        }
+    }
+
+    startCodePos = size;
+    return 0;
+}
+
+std::uint64_t appendByteStreamAsLengthPrefixed(const std::uint8_t* data,
+                                               const std::uint64_t size,
+                                               Vector<std::uint8_t>& output)
+{
+    const std::size_t outputStart = output.size();
+    std::uint64_t startCodePos;
+    std::uint64_t currPos = findNextStartCode(data, size, 0, startCodePos);
+
+    while (currPos < size)
+    {
+        const std::uint64_t startCodeLen = findNextStartCode(data, size, currPos, startCodePos);
+        const auto nalLen                = static_cast<std::uint32_t>(startCodePos - currPos);
+
+        const std::size_t offset = output.size();
+        output.resize(offset + 4 + nalLen);
+        std::uint8_t* dst = output.data() + offset;
+        dst[0]            = static_cast<std::uint8_t>((nalLen >> 24) & 0xff);
+        dst[1]            = static_cast<std::uint8_t>((nalLen >> 16) & 0xff);
+        dst[2]            = static_cast<std::uint8_t>((nalLen >> 8) & 0xff);
+        dst[3]            = static_cast<std::uint8_t>(nalLen & 0xff);
+        std::memcpy(dst + 4, data + currPos, nalLen);
+
+        currPos = startCodePos + startCodeLen;
+    }
+
+    return output.size() - outputStart;
+}
+
+bool getByteStreamSize(const std::uint8_t* data,
+                       const std::uint64_t size,
+                       const unsigned int lengthSize,
+                       std::uint64_t& byteStreamSize)
+{
+    if (lengthSize < 1 || lengthSize > 4)
+    {
+        return false;
+    }
+
+    std::uint64_t nalCount = 0;
+    std::uint64_t pos      = 0;
+    while (pos < size)
+    {
+        if (size - pos < lengthSize)
+        {
+            return false;
+        }
+        std::uint32_t nalLength = 0;
+        for (unsigned int i = 0; i < lengthSize; ++i)
+        {
+            nalLength = (nalLength << 8) | data[pos + i];
+        }
+        pos += lengthSize;
+        if (size - pos < nalLength)
+        {
+            return false;
+        }
+        pos += nalLength;
+        ++nalCount;
+    }
+
+    byteStreamSize = size + nalCount * (4 - lengthSize);
+    return true;
+}
+
+bool convertLengthPrefixedToByteStream(std::uint8_t* data,
+                                       std::uint64_t& size,
+                                       const std::uint64_t capacity,
+                                       const unsigned int lengthSize)
+{
+    std::uint64_t byteStreamSize;
+    if (!getByteStreamSize(data, size, lengthSize, byteStreamSize))
+    {
+        return false;
+    }
+    if (byteStreamSize > capacity)
+    {
+        size = byteStreamSize;
+        return false;
+    }
+
+    if (lengthSize == 4)
+    {
+        // Lengths are overwritten with start codes, without moving the NAL units.
+        for (std::uint64_t pos = 0; pos < size;)
+        {
+            const std::uint32_t nalLength = (static_cast<std::uint32_t>(data[pos]) << 24) |
+                                            (static_cast<std::uint32_t>(data[pos + 1]) << 16) |
+                                            (static_cast<std::uint32_t>(data[pos + 2]) << 8) | data[pos + 3];
+            data[pos]     = 0;
+            data[pos + 1] = 0;
+            data[pos + 2] = 0;
+            data[pos + 3] = 1;
+            pos += 4 + std::uint64_t(nalLength);
+        }
+        return true;
+    }
+
+    // Record NAL unit positions first, then move the units towards the end starting from the last one, so that no
+    // unit is overwritten before it has been moved.
+    Vector<std::uint64_t> nalPositions;
+    for (std::uint64_t pos = 0; pos < size;)
+    {
+        nalPositions.push_back(pos);
+        std::uint32_t nalLength = 0;
+        for (unsigned int i = 0; i < lengthSize; ++i)
+        {
+            nalLength = (nalLength << 8) | data[pos + i];
+        }
+        pos += lengthSize + std::uint64_t(nalLength);
+    }
+
+    std::uint64_t end = size;
+    std::uint64_t dst = byteStreamSize;
+    for (auto position = nalPositions.rbegin(); position != nalPositions.rend(); ++position)
+    {
+        const std::uint64_t nalStart  = *position + lengthSize;
+        const std::uint64_t nalLength = end - nalStart;
+        dst -= nalLength;
+        std::memmove(data + dst, data + nalStart, static_cast<std::size_t>(nalLength));
+        dst -= 4;
+        data[dst]     = 0;
+        data[dst + 1] = 0;
+        data[dst + 2] = 0;
+        data[dst + 3] = 1;
+        end           = *position;
+    }
+
+    size = byteStreamSize;
+    return true;
+}
+
 unsigned int findStartCodeLen(const Vector<uint8_t>& data)
 {
     unsigned int i      = 0;
@@ -57,62 +296,39 @@ bool convertByteStreamToRBSP(const Vector<uint8_t>& byteStr, Vector<uint8_t>& ou
     i += NALU_HEADER_LENGTH;
 
     // copy rest of the data while removing start code emulation prevention bytes
-    enum class State
-    {
-        COPY_DATA,
-        ONE_ZERO_FOUND,
-        TWO_ZEROS_FOUND
-    };
-    State state         = State::COPY_DATA;
-    int copyStartOffset = static_cast<int>(i);
-    for (; i < numBytesInNalUnit; ++i)
+    // sequence of 0x000003 means that 0x03 is the emulation prevention byte
+    unsigned int zeroCount = 0;
+    int copyStartOffset    = static_cast<int>(i);
+    while (i < numBytesInNalUnit)
     {
-        const unsigned int byte = byteStr[i];
-        switch (state)
+        if (zeroCount == 0)
         {
-        case State::COPY_DATA:
-            if (byte != 0)
-            {
-                state = State::COPY_DATA;
-            }
-            else
-            {
-                state = State::ONE_ZERO_FOUND;
-            }
-            break;
-
-        case State::ONE_ZERO_FOUND:
-            if (byte != 0)
-            {
-                state = State::COPY_DATA;
-            }
-            else
+            // bytes other than zero can not start an emulation prevention sequence
+            i += static_cast<uint32_t>(findZeroByte(byteStr.data() + i, numBytesInNalUnit - i));
+            if (i == numBytesInNalUnit)
             {
-                state = State::TWO_ZEROS_FOUND;
+                break;
             }
-            break;
+        }
 
-        case State::TWO_ZEROS_FOUND:
-            // sequence of 0x000003 means that 0x03 is the emulation prevention byte
-            if (byte == 0x03)
-            {
-                // skip copying 0x03
-                output.insert(output.end(), byteStr.cbegin() + copyStartOffset,
-                              byteStr.cbegin() + static_cast<int32_t>(i));
-                copyStartOffset = static_cast<int32_t>(i) + 1;
-                // continue byte stream copying
-                state = State::COPY_DATA;
-            }
-            else if (byte == 0)
-            {
-                state = State::TWO_ZEROS_FOUND;
-            }
-            else
-            {
-                state = State::COPY_DATA;
-            }
-            break;
+        const unsigned int byte = byteStr[i];
+        if (zeroCount == 2 && byte == 0x03)
+        {
+            // skip copying 0x03
+            output.insert(output.end(), byteStr.cbegin() + copyStartOffset,
+                          byteStr.cbegin() + static_cast<int32_t>(i));
+            copyStartOffset = static_cast<int32_t>(i) + 1;
+            zeroCount       = 0;
+        }
+        else if (byte == 0)
+        {
+            zeroCount = (zeroCount == 2) ? 2 : zeroCount + 1;
         }
+        else
+        {
+            zeroCount = 0;
+        }
+        ++i;
     }
     output.insert(output.end(), byteStr.cbegin() + copyStartOffset, byteStr.cend());
     return true;
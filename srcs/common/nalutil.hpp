@@ -14,8 +14,77 @@
 #ifndef NALUTIL_HPP
 #define NALUTIL_HPP
 
+#include <cstdint>
+
 #include "customallocator.hpp"
 
+/**
+ * @brief Returns the position of the first zero byte.
+ * @details The scan is done 16 or 32 bytes at a time with SSE2, AVX2 or NEON instructions when the build target
+ * supports them, and 8 bytes at a time otherwise. Locating zero bytes is the costly part of finding start codes and
+ * emulation prevention bytes, as both begin with two zero bytes.
+ * @param data Data to search from
+ * @param size Size of the data in bytes
+ * @return Position of the first zero byte, size if there is none.
+ */
+std::uint64_t findZeroByte(const std::uint8_t* data, std::uint64_t size);
+
+/**
+ * @brief Finds the next start code.
+ * @details Start code consists of two or more zero bytes (0x00) followed by a one (0x01) byte.
+ * @param data           Byte stream to search from
+ * @param size           Size of the byte stream in bytes
+ * @param searchStartPos Position to start the search from
+ * @param startCodePos   [out] Position of the first byte of the start code, size if a start code is not found.
+ * @return Number of bytes in start code. 0 if a start code is not found.
+ */
+std::uint64_t findNextStartCode(const std::uint8_t* data,
+                                std::uint64_t size,
+                                std::uint64_t searchStartPos,
+                                std::uint64_t& startCodePos);
+
+/**
+ * @brief Appends NAL units of a byte stream to output, with each start code replaced by a 4 byte NAL unit length.
+ * @details The byte stream is expected to begin with a start code. Data without start codes is appended as a single
+ * NAL unit.
+ * @param data   Byte stream to convert
+ * @param size   Size of the byte stream in bytes
+ * @param output Vector to append the NAL units to
+ * @return Number of bytes appended
+ */
+std::uint64_t appendByteStreamAsLengthPrefixed(const std::uint8_t* data,
+                                               std::uint64_t size,
+                                               Vector<std::uint8_t>& output);
+
+/**
+ * @brief Calculates the size of NAL unit data after NAL unit lengths are replaced with 4 byte start codes.
+ * @param data           NAL units, each preceded by its length
+ * @param size           Size of the NAL unit data in bytes
+ * @param lengthSize     Size of the NAL unit length fields in bytes (lengthSizeMinusOne + 1), 1 to 4
+ * @param byteStreamSize [out] Size of the data as a byte stream
+ * @return False if NAL unit lengths exceed the data size. True in success.
+ */
+bool getByteStreamSize(const std::uint8_t* data,
+                       std::uint64_t size,
+                       unsigned int lengthSize,
+                       std::uint64_t& byteStreamSize);
+
+/**
+ * @brief Replaces NAL unit lengths with 4 byte start codes (0x00000001), in place.
+ * @details With length fields shorter than 4 bytes the data grows, and NAL units are moved towards the end of the
+ * buffer. Data is not changed if the conversion fails.
+ * @param data       NAL units, each preceded by its length. Converted to a byte stream.
+ * @param size       [in,out] Size of the NAL unit data in bytes. Size of the byte stream on return, also when the
+ *                   buffer is too small.
+ * @param capacity   Size of the buffer pointed to by data
+ * @param lengthSize Size of the NAL unit length fields in bytes (lengthSizeMinusOne + 1), 1 to 4
+ * @return False if NAL unit lengths exceed the data size, or the byte stream does not fit to the buffer.
+ */
+bool convertLengthPrefixedToByteStream(std::uint8_t* data,
+                                       std::uint64_t& size,
+                                       std::uint64_t capacity,
+                                       unsigned int lengthSize);
+
 /**
  * @brief Returns the number of bytes in start code
  * @details Start code consists of any number of zero bytes (0x00) followed by a
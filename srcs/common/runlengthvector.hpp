@@ -0,0 +1,215 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef RUNLENGTHVECTOR_HPP
+#define RUNLENGTHVECTOR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "customallocator.hpp"
+
+/** Append-only sequence that stores consecutive equal values as a single run. Appending is amortized constant time
+ * and random access does a binary search over the runs, so memory use and lookup cost depend on the number of runs
+ * rather than the number of elements. */
+template <typename T>
+class RunLengthVector
+{
+public:
+    typedef T value_type;
+
+    RunLengthVector();
+
+    /** Appends a value. Extends the last run if the value equals its value. */
+    void push_back(const T& value);
+
+    /** Appends count copies of a value. */
+    void append(std::size_t count, const T& value);
+
+    /** @return Value of the element at index. Index must be smaller than size(). */
+    const T& operator[](std::size_t index) const;
+
+    /** @return Value of the element at index
+     *  @throws std::out_of_range if index is not smaller than size() */
+    const T& at(std::size_t index) const;
+
+    const T& back() const;
+
+    /** @return Index of the first element equal to value, or size() if there is none */
+    std::size_t find(const T& value) const;
+
+    std::size_t size() const;
+    bool empty() const;
+
+    /** @return Number of runs the elements are stored as */
+    std::size_t runCount() const;
+
+    /** @return Number of bytes allocated for the runs */
+    std::size_t allocatedSize() const;
+
+    /** @return Index of the first element of each run, ascending */
+    const Vector<std::size_t>& runStarts() const;
+
+    /** @return Value of each run */
+    const Vector<T>& runValues() const;
+
+    /** Replaces the contents with runs, e.g. ones got from runStarts() and runValues() of another vector.
+     *  @throws std::invalid_argument if the runs do not cover exactly size elements starting from index 0 */
+    void assignRuns(Vector<std::size_t> runStarts, Vector<T> runValues, std::size_t size);
+
+    void clear();
+    void shrink_to_fit();
+
+private:
+    Vector<std::size_t> mRunStarts;  ///< Index of the first element of each run, ascending
+    Vector<T> mRunValues;            ///< Value of each run
+    std::size_t mSize;               ///< Total number of elements
+};
+
+template <typename T>
+RunLengthVector<T>::RunLengthVector()
+    : mRunStarts()
+    , mRunValues()
+    , mSize(0)
+{
+}
+
+template <typename T>
+void RunLengthVector<T>::push_back(const T& value)
+{
+    append(1, value);
+}
+
+template <typename T>
+void RunLengthVector<T>::append(const std::size_t count, const T& value)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (mRunValues.empty() || !(mRunValues.back() == value))
+    {
+        mRunStarts.push_back(mSize);
+        mRunValues.push_back(value);
+    }
+    mSize += count;
+}
+
+template <typename T>
+const T& RunLengthVector<T>::operator[](const std::size_t index) const
+{
+    const auto run = std::upper_bound(mRunStarts.cbegin(), mRunStarts.cend(), index);
+    return mRunValues[static_cast<std::size_t>(run - mRunStarts.cbegin()) - 1];
+}
+
+template <typename T>
+const T& RunLengthVector<T>::at(const std::size_t index) const
+{
+    if (index >= mSize)
+    {
+        throw std::out_of_range("RunLengthVector::at");
+    }
+    return (*this)[index];
+}
+
+template <typename T>
+const T& RunLengthVector<T>::back() const
+{
+    return mRunValues.back();
+}
+
+template <typename T>
+std::size_t RunLengthVector<T>::find(const T& value) const
+{
+    for (std::size_t run = 0; run < mRunValues.size(); ++run)
+    {
+        if (mRunValues[run] == value)
+        {
+            return mRunStarts[run];
+        }
+    }
+    return mSize;
+}
+
+template <typename T>
+std::size_t RunLengthVector<T>::size() const
+{
+    return mSize;
+}
+
+template <typename T>
+bool RunLengthVector<T>::empty() const
+{
+    return mSize == 0;
+}
+
+template <typename T>
+std::size_t RunLengthVector<T>::runCount() const
+{
+    return mRunValues.size();
+}
+
+template <typename T>
+std::size_t RunLengthVector<T>::allocatedSize() const
+{
+    return mRunStarts.capacity() * sizeof(std::size_t) + mRunValues.capacity() * sizeof(T);
+}
+
+template <typename T>
+const Vector<std::size_t>& RunLengthVector<T>::runStarts() const
+{
+    return mRunStarts;
+}
+
+template <typename T>
+const Vector<T>& RunLengthVector<T>::runValues() const
+{
+    return mRunValues;
+}
+
+template <typename T>
+void RunLengthVector<T>::assignRuns(Vector<std::size_t> runStarts, Vector<T> runValues, const std::size_t size)
+{
+    bool valid = (runStarts.size() == runValues.size()) && (runStarts.empty() == (size == 0)) &&
+                 (runStarts.empty() || runStarts.front() == 0);
+    for (std::size_t run = 1; valid && run < runStarts.size(); ++run)
+    {
+        valid = (runStarts[run - 1] < runStarts[run]) && (runStarts[run] < size);
+    }
+    if (!valid)
+    {
+        throw std::invalid_argument("RunLengthVector::assignRuns");
+    }
+    mRunStarts = std::move(runStarts);
+    mRunValues = std::move(runValues);
+    mSize      = size;
+}
+
+template <typename T>
+void RunLengthVector<T>::clear()
+{
+    mRunStarts.clear();
+    mRunValues.clear();
+    mSize = 0;
+}
+
+template <typename T>
+void RunLengthVector<T>::shrink_to_fit()
+{
+    mRunStarts.shrink_to_fit();
+    mRunValues.shrink_to_fit();
+}
+
+#endif /* end of include guard: RUNLENGTHVECTOR_HPP */
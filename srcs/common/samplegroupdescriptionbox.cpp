@@ -114,6 +114,17 @@ void SampleGroupDescriptionBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SampleGroupDescriptionBox::getSerializedSize() const
+{
+    const bool writeLengths = (getVersion() == 1) && (mDefaultLength == 0);
+    std::uint64_t size      = getFullBoxHeaderSize() + (getVersion() == 1 ? 12 : 8);
+    for (auto& entry : mSampleGroupEntry)
+    {
+        size += (writeLengths ? 4 : 0) + entry->getSize();
+    }
+    return size;
+}
+
 void SampleGroupDescriptionBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
@@ -79,6 +79,11 @@ void SampleSizeBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SampleSizeBox::getSerializedSize() const
+{
+    return getFullBoxHeaderSize() + 8 + 4 * static_cast<std::uint64_t>(mSampleCount);
+}
+
 void SampleSizeBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
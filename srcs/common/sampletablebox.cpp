@@ -218,6 +218,34 @@ void SampleTableBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SampleTableBox::getSerializedSize() const
+{
+    std::uint64_t size = getBoxHeaderSize() + mSampleDescriptionBox.getSerializedSize() +
+                         mSampleSizeBox.getSerializedSize() + mTimeToSampleBox.getSerializedSize() +
+                         mSampleToChunkBox.getSerializedSize() + mChunkOffsetBox.getSerializedSize();
+    if (mSyncSampleBox != nullptr)
+    {
+        size += mSyncSampleBox->getSerializedSize();
+    }
+    if (mCompositionOffsetBox != nullptr)
+    {
+        size += mCompositionOffsetBox->getSerializedSize();
+    }
+    if (mCompositionToDecodeBox != nullptr)
+    {
+        size += mCompositionToDecodeBox->getSerializedSize();
+    }
+    for (auto& sgpd : mSampleGroupDescriptionBoxes)
+    {
+        size += sgpd->getSerializedSize();
+    }
+    for (auto& sbgp : mSampleToGroupBoxes)
+    {
+        size += sbgp.getSerializedSize();
+    }
+    return size;
+}
+
 void SampleTableBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
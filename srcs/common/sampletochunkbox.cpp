@@ -13,6 +13,7 @@
 
 #include "sampletochunkbox.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
 
@@ -21,29 +22,46 @@ using namespace std;
 SampleToChunkBox::SampleToChunkBox()
     : FullBox("stsc", 0, 0)
     , mRunOfChunks()
+    , mDecodedRuns()
+    , mDecodedSampleCount(0)
     , mMaxSampleCount(-1)
 {
 }
 
+const SampleToChunkBox::DecodedRun* SampleToChunkBox::findRun(const std::uint32_t sampleIndex) const
+{
+    if (sampleIndex >= mDecodedSampleCount)
+    {
+        return nullptr;
+    }
+
+    const auto run = std::upper_bound(
+        mDecodedRuns.cbegin(), mDecodedRuns.cend(), sampleIndex,
+        [](const std::uint64_t index, const DecodedRun& decodedRun) { return index < decodedRun.firstSample; });
+    return &*(run - 1);
+}
+
 bool SampleToChunkBox::getSampleDescriptionIndex(std::uint32_t sampleIndex, std::uint32_t& sampleDescriptionIdx) const
 {
-    if (sampleIndex >= mDecodedEntries.size())
+    const DecodedRun* run = findRun(sampleIndex);
+    if (run == nullptr)
     {
         return false;
     }
 
-    sampleDescriptionIdx = mDecodedEntries.at(sampleIndex).sampleDescriptionIndex;
+    sampleDescriptionIdx = run->sampleDescriptionIndex;
     return true;
 }
 
 bool SampleToChunkBox::getSampleChunkIndex(std::uint32_t sampleIndex, std::uint32_t& chunkIdx) const
 {
-    if (sampleIndex >= mDecodedEntries.size())
+    const DecodedRun* run = findRun(sampleIndex);
+    if (run == nullptr)
     {
         return false;
     }
 
-    chunkIdx = mDecodedEntries.at(sampleIndex).chunkIndex;
+    chunkIdx = run->firstChunk + static_cast<std::uint32_t>((sampleIndex - run->firstSample) / run->samplesPerChunk);
     return true;
 }
 
@@ -72,6 +90,11 @@ void SampleToChunkBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SampleToChunkBox::getSerializedSize() const
+{
+    return getFullBoxHeaderSize() + 4 + 12 * static_cast<std::uint64_t>(mRunOfChunks.size());
+}
+
 void SampleToChunkBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseFullBoxHeader(bitstr);
@@ -146,7 +169,8 @@ uint32_t SampleToChunkBox::getSampleCountLowerBound(uint32_t chunkEntryCount) co
 
 void SampleToChunkBox::decodeEntries(std::uint32_t chunkEntryCount)
 {
-    mDecodedEntries.clear();
+    mDecodedRuns.clear();
+    mDecodedSampleCount = 0;
 
     if (mRunOfChunks.size() == 0 || chunkEntryCount == 0)
     {
@@ -187,16 +211,15 @@ void SampleToChunkBox::decodeEntries(std::uint32_t chunkEntryCount)
             throw RuntimeError("SampleToChunkBox::parseBox samplesPerChunk is larger than total number of samples");
         }
 
-        DecodedEntry entry;
-        entry.samplesPerChunk        = samplesPerChunk;
-        entry.sampleDescriptionIndex = sampleDescriptionIndex;
-        for (unsigned int i = 0; i < chunkRepetitions; ++i)
+        DecodedRun run;
+        run.firstSample            = mDecodedSampleCount;
+        run.firstChunk             = firstChunk;
+        run.samplesPerChunk        = samplesPerChunk;
+        run.sampleDescriptionIndex = sampleDescriptionIndex;
+        if ((chunkRepetitions > 0) && (samplesPerChunk > 0))
         {
-            entry.chunkIndex = firstChunk + i;
-            for (unsigned int k = 0; k < samplesPerChunk; ++k)
-            {
-                mDecodedEntries.push_back(entry);
-            }
+            mDecodedRuns.push_back(run);
+            mDecodedSampleCount += std::uint64_t(samplesPerChunk) * chunkRepetitions;
         }
     }
 }
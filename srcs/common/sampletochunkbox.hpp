@@ -57,6 +57,10 @@ public:
      *  @param [out] bitstr Bitstream that contains the box data. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the number of chunk runs
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses a SampleToChunkBox bitstream and fills in the necessary member variables
      *  @param [in]  bitstr Bitstream that contains the box data. */
     void parseBox(ISOBMFF::BitStream& bitstr) override;
@@ -66,23 +70,30 @@ public:
     */
     uint32_t getSampleCountLowerBound(uint32_t chunkEntryCount) const;
 
-    /** @brief Decodes the representation of ChunkEntries. Each sample wil have an own entry after this.
+    /** @brief Decodes the representation of ChunkEntries to sample-indexed runs for the sample lookups.
      *  @param [in] chunkEntryCount number of total chunk entries from 'stco' */
     void decodeEntries(std::uint32_t chunkEntryCount);
 
 private:
     Vector<ChunkEntry> mRunOfChunks;  ///< Vector that contains the chunk entries
 
-    /// Run-length decoded chunk entries
-    struct DecodedEntry
+    /// Chunk entry resolved to the range of samples it covers
+    struct DecodedRun
     {
-        std::uint32_t chunkIndex;
+        std::uint64_t firstSample;  ///< 0-based index of the first sample of the run
+        std::uint32_t firstChunk;   ///< 1-based index of the first chunk of the run
         std::uint32_t samplesPerChunk;
         std::uint32_t sampleDescriptionIndex;
     };
 
-    /// A decoded representation of ChunkEntries. Each sample has an own entry here.
-    Vector<DecodedEntry> mDecodedEntries;
+    /** @brief Find the decoded run containing a sample.
+     *  @param [in] sampleIndex Sample index value.
+     *  @return Pointer to the run, or nullptr if the sample is not covered by the box */
+    const DecodedRun* findRun(std::uint32_t sampleIndex) const;
+
+    /// A decoded representation of ChunkEntries, ordered by the first sample of each run.
+    Vector<DecodedRun> mDecodedRuns;
+    std::uint64_t mDecodedSampleCount;  ///< Number of samples covered by mDecodedRuns
 
     int64_t mMaxSampleCount;
 };
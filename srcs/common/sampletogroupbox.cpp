@@ -21,6 +21,7 @@ SampleToGroupBox::SampleToGroupBox()
     , mEntryCount(0)
     , mGroupingTypeParameter(0)
     , mRunOfSamples()
+    , mSampleToGroupIndex()
 {
 }
 
@@ -61,9 +62,9 @@ void SampleToGroupBox::addSampleRun(std::uint32_t sampleCount, std::uint32_t gro
     sampleRun.groupDescriptionIndex = groupDescriptionIndex;
 
     mRunOfSamples.push_back(sampleRun);
+    mSampleToGroupIndex.append(sampleCount, groupDescriptionIndex);
 
     setEntryCount(static_cast<unsigned int>(mRunOfSamples.size()));
-    updateInternalIndex();
 }
 
 std::uint32_t SampleToGroupBox::getSampleGroupDescriptionIndex(const std::uint32_t sampleIndex) const
@@ -74,17 +75,15 @@ std::uint32_t SampleToGroupBox::getSampleGroupDescriptionIndex(const std::uint32
         return 0;
     }
 
-    return mSampleToGroupIndex.at(sampleIndex);
+    return mSampleToGroupIndex[sampleIndex];
 }
 
 std::uint32_t SampleToGroupBox::getSampleId(std::uint32_t groupDescriptionIndex) const
 {
-    for (unsigned int i = 0; i < mSampleToGroupIndex.size(); ++i)
+    const std::size_t sampleIndex = mSampleToGroupIndex.find(groupDescriptionIndex);
+    if (sampleIndex < mSampleToGroupIndex.size())
     {
-        if (groupDescriptionIndex == mSampleToGroupIndex.at(i))
-        {
-            return i;
-        }
+        return static_cast<std::uint32_t>(sampleIndex);
     }
 
     throw RuntimeError("SampleToGroupBox::getSampleId: no entry for requested sample id");
@@ -95,15 +94,6 @@ unsigned int SampleToGroupBox::getNumberOfSamples() const
     return static_cast<unsigned int>(mSampleToGroupIndex.size());
 }
 
-void SampleToGroupBox::updateInternalIndex()
-{
-    mSampleToGroupIndex.clear();
-    for (const auto& sampleRun : mRunOfSamples)
-    {
-        mSampleToGroupIndex.insert(mSampleToGroupIndex.end(), sampleRun.sampleCount, sampleRun.groupDescriptionIndex);
-    }
-}
-
 void SampleToGroupBox::writeBox(ISOBMFF::BitStream& bitstr) const
 {
     if (mRunOfSamples.size() == 0)
@@ -132,6 +122,12 @@ void SampleToGroupBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SampleToGroupBox::getSerializedSize() const
+{
+    return getFullBoxHeaderSize() + (getVersion() == 1 ? 12 : 8) +
+           8 * static_cast<std::uint64_t>(mRunOfSamples.size());
+}
+
 void SampleToGroupBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseFullBoxHeader(bitstr);
@@ -161,7 +157,6 @@ void SampleToGroupBox::parseBox(ISOBMFF::BitStream& bitstr)
         }
         sampleRun.groupDescriptionIndex = bitstr.read32Bits();
         mRunOfSamples.push_back(sampleRun);
+        mSampleToGroupIndex.append(sampleRun.sampleCount, sampleRun.groupDescriptionIndex);
     }
-
-    updateInternalIndex();
 }
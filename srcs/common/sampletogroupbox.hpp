@@ -17,6 +17,7 @@
 #include "bitstream.hpp"
 #include "customallocator.hpp"
 #include "fullbox.hpp"
+#include "runlengthvector.hpp"
 
 
 /** @brief SampleToGroupBox class. Extends from FullBox.
@@ -32,6 +33,10 @@ public:
      *  @throws Run-time Error of the box has no entries. */
     void writeBox(ISOBMFF::BitStream& bitstr) const override;
 
+    /** @brief Computes the serialized size from the number of sample runs
+     *  @see Box::getSerializedSize() */
+    std::uint64_t getSerializedSize() const override;
+
     /** @brief Parses a SampleToGroupBox bitstream and fills in the necessary member variables
      *  @param [in] bitstr Bitstream that contains the box data
      *  @throws Run-time Error of the box has no entries. */
@@ -95,11 +100,8 @@ private:
     };
     Vector<SampleRun> mRunOfSamples;  ///< Vector of sample IDs in the sample run
 
-    /// Internal structure, flattened mRunOfSamples
-    Vector<std::uint32_t> mSampleToGroupIndex;
-
-    /// Update mSampleToGroupIndex after mRunOfSamples has been edited
-    void updateInternalIndex();
+    /// Group description index of each sample, looked up by sample index
+    RunLengthVector<std::uint32_t> mSampleToGroupIndex;
 };
 
 #endif /* end of include guard: SAMPLETOGROUPBOX_HPP */
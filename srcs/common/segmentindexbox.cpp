@@ -87,7 +87,8 @@ Vector<SegmentIndexBox::Reference> SegmentIndexBox::getReferences() const
 void SegmentIndexBox::writeBox(BitStream& bitstr) const
 {
     const uint32_t referenceSize = 3 * 4;
-    const auto reserveBytes      = static_cast<uint32_t>((mReserveTotal - mReferences.size()) * referenceSize);
+    const auto reserveBytes =
+        mReserveTotal != 0 ? static_cast<uint32_t>((mReserveTotal - mReferences.size()) * referenceSize) : 0u;
 
     writeFullBoxHeader(bitstr);
     bitstr.write32Bits(mReferenceID);
@@ -0,0 +1,164 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "statistics.hpp"
+
+#include <cstring>
+
+namespace HEIF
+{
+    namespace
+    {
+        struct ThreadState
+        {
+            ThreadCounters counters;
+            std::uint32_t scopes;  ///< Number of active scopes of the thread.
+            std::uint32_t calls;   ///< Number of active call scopes of the thread.
+        };
+
+        thread_local ThreadState threadState = {};
+
+        ThreadCounters difference(const ThreadCounters& end, const ThreadCounters& start)
+        {
+            ThreadCounters counters;
+            counters.allocations    = end.allocations - start.allocations;
+            counters.allocatedBytes = end.allocatedBytes - start.allocatedBytes;
+            counters.streamReads    = end.streamReads - start.streamReads;
+            counters.streamSeeks    = end.streamSeeks - start.streamSeeks;
+            counters.streamWrites   = end.streamWrites - start.streamWrites;
+            counters.bytesRead      = end.bytesRead - start.bytesRead;
+            counters.bytesWritten   = end.bytesWritten - start.bytesWritten;
+            counters.boxesParsed    = end.boxesParsed - start.boxesParsed;
+            counters.boxesWritten   = end.boxesWritten - start.boxesWritten;
+            return counters;
+        }
+    }  // namespace
+
+#if !HEIF_DISABLE_STATISTICS
+    ThreadCounters* getThreadCounters()
+    {
+        return threadState.scopes ? &threadState.counters : nullptr;
+    }
+#endif
+
+    StatisticsCollector* createStatisticsCollector(const bool enabled)
+    {
+#if HEIF_DISABLE_STATISTICS
+        (void) enabled;
+        return nullptr;
+#else
+        return enabled ? CUSTOM_NEW(StatisticsCollector, ()) : nullptr;
+#endif
+    }
+
+    StatisticsCollector::StatisticsCollector()
+        : mMutex()
+        , mTotal()
+        , mCalls()
+        , mPhases()
+    {
+    }
+
+    void StatisticsCollector::add(const char* name,
+                                  const bool isCall,
+                                  const std::uint64_t timeNs,
+                                  const ThreadCounters& counters)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (isCall)
+        {
+            accumulate(mTotal, timeNs, counters);
+            accumulate(find(mCalls, name), timeNs, counters);
+        }
+        else
+        {
+            accumulate(find(mPhases, name), timeNs, counters);
+        }
+    }
+
+    void StatisticsCollector::get(CallStatistics& total,
+                                  Array<CallStatistics>& calls,
+                                  Array<CallStatistics>& phases) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        total  = mTotal;
+        calls  = Array<CallStatistics>(mCalls.begin(), mCalls.end());
+        phases = Array<CallStatistics>(mPhases.begin(), mPhases.end());
+    }
+
+    void StatisticsCollector::accumulate(CallStatistics& statistics,
+                                         const std::uint64_t timeNs,
+                                         const ThreadCounters& counters)
+    {
+        ++statistics.count;
+        statistics.timeNs += timeNs;
+        statistics.allocations += counters.allocations;
+        statistics.allocatedBytes += counters.allocatedBytes;
+        statistics.streamReads += counters.streamReads;
+        statistics.streamSeeks += counters.streamSeeks;
+        statistics.streamWrites += counters.streamWrites;
+        statistics.bytesRead += counters.bytesRead;
+        statistics.bytesWritten += counters.bytesWritten;
+        statistics.boxesParsed += counters.boxesParsed;
+        statistics.boxesWritten += counters.boxesWritten;
+    }
+
+    CallStatistics& StatisticsCollector::find(Vector<CallStatistics>& entries, const char* name)
+    {
+        // There are only some tens of distinct names, so a linear search is enough.
+        for (auto& entry : entries)
+        {
+            if (entry.name == name || std::strcmp(entry.name, name) == 0)
+            {
+                return entry;
+            }
+        }
+        entries.push_back(CallStatistics());
+        entries.back().name = name;
+        return entries.back();
+    }
+
+    void StatisticsScope::start(StatisticsCollector* collector, const char* name, const Kind kind)
+    {
+        if (kind == Kind::CALL)
+        {
+            if (threadState.calls > 0)
+            {
+                return;
+            }
+            ++threadState.calls;
+        }
+        ++threadState.scopes;
+
+        mCollector     = collector;
+        mName          = name;
+        mKind          = kind;
+        mStartCounters = threadState.counters;
+        mStartTime     = std::chrono::steady_clock::now();
+    }
+
+    void StatisticsScope::stop()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - mStartTime;
+        const auto timeNs  = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        const bool isCall  = mKind == Kind::CALL;
+        if (isCall)
+        {
+            --threadState.calls;
+        }
+        --threadState.scopes;
+
+        const ThreadCounters counters = difference(threadState.counters, mStartCounters);
+        mCollector->add(mName, isCall, static_cast<std::uint64_t>(timeNs), counters);
+    }
+}  // namespace HEIF
@@ -0,0 +1,130 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "../api/common/heifcommondatatypes.h"
+#include "customallocator.hpp"
+
+namespace HEIF
+{
+    /** Counters of one thread. Incremented by the allocator, streams and boxes while a StatisticsScope is active on the
+     * thread, so that the counters can be attributed to the running public call without passing state around. */
+    struct ThreadCounters
+    {
+        std::uint64_t allocations;
+        std::uint64_t allocatedBytes;
+        std::uint64_t streamReads;
+        std::uint64_t streamSeeks;
+        std::uint64_t streamWrites;
+        std::uint64_t bytesRead;
+        std::uint64_t bytesWritten;
+        std::uint64_t boxesParsed;
+        std::uint64_t boxesWritten;
+    };
+
+    /** @return Counters of the calling thread, or nullptr if no StatisticsScope is active on the thread. Always
+     * nullptr when built with HEIF_DISABLE_STATISTICS, so that the counting compiles out. */
+#if HEIF_DISABLE_STATISTICS
+    inline ThreadCounters* getThreadCounters()
+    {
+        return nullptr;
+    }
+#else
+    ThreadCounters* getThreadCounters();
+#endif
+
+    /** Statistics of public calls and phases of one Reader or Writer instance. Scopes may be added from several threads
+     * concurrently. */
+    class StatisticsCollector
+    {
+    public:
+        StatisticsCollector();
+        ~StatisticsCollector() = default;
+
+        /** Add one finished scope.
+         * @param [in] name      Name of the call or phase. Must stay valid for the life time of the collector.
+         * @param [in] isCall    True for public calls, false for phases.
+         * @param [in] timeNs    Duration of the scope.
+         * @param [in] counters  Thread counters accumulated during the scope. */
+        void add(const char* name, bool isCall, std::uint64_t timeNs, const ThreadCounters& counters);
+
+        /** Get the collected statistics.
+         * @param [out] total  Sum of all calls.
+         * @param [out] calls  Statistics of each call, in the order they were first added.
+         * @param [out] phases Statistics of each phase, in the order they were first added. */
+        void get(CallStatistics& total, Array<CallStatistics>& calls, Array<CallStatistics>& phases) const;
+
+    private:
+        static void accumulate(CallStatistics& statistics, std::uint64_t timeNs, const ThreadCounters& counters);
+        static CallStatistics& find(Vector<CallStatistics>& entries, const char* name);
+
+        mutable std::mutex mMutex;
+        CallStatistics mTotal;
+        Vector<CallStatistics> mCalls;
+        Vector<CallStatistics> mPhases;
+    };
+
+    /** @return A new collector if enabled is true and statistics are built in, otherwise nullptr. */
+    StatisticsCollector* createStatisticsCollector(bool enabled);
+
+    /** Measures a public call or a phase and adds it to a collector when destroyed. Does nothing when the collector is
+     * null, i.e. statistics are disabled. A call made during another call of the same thread is not measured
+     * separately, so public methods calling each other are counted once. */
+    class StatisticsScope
+    {
+    public:
+        enum class Kind
+        {
+            CALL,
+            PHASE
+        };
+
+        StatisticsScope(StatisticsCollector* collector, const char* name, const Kind kind = Kind::CALL)
+            : mCollector(nullptr)
+        {
+            if (collector)
+            {
+                start(collector, name, kind);
+            }
+        }
+
+        ~StatisticsScope()
+        {
+            if (mCollector)
+            {
+                stop();
+            }
+        }
+
+        StatisticsScope(const StatisticsScope&) = delete;
+        StatisticsScope& operator=(const StatisticsScope&) = delete;
+
+    private:
+        void start(StatisticsCollector* collector, const char* name, Kind kind);
+        void stop();
+
+        StatisticsCollector* mCollector;  ///< Collector to add to, or null if the scope is not measured.
+        const char* mName;
+        Kind mKind;
+        ThreadCounters mStartCounters;
+        std::chrono::steady_clock::time_point mStartTime;
+    };
+}  // namespace HEIF
+
+#endif /* STATISTICS_HPP */
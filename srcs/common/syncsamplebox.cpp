@@ -50,6 +50,11 @@ void SyncSampleBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t SyncSampleBox::getSerializedSize() const
+{
+    return getFullBoxHeaderSize() + 4 + 4 * static_cast<std::uint64_t>(mSampleNumber.size());
+}
+
 void SyncSampleBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     parseFullBoxHeader(bitstr);
@@ -99,6 +99,11 @@ void TimeToSampleBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t TimeToSampleBox::getSerializedSize() const
+{
+    return getFullBoxHeaderSize() + 4 + 8 * static_cast<std::uint64_t>(mEntryVersion0.size());
+}
+
 void TimeToSampleBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
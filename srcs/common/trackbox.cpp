@@ -164,6 +164,28 @@ void TrackBox::writeBox(ISOBMFF::BitStream& bitstr) const
     updateSize(bitstr);
 }
 
+std::uint64_t TrackBox::getSerializedSize() const
+{
+    std::uint64_t size = getBoxHeaderSize() + mTrackHeaderBox.getSerializedSize() + mMediaBox.getSerializedSize();
+    if (mHasTrackReferences == true)
+    {
+        size += mTrackReferenceBox.getSerializedSize();
+    }
+    if (mEditBox != nullptr)
+    {
+        size += mEditBox->getSerializedSize();
+    }
+    if (mHasTrackGroupBox)
+    {
+        size += mTrackGroupBox.getSerializedSize();
+    }
+    if (mHasTrackTypeBox)
+    {
+        size += mTrackTypeBox.getSerializedSize();
+    }
+    return size;
+}
+
 void TrackBox::parseBox(ISOBMFF::BitStream& bitstr)
 {
     //  First parse the box header
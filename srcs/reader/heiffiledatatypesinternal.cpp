@@ -0,0 +1,563 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "heiffiledatatypesinternal.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "heifreaderindex.hpp"
+
+namespace HEIF
+{
+    namespace
+    {
+        /// Add the values of a per-sample list to a flat array, and record where the next sample starts
+        template <typename T, typename List>
+        void appendList(const List& values, Vector<T>& flat, Vector<std::uint32_t>& begins)
+        {
+            flat.insert(flat.end(), values.cbegin(), values.cend());
+            if (flat.size() > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw RuntimeError("SamplePropertyTable: too many values");
+            }
+            begins.push_back(static_cast<std::uint32_t>(flat.size()));
+        }
+
+        template <typename T>
+        SamplePropertyTable::Range<T> listAt(const Vector<T>& flat,
+                                             const Vector<std::uint32_t>& begins,
+                                             const std::size_t index)
+        {
+            const T* data = flat.data();
+            return SamplePropertyTable::Range<T>(data + begins.at(index), data + begins.at(index + 1));
+        }
+
+        /// Rebuild a flat per-sample array from a presentation time map; map values are sample indices
+        template <typename T, typename Map>
+        void fillCompositionTimes(const Map& pMap,
+                                  const std::size_t sampleCount,
+                                  Vector<T>& flat,
+                                  Vector<std::uint32_t>& begins)
+        {
+            begins.assign(sampleCount + 1, 0);
+            for (const auto& pair : pMap)
+            {
+                if (pair.first < 0)  // negative time implies a hidden sample
+                {
+                    continue;
+                }
+                ++begins.at(pair.second + 1);
+            }
+            for (std::size_t index = 1; index < begins.size(); ++index)
+            {
+                begins[index] += begins[index - 1];
+            }
+
+            Vector<std::uint32_t> positions(begins.cbegin(), begins.cend() - 1);
+            flat.assign(begins.back(), T());
+            for (const auto& pair : pMap)
+            {
+                if (pair.first < 0)
+                {
+                    continue;
+                }
+                flat[positions[pair.second]++] = static_cast<T>(pair.first);
+            }
+        }
+
+        /// Call a function with the index and the value of each element of a run-length vector, in order
+        template <typename T, typename Function>
+        void forEachElement(const RunLengthVector<T>& runs, Function function)
+        {
+            const auto& starts = runs.runStarts();
+            const auto& values = runs.runValues();
+            for (std::size_t run = 0; run < starts.size(); ++run)
+            {
+                const std::size_t end = (run + 1 < starts.size()) ? starts[run + 1] : runs.size();
+                for (std::size_t index = starts[run]; index < end; ++index)
+                {
+                    function(index, values[run]);
+                }
+            }
+        }
+
+        /// Write the size and the run starts of a run-length vector, to be followed by the run values
+        template <typename T>
+        void writeRunStarts(IndexWriter& index, const RunLengthVector<T>& runs)
+        {
+            index.write<std::uint64_t>(runs.size());
+            index.write<std::uint64_t>(runs.runStarts().size());
+            for (const auto start : runs.runStarts())
+            {
+                index.write<std::uint64_t>(start);
+            }
+        }
+
+        template <typename T>
+        void writeRuns(IndexWriter& index, const RunLengthVector<T>& runs)
+        {
+            writeRunStarts(index, runs);
+            index.writeVector(runs.runValues());
+        }
+
+        /// Read the size and the run starts written by writeRunStarts(), and the run values with a function
+        template <typename T, typename ReadValues>
+        void readRuns(IndexReader& index, RunLengthVector<T>& runs, ReadValues readValues)
+        {
+            const auto size = static_cast<std::size_t>(index.read<std::uint64_t>());
+            Vector<std::size_t> starts(index.readCount(sizeof(std::uint64_t)));
+            for (auto& start : starts)
+            {
+                start = static_cast<std::size_t>(index.read<std::uint64_t>());
+            }
+            runs.assignRuns(std::move(starts), readValues(), size);
+        }
+
+        template <typename T>
+        void readRuns(IndexReader& index, RunLengthVector<T>& runs)
+        {
+            readRuns(index, runs, [&index]() {
+                Vector<T> values;
+                index.readVector(values);
+                return values;
+            });
+        }
+
+        /// Read a flat per-sample array and the starts of the samples in it, written by writeIndex()
+        template <typename T>
+        void readList(IndexReader& index, const std::size_t sampleCount, Vector<T>& flat, Vector<std::uint32_t>& begins)
+        {
+            index.readVector(begins);
+            index.readVector(flat);
+            bool valid = (begins.size() == sampleCount + 1) && (begins.front() == 0) && (begins.back() == flat.size());
+            for (std::size_t sample = 0; valid && sample < sampleCount; ++sample)
+            {
+                valid = begins[sample] <= begins[sample + 1];
+            }
+            if (!valid)
+            {
+                throw RuntimeError("SamplePropertyTable: inconsistent sample list in index cache");
+            }
+        }
+    }  // anonymous namespace
+
+    bool SamplePropertyTable::SampleEntryProperties::operator==(const SampleEntryProperties& other) const
+    {
+        return segmentId == other.segmentId && sampleEntryType == other.sampleEntryType &&
+               sampleDescriptionIndex == other.sampleDescriptionIndex &&
+               codingConstraints.allRefPicsIntra == other.codingConstraints.allRefPicsIntra &&
+               codingConstraints.intraPredUsed == other.codingConstraints.intraPredUsed &&
+               codingConstraints.maxRefPerPic == other.codingConstraints.maxRefPerPic && width == other.width &&
+               height == other.height && hasClap == other.hasClap && hasAuxi == other.hasAuxi;
+    }
+
+    SamplePropertyTable::SamplePropertyTable()
+        : mSampleIdOffsets()
+        , mSampleEntries()
+        , mSampleTypes()
+        , mSampleFlags()
+        , mDurationsTS()
+        , mCompositionOffsetsTS()
+        , mDataOffsets()
+        , mDataLengths()
+        , mMaxDataLength(0)
+        , mRepetition()
+        , mCompositionTimesBegin(1, 0)
+        , mCompositionTimes()
+        , mCompositionTimesTSBegin(1, 0)
+        , mCompositionTimesTS()
+        , mDecodeDependenciesBegin(1, 0)
+        , mDecodeDependencies()
+    {
+    }
+
+    std::size_t SamplePropertyTable::size() const
+    {
+        return mDataOffsets.size();
+    }
+
+    bool SamplePropertyTable::empty() const
+    {
+        return mDataOffsets.empty();
+    }
+
+    void SamplePropertyTable::reserve(const std::size_t sampleCount)
+    {
+        mDataOffsets.reserve(sampleCount);
+        mDataLengths.reserve(sampleCount);
+        mCompositionTimesBegin.reserve(sampleCount + 1);
+        mCompositionTimesTSBegin.reserve(sampleCount + 1);
+        mDecodeDependenciesBegin.reserve(sampleCount + 1);
+    }
+
+    void SamplePropertyTable::push_back(const SampleProperties& sample)
+    {
+        const auto index = static_cast<std::uint32_t>(mDataOffsets.size());
+        mSampleIdOffsets.push_back(sample.sampleId.get() - index);
+
+        SampleEntryProperties entry;
+        entry.segmentId              = sample.segmentId;
+        entry.sampleEntryType        = sample.sampleEntryType;
+        entry.sampleDescriptionIndex = sample.sampleDescriptionIndex;
+        entry.codingConstraints      = sample.codingConstraints;
+        entry.width                  = sample.width;
+        entry.height                 = sample.height;
+        entry.hasClap                = sample.hasClap;
+        entry.hasAuxi                = sample.hasAuxi;
+        mSampleEntries.push_back(entry);
+
+        mSampleTypes.push_back(sample.sampleType);
+        mSampleFlags.push_back(sample.sampleFlags.flagsAsUInt);
+        mDurationsTS.push_back(sample.sampleDurationTS);
+        mCompositionOffsetsTS.push_back(sample.sampleCompositionOffsetTs);
+
+        mDataOffsets.push_back(sample.dataOffset);
+        mDataLengths.push_back(sample.dataLength);
+        mMaxDataLength = std::max(mMaxDataLength, sample.dataLength);
+
+        appendList(sample.compositionTimes, mCompositionTimes, mCompositionTimesBegin);
+        appendList(sample.compositionTimesTS, mCompositionTimesTS, mCompositionTimesTSBegin);
+        appendList(sample.decodeDependencies, mDecodeDependencies, mDecodeDependenciesBegin);
+    }
+
+    SampleProperties SamplePropertyTable::get(const std::size_t index) const
+    {
+        const SampleEntryProperties& entry = mSampleEntries.at(index);
+
+        SampleProperties sample;
+        sample.sampleId                  = sampleId(index);
+        sample.segmentId                 = entry.segmentId;
+        sample.sampleEntryType           = entry.sampleEntryType;
+        sample.sampleType                = mSampleTypes.at(index);
+        sample.sampleDescriptionIndex    = entry.sampleDescriptionIndex;
+        sample.codingConstraints         = entry.codingConstraints;
+        sample.sampleDurationTS          = mDurationsTS.at(index);
+        sample.sampleCompositionOffsetTs = mCompositionOffsetsTS.at(index);
+        const auto times                 = compositionTimes(index);
+        sample.compositionTimes.assign(times.begin(), times.end());
+        const auto timesTS = compositionTimesTS(index);
+        sample.compositionTimesTS.assign(timesTS.begin(), timesTS.end());
+        sample.dataOffset              = mDataOffsets.at(index);
+        sample.dataLength              = mDataLengths.at(index);
+        sample.width                   = entry.width;
+        sample.height                  = entry.height;
+        sample.sampleFlags.flagsAsUInt = mSampleFlags.at(index);
+        const auto dependencies        = decodeDependencies(index);
+        sample.decodeDependencies.assign(dependencies.begin(), dependencies.end());
+        sample.hasClap = entry.hasClap;
+        sample.hasAuxi = entry.hasAuxi;
+        return sample;
+    }
+
+    SequenceImageId SamplePropertyTable::sampleId(const std::size_t index) const
+    {
+        return mSampleIdOffsets.at(index) + static_cast<std::uint32_t>(index);
+    }
+
+    SegmentId SamplePropertyTable::segmentId(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).segmentId;
+    }
+
+    FourCCInt SamplePropertyTable::sampleEntryType(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).sampleEntryType;
+    }
+
+    SampleType SamplePropertyTable::sampleType(const std::size_t index) const
+    {
+        return mSampleTypes.at(index);
+    }
+
+    SampleDescriptionIndex SamplePropertyTable::sampleDescriptionIndex(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).sampleDescriptionIndex;
+    }
+
+    CodingConstraints SamplePropertyTable::codingConstraints(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).codingConstraints;
+    }
+
+    std::uint32_t SamplePropertyTable::sampleDurationTS(const std::size_t index) const
+    {
+        return mDurationsTS.at(index);
+    }
+
+    std::int64_t SamplePropertyTable::sampleCompositionOffsetTs(const std::size_t index) const
+    {
+        return mCompositionOffsetsTS.at(index);
+    }
+
+    std::uint64_t SamplePropertyTable::dataOffset(const std::size_t index) const
+    {
+        return mDataOffsets.at(index);
+    }
+
+    std::uint32_t SamplePropertyTable::dataLength(const std::size_t index) const
+    {
+        return mDataLengths.at(index);
+    }
+
+    std::uint32_t SamplePropertyTable::width(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).width;
+    }
+
+    std::uint32_t SamplePropertyTable::height(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).height;
+    }
+
+    SampleFlags SamplePropertyTable::sampleFlags(const std::size_t index) const
+    {
+        SampleFlags flags;
+        flags.flagsAsUInt = mSampleFlags.at(index);
+        return flags;
+    }
+
+    bool SamplePropertyTable::hasClap(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).hasClap;
+    }
+
+    bool SamplePropertyTable::hasAuxi(const std::size_t index) const
+    {
+        return mSampleEntries.at(index).hasAuxi;
+    }
+
+    SamplePropertyTable::TimeRange<std::int64_t> SamplePropertyTable::compositionTimes(const std::size_t index) const
+    {
+        return TimeRange<std::int64_t>(listAt(mCompositionTimes, mCompositionTimesBegin, index), mRepetition.period,
+                                       compositionTimeCount(index));
+    }
+
+    SamplePropertyTable::TimeRange<std::uint64_t> SamplePropertyTable::compositionTimesTS(
+        const std::size_t index) const
+    {
+        const auto times = listAt(mCompositionTimesTS, mCompositionTimesTSBegin, index);
+        if (mRepetition.period <= 0 || times.empty())
+        {
+            return TimeRange<std::uint64_t>(times, 0, times.size());
+        }
+        return TimeRange<std::uint64_t>(times, mRepetition.periodTS, compositionTimeCount(index));
+    }
+
+    std::size_t SamplePropertyTable::compositionTimeCount(const std::size_t index) const
+    {
+        const auto times = listAt(mCompositionTimes, mCompositionTimesBegin, index);
+        if (mRepetition.period <= 0)
+        {
+            return times.size();
+        }
+
+        // Each time of the first pass is repeated for as many periods as it stays before the end.
+        const std::int64_t period = mRepetition.period;
+        std::size_t count         = 0;
+        for (const auto time : times)
+        {
+            if (time < mRepetition.end)
+            {
+                count += static_cast<std::size_t>((mRepetition.end - time + period - 1) / period);
+            }
+        }
+        return count;
+    }
+
+    SamplePropertyTable::Range<SequenceImageId> SamplePropertyTable::decodeDependencies(const std::size_t index) const
+    {
+        return listAt(mDecodeDependencies, mDecodeDependenciesBegin, index);
+    }
+
+    void SamplePropertyTable::setCompositionTimes(const DecodePts::PMap& pMap,
+                                                  const DecodePts::PMapTS& pMapTS,
+                                                  const EditRepetition& repetition)
+    {
+        mRepetition = repetition;
+        fillCompositionTimes(pMap, size(), mCompositionTimes, mCompositionTimesBegin);
+        fillCompositionTimes(pMapTS, size(), mCompositionTimesTS, mCompositionTimesTSBegin);
+    }
+
+    std::uint32_t SamplePropertyTable::maxDataLength() const
+    {
+        return mMaxDataLength;
+    }
+
+    std::size_t SamplePropertyTable::allocatedSize() const
+    {
+        return mSampleIdOffsets.allocatedSize() + mSampleEntries.allocatedSize() + mSampleTypes.allocatedSize() +
+               mSampleFlags.allocatedSize() + mDurationsTS.allocatedSize() + mCompositionOffsetsTS.allocatedSize() +
+               mDataOffsets.capacity() * sizeof(std::uint64_t) + mDataLengths.capacity() * sizeof(std::uint32_t) +
+               mCompositionTimesBegin.capacity() * sizeof(std::uint32_t) +
+               mCompositionTimes.capacity() * sizeof(std::int64_t) +
+               mCompositionTimesTSBegin.capacity() * sizeof(std::uint32_t) +
+               mCompositionTimesTS.capacity() * sizeof(std::uint64_t) +
+               mDecodeDependenciesBegin.capacity() * sizeof(std::uint32_t) +
+               mDecodeDependencies.capacity() * sizeof(SequenceImageId);
+    }
+
+    void SamplePropertyTable::getSampleInformation(Array<SampleInformation>& samples) const
+    {
+        Array<SampleInformation> information(size());
+        forEachElement(mSampleIdOffsets, [&information](const std::size_t index, const std::uint32_t offset) {
+            information[index].sampleId = offset + static_cast<std::uint32_t>(index);
+        });
+        forEachElement(mSampleEntries, [&information](const std::size_t index, const SampleEntryProperties& entry) {
+            information[index].sampleEntryType        = entry.sampleEntryType.getUInt32();
+            information[index].sampleDescriptionIndex = entry.sampleDescriptionIndex.get();
+            information[index].hasClap                = entry.hasClap;
+            information[index].hasAuxi                = entry.hasAuxi;
+            information[index].codingConstraints      = entry.codingConstraints;
+        });
+        forEachElement(mSampleTypes, [&information](const std::size_t index, const SampleType type) {
+            information[index].sampleType = type;
+        });
+        forEachElement(mDurationsTS, [&information](const std::size_t index, const std::uint32_t duration) {
+            information[index].sampleDurationTS = duration;
+        });
+        forEachElement(mCompositionOffsetsTS, [&information](const std::size_t index, const std::int64_t offset) {
+            information[index].sampleCompositionOffsetTs = offset;
+        });
+        for (std::size_t index = 0; index < size(); ++index)
+        {
+            information[index].size = mDataLengths[index];
+        }
+
+        // Hand the array over without copying it.
+        std::swap(samples.elements, information.elements);
+        std::swap(samples.size, information.size);
+    }
+
+    void SamplePropertyTable::writeIndex(IndexWriter& index) const
+    {
+        writeRuns(index, mSampleIdOffsets);
+
+        writeRunStarts(index, mSampleEntries);
+        index.write<std::uint64_t>(mSampleEntries.runValues().size());
+        for (const auto& entry : mSampleEntries.runValues())
+        {
+            index.write<std::uint32_t>(entry.segmentId.get());
+            index.write<std::uint32_t>(entry.sampleEntryType.getUInt32());
+            index.write<std::uint32_t>(entry.sampleDescriptionIndex.get());
+            index.write<std::uint8_t>(entry.codingConstraints.allRefPicsIntra);
+            index.write<std::uint8_t>(entry.codingConstraints.intraPredUsed);
+            index.write<std::uint8_t>(entry.codingConstraints.maxRefPerPic);
+            index.write<std::uint32_t>(entry.width);
+            index.write<std::uint32_t>(entry.height);
+            index.write<std::uint8_t>(entry.hasClap);
+            index.write<std::uint8_t>(entry.hasAuxi);
+        }
+
+        writeRunStarts(index, mSampleTypes);
+        index.write<std::uint64_t>(mSampleTypes.runValues().size());
+        for (const auto type : mSampleTypes.runValues())
+        {
+            index.write<std::uint32_t>(static_cast<std::uint32_t>(type));
+        }
+        writeRuns(index, mSampleFlags);
+        writeRuns(index, mDurationsTS);
+        writeRuns(index, mCompositionOffsetsTS);
+
+        index.writeVector(mDataOffsets);
+        index.writeVector(mDataLengths);
+
+        index.write<std::int64_t>(mRepetition.period);
+        index.write<std::uint64_t>(mRepetition.periodTS);
+        index.write<std::int64_t>(mRepetition.end);
+        index.writeVector(mCompositionTimesBegin);
+        index.writeVector(mCompositionTimes);
+        index.writeVector(mCompositionTimesTSBegin);
+        index.writeVector(mCompositionTimesTS);
+
+        Vector<std::uint32_t> decodeDependencies;
+        decodeDependencies.reserve(mDecodeDependencies.size());
+        for (const auto dependency : mDecodeDependencies)
+        {
+            decodeDependencies.push_back(dependency.get());
+        }
+        index.writeVector(mDecodeDependenciesBegin);
+        index.writeVector(decodeDependencies);
+    }
+
+    void SamplePropertyTable::readIndex(IndexReader& index)
+    {
+        readRuns(index, mSampleIdOffsets);
+
+        readRuns(index, mSampleEntries, [&index]() {
+            const std::uint64_t entrySize = 5 * sizeof(std::uint32_t) + 5 * sizeof(std::uint8_t);
+            Vector<SampleEntryProperties> entries(index.readCount(entrySize));
+            for (auto& entry : entries)
+            {
+                entry.segmentId                         = index.read<std::uint32_t>();
+                entry.sampleEntryType                   = index.read<std::uint32_t>();
+                entry.sampleDescriptionIndex            = index.read<std::uint32_t>();
+                entry.codingConstraints.allRefPicsIntra = index.read<std::uint8_t>() != 0;
+                entry.codingConstraints.intraPredUsed   = index.read<std::uint8_t>() != 0;
+                entry.codingConstraints.maxRefPerPic    = index.read<std::uint8_t>();
+                entry.width                             = index.read<std::uint32_t>();
+                entry.height                            = index.read<std::uint32_t>();
+                entry.hasClap                           = index.read<std::uint8_t>() != 0;
+                entry.hasAuxi                           = index.read<std::uint8_t>() != 0;
+            }
+            return entries;
+        });
+        readRuns(index, mSampleTypes, [&index]() {
+            Vector<SampleType> types(index.readCount(sizeof(std::uint32_t)));
+            for (auto& type : types)
+            {
+                const auto value = index.read<std::uint32_t>();
+                if (value > NON_OUTPUT_REFERENCE_FRAME)
+                {
+                    throw RuntimeError("SamplePropertyTable: invalid sample type in index cache");
+                }
+                type = static_cast<SampleType>(value);
+            }
+            return types;
+        });
+        readRuns(index, mSampleFlags);
+        readRuns(index, mDurationsTS);
+        readRuns(index, mCompositionOffsetsTS);
+
+        index.readVector(mDataOffsets);
+        index.readVector(mDataLengths);
+        const std::size_t sampleCount = mDataOffsets.size();
+        if ((mDataLengths.size() != sampleCount) || (mSampleIdOffsets.size() != sampleCount) ||
+            (mSampleEntries.size() != sampleCount) || (mSampleTypes.size() != sampleCount) ||
+            (mSampleFlags.size() != sampleCount) || (mDurationsTS.size() != sampleCount) ||
+            (mCompositionOffsetsTS.size() != sampleCount))
+        {
+            throw RuntimeError("SamplePropertyTable: inconsistent sample count in index cache");
+        }
+        mMaxDataLength = mDataLengths.empty() ? 0 : *std::max_element(mDataLengths.cbegin(), mDataLengths.cend());
+
+        mRepetition.period   = index.read<std::int64_t>();
+        mRepetition.periodTS = index.read<std::uint64_t>();
+        mRepetition.end      = index.read<std::int64_t>();
+        readList(index, sampleCount, mCompositionTimes, mCompositionTimesBegin);
+        readList(index, sampleCount, mCompositionTimesTS, mCompositionTimesTSBegin);
+
+        // Decode dependencies come only from 'moov' sample tables, where sample ids are the indices of the samples.
+        Vector<std::uint32_t> decodeDependencies;
+        readList(index, sampleCount, decodeDependencies, mDecodeDependenciesBegin);
+        for (const auto dependency : decodeDependencies)
+        {
+            if (dependency >= sampleCount)
+            {
+                throw RuntimeError("SamplePropertyTable: invalid decode dependency in index cache");
+            }
+        }
+        mDecodeDependencies.assign(decodeDependencies.cbegin(), decodeDependencies.cend());
+    }
+}  // namespace HEIF
@@ -14,6 +14,7 @@
 #ifndef HEIFFILEDATATYPESINTERNAL_HPP
 #define HEIFFILEDATATYPESINTERNAL_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <set>
 
@@ -23,6 +24,7 @@
 #include "heifreaderdatatypes.h"
 #include "heifstreaminternal.hpp"
 #include "moviefragmentsdatatypes.hpp"
+#include "runlengthvector.hpp"
 #include "segmenttypebox.hpp"
 #include "tracktypebox.hpp"
 
@@ -167,6 +169,8 @@ namespace HEIF
     // Forward declarations
     struct SampleProperties;
     struct InitTrackInfo;
+    class IndexWriter;
+    class IndexReader;
 
     struct SampleSizeInPixels
     {
@@ -200,7 +204,6 @@ namespace HEIF
 
     typedef std::pair<SequenceImageId, Timestamp> ItemIdTimestampPair;  ///< Pair of Item/sample ID and timestamp
 
-    typedef Map<SequenceImageIdPair, SampleDescriptionIndex> SampleToParameterSetMap;
     typedef Array<SegmentInformation> SegmentIndex;
 
 
@@ -291,6 +294,7 @@ namespace HEIF
         FourCCInt sampleEntryType;  /// sample type from this track. Passed to segments sampleproperties.
 
         Map<SampleDescriptionIndex, ParameterSetMap> parameterSetMaps;  ///< Extracted decoder parameter sets
+        Map<SampleDescriptionIndex, DataVector> parameterSets;  ///< Parameter sets concatenated for decoders
         Map<SampleDescriptionIndex, SampleSizeInPixels>
             sampleSizeInPixels;  ///< Clean sample size information from sample description entries
         Map<SampleDescriptionIndex, std::uint8_t> nalLengthSizeMinus1;
@@ -303,13 +307,310 @@ namespace HEIF
             auxiProperties;  ///< Clean aperture data from sample description entries
     };
 
-    typedef Vector<SampleProperties> SamplePropertyVector;
+    /** @brief Repetition of the presentation times of a track by an edit list with flags & 1 set.
+     *
+     * The times of one pass of the edit list are repeated with the period of the edit list, as long as they are
+     * smaller than the track duration. */
+    struct EditRepetition
+    {
+        std::int64_t period    = 0;  ///< Duration of the edit list in milliseconds, 0 if times are not repeated
+        std::uint64_t periodTS = 0;  ///< Duration of the edit list in time scale units
+        std::int64_t end       = 0;  ///< Track duration in milliseconds, repeated times are smaller than this
+    };
+
+    /** @brief Compact table of the properties of the samples of a track in a segment.
+     *
+     * Properties that usually stay the same over long runs of samples are stored run-length coded and looked up with a
+     * binary search over the runs. Data offsets and lengths are stored per sample, and the composition times and decode
+     * dependencies of all samples share flat arrays indexed by sample. */
+    class SamplePropertyTable
+    {
+    public:
+        /// Read-only view to consecutive values stored in the table. Valid until the table is modified.
+        template <typename T>
+        class Range
+        {
+        public:
+            Range(const T* begin, const T* end)
+                : mBegin(begin)
+                , mEnd(end)
+            {
+            }
+            const T* begin() const
+            {
+                return mBegin;
+            }
+            const T* end() const
+            {
+                return mEnd;
+            }
+            std::size_t size() const
+            {
+                return static_cast<std::size_t>(mEnd - mBegin);
+            }
+            bool empty() const
+            {
+                return mBegin == mEnd;
+            }
+            const T& operator[](std::size_t index) const
+            {
+                return mBegin[index];
+            }
+
+        private:
+            const T* mBegin;
+            const T* mEnd;
+        };
+
+        /** Read-only view to the composition times of a sample. Times of a repeating edit list are computed from the
+         * times of the first pass, so they are not stored. Valid until the table is modified. */
+        template <typename T>
+        class TimeRange
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const T* pointer;
+                typedef T reference;
+
+                const_iterator(const TimeRange* range, std::size_t index)
+                    : mRange(range)
+                    , mIndex(index)
+                    , mTime(0)
+                    , mOffset(0)
+                {
+                }
+                T operator*() const
+                {
+                    return mRange->mTimes[mTime] + mOffset;
+                }
+                const_iterator& operator++()
+                {
+                    // Step through the first pass, then start it over one period later.
+                    ++mIndex;
+                    if (++mTime == mRange->mTimes.size())
+                    {
+                        mTime = 0;
+                        mOffset += mRange->mPeriod;
+                    }
+                    return *this;
+                }
+                bool operator==(const const_iterator& other) const
+                {
+                    return mIndex == other.mIndex;
+                }
+                bool operator!=(const const_iterator& other) const
+                {
+                    return mIndex != other.mIndex;
+                }
+
+            private:
+                const TimeRange* mRange;
+                std::size_t mIndex;  ///< Index in the range, compared by the iterators.
+                std::size_t mTime;   ///< Index of the time of the first pass.
+                T mOffset;           ///< Offset of the current pass.
+            };
+
+            /**
+             * @param [in] times   Times of the first pass, sorted.
+             * @param [in] period  Period of repetition, 0 if not repeated.
+             * @param [in] size    Number of times including repetitions. */
+            TimeRange(const Range<T>& times, T period, std::size_t size)
+                : mTimes(times)
+                , mPeriod(period)
+                , mSize(size)
+            {
+            }
+            const_iterator begin() const
+            {
+                return const_iterator(this, 0);
+            }
+            const_iterator end() const
+            {
+                return const_iterator(this, mSize);
+            }
+            std::size_t size() const
+            {
+                return mSize;
+            }
+            bool empty() const
+            {
+                return mSize == 0;
+            }
+            T operator[](std::size_t index) const
+            {
+                const std::size_t count = mTimes.size();
+                return mTimes[index % count] + static_cast<T>(index / count) * mPeriod;
+            }
+            T back() const
+            {
+                return (*this)[mSize - 1];
+            }
+
+        private:
+            Range<T> mTimes;
+            T mPeriod;
+            std::size_t mSize;
+        };
+
+        SamplePropertyTable();
+
+        std::size_t size() const;
+        bool empty() const;
+        void reserve(std::size_t sampleCount);
+
+        /** @brief Appends a sample to the table, including its composition times and decode dependencies.
+         *  @param [in] sample Properties of the sample */
+        void push_back(const SampleProperties& sample);
+
+        /** @brief Expands all properties of a sample.
+         *  @param [in] index Index of the sample in the table
+         *  @throws std::out_of_range if index is not smaller than size() */
+        SampleProperties get(std::size_t index) const;
+
+        // Accessors for single properties of a sample by its index in the table.
+        // @throws std::out_of_range if index is not smaller than size()
+        SequenceImageId sampleId(std::size_t index) const;
+        SegmentId segmentId(std::size_t index) const;
+        FourCCInt sampleEntryType(std::size_t index) const;
+        SampleType sampleType(std::size_t index) const;
+        SampleDescriptionIndex sampleDescriptionIndex(std::size_t index) const;
+        CodingConstraints codingConstraints(std::size_t index) const;
+        std::uint32_t sampleDurationTS(std::size_t index) const;
+        std::int64_t sampleCompositionOffsetTs(std::size_t index) const;
+        std::uint64_t dataOffset(std::size_t index) const;
+        std::uint32_t dataLength(std::size_t index) const;
+        std::uint32_t width(std::size_t index) const;
+        std::uint32_t height(std::size_t index) const;
+        SampleFlags sampleFlags(std::size_t index) const;
+        bool hasClap(std::size_t index) const;
+        bool hasAuxi(std::size_t index) const;
+        TimeRange<std::int64_t> compositionTimes(std::size_t index) const;
+        TimeRange<std::uint64_t> compositionTimesTS(std::size_t index) const;
+        Range<SequenceImageId> decodeDependencies(std::size_t index) const;
+
+        /** @brief Replaces the composition times of all samples with the ones of presentation time maps.
+         *  Negative times, which imply hidden samples, are skipped.
+         *  @param [in] pMap       Display timestamps of the samples, sample indices relative to the start of the table
+         *  @param [in] pMapTS     Display timestamps of the samples in time scale units
+         *  @param [in] repetition Repetition of the timestamps by a repeating edit list */
+        void setCompositionTimes(const DecodePts::PMap& pMap,
+                                 const DecodePts::PMapTS& pMapTS,
+                                 const EditRepetition& repetition);
+
+        /** @brief Appends the composition times of samples to a vector in presentation order.
+         *  Only the times of the first pass of a repeating edit list are sorted, and the rest are generated from them
+         *  period by period. Equal times are appended in table order.
+         *  @param [in]  include       Predicate taking a table index, true for samples to include
+         *  @param [out] presentations Pairs of composition time and sample id */
+        template <typename Predicate>
+        void appendPresentations(Predicate include, Vector<TimestampIDPair>& presentations) const;
+
+        /// @return Length of the largest sample in bytes
+        std::uint32_t maxDataLength() const;
+
+        /// @return Number of bytes allocated for the table
+        std::size_t allocatedSize() const;
+
+        /** @brief Fills the information of all samples for the reader interface.
+         *  The runs are walked in order, instead of searching the run of each sample.
+         *  @param [out] samples Information of each sample, in table order. Fields not stored in the table, such as
+         *                      timestamps, are not set. */
+        void getSampleInformation(Array<SampleInformation>& samples) const;
+
+        /** @brief Writes the table to an index cache, see Reader::getIndexCache().
+         *  @param [in] index Writer of the index cache */
+        void writeIndex(IndexWriter& index) const;
+
+        /** @brief Replaces the table with one written by writeIndex().
+         *  @param [in] index Reader of the index cache
+         *  @throws RuntimeError or std::invalid_argument if the table in the index cache is not consistent */
+        void readIndex(IndexReader& index);
+
+    private:
+        /// Properties coming from the sample description of a sample
+        struct SampleEntryProperties
+        {
+            SegmentId segmentId;
+            FourCCInt sampleEntryType;
+            SampleDescriptionIndex sampleDescriptionIndex;
+            CodingConstraints codingConstraints;
+            std::uint32_t width;
+            std::uint32_t height;
+            bool hasClap;
+            bool hasAuxi;
+
+            bool operator==(const SampleEntryProperties& other) const;
+        };
+
+        RunLengthVector<std::uint32_t> mSampleIdOffsets;  ///< Sample Id minus the sample's index in the table
+        RunLengthVector<SampleEntryProperties> mSampleEntries;
+        RunLengthVector<SampleType> mSampleTypes;
+        RunLengthVector<std::uint32_t> mSampleFlags;
+        RunLengthVector<std::uint32_t> mDurationsTS;
+        RunLengthVector<std::int64_t> mCompositionOffsetsTS;
+
+        Vector<std::uint64_t> mDataOffsets;
+        Vector<std::uint32_t> mDataLengths;
+        std::uint32_t mMaxDataLength;
+
+        /// @return Number of composition times of a sample, including repetitions
+        std::size_t compositionTimeCount(std::size_t index) const;
+
+        EditRepetition mRepetition;                      ///< Repetition of the composition times
+        Vector<std::uint32_t> mCompositionTimesBegin;    ///< Start of each sample in mCompositionTimes, plus the end
+        Vector<std::int64_t> mCompositionTimes;          ///< Timestamps of the samples. Edit list is considered here.
+        Vector<std::uint32_t> mCompositionTimesTSBegin;  ///< Start of each sample in mCompositionTimesTS, plus the end
+        Vector<std::uint64_t> mCompositionTimesTS;       ///< Timestamps of the samples in time scale units
+        Vector<std::uint32_t> mDecodeDependenciesBegin;  ///< Start of each sample in mDecodeDependencies, plus the end
+        Vector<SequenceImageId> mDecodeDependencies;     ///< Direct decoding dependencies of the samples
+    };
+
+    template <typename Predicate>
+    void SamplePropertyTable::appendPresentations(Predicate include, Vector<TimestampIDPair>& presentations) const
+    {
+        Vector<TimestampIDPair> firstPass;
+        for (std::size_t index = 0; index < size(); ++index)
+        {
+            if (include(index))
+            {
+                const SequenceImageId id = sampleId(index);
+                for (std::uint32_t i = mCompositionTimesBegin[index]; i < mCompositionTimesBegin[index + 1]; ++i)
+                {
+                    firstPass.push_back({mCompositionTimes[i], id});
+                }
+            }
+        }
+        std::stable_sort(firstPass.begin(), firstPass.end(),
+                         [](const TimestampIDPair& a, const TimestampIDPair& b) { return a.timeStamp < b.timeStamp; });
+
+        if (mRepetition.period <= 0)
+        {
+            presentations.insert(presentations.end(), firstPass.cbegin(), firstPass.cend());
+            return;
+        }
+        for (std::int64_t offset = 0; !firstPass.empty(); offset += mRepetition.period)
+        {
+            for (const auto& presentation : firstPass)
+            {
+                if (presentation.timeStamp + offset >= mRepetition.end)
+                {
+                    return;
+                }
+                presentations.push_back({presentation.timeStamp + offset, presentation.itemId});
+            }
+        }
+    }
 
     /// Information about samples of a track in a segment.
     struct TrackInfoInSegment
     {
         SequenceImageId itemIdBase;
-        SamplePropertyVector samples;  ///< Information about each sample in the TrackBox
+        SamplePropertyTable samples;  ///< Information about each sample in the TrackBox
 
         DecodePts::PresentationTimeTS durationTS    = 0;  ///< Track duration in time scale units, from TrackHeaderBox
         DecodePts::PresentationTimeTS earliestPTSTS = 0;  ///< Time of the first sample in time scale units
@@ -319,18 +620,25 @@ namespace HEIF
         some derived value upon first use and the incremented by trackrun duration when one is read. */
         DecodePts::PresentationTimeTS nextPTSTS = 0;
 
-        WriteOnceMap<SequenceImageId, FourCCInt> decoderCodeTypeMap;  ///< Extracted decoder code types
-
-        DecodePts::PMap pMap;      ///< Display timestamps, from edit list
-        DecodePts::PMapTS pMapTS;  ///< Display timestamps in time scale units, from edit list
+        DecodePts::PMap pMap;       ///< Display timestamps, from edit list. One pass of a repeating edit list.
+        DecodePts::PMapTS pMapTS;   ///< Display timestamps in time scale units, from edit list
+        EditRepetition repetition;  ///< Repetition of pMap and pMapTS by a repeating edit list
 
         /// @todo Move to another structs.
         bool hasEditList = false;  ///< Used to determine if updateCompositionTimes should edit the time of last sample
                                    ///< to match track duration
         bool hasTtyp = false;
-        TrackTypeBox ttyp;  ///< TrackType info in case if available
-        double duration;    ///< Track duration in seconds, from TrackHeaderBox
-        double repetitions;
+        TrackTypeBox ttyp;         ///< TrackType info in case if available
+        double duration    = 0.0;  ///< Track duration in seconds, from TrackHeaderBox
+        double repetitions = 0.0;
+    };
+
+    /// Byte range of the input stream to be read to an output buffer.
+    struct ReadRange
+    {
+        std::uint64_t fileOffset;    ///< Offset of the range in the input stream.
+        std::uint64_t size;          ///< Length of the range in bytes.
+        std::uint64_t bufferOffset;  ///< Offset in the output buffer where the range is read to.
     };
 
     struct StreamIO
@@ -351,12 +659,11 @@ namespace HEIF
         SegmentTypeBox styp;  ///< Segment Type Box for later information retrieval
 
         Map<SequenceId, TrackInfoInSegment> trackInfos;
-
-        SampleToParameterSetMap sampleToParameterSetMap;  ///< Map from every sample to parameter set map entry
     };
 
     typedef Map<SegmentId, SegmentProperties> SegmentPropertiesMap;
     typedef Map<Sequence, SegmentId> SequenceToSegmentMap;
+    typedef Map<SequenceImageId, SegmentId> ItemIdBaseToSegmentMap;  ///< First sample id in a segment -> segment
 
     /** @brief Overall File Property definition which contains file's properties.*/
     struct FileInformationInternal
@@ -371,6 +678,7 @@ namespace HEIF
         SegmentIndex segmentIndex;
         SegmentPropertiesMap segmentPropertiesMap;
         SequenceToSegmentMap sequenceToSegment;
+        Map<SequenceId, ItemIdBaseToSegmentMap> segmentsByItemIdBase;  ///< Segments with samples of each track
     };
 }  // namespace HEIF
 
@@ -12,6 +12,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <cassert>
 #include <cstdlib>
@@ -30,6 +31,7 @@
 #include "creationtimeinformation.hpp"
 #include "heiffiledatatypesinternal.hpp"
 #include "heifreaderimpl.hpp"
+#include "heifsamplereader.hpp"
 #include "hevccommondefs.hpp"
 #include "hevcconfigurationbox.hpp"
 #include "hevcdecoderconfigrecord.hpp"
@@ -45,6 +47,7 @@
 #include "metabox.hpp"
 #include "modificationtimeinformation.hpp"
 #include "moviebox.hpp"
+#include "nalutil.hpp"
 #include "pixelaspectratiobox.hpp"
 #include "pixelinformationproperty.hpp"
 #include "rawpropertybox.hpp"
@@ -70,15 +73,45 @@ namespace HEIF
 
             return array;
         }
+
+        /// Upper limit for merging adjacent read ranges, so that large grids can still be spread over threads.
+        static const std::uint64_t MAX_MERGED_READ_SIZE = 4 * 1024 * 1024;
+
+        struct ReadRangesContext
+        {
+            InternalStream* stream;
+            const ReadRange* ranges;
+            uint8_t* buffer;
+            std::atomic<bool> failed;
+        };
+
+        void readRangeTask(void* context, uint64_t index)
+        {
+            auto* readContext      = static_cast<ReadRangesContext*>(context);
+            const ReadRange& range = readContext->ranges[index];
+            if (!readContext->stream->readAt(static_cast<std::int64_t>(range.fileOffset),
+                                             reinterpret_cast<char*>(readContext->buffer + range.bufferOffset),
+                                             static_cast<std::int64_t>(range.size)))
+            {
+                readContext->failed = true;
+            }
+        }
     }  // anonymous namespace
 
     ErrorCode HeifReaderImpl::getFileInformation(FileInformation& fileInfo) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getFileInformation");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode error = loadPendingMoov();
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
         fileInfo = mFileInformation;
 
         return ErrorCode::OK;
@@ -86,6 +119,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getMajorBrand(FourCC& majorBrand) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMajorBrand");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -97,6 +131,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getMinorVersion(uint32_t& minorVersion) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMinorVersion");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -108,6 +143,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getCompatibleBrands(Array<FourCC>& compatibleBrands) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getCompatibleBrands");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -126,6 +162,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getCompatibleBrandCombinations(Array<Array<FourCC>>& compatibleBrandCombinations) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getCompatibleBrandCombinations");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -152,6 +189,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getDisplayWidth(const SequenceId& sequenceId, uint32_t& displayWidth) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDisplayWidth");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -164,6 +202,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getDisplayHeight(const SequenceId& sequenceId, uint32_t& displayHeight) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDisplayHeight");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -176,6 +215,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getWidth(const ImageId& itemId, uint32_t& width) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getWidth");
         ErrorCode error;
         if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
         {
@@ -189,6 +229,7 @@ namespace HEIF
                                        const SequenceImageId& itemId,
                                        uint32_t& width) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getWidth");
         ErrorCode error;
         SampleProperties sampleInfo;
         if ((error = getSampleInfo(sequenceId, itemId, sampleInfo)) != ErrorCode::OK)
@@ -203,6 +244,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getHeight(const ImageId& itemId, uint32_t& height) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getHeight");
         ErrorCode error;
         if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
         {
@@ -216,6 +258,7 @@ namespace HEIF
                                         const SequenceImageId& itemId,
                                         uint32_t& height) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getHeight");
         ErrorCode error;
         SampleProperties sampleInfo;
         if ((error = getSampleInfo(sequenceId, itemId, sampleInfo)) != ErrorCode::OK)
@@ -230,6 +273,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getMatrix(Array<std::int32_t>& matrix) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMatrix");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -246,6 +290,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getMatrix(const SequenceId& sequenceId, Array<int32_t>& matrix) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMatrix");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -262,6 +307,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getPlaybackDurationInSecs(const SequenceId& sequenceId, double& durationInSecs) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getPlaybackDurationInSecs");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -275,12 +321,15 @@ namespace HEIF
             const auto& trackInfo = segment.second.trackInfos.find(sequenceId);
             if (trackInfo != segment.second.trackInfos.end())
             {
-                for (const auto& sample : trackInfo->second.samples)
+                const SamplePropertyTable& samples = trackInfo->second.samples;
+                for (std::size_t index = 0; index < samples.size(); ++index)
                 {
-                    for (const auto& compositionTimesTS : sample.compositionTimesTS)
+                    // Composition times of a sample are sorted, so the last one ends last.
+                    const auto compositionTimesTS = samples.compositionTimesTS(index);
+                    if (!compositionTimesTS.empty())
                     {
-                        maxTimeUs = std::max(
-                            maxTimeUs, int64_t((compositionTimesTS + sample.sampleDurationTS) * 1000000 / timescale));
+                        const std::uint64_t endTS = compositionTimesTS.back() + samples.sampleDurationTS(index);
+                        maxTimeUs                 = std::max(maxTimeUs, int64_t(endTS * 1000000 / timescale));
                     }
                 }
             }
@@ -292,6 +341,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getMasterImages(Array<ImageId>& itemIds) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMasterImages");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -321,6 +371,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getMasterImages(const SequenceId& sequenceId, Array<SequenceImageId>& itemIds) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMasterImages");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -340,6 +391,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getItemListByType(const FourCC& itemType, Array<ImageId>& itemIds) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemListByType");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -366,6 +418,7 @@ namespace HEIF
                                                 const TrackSampleType& sampleType,
                                                 Array<SequenceImageId>& sampleIdsApi) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemListByType");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -390,10 +443,10 @@ namespace HEIF
                 if (hasTrackInfo(segTrackId))
                 {
                     SequenceImageId sampleBase;
-                    const SamplePropertyVector& sampleInfo = getSampleInfo(segTrackId, sampleBase);
+                    const SamplePropertyTable& sampleInfo = getSampleInfo(segTrackId, sampleBase);
                     for (uint32_t index = 0; index < sampleInfo.size(); ++index)
                     {
-                        if (sampleInfo[index].sampleType == SampleType::OUTPUT_REFERENCE_FRAME)
+                        if (sampleInfo.sampleType(index) == SampleType::OUTPUT_REFERENCE_FRAME)
                         {
                             matches.push_back(index + sampleBase.get());
                         }
@@ -405,10 +458,10 @@ namespace HEIF
                 if (hasTrackInfo(segTrackId))
                 {
                     SequenceImageId sampleBase;
-                    const SamplePropertyVector& sampleInfo = getSampleInfo(segTrackId, sampleBase);
+                    const SamplePropertyTable& sampleInfo = getSampleInfo(segTrackId, sampleBase);
                     for (uint32_t index = 0; index < sampleInfo.size(); ++index)
                     {
-                        if (sampleInfo[index].sampleType == SampleType::NON_OUTPUT_REFERENCE_FRAME)
+                        if (sampleInfo.sampleType(index) == SampleType::NON_OUTPUT_REFERENCE_FRAME)
                         {
                             matches.push_back(index + sampleBase.get());
                         }
@@ -420,10 +473,10 @@ namespace HEIF
                 if (hasTrackInfo(segTrackId))
                 {
                     SequenceImageId sampleBase;
-                    const SamplePropertyVector& sampleInfo = getSampleInfo(segTrackId, sampleBase);
+                    const SamplePropertyTable& sampleInfo = getSampleInfo(segTrackId, sampleBase);
                     for (uint32_t index = 0; index < sampleInfo.size(); ++index)
                     {
-                        if (sampleInfo[index].sampleType == SampleType::OUTPUT_NON_REFERENCE_FRAME)
+                        if (sampleInfo.sampleType(index) == SampleType::OUTPUT_NON_REFERENCE_FRAME)
                         {
                             matches.push_back(index + sampleBase.get());
                         }
@@ -434,40 +487,21 @@ namespace HEIF
             {
                 if (hasTrackInfo(segTrackId))
                 {
-                    Vector<SequenceImageId> sampleIds;
-                    // Collect frames to display
+                    // Collect every presentation of frames to display, in display order
                     SequenceImageId sampleBase;
-                    const SamplePropertyVector& sampleInfo = getSampleInfo(segTrackId, sampleBase);
-                    for (uint32_t index = 0; index < sampleInfo.size(); ++index)
-                    {
-                        if (sampleInfo[index].sampleType == SampleType::OUTPUT_NON_REFERENCE_FRAME ||
-                            sampleInfo[index].sampleType == SampleType::OUTPUT_REFERENCE_FRAME)
-                        {
-                            sampleIds.push_back(index + sampleBase.get());
-                        }
-                    }
-
-                    // Collect every presentation time stamp of every sample
-                    Vector<ItemIdTimestampPair> samplePresentationTimes;
-                    for (auto sampleId : sampleIds)
-                    {
-                        const auto& trackInfo = getTrackInfo(segTrackId);
-                        const auto singleSamplePresentationTimes =
-                            trackInfo.samples.at(sampleId.get() - trackInfo.itemIdBase.get()).compositionTimes;
-                        for (auto sampleTime : singleSamplePresentationTimes)
-                        {
-                            samplePresentationTimes.push_back(std::make_pair(sampleId, sampleTime));
-                        }
-                    }
-
-                    // Sort to display order using composition times
-                    std::sort(samplePresentationTimes.begin(), samplePresentationTimes.end(),
-                              [&](ItemIdTimestampPair a, ItemIdTimestampPair b) { return a.second < b.second; });
+                    const SamplePropertyTable& sampleInfo = getSampleInfo(segTrackId, sampleBase);
+                    Vector<TimestampIDPair> samplePresentationTimes;
+                    sampleInfo.appendPresentations(
+                        [&](std::size_t index) {
+                            return sampleInfo.sampleType(index) == SampleType::OUTPUT_NON_REFERENCE_FRAME ||
+                                   sampleInfo.sampleType(index) == SampleType::OUTPUT_REFERENCE_FRAME;
+                        },
+                        samplePresentationTimes);
 
                     // Push sample ids to the result
-                    for (auto pair : samplePresentationTimes)
+                    for (const auto& pair : samplePresentationTimes)
                     {
-                        matches.push_back(pair.first.get());
+                        matches.push_back(pair.itemId.get());
                     }
                 }
             }
@@ -493,6 +527,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getItemType(const ImageId& itemId, FourCC& type) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemType");
         ErrorCode error;
         if ((error = isInitialized()) != ErrorCode::OK)
         {
@@ -512,6 +547,7 @@ namespace HEIF
                                           const SequenceImageId& sequenceImageId,
                                           FourCC& type) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemType");
         ErrorCode error;
         SampleProperties sampleInfo;
         if ((error = getSampleInfo(sequenceId, sequenceImageId, sampleInfo)) != ErrorCode::OK)
@@ -527,6 +563,7 @@ namespace HEIF
                                                               const FourCC& referenceType,
                                                               Array<ImageId>& itemIds) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getReferencedFromItemListByType");
         ErrorCode error;
         if ((error = isValidImageItem(fromItemId)) != ErrorCode::OK)
         {
@@ -556,6 +593,7 @@ namespace HEIF
                                                             const FourCC& referenceType,
                                                             Array<ImageId>& itemIds) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getReferencedToItemListByType");
         ErrorCode error;
         if ((error = isValidImageItem(toItemId)) != ErrorCode::OK)
         {
@@ -586,6 +624,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getPrimaryItem(ImageId& itemId) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getPrimaryItem");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -606,6 +645,7 @@ namespace HEIF
                                           uint64_t& memoryBufferSize,
                                           bool bytestreamHeaders) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemData");
         ErrorCode error;
         if ((error = isValidItem(itemId)) != ErrorCode::OK)
         {
@@ -637,7 +677,8 @@ namespace HEIF
             memoryBufferSize = static_cast<uint32_t>(itemLength);
             return ErrorCode::BUFFER_SIZE_TOO_SMALL;
         }
-        memoryBufferSize = static_cast<uint32_t>(itemLength);
+        const uint64_t bufferCapacity = memoryBufferSize;
+        memoryBufferSize              = static_cast<uint32_t>(itemLength);
 
         // read NAL data to bitstream object
         bool processData = false;
@@ -687,19 +728,10 @@ namespace HEIF
                 return error;
             }
 
-            if (codeType == FourCC("avc1"))
-            {
-                // Get item data from AVC bitstream
-                error = processAvcItemData(memoryBuffer, memoryBufferSize);
-                if (error != ErrorCode::OK)
-                {
-                    return error;
-                }
-            }
-            else if (codeType == FourCC("hvc1"))
+            if ((codeType == FourCC("avc1")) || (codeType == FourCC("hvc1")))
             {
-                // Get item data from HEVC bitstream
-                error = processHevcItemData(memoryBuffer, memoryBufferSize);
+                // Get item data from AVC or HEVC bitstream
+                error = processNalItemData(memoryBuffer, memoryBufferSize, bufferCapacity, getNalLengthSize(itemId));
                 if (error != ErrorCode::OK)
                 {
                     return error;
@@ -714,6 +746,92 @@ namespace HEIF
         return ErrorCode::OK;
     }
 
+    ErrorCode HeifReaderImpl::getItemDataViews(const ImageId& itemId, Array<DataView>& extents) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemDataViews");
+        ErrorCode error;
+        if ((error = isValidItem(itemId)) != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        Vector<DataView> views;
+        try
+        {
+            error = readItemViews(mMetaBox, itemId, views);
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+        }
+        catch (const ISOBMFF::Exception& exc)
+        {
+            logError() << "Error: " << exc.what() << std::endl;
+            return ErrorCode::FILE_READ_ERROR;
+        }
+        catch (const std::exception& e)
+        {
+            logError() << "Error: " << e.what() << std::endl;
+            return ErrorCode::FILE_READ_ERROR;
+        }
+
+        extents = makeArray<DataView>(views);
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getItemDataLocation(const ImageId& itemId, uint64_t& offset, uint64_t& size) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemDataLocation");
+        ErrorCode error;
+        if ((error = isValidItem(itemId)) != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        const ItemLocationBox& iloc = mMetaBox.getItemLocationBox();
+        if (!iloc.hasItemIdEntry(itemId.get()))
+        {
+            return ErrorCode::INVALID_ITEM_ID;
+        }
+        const ItemLocation& itemLocation = iloc.getItemLocationForID(itemId.get());
+        const ExtentList& extentList     = itemLocation.getExtentList();
+        if ((iloc.getVersion() >= 1) &&
+            (itemLocation.getConstructionMethod() != ItemLocation::ConstructionMethod::FILE_OFFSET))
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+        if ((extentList.size() != 1) || (extentList[0].mExtentLength == 0))
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+
+        const std::uint64_t itemOffset = itemLocation.getBaseOffset() + extentList[0].mExtentOffset;
+        const std::uint64_t fileSize   = mMetaBoxLocation.fileSize;
+        if ((itemOffset > fileSize) || (extentList[0].mExtentLength > fileSize - itemOffset))
+        {
+            return ErrorCode::FILE_READ_ERROR;
+        }
+
+        offset = itemOffset;
+        size   = extentList[0].mExtentLength;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getMetaBoxLocation(MetaBoxLocation& location) const
+    {
+        if (isInitialized() != ErrorCode::OK)
+        {
+            return ErrorCode::UNINITIALIZED;
+        }
+        if (!mMetaBoxLoaded)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+
+        location = mMetaBoxLocation;
+        return ErrorCode::OK;
+    }
+
     /// @todo Avoid data copying.
     ErrorCode HeifReaderImpl::getItemData(const SequenceId& sequenceId,
                                           const SequenceImageId& itemId,
@@ -721,6 +839,7 @@ namespace HEIF
                                           uint64_t& memoryBufferSize,
                                           bool bytestreamHeaders)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemData");
         ErrorCode error;
         if ((error = isValidSample(sequenceId, itemId)) != ErrorCode::OK)
         {
@@ -728,7 +847,8 @@ namespace HEIF
         }
 
         // read NAL data to bitstream object
-        error = getTrackSampleData(sequenceId, itemId, memoryBuffer, memoryBufferSize);
+        const uint64_t bufferCapacity = memoryBufferSize;
+        error                         = getTrackSampleData(sequenceId, itemId, memoryBuffer, memoryBufferSize);
         if (error != ErrorCode::OK)
         {
             return error;
@@ -744,19 +864,12 @@ namespace HEIF
 
         if (bytestreamHeaders)
         {
-            if ((codeType == FourCC("avc1")) || (codeType == FourCC("avc3")))
-            {
-                // Get item data from AVC bitstream
-                error = processAvcItemData(memoryBuffer, memoryBufferSize);
-                if (error != ErrorCode::OK)
-                {
-                    return error;
-                }
-            }
-            else if ((codeType == FourCC("hvc1")) || (codeType == FourCC("hev1")))
+            if ((codeType == FourCC("avc1")) || (codeType == FourCC("avc3")) || (codeType == FourCC("hvc1")) ||
+                (codeType == FourCC("hev1")))
             {
-                // Get item data from HEVC bitstream
-                error = processHevcItemData(memoryBuffer, memoryBufferSize);
+                // Get item data from AVC or HEVC bitstream
+                error = processNalItemData(memoryBuffer, memoryBufferSize, bufferCapacity,
+                                           getNalLengthSize(sequenceId, itemId));
                 if (error != ErrorCode::OK)
                 {
                     return error;
@@ -805,48 +918,45 @@ namespace HEIF
             return ErrorCode::INVALID_ITEM_ID;
         }
 
-        const uint32_t sampleLength = getTrackInfo(segTrackId).samples.at(itemId.get()).dataLength;
+        const uint32_t sampleLength = getTrackInfo(segTrackId).samples.dataLength(itemId.get());
         if (memoryBufferSize < sampleLength)
         {
             memoryBufferSize = sampleLength;
             return ErrorCode::MEMORY_TOO_SMALL_BUFFER;
         }
 
-        seekInput(io, static_cast<std::int64_t>(getTrackInfo(segTrackId).samples.at(itemId.get()).dataOffset));
-        io.stream->read(reinterpret_cast<char*>(memoryBuffer), sampleLength);
-        memoryBufferSize = sampleLength;
-
-        if (!io.stream->good())
+        const auto dataOffset = static_cast<std::int64_t>(getTrackInfo(segTrackId).samples.dataOffset(itemId.get()));
+        if (!io.stream->readAt(dataOffset, reinterpret_cast<char*>(memoryBuffer), sampleLength))
         {
             return ErrorCode::FILE_READ_ERROR;
         }
+        memoryBufferSize = sampleLength;
 
         return ErrorCode::OK;
     }
 
     ErrorCode HeifReaderImpl::segmentIdOf(SequenceId sequenceId, SequenceImageId itemId, SegmentId& segmentId) const
     {
-        bool wentPast = false;
+        const ErrorCode moovError = loadPendingMoov();
+        if (moovError != ErrorCode::OK)
+        {
+            return moovError;
+        }
 
         if (mFileProperties.segmentPropertiesMap.empty())
         {
             return ErrorCode::INVALID_SEGMENT;
         }
 
-        const auto& segs = segmentsBySequence();
-        for (auto segmentIt = segs.begin(); !wentPast && segmentIt != segs.end(); ++segmentIt)
+        // The last segment whose first sample of the track is not after itemId
+        const auto segments = mFileProperties.segmentsByItemIdBase.find(sequenceId);
+        if (segments != mFileProperties.segmentsByItemIdBase.end())
         {
-            auto track = segmentIt->trackInfos.find(sequenceId);
-            if (track != segmentIt->trackInfos.end())
+            auto segment = segments->second.upper_bound(itemId);
+            if (segment != segments->second.begin())
             {
-                if (track->second.itemIdBase > itemId)
-                {
-                    wentPast = true;
-                }
-                else
-                {
-                    segmentId = segmentIt->segmentId;
-                }
+                --segment;
+                segmentId = segment->second;
             }
         }
 
@@ -859,6 +969,7 @@ namespace HEIF
             {
                 if (itemId.get() - track->second.itemIdBase.get() < std::uint32_t(track->second.samples.size()))
                 {
+                    touchSegment(segmentId);
                     ret = ErrorCode::OK;
                 }
             }
@@ -869,6 +980,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getItem(const ImageId& itemId, Overlay& iovlItem) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItem");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -895,6 +1007,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getItem(const ImageId& itemId, Grid& gridItem) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItem");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -920,6 +1033,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, Scale& iscl) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -939,6 +1053,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, CreationTimeInformation& crtt) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -955,6 +1070,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, ModificationTimeInformation& mdft) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -971,6 +1087,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, AccessibilityText& altt) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -988,6 +1105,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, RequiredReferenceTypes& rref) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1010,6 +1128,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, UserDescription& udes) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1030,6 +1149,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, AuxiliaryType& auxc) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1057,6 +1177,7 @@ namespace HEIF
                                           const std::uint32_t index,
                                           AuxiliaryType& auxc) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -1075,6 +1196,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, Mirror& imir) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1094,6 +1216,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, Rotate& irot) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1113,6 +1236,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, RelativeLocation& rloc) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1132,6 +1256,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, PixelInformation& pixi) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1150,6 +1275,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, ColourInformation& colr) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1174,6 +1300,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, PixelAspectRatio& pasp) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1193,6 +1320,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, CleanAperture& clap) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1210,18 +1338,20 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const PropertyId& index, RawProperty& property) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
-        const auto data = mMetaBox.getItemPropertiesBox().getPropertyDataByIndex(index.get());
-        if (data.empty())
+        const std::uint8_t* data;
+        std::uint64_t size;
+        if (!mMetaBox.getItemPropertiesBox().getPropertyDataView(index.get(), data, size))
         {
             return ErrorCode::INVALID_PROPERTY_INDEX;
         }
 
-        property.data = makeArray<std::uint8_t>(data);
+        property.data = Array<std::uint8_t>(data, data + size);
         property.type = FourCC(reinterpret_cast<const char*>(&data[4]));
 
         return ErrorCode::OK;
@@ -1229,6 +1359,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getProperty(const SequenceId& sequenceId, std::uint32_t index, CleanAperture& clap) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getProperty");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -1260,6 +1391,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getItemProperties(const GroupId& groupId, Array<ItemPropertyInfo>& propertyTypes) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemProperties");
         ErrorCode error;
 
         if ((error = isValidEntityGroup(groupId)) != ErrorCode::OK)
@@ -1280,6 +1412,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getItemProperties(const ImageId& itemId, Array<ItemPropertyInfo>& propertyTypes) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemProperties");
         ErrorCode error;
         if ((error = isValidItem(itemId)) != ErrorCode::OK)
         {
@@ -1300,82 +1433,159 @@ namespace HEIF
                                                                uint8_t* memoryBuffer,
                                                                uint64_t& memoryBufferSize) const
     {
-        ErrorCode error;
-        if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemDataWithDecoderParameters");
+        DataView decoderParameters;
+        ErrorCode error = getDecoderParameterView(itemId, decoderParameters);
+        if (error != ErrorCode::OK)
         {
             return error;
         }
 
-        bool isProtected = false;
-        error            = getProtection(itemId, isProtected);
+        // Item data goes after the parameter sets, which are copied only once the item fits in the buffer.
+        const uint64_t parameterSize = decoderParameters.size;
+        uint64_t itemSize            = (memoryBufferSize > parameterSize) ? memoryBufferSize - parameterSize : 0;
+        error                        = getItemData(itemId, memoryBuffer + parameterSize, itemSize);
         if (error != ErrorCode::OK)
         {
+            if (error == ErrorCode::BUFFER_SIZE_TOO_SMALL)
+            {
+                memoryBufferSize = itemSize + parameterSize;
+            }
             return error;
         }
-        if (isProtected)
+
+        std::memcpy(memoryBuffer, decoderParameters.data, parameterSize);
+        memoryBufferSize = itemSize + parameterSize;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getItemDataWithDecoderParameters(const SequenceId& sequenceId,
+                                                               const SequenceImageId& itemId,
+                                                               uint8_t* memoryBuffer,
+                                                               uint64_t& memoryBufferSize)
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemDataWithDecoderParameters");
+        DataView decoderParameters;
+        ErrorCode error = getDecoderParameterView(sequenceId, itemId, decoderParameters);
+        if (error != ErrorCode::OK)
         {
-            return ErrorCode::PROTECTED_ITEM;
+            return error;
         }
 
-        FourCC codeType;
-        error = getDecoderCodeType(itemId, codeType);
+        // Sample data goes after the parameter sets, which are copied only once the sample fits in the buffer.
+        const uint64_t parameterSize = decoderParameters.size;
+        uint64_t itemSize            = (memoryBufferSize > parameterSize) ? memoryBufferSize - parameterSize : 0;
+        error                        = getItemData(sequenceId, itemId, memoryBuffer + parameterSize, itemSize);
         if (error != ErrorCode::OK)
         {
+            if (error == ErrorCode::BUFFER_SIZE_TOO_SMALL)
+            {
+                memoryBufferSize = itemSize + parameterSize;
+            }
             return error;
         }
 
-        if ((codeType != FourCC("hvc1")) && (codeType != FourCC("avc1")))
+        std::memcpy(memoryBuffer, decoderParameters.data, parameterSize);
+        memoryBufferSize = itemSize + parameterSize;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getItemDataWithDecoderParameters(const ImageId& itemId,
+                                                               DataView& decoderParameters,
+                                                               uint8_t* memoryBuffer,
+                                                               uint64_t& memoryBufferSize) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemDataWithDecoderParameters");
+        DataView parameterSets;
+        ErrorCode error = getDecoderParameterView(itemId, parameterSets);
+        if (error != ErrorCode::OK)
         {
-            // No other code types supported
-            return ErrorCode::UNSUPPORTED_CODE_TYPE;
+            return error;
         }
 
-        DecoderConfiguration decoderInfos;
-        error = getDecoderParameterSets(itemId, decoderInfos);
+        error = getItemData(itemId, memoryBuffer, memoryBufferSize);
         if (error != ErrorCode::OK)
         {
             return error;
         }
+        decoderParameters = parameterSets;
+        return ErrorCode::OK;
+    }
 
-        // Calculate size of parameter sets, but do not copy the data yet.
-        size_t parameterSize = 0;
-        for (auto& config : decoderInfos.decoderSpecificInfo)
+    ErrorCode HeifReaderImpl::getItemDataWithDecoderParameters(const SequenceId& sequenceId,
+                                                               const SequenceImageId& itemId,
+                                                               DataView& decoderParameters,
+                                                               uint8_t* memoryBuffer,
+                                                               uint64_t& memoryBufferSize)
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemDataWithDecoderParameters");
+        DataView parameterSets;
+        ErrorCode error = getDecoderParameterView(sequenceId, itemId, parameterSets);
+        if (error != ErrorCode::OK)
         {
-            parameterSize += config.decSpecInfoData.size;
+            return error;
         }
 
-        uint64_t itemSize(0);
-        if (memoryBufferSize > parameterSize)
+        error = getItemData(sequenceId, itemId, memoryBuffer, memoryBufferSize);
+        if (error != ErrorCode::OK)
         {
-            // Copy parameter data to the beginning of the buffer.
-            size_t offset = 0;
-            for (const auto& config : decoderInfos.decoderSpecificInfo)
-            {
-                std::memcpy(memoryBuffer + offset, config.decSpecInfoData.begin(), config.decSpecInfoData.size);
-                offset += config.decSpecInfoData.size;
-            }
-            itemSize = memoryBufferSize - static_cast<uint32_t>(parameterSize);
+            return error;
+        }
+        decoderParameters = parameterSets;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getDecoderParameterView(const ImageId& itemId, DataView& decoderParameters) const
+    {
+        ErrorCode error;
+        if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
+        {
+            return error;
         }
 
-        // Copy item data to the buffer
-        error = getItemData(itemId, &memoryBuffer[parameterSize], itemSize);
+        bool isProtected = false;
+        error            = getProtection(itemId, isProtected);
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+        if (isProtected)
+        {
+            return ErrorCode::PROTECTED_ITEM;
+        }
+
+        FourCC codeType;
+        error = getDecoderCodeType(itemId, codeType);
         if (error != ErrorCode::OK)
         {
-            if (error == ErrorCode::BUFFER_SIZE_TOO_SMALL)
-            {
-                memoryBufferSize = itemSize + static_cast<uint32_t>(parameterSize);
-            }
             return error;
         }
 
-        memoryBufferSize = itemSize + static_cast<uint32_t>(parameterSize);
+        if ((codeType != FourCC("hvc1")) && (codeType != FourCC("avc1")))
+        {
+            // No other code types supported
+            return ErrorCode::UNSUPPORTED_CODE_TYPE;
+        }
+
+        const auto configIter = mImageToParameterSetMap.find(itemId);
+        if (configIter == mImageToParameterSetMap.cend())
+        {
+            return ErrorCode::INVALID_ITEM_ID;
+        }
+        const auto parameterSetsIter = mImageItemParameterSets.find(configIter->second);
+        if (parameterSetsIter == mImageItemParameterSets.cend())
+        {
+            return ErrorCode::FILE_HEADER_ERROR;
+        }
+
+        decoderParameters.data = parameterSetsIter->second.data();
+        decoderParameters.size = parameterSetsIter->second.size();
         return ErrorCode::OK;
     }
 
-    ErrorCode HeifReaderImpl::getItemDataWithDecoderParameters(const SequenceId& sequenceId,
-                                                               const SequenceImageId& itemId,
-                                                               uint8_t* memoryBuffer,
-                                                               uint64_t& memoryBufferSize)
+    ErrorCode HeifReaderImpl::getDecoderParameterView(const SequenceId& sequenceId,
+                                                      const SequenceImageId& itemId,
+                                                      DataView& decoderParameters)
     {
         ErrorCode error;
         if ((error = isValidSample(sequenceId, itemId)) != ErrorCode::OK)
@@ -1397,87 +1607,290 @@ namespace HEIF
             return ErrorCode::UNSUPPORTED_CODE_TYPE;
         }
 
-        DecoderConfiguration decoderConfiguration;
-        error = getDecoderParameterSets(sequenceId, itemId, decoderConfiguration);
+        const DataVector* parameterSets = getParameterSets(sequenceId, itemId);
+        if (parameterSets == nullptr)
+        {
+            return ErrorCode::INVALID_SEQUENCE_IMAGE_ID;
+        }
+
+        decoderParameters.data = parameterSets->data();
+        decoderParameters.size = parameterSets->size();
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getGridTileData(const ImageId& gridId,
+                                              GridTileData& gridTileData,
+                                              TaskRunner* taskRunner) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getGridTileData");
+        Grid grid;
+        ErrorCode error = getItem(gridId, grid);
         if (error != ErrorCode::OK)
         {
             return error;
         }
+        if (grid.imageIds.size == 0)
+        {
+            return ErrorCode::FILE_HEADER_ERROR;
+        }
+
+        // Check that all tiles can be fed to the same decoder(s).
+        FourCC codeType;
+        DecoderConfigId decoderConfigId;
+        for (size_t i = 0; i < grid.imageIds.size; ++i)
+        {
+            const ImageId tileId = grid.imageIds[i];
+            bool isProtected     = false;
+            error                = getProtection(tileId, isProtected);
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+            if (isProtected)
+            {
+                return ErrorCode::PROTECTED_ITEM;
+            }
+
+            FourCC tileCodeType;
+            error = getDecoderCodeType(tileId, tileCodeType);
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+            if ((tileCodeType != FourCC("hvc1")) && (tileCodeType != FourCC("avc1")))
+            {
+                return ErrorCode::UNSUPPORTED_CODE_TYPE;
+            }
+
+            const auto parameterSetIter = mImageToParameterSetMap.find(tileId);
+            if (parameterSetIter == mImageToParameterSetMap.cend())
+            {
+                return ErrorCode::INVALID_ITEM_ID;
+            }
+
+            if (i == 0)
+            {
+                codeType        = tileCodeType;
+                decoderConfigId = parameterSetIter->second;
+            }
+            else if ((tileCodeType != codeType) || (parameterSetIter->second != decoderConfigId))
+            {
+                return ErrorCode::DECODER_CONFIGURATION_ERROR;
+            }
+        }
 
-        // Calculate size of parameter sets, but do not copy the data yet.
-        size_t parameterSize = 0;
-        for (auto& config : decoderConfiguration.decoderSpecificInfo)
+        const auto parameterSetsIter = mImageItemParameterSets.find(decoderConfigId);
+        if (parameterSetsIter == mImageItemParameterSets.cend())
         {
-            parameterSize += config.decSpecInfoData.size;
+            return ErrorCode::FILE_HEADER_ERROR;
         }
 
-        // Copy item data to the buffer
-        uint64_t itemSize(0);
-        if (memoryBufferSize > parameterSize)
+        const auto& io = mFileProperties.segmentPropertiesMap.at(0).io;
+        Array<TileData> tiles(grid.imageIds.size);
+        Vector<ReadRange> ranges;
+        Vector<size_t> assembledTiles;  // tiles not stored as file extents
+        std::uint64_t totalSize = 0;
+        try
         {
-            // Copy parameter data to the beginning of the buffer.
-            size_t offset = 0;
-            for (const auto& config : decoderConfiguration.decoderSpecificInfo)
+            // Resolve all tile extents in one pass.
+            for (size_t i = 0; i < grid.imageIds.size; ++i)
             {
-                std::memcpy(memoryBuffer + offset, config.decSpecInfoData.begin(), config.decSpecInfoData.size);
-                offset += config.decSpecInfoData.size;
+                const ImageId tileId = grid.imageIds[i];
+                std::uint64_t itemLength(0);
+                List<ImageId> pastReferences;
+                error = getItemLength(mMetaBox, tileId, itemLength, pastReferences);
+                if (error != ErrorCode::OK)
+                {
+                    return error;
+                }
+                if (static_cast<int64_t>(itemLength) > io.size)
+                {
+                    return ErrorCode::FILE_HEADER_ERROR;
+                }
+
+                error = getItemReadRanges(mMetaBox, tileId, totalSize, ranges);
+                if (error == ErrorCode::NOT_APPLICABLE)
+                {
+                    assembledTiles.push_back(i);
+                }
+                else if (error != ErrorCode::OK)
+                {
+                    return error;
+                }
+
+                tiles[i].imageId = tileId;
+                tiles[i].offset  = totalSize;
+                tiles[i].size    = itemLength;
+                totalSize += itemLength;
             }
-            itemSize = memoryBufferSize - static_cast<uint32_t>(parameterSize);
+        }
+        catch (const ISOBMFF::Exception& exc)
+        {
+            logError() << "Error: " << exc.what() << std::endl;
+            return ErrorCode::FILE_READ_ERROR;
+        }
+        catch (const std::exception& e)
+        {
+            logError() << "Error: " << e.what() << std::endl;
+            return ErrorCode::FILE_READ_ERROR;
         }
 
-        error = getItemData(sequenceId, itemId, &memoryBuffer[parameterSize], itemSize);
-        if (error != ErrorCode::OK)
+        // Merge ranges which are adjacent both in the file and in the output buffer.
+        std::stable_sort(ranges.begin(), ranges.end(),
+                         [](const ReadRange& a, const ReadRange& b) { return a.fileOffset < b.fileOffset; });
+        Vector<ReadRange> mergedRanges;
+        mergedRanges.reserve(ranges.size());
+        for (const auto& range : ranges)
         {
-            if (error == ErrorCode::BUFFER_SIZE_TOO_SMALL)
+            if (range.size == 0)
             {
-                memoryBufferSize = itemSize + static_cast<uint32_t>(parameterSize);
+                continue;
             }
-            return error;
+            if (!mergedRanges.empty())
+            {
+                ReadRange& previous = mergedRanges.back();
+                if ((previous.fileOffset + previous.size == range.fileOffset) &&
+                    (previous.bufferOffset + previous.size == range.bufferOffset) &&
+                    (previous.size + range.size <= MAX_MERGED_READ_SIZE))
+                {
+                    previous.size += range.size;
+                    continue;
+                }
+            }
+            mergedRanges.push_back(range);
+        }
+
+        Array<uint8_t> data(totalSize);
+        ReadRangesContext context;
+        context.stream = io.stream.get();
+        context.ranges = mergedRanges.data();
+        context.buffer = data.elements;
+        context.failed = false;
+        if (taskRunner && mergedRanges.size() > 1)
+        {
+            taskRunner->run(&readRangeTask, &context, mergedRanges.size());
+        }
+        else
+        {
+            for (size_t i = 0; i < mergedRanges.size(); ++i)
+            {
+                readRangeTask(&context, i);
+            }
+        }
+        if (context.failed)
+        {
+            return ErrorCode::FILE_READ_ERROR;
+        }
+
+        try
+        {
+            for (const auto tileIndex : assembledTiles)
+            {
+                const TileData& tile = tiles[tileIndex];
+                error                = readItem(mMetaBox, tile.imageId, data.elements + tile.offset, tile.size);
+                if (error != ErrorCode::OK)
+                {
+                    return error;
+                }
+            }
+        }
+        catch (const ISOBMFF::Exception& exc)
+        {
+            logError() << "Error: " << exc.what() << std::endl;
+            return ErrorCode::FILE_READ_ERROR;
+        }
+        catch (const std::exception& e)
+        {
+            logError() << "Error: " << e.what() << std::endl;
+            return ErrorCode::FILE_READ_ERROR;
+        }
+
+        // Substitute nal-length values with bytestream headers. Tiles grow if nal-length values are shorter than
+        // bytestream headers, and are then moved to a larger buffer first.
+        const unsigned int nalLengthSize = getNalLengthSize(grid.imageIds[0]);
+        if (nalLengthSize != 4)
+        {
+            std::uint64_t byteStreamSize = 0;
+            for (auto& tile : tiles)
+            {
+                std::uint64_t tileSize;
+                if (!getByteStreamSize(data.elements + tile.offset, tile.size, nalLengthSize, tileSize))
+                {
+                    return ErrorCode::FILE_READ_ERROR;
+                }
+                tile.offset = byteStreamSize;
+                byteStreamSize += tileSize;
+            }
+            Array<uint8_t> byteStreamData(byteStreamSize);
+            std::uint64_t dataOffset = 0;
+            for (const auto& tile : tiles)
+            {
+                std::memcpy(byteStreamData.elements + tile.offset, data.elements + dataOffset, tile.size);
+                dataOffset += tile.size;
+            }
+            std::swap(data.elements, byteStreamData.elements);
+            std::swap(data.size, byteStreamData.size);
         }
-        memoryBufferSize = itemSize + static_cast<uint32_t>(parameterSize);
+        for (size_t i = 0; i < tiles.size; ++i)
+        {
+            TileData& tile                = tiles[i];
+            const std::uint64_t available = ((i + 1 < tiles.size) ? tiles[i + 1].offset : data.size) - tile.offset;
+
+            error = processNalItemData(data.elements + tile.offset, tile.size, available, nalLengthSize);
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+        }
+
+        gridTileData.grid              = grid;
+        gridTileData.decoderCodeType   = codeType;
+        gridTileData.decoderConfigId   = decoderConfigId;
+        gridTileData.decoderParameters = makeArray<uint8_t>(parameterSetsIter->second);
+        gridTileData.tiles             = tiles;
+
+        // Hand the tile data buffer over without copying it.
+        std::swap(gridTileData.data.elements, data.elements);
+        std::swap(gridTileData.data.size, data.size);
         return ErrorCode::OK;
     }
 
     ErrorCode HeifReaderImpl::getItemTimestamps(const SequenceId& sequenceId, Array<TimestampIDPair>& timestamps) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemTimestamps");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
             return error;
         }
 
-        WriteOnceMap<Timestamp, SequenceImageId> timestampMap;
-
+        // Presentations of each segment are sorted, and merged with the ones of the preceding segments. Of equal
+        // timestamps, the one of the earliest sample is kept.
+        Vector<TimestampIDPair> presentations;
         for (const auto& segment : mFileProperties.segmentPropertiesMap)
         {
             SegmentId segmentId       = segment.first;
             SegmentTrackId segTrackId = std::make_pair(segmentId, sequenceId);
             if (hasTrackInfo(segTrackId))
             {
-                for (const auto& sampleInfo : getTrackInfo(segTrackId).samples)
-                {
-                    if (sampleInfo.sampleType == SampleType::NON_OUTPUT_REFERENCE_FRAME)
-                    {
-                        continue;
-                    }
-                    for (auto compositionTime : sampleInfo.compositionTimes)
-                    {
-                        timestampMap.insert(std::make_pair(compositionTime, sampleInfo.sampleId));
-                    }
-                }
+                const SamplePropertyTable& samples = getTrackInfo(segTrackId).samples;
+                const auto segmentBegin            = static_cast<std::ptrdiff_t>(presentations.size());
+                samples.appendPresentations(
+                    [&](std::size_t index) {
+                        return samples.sampleType(index) != SampleType::NON_OUTPUT_REFERENCE_FRAME;
+                    },
+                    presentations);
+                std::inplace_merge(
+                    presentations.begin(), presentations.begin() + segmentBegin, presentations.end(),
+                    [](const TimestampIDPair& a, const TimestampIDPair& b) { return a.timeStamp < b.timeStamp; });
             }
         }
+        const auto last = std::unique(
+            presentations.begin(), presentations.end(),
+            [](const TimestampIDPair& a, const TimestampIDPair& b) { return a.timeStamp == b.timeStamp; });
+        presentations.erase(last, presentations.end());
 
-        timestamps = Array<TimestampIDPair>(timestampMap.size());
-        uint32_t i = 0;
-        for (auto const& entry : timestampMap)
-        {
-            TimestampIDPair pair;
-            pair.timeStamp           = entry.first;
-            pair.itemId              = entry.second;
-            timestamps.elements[i++] = pair;
-        }
-
+        timestamps = makeArray<TimestampIDPair>(presentations);
         return ErrorCode::OK;
     }
 
@@ -1485,6 +1898,7 @@ namespace HEIF
                                                   const SequenceImageId& itemIdApi,
                                                   Array<int64_t>& timestamps) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getTimestampsOfItem");
         ErrorCode error;
         if ((error = isValidSample(sequenceId, itemIdApi)) != ErrorCode::OK)
         {
@@ -1500,15 +1914,17 @@ namespace HEIF
         SequenceImageId itemId = itemIdApi.get() - getTrackInfo(SegmentTrackId(segmentId, sequenceId)).itemIdBase.get();
         SegmentTrackId segTrackId = std::make_pair(segmentId, sequenceId);
 
-        const auto& displayTimes = getTrackInfo(segTrackId).samples.at(itemId.get()).compositionTimes;
+        const auto displayTimes = getTrackInfo(segTrackId).samples.compositionTimes(itemId.get());
 
-        timestamps = makeArray<int64_t>(displayTimes);
+        timestamps = Array<int64_t>(displayTimes.size());
+        std::copy(displayTimes.begin(), displayTimes.end(), timestamps.begin());
         return ErrorCode::OK;
     }
 
     ErrorCode HeifReaderImpl::getItemsInDecodingOrder(const SequenceId& sequenceId,
                                                       Array<TimestampIDPair>& decodingOrder) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemsInDecodingOrder");
         ErrorCode error;
         if ((error = isValidTrack(sequenceId)) != ErrorCode::OK)
         {
@@ -1524,19 +1940,13 @@ namespace HEIF
 
             if (hasTrackInfo(segTrackId))
             {
-                const auto& samples = getTrackInfo(segTrackId).samples;
-                decodingOrderVector.reserve(samples.size());
-                for (const auto& sample : samples)
-                {
-                    for (const auto compositionTime : sample.compositionTimes)
-                    {
-                        decodingOrderVector.push_back({compositionTime, sample.sampleId});
-                    }
-                }
-
-                // Sort using composition times
-                std::sort(decodingOrderVector.begin(), decodingOrderVector.end(),
-                          [&](TimestampIDPair a, TimestampIDPair b) { return a.timeStamp < b.timeStamp; });
+                // Presentations of the segment come sorted, and are merged with the ones of the preceding segments.
+                const auto& samples     = getTrackInfo(segTrackId).samples;
+                const auto segmentBegin = static_cast<std::ptrdiff_t>(decodingOrderVector.size());
+                samples.appendPresentations([](std::size_t) { return true; }, decodingOrderVector);
+                std::inplace_merge(
+                    decodingOrderVector.begin(), decodingOrderVector.begin() + segmentBegin, decodingOrderVector.end(),
+                    [](const TimestampIDPair& a, const TimestampIDPair& b) { return a.timeStamp < b.timeStamp; });
             }
         }
 
@@ -1547,8 +1957,65 @@ namespace HEIF
         return ErrorCode::OK;
     }
 
+    ErrorCode HeifReaderImpl::createSampleReader(const SequenceId& sequenceId,
+                                                 const SampleReaderConfig& config,
+                                                 SampleReader*& sampleReader) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "createSampleReader");
+        Array<TimestampIDPair> decodingOrder;
+        ErrorCode error = getItemsInDecodingOrder(sequenceId, decodingOrder);
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        // Resolve sample locations here, so that the background thread only reads the streams.
+        Vector<SampleReaderImpl::Sample> samples;
+        samples.reserve(decodingOrder.size);
+        for (const auto& entry : decodingOrder)
+        {
+            SegmentId segmentId;
+            if ((error = segmentIdOf(sequenceId, entry.itemId, segmentId)) != ErrorCode::OK)
+            {
+                return error;
+            }
+            const TrackInfoInSegment& trackInfo = getTrackInfo(std::make_pair(segmentId, sequenceId));
+            const std::uint32_t index           = entry.itemId.get() - trackInfo.itemIdBase.get();
+
+            SampleReaderImpl::Sample sample;
+            sample.sampleId      = entry.itemId;
+            sample.timeStamp     = entry.timeStamp;
+            sample.stream        = mFileProperties.segmentPropertiesMap.at(segmentId).io.stream.get();
+            sample.offset        = trackInfo.samples.dataOffset(index);
+            sample.size          = trackInfo.samples.dataLength(index);
+            sample.nalLengthSize = 0;
+            if (config.bytestreamHeaders)
+            {
+                FourCC codeType;
+                if ((error = getDecoderCodeType(sequenceId, entry.itemId, codeType)) != ErrorCode::OK)
+                {
+                    return error;
+                }
+                if ((codeType == FourCC("avc1")) || (codeType == FourCC("avc3")) || (codeType == FourCC("hvc1")) ||
+                    (codeType == FourCC("hev1")))
+                {
+                    sample.nalLengthSize = getNalLengthSize(sequenceId, entry.itemId);
+                }
+                else if ((codeType != "mp4a") && (codeType != "mp4v"))
+                {
+                    return ErrorCode::UNSUPPORTED_CODE_TYPE;
+                }
+            }
+            samples.push_back(sample);
+        }
+
+        sampleReader = CUSTOM_NEW(SampleReaderImpl, (std::move(samples), config));
+        return ErrorCode::OK;
+    }
+
     ErrorCode HeifReaderImpl::getDecodeDependencies(const ImageId& imageId, Array<ImageId>& dependencies) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDecodeDependencies");
         return getReferencedFromItemListByType(imageId, "pred", dependencies);
     }
 
@@ -1556,16 +2023,19 @@ namespace HEIF
                                                     const SequenceImageId& itemId,
                                                     Array<SequenceImageId>& dependencies) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDecodeDependencies");
+        SegmentId segmentId;
         ErrorCode error;
-        SampleProperties sampleInfo;
-        if ((error = getSampleInfo(sequenceId, itemId, sampleInfo)) != ErrorCode::OK)
+        if ((error = segmentIdOf(sequenceId, itemId, segmentId)) != ErrorCode::OK)
         {
             return error;
         }
 
-        Vector<SequenceImageId> dependencyVector;
-        const auto& decodeDependencies = sampleInfo.decodeDependencies;
-        dependencyVector.insert(dependencyVector.begin(), decodeDependencies.cbegin(), decodeDependencies.cend());
+        // Read only the dependencies, as SampleProperties would copy all composition times of the sample.
+        SequenceImageId sampleBase;
+        const auto& sampleTable       = getSampleInfo(std::make_pair(segmentId, sequenceId), sampleBase);
+        const auto decodeDependencies = sampleTable.decodeDependencies(itemId.get() - sampleBase.get());
+        Vector<SequenceImageId> dependencyVector(decodeDependencies.begin(), decodeDependencies.end());
 
         // For I-frames return item id itself.
         if (dependencyVector.empty())
@@ -1579,6 +2049,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getDecoderCodeType(const ImageId& itemId, FourCC& type) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDecoderCodeType");
         ErrorCode error;
         if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
         {
@@ -1599,6 +2070,7 @@ namespace HEIF
                                                  const SequenceImageId& sampleId,
                                                  FourCC& decoderCodeType) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDecoderCodeType");
         ErrorCode error;
         if ((error = isValidTrack(trackId)) != ErrorCode::OK)
         {
@@ -1624,12 +2096,10 @@ namespace HEIF
             return ErrorCode::INVALID_SEQUENCE_ID;
         }
         const TrackInfoInSegment& trackInfo = trackInfoIt->second;
-        const auto& decoderCodeTypeMap      = trackInfo.decoderCodeTypeMap;
-
-        auto iter = decoderCodeTypeMap.find(sampleId);
-        if (iter != decoderCodeTypeMap.end())
+        const std::uint32_t sampleIndex     = sampleId.get() - trackInfo.itemIdBase.get();
+        if (sampleIndex < trackInfo.samples.size())
         {
-            decoderCodeType = iter->second.getUInt32();
+            decoderCodeType = trackInfo.samples.sampleEntryType(sampleIndex).getUInt32();
             return ErrorCode::OK;
         }
 
@@ -1638,6 +2108,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getDecoderParameterSets(const ImageId& itemId, DecoderConfiguration& decoderInfos) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDecoderParameterSets");
         ErrorCode error;
         if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
         {
@@ -1676,6 +2147,7 @@ namespace HEIF
                                                       const SequenceImageId& itemId,
                                                       DecoderConfiguration& decoderInfos) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getDecoderParameterSets");
         ErrorCode error;
         if ((error = isValidSample(sequenceId, itemId)) != ErrorCode::OK)
         {
@@ -1704,6 +2176,7 @@ namespace HEIF
                                                       uint8_t* memoryBuffer,
                                                       uint64_t& memoryBufferSize) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getItemProtectionScheme");
         ErrorCode error;
         if ((error = isValidImageItem(itemId)) != ErrorCode::OK)
         {
@@ -1740,11 +2213,18 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::getTrackInformations(Array<TrackInformation>& trackInfos) const
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getTrackInformations");
         if (isInitialized() != ErrorCode::OK)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode error = loadPendingMoov();
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
         const size_t totalSize   = mFileProperties.initTrackInfos.size();
         trackInfos               = Array<TrackInformation>(totalSize);
         uint32_t outTrackIdxBase = 0;
@@ -1849,43 +2329,43 @@ namespace HEIF
                     if (!trackInfo.samples.empty())
                     {
                         std::uint64_t sum = 0;
-                        for (const auto& sample : trackInfo.samples)
+                        for (std::size_t index = 0; index < trackInfo.samples.size(); ++index)
                         {
-                            sum += static_cast<std::uint64_t>(sample.sampleDurationTS);
+                            sum += static_cast<std::uint64_t>(trackInfo.samples.sampleDurationTS(index));
                         }
                         auto timeScale = mFileProperties.initTrackInfos.at(trackId).timeScale;
                         trackInfos.elements[outTrackIdx].frameRate =
                             Rational{timeScale, sum / trackInfo.samples.size()};
                     }
 
-                    for (auto const& sample : trackInfo.samples)
+                    const SamplePropertyTable& samples = trackInfo.samples;
+                    for (std::size_t index = 0; index < samples.size(); ++index)
                     {
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].sampleId = sample.sampleId.get();
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].sampleEntryType =
-                            sample.sampleEntryType.getUInt32();
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].sampleDescriptionIndex =
-                            sample.sampleDescriptionIndex.get();
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].sampleType = sample.sampleType;
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].segmentId  = segment.segmentId.get();
-                        if (!sample.compositionTimes.empty() != 0u)
+                        SampleInformation& sampleInformation = trackInfos.elements[outTrackIdx].sampleProperties[i];
+                        sampleInformation.sampleId           = samples.sampleId(index).get();
+                        sampleInformation.sampleEntryType    = samples.sampleEntryType(index).getUInt32();
+                        sampleInformation.sampleDescriptionIndex = samples.sampleDescriptionIndex(index).get();
+                        sampleInformation.sampleType             = samples.sampleType(index);
+                        sampleInformation.segmentId              = segment.segmentId.get();
+                        const auto compositionTimes              = samples.compositionTimes(index);
+                        const auto compositionTimesTS            = samples.compositionTimesTS(index);
+                        if (!compositionTimes.empty() && !compositionTimesTS.empty())
                         {
                             // Edit list has been applied to these timestamps already, so negative times shouldn't be
                             // present.
-                            trackInfos.elements[outTrackIdx].sampleProperties[i].earliestTimestamp =
-                                static_cast<std::uint64_t>(sample.compositionTimes.at(0));
-                            trackInfos.elements[outTrackIdx].sampleProperties[i].earliestTimestampTS =
-                                sample.compositionTimesTS.at(0);
+                            sampleInformation.earliestTimestamp   = static_cast<std::uint64_t>(compositionTimes[0]);
+                            sampleInformation.earliestTimestampTS = compositionTimesTS[0];
                         }
                         else
                         {
-                            trackInfos.elements[outTrackIdx].sampleProperties[i].earliestTimestamp   = 0;
-                            trackInfos.elements[outTrackIdx].sampleProperties[i].earliestTimestampTS = 0;
+                            sampleInformation.earliestTimestamp   = 0;
+                            sampleInformation.earliestTimestampTS = 0;
                         }
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].sampleFlags.flagsAsUInt =
-                            sample.sampleFlags.flagsAsUInt;
-                        trackInfos.elements[outTrackIdx].sampleProperties[i].sampleDurationTS = sample.sampleDurationTS;
+                        sampleInformation.sampleFlags      = samples.sampleFlags(index);
+                        sampleInformation.sampleDurationTS = samples.sampleDurationTS(index);
 
-                        unsigned int sampleSize = sample.dataLength;
+                        unsigned int sampleSize = samples.dataLength(index);
+                        sampleInformation.size  = sampleSize;
                         if (sampleSize > trackInfos.elements[outTrackIdx].maxSampleSize)
                         {
                             trackInfos.elements[outTrackIdx].maxSampleSize = sampleSize;
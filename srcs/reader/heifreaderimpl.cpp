@@ -48,6 +48,7 @@
 #include "moviebox.hpp"
 #include "moviefragmentbox.hpp"
 #include "mp4audiosampleentrybox.hpp"
+#include "nalutil.hpp"
 #include "requiredreferencetypesproperty.hpp"
 #include "sampletometadataitementry.hpp"
 #include "segmentindexbox.hpp"
@@ -73,6 +74,49 @@ namespace HEIF
             return array;
         }
 
+        /**
+         * Store all repetitions of a repeating edit list in pMap and pMapTS, so that the timestamps of track runs can
+         * be added to them. Entries of the two maps are repeated in step until the track duration is reached. */
+        void expandRepetition(TrackInfoInSegment& trackInfo)
+        {
+            const EditRepetition repetition = trackInfo.repetition;
+            const std::size_t count         = trackInfo.pMap.size();
+            const std::size_t countTS       = trackInfo.pMapTS.size();
+            if (repetition.period <= 0 || count == 0 || countTS == 0)
+            {
+                return;
+            }
+
+            DecodePts::PMap pMap;
+            DecodePts::PMapTS pMapTS;
+            for (std::size_t i = 0;; ++i)
+            {
+                const auto& entry = *(trackInfo.pMap.cbegin() + static_cast<std::ptrdiff_t>(i % count));
+                const DecodePts::PresentationTime time =
+                    entry.first + static_cast<DecodePts::PresentationTime>(i / count) * repetition.period;
+                if (time >= repetition.end)
+                {
+                    break;
+                }
+                const auto& entryTS = *(trackInfo.pMapTS.cbegin() + static_cast<std::ptrdiff_t>(i % countTS));
+                const DecodePts::PresentationTimeTS timeTS =
+                    entryTS.first + static_cast<DecodePts::PresentationTimeTS>((i / countTS) * repetition.periodTS);
+                pMap.insert(time, entry.second);
+                pMapTS.insert(timeTS, entryTS.second);
+            }
+            trackInfo.pMap       = std::move(pMap);
+            trackInfo.pMapTS     = std::move(pMapTS);
+            trackInfo.repetition = EditRepetition();
+        }
+
+        /// Destroy and default construct an object, so that all memory held by it is released.
+        template <typename T>
+        void recreate(T& object)
+        {
+            object.~T();
+            new (&object) T();
+        }
+
     }  // anonymous namespace
 
     /* ********************************************************************** */
@@ -84,15 +128,26 @@ namespace HEIF
         , mIsPrimaryItemSet(false)
         , mPrimaryItemId(0)
         , mMetaBoxLoaded(false)
+        , mMetaBoxLocation()
     {
     }
 
     ErrorCode HeifReaderImpl::initialize(const char* fileName)
+    {
+        return initialize(fileName, ReaderConfig());
+    }
+
+    ErrorCode HeifReaderImpl::initialize(StreamInterface* stream)
+    {
+        return initialize(stream, ReaderConfig());
+    }
+
+    ErrorCode HeifReaderImpl::initialize(const char* fileName, const ReaderConfig& config)
     {
         ErrorCode rc;
         auto& io = mFileStream;
-        io.fileStream.reset(openFile(fileName));
-        rc = initialize(&*io.fileStream);
+        io.fileStream.reset(openFile(fileName, config.memoryMapFile));
+        rc = initialize(&*io.fileStream, config);
         if (rc != ErrorCode::OK)
         {
             io.fileStream.reset();
@@ -100,9 +155,12 @@ namespace HEIF
         return rc;
     }
 
-    ErrorCode HeifReaderImpl::initialize(StreamInterface* stream)
+    ErrorCode HeifReaderImpl::initialize(StreamInterface* stream, const ReaderConfig& config)
     {
-        UniquePtr<InternalStream> internalStream(CUSTOM_NEW(InternalStream, (stream)));
+        mStatistics.reset(createStatisticsCollector(config.collectStatistics));
+        StatisticsScope statisticsScope(mStatistics.get(), "initialize");
+
+        UniquePtr<InternalStream> internalStream(CUSTOM_NEW(InternalStream, (stream, config.readAheadSize)));
 
         if (!internalStream->good())
         {
@@ -110,6 +168,9 @@ namespace HEIF
         }
 
         reset();
+        mConfig = config;
+        prepareArena(config);
+        ArenaScope arenaScope(mArena.get(), mConfig.parseAllocator);
 
         SegmentId segmentId = 0;  // Initialization segment id
         auto& io            = mFileProperties.segmentPropertiesMap[segmentId].io;
@@ -118,7 +179,11 @@ namespace HEIF
 
         try
         {
-            ErrorCode error = readStream();
+            ErrorCode error = ErrorCode::OK;
+            if ((mConfig.indexCache == nullptr) || (loadIndexCache() != ErrorCode::OK))
+            {
+                error = readStream();
+            }
             if (error != ErrorCode::OK)
             {
                 return error;
@@ -135,29 +200,43 @@ namespace HEIF
             return ErrorCode::FILE_READ_ERROR;
         }
 
-        mFileInformation = makeFileInformation(mFileProperties);
+        makeFileInformation(mFileProperties, mFileInformation);
 
         return ErrorCode::OK;
     }
 
-    FileInformation HeifReaderImpl::makeFileInformation(const FileInformationInternal& intInfo) const
+    void HeifReaderImpl::makeFileInformation(const FileInformationInternal& intInfo,
+                                             FileInformation& fileInformation) const
     {
-        FileInformation fileInformation;
         fileInformation.rootMetaBoxInformation = convertRootMetaBoxInformation(intInfo.rootLevelMetaBoxProperties);
-        fileInformation.trackInformation       = convertTrackInformation(intInfo.initTrackInfos);
         fileInformation.features               = intInfo.fileFeature.getFeatureMask();
         fileInformation.movieTimescale         = intInfo.moovProperties.movieTimescale;
 
-        return fileInformation;
+        // Hand the track information over without copying the sample information arrays in it.
+        Array<TrackInformation> trackInformation = convertTrackInformation(intInfo.initTrackInfos);
+        std::swap(fileInformation.trackInformation.elements, trackInformation.elements);
+        std::swap(fileInformation.trackInformation.size, trackInformation.size);
+    }
+
+    ErrorCode HeifReaderImpl::getStatistics(ReaderStatistics& statistics) const
+    {
+        if (!mStatistics)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+        mStatistics->get(statistics.total, statistics.calls, statistics.phases);
+        return ErrorCode::OK;
     }
 
     void HeifReaderImpl::close()
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "close");
         reset();
     }
 
     ErrorCode HeifReaderImpl::invalidateSegment(const SegmentId segmentId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "invalidateSegment");
         const bool isSegment = (mFileProperties.segmentPropertiesMap.count(segmentId) == 1u);
         if (isSegment == false)
         {
@@ -170,13 +249,32 @@ namespace HEIF
         {
             sequenceToSegment.erase(sequence);
         }
+        for (const auto& trackInfo : segmentProperties.trackInfos)
+        {
+            auto& segments     = mFileProperties.segmentsByItemIdBase[trackInfo.first];
+            const auto segment = segments.find(trackInfo.second.itemIdBase);
+            if (segment != segments.end() && segment->second == segmentId)
+            {
+                segments.erase(segment);
+            }
+        }
         mFileProperties.segmentPropertiesMap.erase(segmentId);
 
+        std::lock_guard<std::mutex> lock(mSegmentUsageMutex);
+        const auto usage = mSegmentUsage.find(segmentId);
+        if (usage != mSegmentUsage.end())
+        {
+            mSegmentsAllocatedSize -= usage->second.allocatedSize;
+            mSegmentUseOrder.erase(usage->second.useOrderPosition);
+            mSegmentUsage.erase(usage);
+        }
+
         return ErrorCode::OK;
     }
 
     ErrorCode HeifReaderImpl::getSegmentIndex(Array<SegmentInformation>& segmentIndex)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "getSegmentIndex");
         segmentIndex = mFileProperties.segmentIndex;
         return ErrorCode::OK;
     }
@@ -184,8 +282,9 @@ namespace HEIF
     ErrorCode HeifReaderImpl::parseSegmentIndex(StreamInterface* streamInterface,
                                                 Array<SegmentInformation>& segmentIndex)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parseSegmentIndex");
         StreamIO io;
-        io.stream.reset(CUSTOM_NEW(InternalStream, (streamInterface)));
+        io.stream.reset(CUSTOM_NEW(InternalStream, (streamInterface, mConfig.readAheadSize)));
         if (io.stream->peekEof())
         {
             io.stream.reset();
@@ -207,6 +306,7 @@ namespace HEIF
                 {
                     if (boxType == "sidx")
                     {
+                        StatisticsScope sidxStatistics(mStatistics.get(), "parse sidx", StatisticsScope::Kind::PHASE);
                         error = readBox(io, bitstream);
                         if (error == ErrorCode::OK)
                         {
@@ -264,17 +364,24 @@ namespace HEIF
                                            SegmentId segmentId,
                                            uint64_t earliestPTSinTS)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parseSegment");
         if (mFileProperties.segmentPropertiesMap.count(segmentId) != 0u)
         {
             return ErrorCode::OK;
         }
 
+        const ErrorCode moovError = loadPendingMoov();
+        if (moovError != ErrorCode::OK)
+        {
+            return moovError;
+        }
+
         State prevState = mState;
         mState          = State::INITIALIZING;
 
         SegmentProperties& segmentProperties = mFileProperties.segmentPropertiesMap[segmentId];
         StreamIO& io                         = segmentProperties.io;
-        io.stream.reset(CUSTOM_NEW(InternalStream, (streamInterface)));
+        io.stream.reset(CUSTOM_NEW(InternalStream, (streamInterface, mConfig.readAheadSize)));
         if (io.stream->peekEof())
         {
             mState = prevState;
@@ -318,6 +425,7 @@ namespace HEIF
                     }
                     else if (boxType == "sidx")
                     {
+                        StatisticsScope sidxStatistics(mStatistics.get(), "parse sidx", StatisticsScope::Kind::PHASE);
                         error = readBox(io, bitstream);
                         if (error == ErrorCode::OK)
                         {
@@ -380,7 +488,8 @@ namespace HEIF
             }
             io.stream->clear();
 
-            mFileInformation = makeFileInformation(mFileProperties);
+            updateSegmentUsage(segmentId);
+            makeFileInformation(mFileProperties, mFileInformation);
 
             mState = State::READY;
         }
@@ -443,18 +552,55 @@ namespace HEIF
     {
         mState = State::UNINITIALIZED;
 
-        mFileInformation  = {};
-        mFileProperties   = {};
-        mFtyp             = {};
+        // Parse state is destroyed instead of assigned empty values, which may keep the capacity of containers, so
+        // that nothing refers to the arena when it is rewound below. Until then, the arena tells apart its own memory
+        // being freed without a lookup, while new objects are allocated as outside of parsing.
+        AllocatorScope releaseScope(mArena ? getCustomAllocator() : nullptr, nullptr, 0, mArena.get());
+        recreate(mFileInformation);
+        recreate(mFileProperties);
+        recreate(mFtyp);
+        recreate(mEtyp);
         mIsPrimaryItemSet = false;
-        mMetaBox          = {};
-        mMetaBoxInfo      = {};
-        mMetaBoxLoaded    = false;
-        mPrimaryItemId    = 0;
+        recreate(mMetaBox);
+        recreate(mMetaBoxInfo);
+        mMetaBoxLoaded   = false;
+        mMetaBoxLocation = {};
+        recreate(mHeaderBoxes);
+        mPrimaryItemId = 0;
+
+        mConfig            = {};
+        mPendingMoovOffset = -1;
+        mPendingMoovSize   = 0;
 
-        mImageItemCodeTypeMap.clear();
-        mImageItemParameterSetMap.clear();
-        mImageToParameterSetMap.clear();
+        {
+            std::lock_guard<std::mutex> lock(mSegmentUsageMutex);
+            recreate(mSegmentUseOrder);
+            recreate(mSegmentUsage);
+            mSegmentsAllocatedSize = 0;
+        }
+
+        recreate(mImageItemCodeTypeMap);
+        recreate(mImageItemParameterSetMap);
+        recreate(mImageItemParameterSets);
+        recreate(mImageToParameterSetMap);
+
+        if (mArena)
+        {
+            mArena->rewind();
+        }
+    }
+
+    void HeifReaderImpl::prepareArena(const ReaderConfig& config)
+    {
+        CustomAllocator* upstream = config.parseAllocator ? config.parseAllocator : getCustomAllocator();
+        if (config.arenaBlockSize == 0)
+        {
+            mArena.reset();
+        }
+        else if (!mArena || mArena->getUpstream() != upstream || mArena->getBlockSize() != config.arenaBlockSize)
+        {
+            mArena.reset(CUSTOM_NEW(ArenaAllocator, (upstream, config.arenaBlockSize)));
+        }
     }
 
     MetaBoxInformation HeifReaderImpl::convertRootMetaBoxInformation(const MetaBoxProperties& metaboxProperties) const
@@ -530,27 +676,10 @@ namespace HEIF
             }
 
             const SegmentId intializationSegmentId = 0;
-            const SamplePropertyVector& samplePropertyVector =
-                mFileProperties.segmentPropertiesMap.at(intializationSegmentId)
-                    .trackInfos.at(trackInfoOut[i].trackId)
-                    .samples;
-            Array<SampleInformation> sampleInfo(samplePropertyVector.size());
-            unsigned int j = 0;
-            for (const auto& sampleProp : samplePropertyVector)
-            {
-                sampleInfo[j].sampleId                  = sampleProp.sampleId;
-                sampleInfo[j].sampleEntryType           = sampleProp.sampleEntryType.getUInt32();
-                sampleInfo[j].sampleDescriptionIndex    = sampleProp.sampleDescriptionIndex.get();
-                sampleInfo[j].sampleType                = sampleProp.sampleType;
-                sampleInfo[j].sampleDurationTS          = sampleProp.sampleDurationTS;
-                sampleInfo[j].sampleCompositionOffsetTs = sampleProp.sampleCompositionOffsetTs;
-                sampleInfo[j].hasClap                   = sampleProp.hasClap;
-                sampleInfo[j].hasAuxi                   = sampleProp.hasAuxi;
-                sampleInfo[j].codingConstraints         = sampleProp.codingConstraints;
-                sampleInfo[j].size                      = sampleProp.dataLength;
-                ++j;
-            }
-            trackInfoOut[i].sampleProperties = sampleInfo;
+            const SamplePropertyTable& samples = mFileProperties.segmentPropertiesMap.at(intializationSegmentId)
+                                                     .trackInfos.at(trackInfoOut[i].trackId)
+                                                     .samples;
+            samples.getSampleInformation(trackInfoOut[i].sampleProperties);
             ++i;
         }
 
@@ -559,6 +688,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::handleMeta(StreamIO& io)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parse meta", StatisticsScope::Kind::PHASE);
         BitStream bitstream;
         auto error = readBox(io, bitstream);
         if (error != ErrorCode::OK)
@@ -572,7 +702,8 @@ namespace HEIF
         mMetaBoxInfo                               = extractItems(metaBox);
         processDecoderConfigProperties(metaBox.getItemPropertiesBox(),
                                        mFileProperties.rootLevelMetaBoxProperties.itemFeaturesMap,
-                                       mImageItemParameterSetMap, mImageToParameterSetMap, mImageItemCodeTypeMap);
+                                       mImageItemParameterSetMap, mImageItemParameterSets, mImageToParameterSetMap,
+                                       mImageItemCodeTypeMap);
 
         Array<ImageId> masterImages;
         getMasterImages(masterImages);
@@ -594,32 +725,40 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::handleMoov(StreamIO& io)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parse moov", StatisticsScope::Kind::PHASE);
         BitStream bitstream;
-        SegmentId initializationSegmentId = 0;
 
         auto error = readBox(io, bitstream);
         if (error == ErrorCode::OK)
         {
-            MovieBox moov;
-            moov.parseBox(bitstream);
-
-            mFileProperties.moovProperties = extractMoovProperties(moov);
-            fillSegmentPropertiesMap(initializationSegmentId, moov, mFileProperties.segmentPropertiesMap);
-            mFileProperties.initTrackInfos =
-                extractInitTrackInfos(initializationSegmentId, moov, mFileProperties.segmentPropertiesMap);
-            mFileProperties.moovProperties.movieTimescale = moov.getMovieHeaderBox().getTimeScale();
-            mFileProperties.moovProperties.mMatrix        = moov.getMovieHeaderBox().getMatrix();
+            parseMoov(bitstream);
         }
 
         return error;
     }
 
+    void HeifReaderImpl::parseMoov(BitStream& bitstream)
+    {
+        SegmentId initializationSegmentId = 0;
+        MovieBox moov;
+        moov.parseBox(bitstream);
+
+        mFileProperties.moovProperties = extractMoovProperties(moov);
+        fillSegmentPropertiesMap(initializationSegmentId, moov, mFileProperties.segmentPropertiesMap);
+        mFileProperties.initTrackInfos =
+            extractInitTrackInfos(initializationSegmentId, moov, mFileProperties.segmentPropertiesMap);
+        indexSegmentTracks(initializationSegmentId);
+        mFileProperties.moovProperties.movieTimescale = moov.getMovieHeaderBox().getTimeScale();
+        mFileProperties.moovProperties.mMatrix        = moov.getMovieHeaderBox().getMatrix();
+    }
+
     ErrorCode HeifReaderImpl::handleSegmentMoof(StreamIO& io,
                                                 const SegmentId segmentId,
                                                 bool& earliestPTSRead,
                                                 Map<SequenceId, DecodePts::PresentationTimeTS>& earliestPTSTS,
                                                 uint64_t& earliestPTSinTS)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parse moof", StatisticsScope::Kind::PHASE);
         // we need to save moof start byte for possible trun dataoffset depending on its flags.
         const StreamInterface::offset_t moofFirstByte = io.stream->tell();
 
@@ -672,6 +811,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::handleInitSegmentMoof(StreamIO& io, const SegmentId segmentId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parse moof", StatisticsScope::Kind::PHASE);
         BitStream bitstream;
 
         // we need to save moof start byte for possible trun dataoffset depending on its flags.
@@ -699,8 +839,9 @@ namespace HEIF
 
             if (!trackInfo.samples.empty())
             {
-                auto sampleDataEndOffset = static_cast<int64_t>(trackInfo.samples.rbegin()->dataOffset +
-                                                                trackInfo.samples.rbegin()->dataLength);
+                const std::size_t lastSample = trackInfo.samples.size() - 1;
+                auto sampleDataEndOffset     = static_cast<int64_t>(trackInfo.samples.dataOffset(lastSample) +
+                                                                trackInfo.samples.dataLength(lastSample));
                 if (sampleDataEndOffset > io.size || sampleDataEndOffset < 0)
                 {
                     throw RuntimeError(
@@ -715,6 +856,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::handleFtyp(StreamIO& io)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parse ftyp", StatisticsScope::Kind::PHASE);
         BitStream bitstream;
         auto error = readBox(io, bitstream);
         if (error == ErrorCode::OK)
@@ -776,6 +918,7 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::handleEtyp(StreamIO& io)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "parse ftyp", StatisticsScope::Kind::PHASE);
         BitStream bitstream;
         auto error = readBox(io, bitstream);
         if (error != ErrorCode::OK)
@@ -825,7 +968,8 @@ namespace HEIF
                 String boxType;
                 std::int64_t boxSize = 0;
                 BitStream bitstream;
-                error = readBoxParameters(io, boxType, boxSize);
+                const std::int64_t boxOffset = io.stream->tell();
+                error                        = readBoxParameters(io, boxType, boxSize);
                 if (error == ErrorCode::OK)
                 {
                     if (boxType == "ftyp")
@@ -835,7 +979,8 @@ namespace HEIF
                             return ErrorCode::FILE_READ_ERROR;  // Multiple ftyp boxes.
                         }
                         ftypFound = true;
-                        error     = handleFtyp(io);
+                        mHeaderBoxes.push_back(std::make_pair(boxOffset, boxSize));
+                        error = handleFtyp(io);
                     }
                     else if (boxType == "etyp")
                     {
@@ -844,7 +989,8 @@ namespace HEIF
                             return ErrorCode::FILE_READ_ERROR;  // Multiple etyp boxes, also must be after ftyp.
                         }
                         etypFound = true;
-                        error     = handleEtyp(io);
+                        mHeaderBoxes.push_back(std::make_pair(boxOffset, boxSize));
+                        error = handleEtyp(io);
                     }
                     else if (boxType == "meta")
                     {
@@ -852,8 +998,11 @@ namespace HEIF
                         {
                             return ErrorCode::FILE_READ_ERROR;  // Multiple root-level meta boxes.
                         }
-                        metaFound = true;
-                        error     = handleMeta(io);
+                        metaFound               = true;
+                        mMetaBoxLocation.offset = static_cast<std::uint64_t>(boxOffset);
+                        mMetaBoxLocation.space  = static_cast<std::uint64_t>(boxSize);
+                        mHeaderBoxes.push_back(std::make_pair(boxOffset, boxSize));
+                        error = handleMeta(io);
                     }
                     else if (boxType == "moov")
                     {
@@ -864,16 +1013,43 @@ namespace HEIF
                         }
                         moovFound = true;
                         addSegmentSequence(0, mNextSequence);
-                        error = handleMoov(io);
+                        if (mConfig.lazyTrackParsing)
+                        {
+                            mPendingMoovOffset = io.stream->tell();
+                            mPendingMoovSize   = boxSize;
+                            error              = skipBox(io);
+                        }
+                        else
+                        {
+                            error = handleMoov(io);
+                        }
                     }
                     else if (boxType == "moof")
                     {
+                        // Movie fragments extend the tracks of 'moov', so a skipped 'moov' is needed now.
+                        if (mPendingMoovOffset >= 0)
+                        {
+                            const std::int64_t moofOffset = io.stream->tell();
+                            error                         = parsePendingMoov();
+                            seekInput(io, moofOffset);
+                            if (error != ErrorCode::OK)
+                            {
+                                break;
+                            }
+                        }
+
                         // 0 index of segmentPropertiesMap is reserved for initialization segment data
                         const SegmentId initializationSegmentId = 0;
                         error                                   = handleInitSegmentMoof(io, initializationSegmentId);
                     }
                     else if (boxType == "mdat" || boxType == "free" || boxType == "skip")
                     {
+                        // Free space directly after the 'meta' box is room the 'meta' box can grow into in place.
+                        if (metaFound && (boxType != "mdat") &&
+                            (static_cast<std::uint64_t>(boxOffset) == mMetaBoxLocation.offset + mMetaBoxLocation.space))
+                        {
+                            mMetaBoxLocation.space += static_cast<std::uint64_t>(boxSize);
+                        }
                         // skip 'mdat' as it is handled elsewhere, 'free' can be skipped
                         error = skipBox(io);
                     }
@@ -914,12 +1090,73 @@ namespace HEIF
             }
             io.stream->clear();
             mFileProperties.fileFeature = getFileFeatures();
+            mMetaBoxLocation.fileSize   = static_cast<std::uint64_t>(io.size);
             mState                      = State::READY;
         }
 
         return error;
     }
 
+    ErrorCode HeifReaderImpl::loadPendingMoov() const
+    {
+        if (mPendingMoovOffset.load(std::memory_order_acquire) < 0)
+        {
+            return ErrorCode::OK;
+        }
+
+        std::lock_guard<std::mutex> lock(mPendingMoovMutex);
+        if (mPendingMoovOffset.load(std::memory_order_relaxed) < 0)
+        {
+            return ErrorCode::OK;  // Parsed by another thread while waiting.
+        }
+        return const_cast<HeifReaderImpl*>(this)->parsePendingMoov();
+    }
+
+    ErrorCode HeifReaderImpl::parsePendingMoov()
+    {
+        ArenaScope arenaScope(mArena.get(), mConfig.parseAllocator);
+        StreamIO& io            = mFileProperties.segmentPropertiesMap.at(0).io;
+        const std::int64_t moov = mPendingMoovOffset.load(std::memory_order_relaxed);
+        ErrorCode error         = ErrorCode::OK;
+
+        try
+        {
+            StatisticsScope statisticsScope(mStatistics.get(), "parse moov", StatisticsScope::Kind::PHASE);
+            Vector<std::uint8_t> data(static_cast<std::size_t>(mPendingMoovSize));
+            if (io.stream->readAt(moov, reinterpret_cast<char*>(data.data()), mPendingMoovSize))
+            {
+                BitStream bitstream(std::move(data));
+                parseMoov(bitstream);
+            }
+            else
+            {
+                error = ErrorCode::FILE_READ_ERROR;
+            }
+        }
+        catch (const ISOBMFF::Exception& exc)
+        {
+            logError() << "parsePendingMoov Exception Error: " << exc.what() << std::endl;
+            error = ErrorCode::FILE_READ_ERROR;
+        }
+        catch (const std::exception& e)
+        {
+            logError() << "parsePendingMoov std::exception Error:: " << e.what() << std::endl;
+            error = ErrorCode::FILE_READ_ERROR;
+        }
+
+        // When called from readStream(), these are done once the whole stream has been read.
+        if ((error == ErrorCode::OK) && (mState == State::READY))
+        {
+            updateCompositionTimes(0);
+            mFileProperties.fileFeature = getFileFeatures();
+            makeFileInformation(mFileProperties, mFileInformation);
+        }
+
+        // Errors are reported once, by the caller which triggered the parsing, like in readStream().
+        mPendingMoovOffset.store(-1, std::memory_order_release);
+        return error;
+    }
+
     HeifReaderImpl::ItemInfoMap HeifReaderImpl::extractItemInfoMap(const MetaBox& metaBox)
     {
         ItemInfoMap itemInfoMap;
@@ -989,15 +1226,17 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::readBytes(StreamIO& io, const unsigned int count, std::int64_t& result)
     {
-        std::int64_t value = 0;
+        std::uint8_t bytes[8];
+        io.stream->read(reinterpret_cast<char*>(bytes), count);
+        if (!io.stream->good())
+        {
+            return ErrorCode::FILE_READ_ERROR;
+        }
 
+        std::int64_t value = 0;
         for (unsigned int i = 0; i < count; ++i)
         {
-            value = (value << 8) | static_cast<int64_t>(io.stream->get());
-            if (!io.stream->good())
-            {
-                return ErrorCode::FILE_READ_ERROR;
-            }
+            value = (value << 8) | static_cast<int64_t>(bytes[i]);
         }
 
         result = value;
@@ -1049,9 +1288,7 @@ namespace HEIF
         {
             return ErrorCode::FILE_READ_ERROR;
         }
-        bitstream.clear();
-        bitstream.reset();
-        bitstream.write8BitsArray(data, std::uint64_t(boxSize));
+        bitstream = BitStream(std::move(data));
         return ErrorCode::OK;
     }
 
@@ -1157,6 +1394,23 @@ namespace HEIF
         return pm;
     }
 
+    DataVector HeifReaderImpl::concatenateParameterSets(const ParameterSetMap& parameterSetMap)
+    {
+        // Map order of the types is the decoding order, e.g. VPS, SPS, PPS.
+        size_t size = 0;
+        for (const auto& entry : parameterSetMap)
+        {
+            size += entry.second.size();
+        }
+        DataVector parameterSets;
+        parameterSets.reserve(size);
+        for (const auto& entry : parameterSetMap)
+        {
+            parameterSets.insert(parameterSets.end(), entry.second.cbegin(), entry.second.cend());
+        }
+        return parameterSets;
+    }
+
     void HeifReaderImpl::getCollectionItems(Vector<ImageId>& items) const
     {
         items.clear();
@@ -1185,10 +1439,11 @@ namespace HEIF
 
             if (hasTrackInfo(segTrackId))
             {
-                samples.reserve(getTrackInfo(segTrackId).samples.size());
-                for (const auto& sampleInfo : getTrackInfo(segTrackId).samples)
+                const SamplePropertyTable& sampleTable = getTrackInfo(segTrackId).samples;
+                samples.reserve(samples.size() + sampleTable.size());
+                for (std::size_t index = 0; index < sampleTable.size(); ++index)
                 {
-                    samples.push_back(sampleInfo.sampleId);
+                    samples.push_back(sampleTable.sampleId(index));
                 }
             }
         }
@@ -1215,57 +1470,28 @@ namespace HEIF
         return ErrorCode::OK;
     }
 
-    ErrorCode HeifReaderImpl::processAvcItemData(uint8_t* memoryBuffer, uint64_t& memoryBufferSize)
+    ErrorCode HeifReaderImpl::processNalItemData(uint8_t* memoryBuffer,
+                                                 uint64_t& memoryBufferSize,
+                                                 const uint64_t bufferCapacity,
+                                                 const unsigned int nalLengthSize)
     {
-        uint32_t outputOffset = 0;
-        uint32_t byteOffset   = 0;
-
-        while (outputOffset < memoryBufferSize)
+        if (!convertLengthPrefixedToByteStream(memoryBuffer, memoryBufferSize, bufferCapacity, nalLengthSize))
         {
-            uint32_t nalLength                      = memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 0;
-            byteOffset++;
-            nalLength                               = (nalLength << 8) | memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 0;
-            byteOffset++;
-            nalLength                               = (nalLength << 8) | memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 0;
-            byteOffset++;
-            nalLength                               = (nalLength << 8) | memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 1;
-            // byteOffset++;
-            // AvcNalUnitType naluType = AvcNalUnitType((uint8_t)memoryBuffer[outputOffset + byteOffset] & 0x1f);
-            outputOffset += nalLength + 4;  // 4 bytes of nal length information
-            byteOffset = 0;
+            return (memoryBufferSize > bufferCapacity) ? ErrorCode::BUFFER_SIZE_TOO_SMALL : ErrorCode::FILE_READ_ERROR;
         }
         return ErrorCode::OK;
     }
 
-    ErrorCode HeifReaderImpl::processHevcItemData(uint8_t* memoryBuffer, uint64_t& memoryBufferSize)
+    unsigned int HeifReaderImpl::getNalLengthSize(const ImageId imageId) const
     {
-        uint32_t outputOffset = 0;
-        uint32_t byteOffset   = 0;
-
-        while (outputOffset < memoryBufferSize)
+        const auto parameterSetIter = mImageToParameterSetMap.find(imageId);
+        if (parameterSetIter == mImageToParameterSetMap.cend())
         {
-            uint32_t nalLength                      = memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 0;
-            byteOffset++;
-            nalLength                               = (nalLength << 8) | memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 0;
-            byteOffset++;
-            nalLength                               = (nalLength << 8) | memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 0;
-            byteOffset++;
-            nalLength                               = (nalLength << 8) | memoryBuffer[outputOffset + byteOffset];
-            memoryBuffer[outputOffset + byteOffset] = 1;
-            // byteOffset++;
-            // HevcNalUnitType naluType = HevcNalUnitType(((uint8_t)memoryBuffer[outputOffset + byteOffset] >> 1) &
-            // 0x3f);
-            outputOffset += nalLength + 4;  // 4 bytes of nal length information
-            byteOffset = 0;
+            return 4;
         }
-        return ErrorCode::OK;
+        const auto* record = static_cast<const DecoderConfigurationBox*>(
+            mMetaBox.getItemPropertiesBox().getPropertyByIndex(parameterSetIter->second.get() - 1));
+        return record->getConfiguration().getLengthSizeMinus1() + 1u;
     }
 
     /* ********************************************************************** */
@@ -1622,6 +1848,7 @@ namespace HEIF
     void HeifReaderImpl::processDecoderConfigProperties(const ItemPropertiesBox& iprp,
                                                         const ItemFeaturesMap& itemFeaturesMap,
                                                         Map<DecoderConfigId, ParameterSetMap>& imageItemParameterSetMap,
+                                                        Map<DecoderConfigId, DataVector>& imageItemParameterSets,
                                                         Map<ImageId, DecoderConfigId>& imageToParameterSetMap,
                                                         Map<ImageId, FourCCInt>& imageItemCodeTypeMap)
     {
@@ -1661,6 +1888,7 @@ namespace HEIF
             if (imageItemParameterSetMap.count(configIndex) == 0u)
             {
                 imageItemParameterSetMap[configIndex] = makeDecoderParameterSetMap(record->getConfiguration());
+                imageItemParameterSets[configIndex]   = concatenateParameterSets(imageItemParameterSetMap[configIndex]);
             }
             imageToParameterSetMap[imageId] = configIndex;
             imageItemCodeTypeMap[imageId]   = type;
@@ -1736,8 +1964,6 @@ namespace HEIF
     {
         const auto& io = mFileProperties.segmentPropertiesMap.at(0).io;
 
-        const streampos oldPosition = io.stream->tell();
-
         uint64_t itemLength(0);
         List<ImageId> pastReferences;
         ErrorCode error = getItemLength(metaBox, itemId, itemLength, pastReferences);
@@ -1753,9 +1979,7 @@ namespace HEIF
         data.resize(itemLength);
 
         uint8_t* dataPtr = data.data();
-        error            = readItem(metaBox, itemId, dataPtr, itemLength);
-        io.stream->seek(oldPosition);
-        return error;
+        return readItem(metaBox, itemId, dataPtr, itemLength);
     }
 
     ErrorCode HeifReaderImpl::getItemLength(const MetaBox& metaBox,
@@ -1803,13 +2027,9 @@ namespace HEIF
         if ((version >= 1) && constructionMethod == ItemLocation::ConstructionMethod::ITEM_OFFSET)
         {
             // Request list of 'iloc' type item references, and assemble the length of the item recursively.
-            const auto& allIlocReferences = metaBox.getItemReferenceBox().getReferencesOfType("iloc");
-            auto isWantedItemId           = [itemId](const SingleItemTypeReferenceBox& item) {
-                return item.getFromItemID() == itemId;
-            };
-            const auto& ilocReference =
-                std::find_if(allIlocReferences.cbegin(), allIlocReferences.cend(), isWantedItemId);
-            if (ilocReference == allIlocReferences.end())
+            const SingleItemTypeReferenceBox* ilocReference =
+                metaBox.getItemReferenceBox().findReference("iloc", itemId.get());
+            if (ilocReference == nullptr)
             {
                 return ErrorCode::FILE_READ_ERROR;
             }
@@ -1854,17 +2074,155 @@ namespace HEIF
                 }
             }
         }
-        else
+        else if ((version >= 1) && (constructionMethod == ItemLocation::ConstructionMethod::IDAT_OFFSET))
         {
             for (const auto& extent : extentList)
             {
                 itemLength += extent.mExtentLength;
             }
         }
+        else
+        {
+            const std::uint64_t baseOffset = itemLocation.getBaseOffset();
+            for (const auto& extent : extentList)
+            {
+                std::uint64_t extentLength = 0;
+                error = getFileExtentLength(baseOffset + extent.mExtentOffset, extent, extentLength);
+                if (error != ErrorCode::OK)
+                {
+                    return error;
+                }
+                itemLength += extentLength;
+            }
+        }
+
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::getFileExtentLength(const std::uint64_t offset,
+                                                  const ItemLocationExtent& extent,
+                                                  std::uint64_t& length) const
+    {
+        length = extent.mExtentLength;
+        if (extent.mExtentLength == 0)
+        {
+            // Length 0 means the extent continues to the end of the file.
+            const std::int64_t fileSize = mFileProperties.segmentPropertiesMap.at(0).io.size;
+            if ((fileSize < 0) || (offset > static_cast<std::uint64_t>(fileSize)))
+            {
+                return ErrorCode::FILE_HEADER_ERROR;
+            }
+            length = static_cast<std::uint64_t>(fileSize) - offset;
+        }
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::readItemViews(const MetaBox& metaBox,
+                                            const ImageId itemId,
+                                            Vector<DataView>& views) const
+    {
+        const auto& io = mFileProperties.segmentPropertiesMap.at(0).io;
+
+        const ItemLocationBox& iloc = metaBox.getItemLocationBox();
+        const unsigned int version  = iloc.getVersion();
+        if (!iloc.hasItemIdEntry(itemId.get()))
+        {
+            return ErrorCode::INVALID_ITEM_ID;
+        }
+        const ItemLocation& itemLocation                          = iloc.getItemLocationForID(itemId.get());
+        const ItemLocation::ConstructionMethod constructionMethod = itemLocation.getConstructionMethod();
+        const ExtentList& extentList                              = itemLocation.getExtentList();
+        const std::uint64_t baseOffset                            = itemLocation.getBaseOffset();
+
+        if (extentList.empty())
+        {
+            return ErrorCode::FILE_READ_ERROR;  // No extents given for an item.
+        }
+
+        views.clear();
+        views.reserve(extentList.size());
+        if (version == 0 || ((version >= 1) && constructionMethod == ItemLocation::ConstructionMethod::FILE_OFFSET))
+        {
+            const char* streamData = io.stream->data();
+            if (streamData == nullptr)
+            {
+                return ErrorCode::NOT_APPLICABLE;
+            }
+            const auto streamSize = static_cast<std::uint64_t>(io.size);
+            for (const auto& extent : extentList)
+            {
+                const std::uint64_t offset = baseOffset + extent.mExtentOffset;
+                std::uint64_t length       = 0;
+                if ((getFileExtentLength(offset, extent, length) != ErrorCode::OK) || (offset > streamSize) ||
+                    (length > streamSize - offset))
+                {
+                    return ErrorCode::FILE_READ_ERROR;
+                }
+                views.push_back({reinterpret_cast<const uint8_t*>(streamData) + offset, length});
+            }
+        }
+        else if ((version >= 1) && (constructionMethod == ItemLocation::ConstructionMethod::IDAT_OFFSET))
+        {
+            for (const auto& extent : extentList)
+            {
+                const std::uint64_t offset = baseOffset + extent.mExtentOffset;
+                const uint8_t* data        = metaBox.getItemDataBox().getData(offset, extent.mExtentLength);
+                if (data == nullptr)
+                {
+                    return ErrorCode::FILE_READ_ERROR;
+                }
+                views.push_back({data, extent.mExtentLength});
+            }
+        }
+        else
+        {
+            // Items constructed from other items are assembled in memory, see readItem().
+            return ErrorCode::NOT_APPLICABLE;
+        }
 
         return ErrorCode::OK;
     }
 
+    ErrorCode HeifReaderImpl::getItemReadRanges(const MetaBox& metaBox,
+                                                const ImageId itemId,
+                                                const std::uint64_t bufferOffset,
+                                                Vector<ReadRange>& ranges) const
+    {
+        const ItemLocationBox& iloc = metaBox.getItemLocationBox();
+        if (!iloc.hasItemIdEntry(itemId.get()))
+        {
+            return ErrorCode::INVALID_ITEM_ID;
+        }
+        const ItemLocation& itemLocation                          = iloc.getItemLocationForID(itemId.get());
+        const ItemLocation::ConstructionMethod constructionMethod = itemLocation.getConstructionMethod();
+        const ExtentList& extentList                              = itemLocation.getExtentList();
+        const std::uint64_t baseOffset                            = itemLocation.getBaseOffset();
+
+        if (extentList.empty())
+        {
+            return ErrorCode::FILE_READ_ERROR;  // No extents given for an item.
+        }
+        if (iloc.getVersion() >= 1 && constructionMethod != ItemLocation::ConstructionMethod::FILE_OFFSET)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+
+        std::uint64_t offset = bufferOffset;
+        for (const auto& extent : extentList)
+        {
+            const std::uint64_t fileOffset = baseOffset + extent.mExtentOffset;
+            std::uint64_t length           = 0;
+            const ErrorCode error          = getFileExtentLength(fileOffset, extent, length);
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+            ranges.push_back({fileOffset, length, offset});
+            offset += length;
+        }
+        return ErrorCode::OK;
+    }
+
     ErrorCode HeifReaderImpl::readItem(const MetaBox& metaBox,
                                        const ImageId itemId,
                                        uint8_t* memoryBuffer,
@@ -1899,23 +2257,20 @@ namespace HEIF
         {
             for (const auto& extent : extentList)
             {
-                const auto offset = static_cast<std::int64_t>(baseOffset + extent.mExtentOffset);
-                io.stream->seek(offset);
-                if (!io.stream->good())
+                const auto offset    = static_cast<std::int64_t>(baseOffset + extent.mExtentOffset);
+                std::uint64_t length = 0;
+                if ((getFileExtentLength(baseOffset + extent.mExtentOffset, extent, length) != ErrorCode::OK) ||
+                    (totalLenght + length > maxSize))
                 {
                     return ErrorCode::FILE_READ_ERROR;
                 }
-                if (totalLenght + extent.mExtentLength > maxSize)
+                const auto readSize = static_cast<std::int64_t>(length);
+                if (!io.stream->readAt(offset, reinterpret_cast<char*>(memoryBuffer), readSize))
                 {
                     return ErrorCode::FILE_READ_ERROR;
                 }
-                io.stream->read(reinterpret_cast<char*>(memoryBuffer), std::streamsize(extent.mExtentLength));
-                if (!io.stream->good())
-                {
-                    return ErrorCode::FILE_READ_ERROR;
-                }
-                totalLenght += extent.mExtentLength;
-                memoryBuffer += extent.mExtentLength;
+                totalLenght += length;
+                memoryBuffer += length;
             }
         }
         else if ((version >= 1) && (constructionMethod == ItemLocation::ConstructionMethod::IDAT_OFFSET))
@@ -1938,12 +2293,12 @@ namespace HEIF
         else if ((version >= 1) && (constructionMethod == ItemLocation::ConstructionMethod::ITEM_OFFSET))
         {
             // Request list of 'iloc' type item references, and assemble the data of the item recursively.
-            const auto& allIlocReferences = metaBox.getItemReferenceBox().getReferencesOfType("iloc");
-            auto isWantedItemId           = [itemId](const SingleItemTypeReferenceBox& item) {
-                return item.getFromItemID() == itemId;
-            };
-            const auto& ilocReference =
-                std::find_if(allIlocReferences.cbegin(), allIlocReferences.cend(), isWantedItemId);
+            const SingleItemTypeReferenceBox* ilocReference =
+                metaBox.getItemReferenceBox().findReference("iloc", itemId.get());
+            if (ilocReference == nullptr)
+            {
+                return ErrorCode::FILE_READ_ERROR;
+            }
             const auto& toItemIds = ilocReference->getToItemIds();
 
             // Iterate extents
@@ -2023,18 +2378,6 @@ namespace HEIF
     /* *********************** Track-specific methods  *********************** */
     /* *********************************************************************** */
 
-    void HeifReaderImpl::updateDecoderCodeTypeMap(const SamplePropertyVector& sampleInfo,
-                                                  WriteOnceMap<SequenceImageId, FourCCInt>& decoderCodeTypeMap,
-                                                  std::size_t prevSampleInfoSize)
-    {
-        for (std::size_t sampleIndex = prevSampleInfoSize; sampleIndex < sampleInfo.size(); ++sampleIndex)
-        {
-            const auto& info = sampleInfo[sampleIndex];
-            decoderCodeTypeMap.insert(
-                std::make_pair(info.sampleId, info.sampleEntryType));  // Store decoder type for track data decoding
-        }
-    }
-
     ErrorCode HeifReaderImpl::isValidTrack(const SequenceId& sequenceId) const
     {
         ErrorCode error;
@@ -2042,6 +2385,10 @@ namespace HEIF
         {
             return error;
         }
+        if ((error = loadPendingMoov()) != ErrorCode::OK)
+        {
+            return error;
+        }
         if (mFileProperties.initTrackInfos.count(sequenceId) != 0)
         {
             return ErrorCode::OK;
@@ -2079,9 +2426,6 @@ namespace HEIF
             SequenceId sequenceId       = trackBox->getTrackHeaderBox().getTrackID();
             const auto& trackInfo       = segmentPropertiesMap.at(segmentId).trackInfos.at(sequenceId);
 
-            std::uint64_t maxSampleSize = 0;
-            makeSamplePropertyVector(trackBox, maxSampleSize);  //  discard return value, just get max sample size
-
             fillSampleEntryMap(stsdBox, initTrackInfo);
 
             initTrackInfo.trackId           = sequenceId.get();
@@ -2094,12 +2438,18 @@ namespace HEIF
             initTrackInfo.referenceSamples  = getDirectReferenceSamplesGroups(trackBox);
             initTrackInfo.alternateTrackIds = getAlternateTrackIds(trackBox, moovBox);
             initTrackInfo.alternateGroupId  = trackBox->getTrackHeaderBox().getAlternateGroup();
-            initTrackInfo.maxSampleSize     = maxSampleSize;
+            initTrackInfo.maxSampleSize     = trackInfo.samples.maxDataLength();
             initTrackInfo.timeScale         = trackBox->getMediaBox().getMediaHeaderBox().getTimeScale();
             initTrackInfo.editList          = getEditList(trackBox, trackInfo.repetitions);
             initTrackInfo.editBox           = trackBox->getEditBox();
 
-            if (initTrackInfo.trackFeature.hasFeature(TrackFeatureEnum::HasEditList) && (trackInfo.pMap.size() <= 1))
+            // A single sample repeated by the edit list is shown more than once.
+            const EditRepetition& repetition = trackInfo.repetition;
+            const bool singlePresentation =
+                (trackInfo.pMap.size() == 0) ||
+                ((trackInfo.pMap.size() == 1) &&
+                 ((repetition.period <= 0) || (trackInfo.pMap.front().first + repetition.period >= repetition.end)));
+            if (initTrackInfo.trackFeature.hasFeature(TrackFeatureEnum::HasEditList) && singlePresentation)
             {
                 initTrackInfo.trackFeature.setFeature(TrackFeatureEnum::DisplayAllSamples);
             }
@@ -2137,13 +2487,7 @@ namespace HEIF
                 createTrackInfoInSegment(trackBox, moovBox.getMovieHeaderBox().getTimeScale());
             SequenceId sequenceId = trackBox->getTrackHeaderBox().getTrackID();
 
-            std::uint64_t maxSampleSize = 0;
-            trackInfo.samples           = makeSamplePropertyVector(trackBox, maxSampleSize);
-
-            updateSampleToParametersSetMap(segmentPropertiesMap[segmentId].sampleToParameterSetMap, sequenceId,
-                                           trackInfo.samples);
-
-            updateDecoderCodeTypeMap(trackInfo.samples, trackInfo.decoderCodeTypeMap);
+            trackInfo.samples = makeSamplePropertyTable(trackBox);
 
             segmentPropertiesMap[segmentId].trackInfos[sequenceId] = trackInfo;
         }
@@ -2528,7 +2872,9 @@ namespace HEIF
         const SampleDescriptionBox& stsdBox = stblBox.getSampleDescriptionBox();
         FourCCInt handlerType               = trackBox->getMediaBox().getHandlerBox().getHandlerType();
 
-        if (handlerType == "vide" || handlerType == "pict")
+        // A track without samples, e.g. in a fragmented file, may have no sample entries.
+        const bool hasSampleEntries = !stsdBox.getSampleEntries().empty();
+        if (hasSampleEntries && (handlerType == "vide" || handlerType == "pict"))
         {
             auto sampleEntry = static_cast<const VisualSampleEntryBox*>(
                 stsdBox.getSampleEntry(1));  // get 1 index as truns sampleEntryType wont care
@@ -2537,7 +2883,7 @@ namespace HEIF
                 initTrackInfo.sampleEntryType = sampleEntry->getType();
             }
         }
-        else if (handlerType == "soun")
+        else if (hasSampleEntries && handlerType == "soun")
         {
             auto sampleEntry = static_cast<const AudioSampleEntryBox*>(
                 stsdBox.getSampleEntry(1));  // get 1 index as truns sampleEntryType wont care
@@ -2601,45 +2947,17 @@ namespace HEIF
             // number of times to equal the track duration.
             if ((editBox->getEditListBox()->getFlags() & 1) == 1)
             {
-                DecodePts::PMap repeatingPMap;
-                DecodePts::PMapTS repeatingPMapTS;
-                const auto trackDuration      = static_cast<int64_t>(trackInfo.duration * 1000u);
-                const auto editListDuration   = static_cast<int64_t>(decodePts.getSpan() * 1000u / mediaTimeScale);
-                const auto editListDurationTS = decodePts.getSpan();
-                trackInfo.repetitions         = double(trackDuration) / double(editListDuration);
-                auto iter                     = trackInfo.pMap.cbegin();
-                int64_t nextSampleTimestamp   = iter->first;
-                int64_t offset                = 0;
-                auto iterTS                   = trackInfo.pMapTS.cbegin();
-                int64_t nextSampleTimestampTS = iterTS->first;
-                int64_t offsetTS              = 0;
-
-                while (nextSampleTimestamp < trackDuration)
-                {
-                    repeatingPMap.insert(nextSampleTimestamp, iter->second);
-                    ++iter;
-
-                    repeatingPMapTS.insert(nextSampleTimestampTS, iterTS->second);
-                    ++iterTS;
-
-                    // Increase timestamp offset and skip to begin if the end was reached.
-                    if (iter == trackInfo.pMap.cend())
-                    {
-                        iter = trackInfo.pMap.cbegin();
-                        offset += editListDuration;
-                    }
-                    nextSampleTimestamp = iter->first + offset;
-
-                    if (iterTS == trackInfo.pMapTS.cend())
-                    {
-                        iterTS = trackInfo.pMapTS.cbegin();
-                        offsetTS += editListDurationTS;
-                    }
-                    nextSampleTimestampTS = iterTS->first + offsetTS;
+                // Only one pass of the edit list is kept in pMap and pMapTS. Timestamps of the repetitions are computed
+                // from it when needed, so that a long track duration does not expand the maps.
+                const auto trackDuration    = static_cast<int64_t>(trackInfo.duration * 1000u);
+                const auto editListDuration = static_cast<int64_t>(decodePts.getSpan() * 1000u / mediaTimeScale);
+                trackInfo.repetitions       = double(trackDuration) / double(editListDuration);
+                if (editListDuration > 0)
+                {
+                    trackInfo.repetition.period   = editListDuration;
+                    trackInfo.repetition.periodTS = decodePts.getSpan();
+                    trackInfo.repetition.end      = trackDuration;
                 }
-
-                trackInfo.pMap   = repeatingPMap;
-                trackInfo.pMapTS = repeatingPMapTS;
             }
         }
 
@@ -2653,10 +2971,9 @@ namespace HEIF
         return trackInfo;
     }
 
-    SamplePropertyVector HeifReaderImpl::makeSamplePropertyVector(const TrackBox* trackBox,
-                                                                  std::uint64_t& maxSampleSize)
+    SamplePropertyTable HeifReaderImpl::makeSamplePropertyTable(const TrackBox* trackBox)
     {
-        SamplePropertyVector sampleInfoVector;
+        SamplePropertyTable sampleTable;
 
         const SampleTableBox& stblBox       = trackBox->getMediaBox().getMediaInformationBox().getSampleTableBox();
         const SampleDescriptionBox& stsdBox = stblBox.getSampleDescriptionBox();
@@ -2679,8 +2996,28 @@ namespace HEIF
             throw FileReaderException(ErrorCode::FILE_HEADER_ERROR);
         }
 
+        // Sync samples, 1-based and sorted for lookups
+        Vector<std::uint32_t> syncSamples;
+        if (stblBox.hasSyncSampleBox())
+        {
+            syncSamples = stblBox.getSyncSampleBox()->getSyncSampleIds();
+            std::sort(syncSamples.begin(), syncSamples.end());
+            if (!syncSamples.empty() && (syncSamples.front() == 0 || syncSamples.back() > sampleCount))
+            {
+                throw FileReaderException(ErrorCode::FILE_HEADER_ERROR);
+            }
+        }
+
+        Vector<int64_t> compositionOffsets;
+        const CompositionOffsetBox* ctts = stblBox.getCompositionOffsetBox().get();
+        if (ctts != nullptr)
+        {
+            compositionOffsets = ctts->getSampleCompositionOffsets();
+        }
+
+        sampleTable.reserve(sampleCount);
         std::uint32_t previousChunkIndex = 0;  // Index is 1-based so 0 will not be used.
-        std::uint64_t maxSize            = 0;
+        std::uint64_t nextDataOffset     = 0;
         for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
         {
             SampleProperties sampleProperties{};
@@ -2695,11 +3032,6 @@ namespace HEIF
             sampleProperties.dataLength             = sampleSizeEntries.at(sampleIndex);
             sampleProperties.sampleDescriptionIndex = sampleDescriptionIndex;
 
-            if (sampleProperties.dataLength > maxSize)
-            {
-                maxSize = sampleProperties.dataLength;
-            }
-
             std::uint32_t chunkIndex = 0;
             if (!stscBox.getSampleChunkIndex(sampleIndex, chunkIndex))
             {
@@ -2708,13 +3040,14 @@ namespace HEIF
 
             if (chunkIndex == previousChunkIndex)
             {
-                sampleProperties.dataOffset = sampleInfoVector.back().dataOffset + sampleInfoVector.back().dataLength;
+                sampleProperties.dataOffset = nextDataOffset;
             }
             else
             {
                 sampleProperties.dataOffset = chunkOffsets.at(chunkIndex - 1);
                 previousChunkIndex          = chunkIndex;
             }
+            nextDataOffset = sampleProperties.dataOffset + sampleProperties.dataLength;
 
             sampleProperties.sampleDurationTS = sampleDeltas.at(sampleIndex);
 
@@ -2836,42 +3169,25 @@ namespace HEIF
                 }
             }
 
-            sampleInfoVector.push_back(sampleProperties);
-        }
-
-        if (stblBox.hasSyncSampleBox())
-        {
-            const Vector<std::uint32_t>& syncSamples = stblBox.getSyncSampleBox()->getSyncSampleIds();
-            for (unsigned int i : syncSamples)
+            if (std::binary_search(syncSamples.cbegin(), syncSamples.cend(), sampleIndex + 1))
             {
-                std::uint32_t syncSample    = i - 1;
-                auto& sampleProperties      = sampleInfoVector.at(syncSample);
                 sampleProperties.sampleType = OUTPUT_REFERENCE_FRAME;
             }
-        }
 
-        // handle hidden samples:
-        const CompositionOffsetBox* ctts = stblBox.getCompositionOffsetBox().get();
-        if (ctts != nullptr)
-        {
-            const Vector<int64_t>& offsets = ctts->getSampleCompositionOffsets();
-            const int32_t min              = std::numeric_limits<int32_t>::min();
-            for (size_t i = 0; i < offsets.size(); i++)
+            // handle hidden samples:
+            if (sampleIndex < compositionOffsets.size())
             {
-                if (sampleInfoVector.size() > static_cast<uint32_t>(i))
+                sampleProperties.sampleCompositionOffsetTs = compositionOffsets.at(sampleIndex);
+                if (compositionOffsets.at(sampleIndex) == std::numeric_limits<int32_t>::min())
                 {
-                    sampleInfoVector.at(static_cast<uint32_t>(i)).sampleCompositionOffsetTs = offsets.at(i);
-                    if (offsets.at(i) == min)
-                    {
-                        sampleInfoVector.at(static_cast<uint32_t>(i)).sampleType =
-                            SampleType::NON_OUTPUT_REFERENCE_FRAME;
-                    }
+                    sampleProperties.sampleType = SampleType::NON_OUTPUT_REFERENCE_FRAME;
                 }
             }
+
+            sampleTable.push_back(sampleProperties);
         }
 
-        maxSampleSize = maxSize;
-        return sampleInfoVector;
+        return sampleTable;
     }
 
     bool HeifReaderImpl::hasTrackInfo(SegmentTrackId segTrackId) const
@@ -2904,14 +3220,14 @@ namespace HEIF
         SegmentTrackId segTrackId = std::make_pair(segmentId, sequenceId);
 
         SequenceImageId sampleBase;
-        const auto& sampleInfoVector = getSampleInfo(segTrackId, sampleBase);
-        sampleInfo                   = sampleInfoVector.at(sequenceImageId.get() - sampleBase.get());
+        const auto& sampleTable = getSampleInfo(segTrackId, sampleBase);
+        sampleInfo              = sampleTable.get(sequenceImageId.get() - sampleBase.get());
 
         return ErrorCode::OK;
     }
 
-    const SamplePropertyVector& HeifReaderImpl::getSampleInfo(SegmentTrackId segTrackId,
-                                                              SequenceImageId& sampleBase) const
+    const SamplePropertyTable& HeifReaderImpl::getSampleInfo(SegmentTrackId segTrackId,
+                                                             SequenceImageId& sampleBase) const
     {
         const auto& segmentProperties = mFileProperties.segmentPropertiesMap.at(segTrackId.first);
         sampleBase                    = getTrackInfo(segTrackId).itemIdBase;
@@ -2949,7 +3265,10 @@ namespace HEIF
             // FourCCInt type = entry->getType();
             if (entry != nullptr)
             {
-                parameterSetMaps[index] = makeDecoderParameterSetMap(*entry->getConfigurationRecord());
+                const DecoderConfigurationRecord& record = *entry->getConfigurationRecord();
+                parameterSetMaps[index]                  = makeDecoderParameterSetMap(record);
+                initTrackInfo.parameterSets[index]       = concatenateParameterSets(parameterSetMaps[index]);
+                initTrackInfo.nalLengthSizeMinus1[index] = record.getLengthSizeMinus1();
 
                 if (entry->isVisual())
                 {
@@ -3012,7 +3331,7 @@ namespace HEIF
                 const auto& trackInfo = segmentProperties.trackInfos.at(trackId);
                 if (!trackInfo.samples.empty())
                 {
-                    nextItemIdBase = trackInfo.samples.rbegin()->sampleId.get() + 1;
+                    nextItemIdBase = trackInfo.samples.sampleId(trackInfo.samples.size() - 1).get() + 1;
                 }
                 else
                 {
@@ -3085,6 +3404,63 @@ namespace HEIF
         mFileProperties.sequenceToSegment.insert(std::make_pair(sequence, segmentId));
     }
 
+    void HeifReaderImpl::indexSegmentTracks(const SegmentId segmentId)
+    {
+        for (const auto& trackInfo : mFileProperties.segmentPropertiesMap.at(segmentId).trackInfos)
+        {
+            if (!trackInfo.second.samples.empty())
+            {
+                mFileProperties.segmentsByItemIdBase[trackInfo.first][trackInfo.second.itemIdBase] = segmentId;
+            }
+        }
+    }
+
+    void HeifReaderImpl::touchSegment(const SegmentId segmentId) const
+    {
+        std::lock_guard<std::mutex> lock(mSegmentUsageMutex);
+        const auto usage = mSegmentUsage.find(segmentId);
+        if (usage != mSegmentUsage.end())
+        {
+            mSegmentUseOrder.splice(mSegmentUseOrder.end(), mSegmentUseOrder, usage->second.useOrderPosition);
+        }
+    }
+
+    void HeifReaderImpl::updateSegmentUsage(const SegmentId segmentId)
+    {
+        if (mConfig.segmentMemoryBudget == 0)
+        {
+            return;
+        }
+
+        std::size_t allocatedSize = 0;
+        for (const auto& trackInfo : mFileProperties.segmentPropertiesMap.at(segmentId).trackInfos)
+        {
+            allocatedSize += trackInfo.second.samples.allocatedSize();
+        }
+
+        // Segments to evict are taken out of the use order under the lock, and invalidated after it is released.
+        Vector<SegmentId> evicted;
+        {
+            std::lock_guard<std::mutex> lock(mSegmentUsageMutex);
+            const auto position      = mSegmentUseOrder.insert(mSegmentUseOrder.end(), segmentId);
+            mSegmentUsage[segmentId] = {position, allocatedSize};
+            mSegmentsAllocatedSize += allocatedSize;
+
+            while (mSegmentsAllocatedSize > mConfig.segmentMemoryBudget && mSegmentUseOrder.front() != segmentId)
+            {
+                const auto usage = mSegmentUsage.find(mSegmentUseOrder.front());
+                mSegmentsAllocatedSize -= usage->second.allocatedSize;
+                mSegmentUsage.erase(usage);
+                evicted.push_back(mSegmentUseOrder.front());
+                mSegmentUseOrder.pop_front();
+            }
+        }
+        for (const SegmentId evictedId : evicted)
+        {
+            invalidateSegment(evictedId);
+        }
+    }
+
     void HeifReaderImpl::addToTrackProperties(SegmentId segmentId,
                                               MovieFragmentBox& moofBox,
                                               const SequenceIdPresentationTimeTSMap& earliestPTSTS)
@@ -3130,7 +3506,8 @@ namespace HEIF
             for (const auto trackRunBox : trackRunBoxes)
             {
                 SequenceImageId trackrunItemIdBase =
-                    !trackInfo.samples.empty() ? trackInfo.samples.back().sampleId.get() + 1 : segmentItemIdBase;
+                    !trackInfo.samples.empty() ? trackInfo.samples.sampleId(trackInfo.samples.size() - 1).get() + 1
+                                               : segmentItemIdBase;
                 // figure out what is the base data offset for the samples in this trun box:
                 std::uint64_t baseDataOffset = 0;
                 if ((trackFragmentBox->getTrackFragmentHeaderBox().getFlags() &
@@ -3169,37 +3546,22 @@ namespace HEIF
                                       segmentItemIdBase, trackrunItemIdBase, trackRunBox);
             }
             trackInfo.itemIdBase = segmentItemIdBase;
-            auto& decoderCodeTypeMap =
-                mFileProperties.segmentPropertiesMap.at(segmentId).trackInfos.at(trackId).decoderCodeTypeMap;
-            updateDecoderCodeTypeMap(trackInfo.samples, decoderCodeTypeMap, prevSampleInfoSize);
-            updateSampleToParametersSetMap(mFileProperties.segmentPropertiesMap[segmentId].sampleToParameterSetMap,
-                                           trackId, trackInfo.samples, prevSampleInfoSize);
 
             if (!trackInfo.samples.empty())
             {
                 // update sample data offset in case it is needed to read next track fragment data offsets (base offset
                 // not defined)
-                trackFragmentSampleDataOffset =
-                    trackInfo.samples.rbegin()->dataOffset + trackInfo.samples.rbegin()->dataLength;
+                const std::size_t lastSample  = trackInfo.samples.size() - 1;
+                trackFragmentSampleDataOffset = trackInfo.samples.dataOffset(lastSample) +
+                                                trackInfo.samples.dataLength(lastSample);
             }
             firstTrackFragment = false;
         }
-    }
 
-
-    void HeifReaderImpl::updateSampleToParametersSetMap(SampleToParameterSetMap& sampleToParameterSetMap,
-                                                        const SequenceId sequenceId,
-                                                        const SamplePropertyVector& sampleInfo,
-                                                        const std::size_t prevSampleInfoSize)
-    {
-        for (std::size_t sampleIndex = prevSampleInfoSize; sampleIndex < sampleInfo.size(); ++sampleIndex)
-        {
-            auto itemId            = SequenceImageIdPair(sequenceId, sampleIndex);
-            auto parameterSetMapId = sampleInfo[sampleIndex].sampleDescriptionIndex;
-            sampleToParameterSetMap.insert(std::make_pair(itemId, parameterSetMapId));
-        }
+        indexSegmentTracks(segmentId);
     }
 
+
     void HeifReaderImpl::addSamplesToTrackInfo(TrackInfoInSegment& trackInfo,
                                                const FileInformationInternal& fileInformation,
                                                const InitTrackInfo& initTrackInfo,
@@ -3228,6 +3590,7 @@ namespace HEIF
         decodePts.applyLocalTime(static_cast<std::uint64_t>(trackInfo.nextPTSTS));
         decodePts.getTimeTrackRun(initTrackInfo.timeScale, localPMap);
         decodePts.getTimeTrackRunTS(localPMapTS);
+        expandRepetition(trackInfo);
         for (const auto& mapping : localPMap)
         {
             trackInfo.pMap.insert(std::make_pair(mapping.first, mapping.second + itemIdOffset));
@@ -3303,6 +3666,28 @@ namespace HEIF
 
     ErrorCode HeifReaderImpl::parseInitializationSegment(StreamInterface* streamInterface)
     {
+        // Keeps the current reader state and options, like before the config overload existed.
+        ArenaScope arenaScope(mArena.get(), mConfig.parseAllocator);
+        return parseInitializationSegmentStream(streamInterface);
+    }
+
+    ErrorCode HeifReaderImpl::parseInitializationSegment(StreamInterface* streamInterface, const ReaderConfig& config)
+    {
+        mStatistics.reset(createStatisticsCollector(config.collectStatistics));
+
+        // The arena is replaced below, so nothing allocated from the previous one may survive.
+        reset();
+        mConfig                  = config;
+        mConfig.lazyTrackParsing = false;
+        prepareArena(config);
+        ArenaScope arenaScope(mArena.get(), mConfig.parseAllocator);
+        return parseInitializationSegmentStream(streamInterface);
+    }
+
+    ErrorCode HeifReaderImpl::parseInitializationSegmentStream(StreamInterface* streamInterface)
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "parseInitializationSegment");
+
         SegmentId segmentId = 0;  // all "segment" info for initialization segment goes to key=0 of SegmentPropertiesMap
 
         State prevState = mState;
@@ -3310,7 +3695,7 @@ namespace HEIF
 
         SegmentProperties& segmentProperties = mFileProperties.segmentPropertiesMap[segmentId];
         StreamIO& io                         = segmentProperties.io;
-        io.stream.reset(CUSTOM_NEW(InternalStream, (streamInterface)));
+        io.stream.reset(CUSTOM_NEW(InternalStream, (streamInterface, mConfig.readAheadSize)));
         if (io.stream->peekEof())
         {
             mState = prevState;
@@ -3362,6 +3747,7 @@ namespace HEIF
                     }
                     else if (boxType == "sidx")
                     {
+                        StatisticsScope sidxStatistics(mStatistics.get(), "parse sidx", StatisticsScope::Kind::PHASE);
                         error = readBox(io, bitstream);
                         if (error == ErrorCode::OK)
                         {
@@ -3438,7 +3824,7 @@ namespace HEIF
             io.stream->clear();
 
             mFileProperties.fileFeature = getFileFeatures();
-            mFileInformation            = makeFileInformation(mFileProperties);
+            makeFileInformation(mFileProperties, mFileInformation);
 
             mState = State::READY;
         }
@@ -3487,22 +3873,7 @@ namespace HEIF
             if (trackInfo.pMap.size() != 0u)
             {
                 // Set composition times from Pmap, which considers also edit lists
-                for (const auto& pair : trackInfo.pMap)
-                {
-                    if (pair.first < 0)  // negative time implies a hidden sample
-                    {
-                        continue;
-                    }
-                    trackInfo.samples.at(pair.second).compositionTimes.push_back(pair.first);
-                }
-                for (const auto& pair : trackInfo.pMapTS)
-                {
-                    if (pair.first < 0)  // negative time implies a hidden sample
-                    {
-                        continue;
-                    }
-                    trackInfo.samples.at(pair.second).compositionTimesTS.push_back(std::uint64_t(pair.first));
-                }
+                trackInfo.samples.setCompositionTimes(trackInfo.pMap, trackInfo.pMapTS, trackInfo.repetition);
             }
         }
     }
@@ -3552,29 +3923,82 @@ namespace HEIF
         }
     }
 
+    ErrorCode HeifReaderImpl::getSampleDescriptionIndex(const SequenceId sequenceId,
+                                                        const SequenceImageId sampleId,
+                                                        const InitTrackInfo*& initTrackInfo,
+                                                        SampleDescriptionIndex& sampleDescriptionIndex) const
+    {
+        SegmentId segmentId;
+        const ErrorCode error = segmentIdOf(sequenceId, sampleId, segmentId);
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+        const auto initTrackInfoIter = mFileProperties.initTrackInfos.find(sequenceId);
+        if (initTrackInfoIter == mFileProperties.initTrackInfos.end())
+        {
+            return ErrorCode::INVALID_SEQUENCE_ID;
+        }
+        const TrackInfoInSegment& trackInfo = getTrackInfo({segmentId, sequenceId});
+        const unsigned int sampleIndex      = sampleId.get() - trackInfo.itemIdBase.get();
+        initTrackInfo                       = &initTrackInfoIter->second;
+        sampleDescriptionIndex              = trackInfo.samples.sampleDescriptionIndex(sampleIndex);
+        return ErrorCode::OK;
+    }
+
     const ParameterSetMap* HeifReaderImpl::getParameterSetMap(const SequenceId sequenceId,
                                                               const SequenceImageId sampleId) const
     {
-        SegmentId segmentId;
-        ErrorCode result = segmentIdOf(sequenceId, sampleId, segmentId);
-        if (result != ErrorCode::OK)
+        const InitTrackInfo* initTrackInfo = nullptr;
+        SampleDescriptionIndex sampleDescriptionIndex;
+        if (getSampleDescriptionIndex(sequenceId, sampleId, initTrackInfo, sampleDescriptionIndex) != ErrorCode::OK)
         {
             return nullptr;
         }
-        const auto& segmentProperties  = mFileProperties.segmentPropertiesMap.at(segmentId);
-        const unsigned int sampleIndex = sampleId.get() - getTrackInfo({segmentId, sequenceId}).itemIdBase.get();
-        const auto& itemIndexIterator  = segmentProperties.sampleToParameterSetMap.find({sequenceId, sampleIndex});
-        if (itemIndexIterator != segmentProperties.sampleToParameterSetMap.end())
+        const auto parameterSetMap = initTrackInfo->parameterSetMaps.find(sampleDescriptionIndex);
+        if (parameterSetMap != initTrackInfo->parameterSetMaps.end())
         {
-            if (mFileProperties.initTrackInfos.at(sequenceId).parameterSetMaps.count(itemIndexIterator->second))
-            {
-                return &mFileProperties.initTrackInfos.at(sequenceId).parameterSetMaps.at(itemIndexIterator->second);
-            }
+            return &parameterSetMap->second;
+        }
+
+        return nullptr;
+    }
+
+    const DataVector* HeifReaderImpl::getParameterSets(const SequenceId sequenceId,
+                                                       const SequenceImageId sampleId) const
+    {
+        const InitTrackInfo* initTrackInfo = nullptr;
+        SampleDescriptionIndex sampleDescriptionIndex;
+        if (getSampleDescriptionIndex(sequenceId, sampleId, initTrackInfo, sampleDescriptionIndex) != ErrorCode::OK)
+        {
+            return nullptr;
+        }
+        const auto parameterSets = initTrackInfo->parameterSets.find(sampleDescriptionIndex);
+        if (parameterSets != initTrackInfo->parameterSets.end())
+        {
+            return &parameterSets->second;
         }
 
         return nullptr;
     }
 
+    unsigned int HeifReaderImpl::getNalLengthSize(const SequenceId sequenceId, const SequenceImageId sampleId) const
+    {
+        const InitTrackInfo* initTrackInfo = nullptr;
+        SampleDescriptionIndex sampleDescriptionIndex;
+        if (getSampleDescriptionIndex(sequenceId, sampleId, initTrackInfo, sampleDescriptionIndex) != ErrorCode::OK)
+        {
+            return 4;
+        }
+        const auto nalLengthSize = initTrackInfo->nalLengthSizeMinus1.find(sampleDescriptionIndex);
+        if (nalLengthSize != initTrackInfo->nalLengthSizeMinus1.end())
+        {
+            return nalLengthSize->second + 1u;
+        }
+
+        return 4;
+    }
+
 
     /* *********************************************************************** */
     /* ************************* Helper functions **************************** */
@@ -3669,16 +4093,7 @@ namespace HEIF
 
     bool doReferencesFromItemIdExist(const MetaBox& metaBox, const ImageId itemId, const FourCCInt& referenceType)
     {
-        const Vector<SingleItemTypeReferenceBox>& references =
-            metaBox.getItemReferenceBox().getReferencesOfType(FourCCInt(referenceType));
-        for (const auto& singleItemTypeReferenceBox : references)
-        {
-            if (singleItemTypeReferenceBox.getFromItemID() == itemId)
-            {
-                return true;
-            }
-        }
-        return false;
+        return metaBox.getItemReferenceBox().findReference(referenceType, itemId.get()) != nullptr;
     }
 
     bool doReferencesToItemIdExist(const MetaBox& metaBox, const ImageId itemId, const FourCCInt& referenceType)
@@ -3708,6 +4123,7 @@ namespace HEIF
         return array;
     }
 
+    template Array<DataView> makeArray(const Vector<DataView>& container);
     template Array<ImageId> makeArray(const Vector<ImageId>& container);
     template Array<ImageId> makeArray(const Vector<uint32_t>& container);
     template Array<ItemPropertyInfo> makeArray(const Vector<ItemPropertyInfo>& container);
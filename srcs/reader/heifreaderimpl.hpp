@@ -14,6 +14,10 @@
 #ifndef HEIFREADERIMPL_HPP
 #define HEIFREADERIMPL_HPP
 
+#include <atomic>
+#include <mutex>
+
+#include "arenaallocator.hpp"
 #include "decodepts.hpp"
 #include "extendedtypebox.hpp"
 #include "filetypebox.hpp"
@@ -27,6 +31,7 @@
 #include "moviebox.hpp"
 #include "moviefragmentbox.hpp"
 #include "segmentindexbox.hpp"
+#include "statistics.hpp"
 
 class CleanApertureBox;
 class AuxiliaryTypeInfoBox;
@@ -47,6 +52,12 @@ namespace HEIF
         /// @see Reader::initialize()
         ErrorCode initialize(StreamInterface* stream) override;
 
+        /// @see Reader::initialize()
+        ErrorCode initialize(const char* fileName, const ReaderConfig& config) override;
+
+        /// @see Reader::initialize()
+        ErrorCode initialize(StreamInterface* stream, const ReaderConfig& config) override;
+
         /// @see Reader::close()
         void close() override;
 
@@ -136,6 +147,18 @@ namespace HEIF
                               uint64_t& memoryBufferSize,
                               bool bytestreamHeaders = true) override;
 
+        /// @see Reader::getItemDataViews()
+        ErrorCode getItemDataViews(const ImageId& itemId, Array<DataView>& extents) const override;
+
+        /// @see Reader::getItemDataLocation()
+        ErrorCode getItemDataLocation(const ImageId& itemId, uint64_t& offset, uint64_t& size) const override;
+
+        /// @see Reader::getMetaBoxLocation()
+        ErrorCode getMetaBoxLocation(MetaBoxLocation& location) const override;
+
+        /// @see Reader::getIndexCache()
+        ErrorCode getIndexCache(uint64_t contentKey, Array<uint8_t>& indexCache) const override;
+
         /// @see Reader::getItem()
         ErrorCode getItem(const ImageId& itemId, Overlay& iovlItem) const override;
 
@@ -214,6 +237,24 @@ namespace HEIF
                                                    uint8_t* memoryBuffer,
                                                    uint64_t& memoryBufferSize) override;
 
+        /// @see Reader::getItemDataWithDecoderParameters()
+        ErrorCode getItemDataWithDecoderParameters(const ImageId& itemId,
+                                                   DataView& decoderParameters,
+                                                   uint8_t* memoryBuffer,
+                                                   uint64_t& memoryBufferSize) const override;
+
+        /// @see Reader::getItemDataWithDecoderParameters()
+        ErrorCode getItemDataWithDecoderParameters(const SequenceId& sequenceId,
+                                                   const SequenceImageId& itemId,
+                                                   DataView& decoderParameters,
+                                                   uint8_t* memoryBuffer,
+                                                   uint64_t& memoryBufferSize) override;
+
+        /// @see Reader::getGridTileData()
+        ErrorCode getGridTileData(const ImageId& gridId,
+                                  GridTileData& gridTileData,
+                                  TaskRunner* taskRunner = nullptr) const override;
+
         /// @see Reader::getItemProtectionScheme()
         ErrorCode getItemProtectionScheme(const ImageId& itemId,
                                           uint8_t* memoryBuffer,
@@ -231,6 +272,11 @@ namespace HEIF
         ErrorCode getItemsInDecodingOrder(const SequenceId& sequenceId,
                                           Array<TimestampIDPair>& decodingOrder) const override;
 
+        /// @see Reader::createSampleReader()
+        ErrorCode createSampleReader(const SequenceId& sequenceId,
+                                     const SampleReaderConfig& config,
+                                     SampleReader*& sampleReader) const override;
+
         /// @see Reader::getDecodeDependencies()
         ErrorCode getDecodeDependencies(const SequenceId& sequenceId,
                                         const SequenceImageId& itemId,
@@ -261,6 +307,7 @@ namespace HEIF
         // segment handling
     public:
         ErrorCode parseInitializationSegment(StreamInterface* streamInterface) override;
+        ErrorCode parseInitializationSegment(StreamInterface* streamInterface, const ReaderConfig& config) override;
         ErrorCode parseSegment(StreamInterface* streamInterface,
                                SegmentId segmentId,
                                uint64_t earliestPTSinTS = UINT64_MAX) override;
@@ -268,6 +315,9 @@ namespace HEIF
         ErrorCode getSegmentIndex(Array<SegmentInformation>& segmentIndex) override;
         ErrorCode parseSegmentIndex(StreamInterface* streamInterface, Array<SegmentInformation>& segmentIndex) override;
 
+        /// @see Reader::getStatistics()
+        ErrorCode getStatistics(ReaderStatistics& statistics) const override;
+
     private:
         enum class State
         {
@@ -275,6 +325,11 @@ namespace HEIF
             INITIALIZING,   ///< State during parsing the file
             READY           ///< State after the file has been parsed and information extracted
         };
+
+        /// Arena of the parse state, if enabled with ReaderConfig::arenaBlockSize. Declared first, so that it is
+        /// destroyed after everything allocated from it.
+        UniquePtr<ArenaAllocator> mArena;
+
         State mState;  ///< Running state of the reader API implementation
 
         StreamIO mFileStream;  ///< File IO stream
@@ -314,18 +369,28 @@ namespace HEIF
         ErrorCode isInitialized() const;
 
         /**
-         * Create file information struct for the API.
-         * @param internalFileInfo Reader internal information about the file.
-         * @return FileInformation struct for the public API.
+         * Fill file information struct for the API. The large per-sample arrays are handed over without copying them.
+         * @param [in]  internalFileInfo Reader internal information about the file.
+         * @param [out] fileInformation  FileInformation struct for the public API.
          */
-        FileInformation makeFileInformation(const FileInformationInternal& internalFileInfo) const;
+        void makeFileInformation(const FileInformationInternal& internalFileInfo,
+                                 FileInformation& fileInformation) const;
 
         /** Reset reader internal state */
         void reset();
 
+        /** Set up mArena as configured by config.arenaBlockSize. An existing arena with the same settings is kept, so
+         * that its blocks are reused. Must be called only when there is no parse state. */
+        void prepareArena(const ReaderConfig& config);
+
         /** Parse input stream, fill mFileProperties and implementation internal data structures. */
         ErrorCode readStream();
 
+        /** Fill the same data structures as readStream() from mConfig.indexCache instead of parsing the input stream.
+         *  @return ErrorCode: OK, NOT_APPLICABLE if the cache is not for this file or version of the library,
+         *                     FILE_READ_ERROR if the cache is corrupted. The parse state is reset on errors. */
+        ErrorCode loadIndexCache();
+
         FileFeature getFileFeatures() const;
 
         FileInformation mFileInformation;  ///< File information extracted during initialize().
@@ -339,12 +404,46 @@ namespace HEIF
         ErrorCode handleMeta(StreamIO& io);
         ErrorCode handleMoov(StreamIO& io);
 
+        /** Update track information from a 'moov' box read to memory. */
+        void parseMoov(BitStream& bitstream);
+
+        /** Parse an initialization segment with the current options and arena, keeping earlier segments. */
+        ErrorCode parseInitializationSegmentStream(StreamInterface* streamInterface);
+
+        ReaderConfig mConfig;                              ///< Options given to initialize().
+        std::atomic<std::int64_t> mPendingMoovOffset{-1};  ///< Offset of the 'moov' box skipped by lazy parsing, or -1.
+        std::int64_t mPendingMoovSize = 0;                 ///< Size of the 'moov' box skipped by lazy parsing.
+        mutable std::mutex mPendingMoovMutex;              ///< Serializes parsing of the skipped 'moov' box.
+        UniquePtr<StatisticsCollector> mStatistics;        ///< Statistics, if ReaderConfig::collectStatistics is set.
+
+        /**
+         * Parse the 'moov' box skipped by lazy parsing during initialize(), if it has not been parsed yet.
+         * Track information is part of the file header, so the const accessors needing it call this too. The box is
+         * parsed once under mPendingMoovMutex, so concurrent callers wait for the first one to finish it.
+         * @return ErrorCode: OK, FILE_READ_ERROR, FILE_HEADER_ERROR */
+        ErrorCode loadPendingMoov() const;
+
+        /** Parse the 'moov' box at mPendingMoovOffset and update file information accordingly. mPendingMoovOffset is
+         * cleared only after all state has been updated, so that loadPendingMoov() can check it without locking.
+         * The box is read with readAt(), which does not move the stream shared with concurrent sample reads. */
+        ErrorCode parsePendingMoov();
+
 
         ErrorCode getItemLength(const MetaBox& metaBox,
                                 const ImageId& itemId,
                                 std::uint64_t& itemLength,
                                 List<ImageId>& pastReferences) const;
 
+        /**
+         * @brief Get the length of an item extent stored with construction method 0 (file offset).
+         * @param offset       File offset of the extent.
+         * @param extent       The extent.
+         * @param [out] length Length of the extent. Extent length 0 is resolved to the rest of the file.
+         * @return ErrorCode: OK, FILE_HEADER_ERROR if the extent begins after the end of the file */
+        ErrorCode getFileExtentLength(std::uint64_t offset,
+                                      const ItemLocationExtent& extent,
+                                      std::uint64_t& length) const;
+
         /**
          * @brief Read bytes from stream to an integer value.
          * @param io           Segment IO stream to read from.
@@ -366,6 +465,11 @@ namespace HEIF
          * @return Decoder parameters */
         static ParameterSetMap makeDecoderParameterSetMap(const DecoderConfigurationRecord& record);
 
+        /** Concatenate parameter sets in the order they are fed to a decoder.
+         * @param parameterSetMap Decoder parameters with bytestream headers
+         * @return Parameter sets as one bytestream */
+        static DataVector concatenateParameterSets(const ParameterSetMap& parameterSetMap);
+
         /**
          * Get ids of all items of a image collection.
          * @param [out] items Ids of all items in the image collection.
@@ -385,19 +489,40 @@ namespace HEIF
          * @return ErrorCode: OK, INVALID_ITEM_ID */
         ErrorCode getProtection(ImageId itemId, bool& isProtected) const;
 
-        /** Process item data from AVC bitstream
-         *  @param [in] data  char pointer to Raw AVC bitstream data.
-         *  @param [in] size  size of data to be modified.
-         *  @pre initialize() has been called successfully.
-         *  @return ErrorCode: OK, FILE_READ_ERROR */
-        static ErrorCode processAvcItemData(uint8_t* memoryBuffer, uint64_t& memoryBufferSize);
+        /** Replace NAL unit lengths of AVC or HEVC item data with bytestream headers (0001).
+         *  @param [in]     memoryBuffer     Item data, converted in place.
+         *  @param [in,out] memoryBufferSize Size of item data. Size of converted data on return, also when the buffer
+         *                                   is too small.
+         *  @param [in]     bufferCapacity   Size of the buffer pointed to by memoryBuffer. Data grows when NAL unit
+         *                                   length fields are shorter than 4 bytes.
+         *  @param [in]     nalLengthSize    Size of NAL unit length fields in bytes, from the decoder configuration.
+         *  @return ErrorCode: OK, BUFFER_SIZE_TOO_SMALL, FILE_READ_ERROR */
+        static ErrorCode processNalItemData(uint8_t* memoryBuffer,
+                                            uint64_t& memoryBufferSize,
+                                            uint64_t bufferCapacity,
+                                            unsigned int nalLengthSize);
+
+        /** @return Size of NAL unit length fields of an image item in bytes, 4 if not known. */
+        unsigned int getNalLengthSize(ImageId imageId) const;
 
-        /** Process item data from HEVC bitstream
-         *  @param [in] data  char pointer to Raw HEVC bitstream data.
-         *  @param [in] size  size of data to be modified.
-         *  @pre initialize() has been called successfully.
-         *  @return ErrorCode: OK, FILE_READ_ERROR */
-        static ErrorCode processHevcItemData(uint8_t* memoryBuffer, uint64_t& memoryBufferSize);
+        /**
+         * Get the concatenated parameter sets of a coded image item, checking that the item can be fed to a decoder.
+         * @param [in]  itemId            Item id.
+         * @param [out] decoderParameters View to the parameter sets, owned by the reader.
+         * @return ErrorCode: OK, UNINITIALIZED, INVALID_ITEM_ID, PROTECTED_ITEM, UNSUPPORTED_CODE_TYPE,
+         *                    FILE_HEADER_ERROR */
+        ErrorCode getDecoderParameterView(const ImageId& itemId, DataView& decoderParameters) const;
+
+        /**
+         * Get the concatenated parameter sets of a sample, checking that the sample can be fed to a decoder.
+         * @param [in]  sequenceId        Track id.
+         * @param [in]  itemId            Sample id.
+         * @param [out] decoderParameters View to the parameter sets, owned by the reader.
+         * @return ErrorCode: OK, UNINITIALIZED, INVALID_SEQUENCE_ID, INVALID_SEQUENCE_IMAGE_ID,
+         *                    UNSUPPORTED_CODE_TYPE */
+        ErrorCode getDecoderParameterView(const SequenceId& sequenceId,
+                                          const SequenceImageId& itemId,
+                                          DataView& decoderParameters);
 
         /* ********************************************************************** */
         /* *********************** Meta-specific section  *********************** */
@@ -405,10 +530,14 @@ namespace HEIF
 
         Map<ImageId, FourCCInt> mImageItemCodeTypeMap;  ///< Extracted decoder code types for each image item
         Map<DecoderConfigId, ParameterSetMap> mImageItemParameterSetMap;  ///< Extracted decoder parameter sets
+        Map<DecoderConfigId, DataVector> mImageItemParameterSets;  ///< Parameter sets concatenated for decoders
         Map<ImageId, DecoderConfigId> mImageToParameterSetMap;  ///< Map from image item to parameter set map entry
 
         MetaBox mMetaBox;  ///< Root-level MetaBox for later information retrieval
         bool mMetaBoxLoaded;
+        MetaBoxLocation mMetaBoxLocation;  ///< Location of the root-level MetaBox in the file, if mMetaBoxLoaded.
+        Vector<std::pair<std::int64_t, std::int64_t>>
+            mHeaderBoxes;  ///< Offset and size of the 'ftyp', 'etyp' and root-level 'meta' boxes, for getIndexCache()
 
         typedef Map<uint32_t, PropertyTypeVector> Properties;  ///< Convenience type for mapping properties
 
@@ -511,10 +640,12 @@ namespace HEIF
         Properties processItemProperties() const;
 
         /**
-         * @brief Fill imageItemParameterSetMap, imageToParameterSetMap and imageItemCodeTypeMap from metabox */
+         * @brief Fill imageItemParameterSetMap, imageItemParameterSets, imageToParameterSetMap and imageItemCodeTypeMap
+         *        from metabox */
         static void processDecoderConfigProperties(const ItemPropertiesBox& iprp,
                                                    const ItemFeaturesMap& itemFeaturesMap,
                                                    Map<DecoderConfigId, ParameterSetMap>& imageItemParameterSetMap,
+                                                   Map<DecoderConfigId, DataVector>& imageItemParameterSets,
                                                    Map<ImageId, DecoderConfigId>& imageToParameterSetMap,
                                                    Map<ImageId, FourCCInt>& imageItemCodeTypeMap);
 
@@ -543,6 +674,29 @@ namespace HEIF
          * @return ErrorCode: OK, INVALID_ITEM_ID, FILE_READ_ERROR */
         ErrorCode readItem(const MetaBox& metaBox, ImageId itemId, uint8_t* memorybuffer, uint64_t maxSize) const;
 
+        /**
+         * @brief Resolve item extents to views into the input stream mapping or the 'idat' box, without copying.
+         * @pre The item id has been checked with isValidItem().
+         * @param metaBox The MetaBox where the item is located
+         * @param itemId  ID of the item
+         * @param [out] views Extent views in item data order
+         * @return ErrorCode: OK, INVALID_ITEM_ID, FILE_READ_ERROR, NOT_APPLICABLE if the item can not be accessed
+         *                    without copying */
+        ErrorCode readItemViews(const MetaBox& metaBox, ImageId itemId, Vector<DataView>& views) const;
+
+        /**
+         * @brief Resolve file ranges of an item stored with construction method 0 (file offset).
+         * @param metaBox      The MetaBox where the item is located
+         * @param itemId       ID of the item
+         * @param bufferOffset Offset in the destination buffer where the item data begins
+         * @param [out] ranges Ranges of the item are appended here, in item data order
+         * @return ErrorCode: OK, INVALID_ITEM_ID, FILE_READ_ERROR, NOT_APPLICABLE if the item is not stored as file
+         *                    offset extents */
+        ErrorCode getItemReadRanges(const MetaBox& metaBox,
+                                    ImageId itemId,
+                                    std::uint64_t bufferOffset,
+                                    Vector<ReadRange>& ranges) const;
+
         /**
          * @brief Convert information extracted from the MetaBox to fixed-sized arrays for public API.
          * @return Filled MetaBoxInformation struct.
@@ -568,6 +722,18 @@ namespace HEIF
         /// MovieFragmentHeader.FragmentSequenceNumber
         Sequence mNextSequence = {};
 
+        /// Sample table memory use of a parsed media segment, and its position in mSegmentUseOrder
+        struct SegmentUsage
+        {
+            List<SegmentId>::iterator useOrderPosition;
+            std::size_t allocatedSize;
+        };
+
+        mutable std::mutex mSegmentUsageMutex;               ///< Guards the three members below
+        mutable List<SegmentId> mSegmentUseOrder;            ///< Media segments from least to most recently used
+        mutable Map<SegmentId, SegmentUsage> mSegmentUsage;  ///< Only filled when segment memory budget is set
+        std::uint64_t mSegmentsAllocatedSize = 0;            ///< Sum of SegmentUsage::allocatedSize
+
         typedef Map<SequenceId, DecodePts::PresentationTimeTS> SequenceIdPresentationTimeTSMap;
 
         InitTrackInfo& getInitTrackInfo(SequenceId initSegTrackId);
@@ -577,28 +743,7 @@ namespace HEIF
         HEIF::ErrorCode getSampleInfo(SequenceId sequenceId,
                                       SequenceImageId sequenceImageId,
                                       SampleProperties& sampleInfo) const;
-        const SamplePropertyVector& getSampleInfo(SegmentTrackId segTrackId, SequenceImageId& sampleBase) const;
-
-        /**
-         * @brief Update mDecoderCodeTypeMap to include the data from the samples
-         * @param [in] SampleInfoVector sampleInfo Samples to traverse
-         */
-        static void updateDecoderCodeTypeMap(const SamplePropertyVector& sampleInfo,
-                                             WriteOnceMap<SequenceImageId, FourCCInt>& decoderCodeTypeMap,
-                                             std::size_t prevSampleInfoSize = 0);
-
-        /**
-         * @brief Update given SampleToParameterSetMap
-         * @param [out] sampleToParameterSetMap Map where parameters are added
-         * @param [in] sequenceId              Sequence/track ID
-         * @param [in] sampleToParameterSetMap Samples to traverse
-         * @param [in] size_t prevSampleInfoSize Index to start interating on (to avoid duplicate work on consecutive
-         * moofs)
-         */
-        static void updateSampleToParametersSetMap(SampleToParameterSetMap& sampleToParameterSetMap,
-                                                   SequenceId initSegTrackId,
-                                                   const SamplePropertyVector& sampleInfo,
-                                                   size_t prevSampleInfoSize = 0);
+        const SamplePropertyTable& getSampleInfo(SegmentTrackId segTrackId, SequenceImageId& sampleBase) const;
 
         /**
          * @brief Add samples to a addToTrackInfo for the reader interface
@@ -623,6 +768,22 @@ namespace HEIF
          * If the mapping already exists, nothing changes. */
         void addSegmentSequence(SegmentId segmentId, Sequence sequence);
 
+        /**
+         * @brief Add tracks of a segment which have samples to FileInformationInternal::segmentsByItemIdBase.
+         * @param [in] segmentId Segment id of the tracks. */
+        void indexSegmentTracks(SegmentId segmentId);
+
+        /**
+         * @brief Mark a parsed media segment as the most recently used one, when segment memory budget is set.
+         * @param [in] segmentId Segment id of the accessed segment. */
+        void touchSegment(SegmentId segmentId) const;
+
+        /**
+         * @brief Account the sample tables of a parsed media segment against the segment memory budget, and invalidate
+         * least recently used segments while the budget is exceeded.
+         * @param [in] segmentId Segment id of the parsed segment. It is not invalidated. */
+        void updateSegmentUsage(SegmentId segmentId);
+
         /**
          * @brief Add to a TrackPropertiesMap struct for the reader interface
          * @param [in] segmentId Segment id of the track.
@@ -786,9 +947,8 @@ namespace HEIF
         /**
          * @brief Extract reader internal information about samples
          * @param trackBox [in] trackBox TrackBox to extract data from
-         * @param maxSampleSize max size of samples for track.
-         * @return SamplePropertyVector containing information about every sample of the track */
-        static SamplePropertyVector makeSamplePropertyVector(const TrackBox* trackBox, std::uint64_t& maxSampleSize);
+         * @return SamplePropertyTable containing information about every sample of the track */
+        static SamplePropertyTable makeSamplePropertyTable(const TrackBox* trackBox);
 
         /**
          * @brief Add sample decoding dependencies
@@ -837,11 +997,29 @@ namespace HEIF
         /** @return True if there exists track info for wanted track in the segment in question, false otherwise. */
         bool hasTrackInfo(SegmentTrackId segTrackId) const;
 
+        /**
+         * @brief Find the sample entry of a sample without throwing on unknown ids.
+         * @param [out] initTrackInfo          Track information of the init segment the sample belongs to.
+         * @param [out] sampleDescriptionIndex Index of the sample entry of the sample.
+         * @return ErrorCode: OK, INVALID_SEQUENCE_ID, INVALID_SEQUENCE_IMAGE_ID */
+        ErrorCode getSampleDescriptionIndex(SequenceId sequenceId,
+                                            SequenceImageId sampleId,
+                                            const InitTrackInfo*& initTrackInfo,
+                                            SampleDescriptionIndex& sampleDescriptionIndex) const;
+
         /**
          * @brief Get parameters for the sequence image/sample.
          * @return Pointer to parameter set, nullptr if not found. */
         const ParameterSetMap* getParameterSetMap(SequenceId sequenceId, SequenceImageId sampleId) const;
 
+        /**
+         * @brief Get parameter sets of the sequence image/sample concatenated for decoders.
+         * @return Pointer to parameter sets, nullptr if not found. */
+        const DataVector* getParameterSets(SequenceId sequenceId, SequenceImageId sampleId) const;
+
+        /** @return Size of NAL unit length fields of a sample in bytes, 4 if not known. */
+        unsigned int getNalLengthSize(SequenceId sequenceId, SequenceImageId sampleId) const;
+
         class FileReaderException : public ISOBMFF::Exception
         {
         public:
@@ -883,6 +1061,8 @@ namespace HEIF
                     return "The item is not protected.";
                 case ErrorCode::UNINITIALIZED:
                     return "Reader not initialized. Call initialize() first.";
+                case ErrorCode::MEMORY_ALLOCATION_FAILED:
+                    return "Memory allocation failed.";
                 case ErrorCode::NOT_APPLICABLE:
                 default:
                     return "Unspecified error.";
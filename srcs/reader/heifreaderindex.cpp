@@ -0,0 +1,818 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "heifreaderindex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "buildinfo.hpp"
+#include "editbox.hpp"
+#include "heifreaderimpl.hpp"
+#include "log.hpp"
+
+namespace HEIF
+{
+    namespace
+    {
+        /// Read-only stream to a box stored in an index cache, so that it is parsed like the box in the file.
+        class MemoryStream : public StreamInterface
+        {
+        public:
+            explicit MemoryStream(const Vector<std::uint8_t>& data)
+                : mData(data)
+                , mPosition(0)
+            {
+            }
+
+            offset_t read(char* buffer, offset_t size) override
+            {
+                const offset_t count = std::max<offset_t>(0, std::min(size, this->size() - mPosition));
+                if (count > 0)
+                {
+                    std::memcpy(buffer, mData.data() + mPosition, static_cast<std::size_t>(count));
+                    mPosition += count;
+                }
+                return count;
+            }
+
+            bool absoluteSeek(offset_t offset) override
+            {
+                if ((offset < 0) || (offset > size()))
+                {
+                    return false;
+                }
+                mPosition = offset;
+                return true;
+            }
+
+            offset_t tell() override
+            {
+                return mPosition;
+            }
+
+            offset_t size() override
+            {
+                return static_cast<offset_t>(mData.size());
+            }
+
+            const char* data() override
+            {
+                return reinterpret_cast<const char*>(mData.data());
+            }
+
+        private:
+            const Vector<std::uint8_t>& mData;
+            offset_t mPosition;
+        };
+
+        /// @return Version of the library, which index caches are written with and valid for.
+        Vector<std::uint8_t> libraryVersion()
+        {
+            return Vector<std::uint8_t>(BuildInfo::Version, BuildInfo::Version + std::strlen(BuildInfo::Version));
+        }
+
+        void writeFourCC(IndexWriter& index, const FourCC& fourcc)
+        {
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                index.write<char>(fourcc.value[i]);
+            }
+        }
+
+        FourCC readFourCC(IndexReader& index)
+        {
+            FourCC fourcc;
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                fourcc.value[i] = index.read<char>();
+            }
+            return fourcc;
+        }
+
+        /// Writes the ids of a Vector, Array or Set of IdType values.
+        template <typename Ids>
+        void writeIds(IndexWriter& index, const Ids& ids)
+        {
+            index.write<std::uint64_t>(static_cast<std::uint64_t>(std::distance(std::begin(ids), std::end(ids))));
+            for (const auto& id : ids)
+            {
+                index.write<std::uint32_t>(id.get());
+            }
+        }
+
+        /// Reads ids written by writeIds() to a container constructed from a range of std::uint32_t.
+        template <typename Ids>
+        Ids readIds(IndexReader& index)
+        {
+            Vector<std::uint32_t> values;
+            index.readVector(values);
+            return Ids(values.begin(), values.end());
+        }
+
+        /// Writes an Array of plain values, such as the contents of a property.
+        template <typename T>
+        void writeArray(IndexWriter& index, const Array<T>& values)
+        {
+            index.writeVector(Vector<T>(values.begin(), values.end()));
+        }
+
+        template <typename T>
+        Array<T> readArray(IndexReader& index)
+        {
+            Vector<T> values;
+            index.readVector(values);
+            return Array<T>(values.begin(), values.end());
+        }
+
+        void writeBox(IndexWriter& index, const Box& box)
+        {
+            BitStream bitstream;
+            box.writeBox(bitstream);
+            index.writeVector(bitstream.getStorage());
+        }
+
+        void readBox(IndexReader& index, Box& box)
+        {
+            Vector<std::uint8_t> data;
+            index.readVector(data);
+            BitStream bitstream(std::move(data));
+            box.parseBox(bitstream);
+        }
+
+        void writeSampleGroupings(IndexWriter& index, const Array<SampleGrouping>& groupings)
+        {
+            index.write<std::uint64_t>(groupings.size);
+            for (const auto& grouping : groupings)
+            {
+                writeFourCC(index, grouping.type);
+                index.write<std::uint32_t>(grouping.typeParameter);
+                index.write<std::uint64_t>(grouping.samples.size);
+                for (const auto& sample : grouping.samples)
+                {
+                    index.write<std::uint32_t>(sample.sampleId.get());
+                    index.write<std::uint32_t>(sample.sampleGroupDescriptionIndex);
+                }
+            }
+        }
+
+        Array<SampleGrouping> readSampleGroupings(IndexReader& index)
+        {
+            Array<SampleGrouping> groupings(index.readCount(4 + 4 + 8));
+            for (auto& grouping : groupings)
+            {
+                grouping.type          = readFourCC(index);
+                grouping.typeParameter = index.read<std::uint32_t>();
+                grouping.samples       = Array<SampleAndEntryIds>(index.readCount(4 + 4));
+                for (auto& sample : grouping.samples)
+                {
+                    sample.sampleId                    = index.read<std::uint32_t>();
+                    sample.sampleGroupDescriptionIndex = index.read<std::uint32_t>();
+                }
+            }
+            return groupings;
+        }
+
+        void writeEditList(IndexWriter& index, const EditList& editList)
+        {
+            index.write<std::uint8_t>(editList.looping);
+            index.write<double>(editList.repetitions);
+            index.write<std::uint64_t>(editList.editUnits.size);
+            for (const auto& unit : editList.editUnits)
+            {
+                index.write<std::uint32_t>(static_cast<std::uint32_t>(unit.editType));
+                index.write<std::int64_t>(unit.mediaTimeInTrackTS);
+                index.write<std::uint64_t>(unit.durationInMovieTS);
+                index.write<std::int16_t>(unit.mediaRateInteger);
+                index.write<std::int16_t>(unit.mediaRateFraction);
+            }
+        }
+
+        void readEditList(IndexReader& index, EditList& editList)
+        {
+            editList.looping     = index.read<std::uint8_t>() != 0;
+            editList.repetitions = index.read<double>();
+            editList.editUnits   = Array<EditUnit>(index.readCount(4 + 8 + 8 + 2 + 2));
+            for (auto& unit : editList.editUnits)
+            {
+                const auto editType = index.read<std::uint32_t>();
+                if (editType > static_cast<std::uint32_t>(EditType::RAW))
+                {
+                    throw RuntimeError("Index cache: invalid edit type");
+                }
+                unit.editType           = static_cast<EditType>(editType);
+                unit.mediaTimeInTrackTS = index.read<std::int64_t>();
+                unit.durationInMovieTS  = index.read<std::uint64_t>();
+                unit.mediaRateInteger   = index.read<std::int16_t>();
+                unit.mediaRateFraction  = index.read<std::int16_t>();
+            }
+        }
+
+        void writeInitTrackInfo(IndexWriter& index, const InitTrackInfo& info)
+        {
+            index.write<std::uint32_t>(info.trackId.get());
+            writeSampleGroupings(index, info.groupedSamples);
+
+            index.write<std::uint64_t>(info.equivalences.size);
+            for (const auto& equivalence : info.equivalences)
+            {
+                index.write<std::uint32_t>(equivalence.sampleGroupDescriptionIndex);
+                index.write<std::int16_t>(equivalence.timeOffset);
+                index.write<std::uint16_t>(equivalence.timescaleMultiplier);
+            }
+            index.write<std::uint64_t>(info.metadatas.size);
+            for (const auto& metadata : info.metadatas)
+            {
+                index.write<std::uint32_t>(metadata.sampleGroupDescriptionIndex);
+                writeIds(index, metadata.metadataItemIds);
+            }
+            index.write<std::uint64_t>(info.referenceSamples.size);
+            for (const auto& references : info.referenceSamples)
+            {
+                index.write<std::uint32_t>(references.sampleGroupDescriptionIndex);
+                index.write<std::uint32_t>(references.sampleId);
+                writeIds(index, references.referenceItemIds);
+            }
+
+            index.write<std::uint64_t>(info.maxSampleSize);
+            index.write<std::uint32_t>(info.timeScale);
+            index.write<std::uint32_t>(info.alternateGroupId);
+            index.write<std::uint32_t>(info.trackFeature.getFeatureMask());
+            writeIds(index, info.alternateTrackIds);
+
+            index.write<std::uint64_t>(info.referenceTrackIds.size());
+            for (const auto& reference : info.referenceTrackIds)
+            {
+                writeFourCC(index, reference.first);
+                writeIds(index, reference.second);
+            }
+            index.write<std::uint64_t>(info.trackGroupInfoMap.size());
+            for (const auto& group : info.trackGroupInfoMap)
+            {
+                index.write<std::uint32_t>(group.first.getUInt32());
+                writeIds(index, group.second.ids);
+            }
+
+            writeEditList(index, info.editList);
+            index.write<std::uint8_t>(info.editBox != nullptr);
+            if (info.editBox)
+            {
+                writeBox(index, *info.editBox);
+            }
+
+            index.write<std::uint32_t>(info.width);
+            index.write<std::uint32_t>(info.height);
+            index.write<std::uint32_t>(info.sampleEntryType.getUInt32());
+
+            index.write<std::uint64_t>(info.parameterSetMaps.size());
+            for (const auto& parameterSetMap : info.parameterSetMaps)
+            {
+                index.write<std::uint32_t>(parameterSetMap.first.get());
+                index.write<std::uint64_t>(parameterSetMap.second.size());
+                for (const auto& parameterSet : parameterSetMap.second)
+                {
+                    index.write<std::uint8_t>(static_cast<std::uint8_t>(parameterSet.first));
+                    index.writeVector(parameterSet.second);
+                }
+            }
+            index.write<std::uint64_t>(info.parameterSets.size());
+            for (const auto& parameterSets : info.parameterSets)
+            {
+                index.write<std::uint32_t>(parameterSets.first.get());
+                index.writeVector(parameterSets.second);
+            }
+            index.write<std::uint64_t>(info.sampleSizeInPixels.size());
+            for (const auto& sampleSize : info.sampleSizeInPixels)
+            {
+                index.write<std::uint32_t>(sampleSize.first.get());
+                index.write<std::uint32_t>(sampleSize.second.width);
+                index.write<std::uint32_t>(sampleSize.second.height);
+            }
+            index.write<std::uint64_t>(info.nalLengthSizeMinus1.size());
+            for (const auto& nalLengthSize : info.nalLengthSizeMinus1)
+            {
+                index.write<std::uint32_t>(nalLengthSize.first.get());
+                index.write<std::uint8_t>(nalLengthSize.second);
+            }
+
+            index.writeVector(info.matrix);
+
+            index.write<std::uint64_t>(info.clapProperties.size());
+            for (const auto& clap : info.clapProperties)
+            {
+                index.write<std::uint32_t>(clap.first.get());
+                index.write<std::uint32_t>(clap.second.widthN);
+                index.write<std::uint32_t>(clap.second.widthD);
+                index.write<std::uint32_t>(clap.second.heightN);
+                index.write<std::uint32_t>(clap.second.heightD);
+                index.write<std::uint32_t>(clap.second.horizontalOffsetN);
+                index.write<std::uint32_t>(clap.second.horizontalOffsetD);
+                index.write<std::uint32_t>(clap.second.verticalOffsetN);
+                index.write<std::uint32_t>(clap.second.verticalOffsetD);
+            }
+            index.write<std::uint64_t>(info.auxiProperties.size());
+            for (const auto& auxi : info.auxiProperties)
+            {
+                index.write<std::uint32_t>(auxi.first.get());
+                writeArray(index, auxi.second.auxType);
+                writeArray(index, auxi.second.subType);
+            }
+        }
+
+        void readInitTrackInfo(IndexReader& index, InitTrackInfo& info)
+        {
+            info.trackId        = index.read<std::uint32_t>();
+            info.groupedSamples = readSampleGroupings(index);
+
+            info.equivalences = Array<SampleVisualEquivalence>(index.readCount(4 + 2 + 2));
+            for (auto& equivalence : info.equivalences)
+            {
+                equivalence.sampleGroupDescriptionIndex = index.read<std::uint32_t>();
+                equivalence.timeOffset                  = index.read<std::int16_t>();
+                equivalence.timescaleMultiplier         = index.read<std::uint16_t>();
+            }
+            info.metadatas = Array<SampleToMetadataItem>(index.readCount(4 + 8));
+            for (auto& metadata : info.metadatas)
+            {
+                metadata.sampleGroupDescriptionIndex = index.read<std::uint32_t>();
+                metadata.metadataItemIds             = readIds<Array<ImageId>>(index);
+            }
+            info.referenceSamples = Array<DirectReferenceSamples>(index.readCount(4 + 4 + 8));
+            for (auto& references : info.referenceSamples)
+            {
+                references.sampleGroupDescriptionIndex = index.read<std::uint32_t>();
+                references.sampleId                    = index.read<std::uint32_t>();
+                references.referenceItemIds            = readIds<Array<SequenceImageId>>(index);
+            }
+
+            info.maxSampleSize    = index.read<std::uint64_t>();
+            info.timeScale        = index.read<std::uint32_t>();
+            info.alternateGroupId = index.read<std::uint32_t>();
+            const auto features   = index.read<std::uint32_t>();
+            for (std::uint32_t feature = 1; feature != 0; feature <<= 1)
+            {
+                if ((features & feature) != 0)
+                {
+                    info.trackFeature.setFeature(static_cast<TrackFeatureEnum::Feature>(feature));
+                }
+            }
+            info.alternateTrackIds = readIds<Vector<SequenceId>>(index);
+
+            for (std::size_t count = index.readCount(4 + 8); count > 0; --count)
+            {
+                const FourCC type            = readFourCC(index);
+                info.referenceTrackIds[type] = readIds<Vector<SequenceId>>(index);
+            }
+            for (std::size_t count = index.readCount(4 + 8); count > 0; --count)
+            {
+                const FourCCInt type             = index.read<std::uint32_t>();
+                info.trackGroupInfoMap[type].ids = readIds<Vector<SequenceId>>(index);
+            }
+
+            readEditList(index, info.editList);
+            if (index.read<std::uint8_t>() != 0)
+            {
+                auto editBox = makeCustomShared<EditBox>();
+                readBox(index, *editBox);
+                info.editBox = editBox;
+            }
+
+            info.width           = index.read<std::uint32_t>();
+            info.height          = index.read<std::uint32_t>();
+            info.sampleEntryType = index.read<std::uint32_t>();
+
+            for (std::size_t count = index.readCount(4 + 8); count > 0; --count)
+            {
+                auto& parameterSetMap = info.parameterSetMaps[index.read<std::uint32_t>()];
+                for (std::size_t parameterSets = index.readCount(1 + 8); parameterSets > 0; --parameterSets)
+                {
+                    const auto type = static_cast<DecoderSpecInfoType>(index.read<std::uint8_t>());
+                    index.readVector(parameterSetMap[type]);
+                }
+            }
+            for (std::size_t count = index.readCount(4 + 8); count > 0; --count)
+            {
+                index.readVector(info.parameterSets[index.read<std::uint32_t>()]);
+            }
+            for (std::size_t count = index.readCount(4 + 4 + 4); count > 0; --count)
+            {
+                auto& sampleSize  = info.sampleSizeInPixels[index.read<std::uint32_t>()];
+                sampleSize.width  = index.read<std::uint32_t>();
+                sampleSize.height = index.read<std::uint32_t>();
+            }
+            for (std::size_t count = index.readCount(4 + 1); count > 0; --count)
+            {
+                const SampleDescriptionIndex sampleDescriptionIndex = index.read<std::uint32_t>();
+                info.nalLengthSizeMinus1[sampleDescriptionIndex]    = index.read<std::uint8_t>();
+            }
+
+            index.readVector(info.matrix);
+
+            for (std::size_t count = index.readCount(4 + 8 * 4); count > 0; --count)
+            {
+                auto& clap             = info.clapProperties[index.read<std::uint32_t>()];
+                clap.widthN            = index.read<std::uint32_t>();
+                clap.widthD            = index.read<std::uint32_t>();
+                clap.heightN           = index.read<std::uint32_t>();
+                clap.heightD           = index.read<std::uint32_t>();
+                clap.horizontalOffsetN = index.read<std::uint32_t>();
+                clap.horizontalOffsetD = index.read<std::uint32_t>();
+                clap.verticalOffsetN   = index.read<std::uint32_t>();
+                clap.verticalOffsetD   = index.read<std::uint32_t>();
+            }
+            for (std::size_t count = index.readCount(4 + 8 + 8); count > 0; --count)
+            {
+                auto& auxi   = info.auxiProperties[index.read<std::uint32_t>()];
+                auxi.auxType = readArray<char>(index);
+                auxi.subType = readArray<std::uint8_t>(index);
+            }
+        }
+
+        template <typename Key, typename Value>
+        void writeMap(IndexWriter& index, const WriteOnceMap<Key, Value>& map)
+        {
+            index.write<std::uint64_t>(map.size());
+            for (const auto& entry : map)
+            {
+                index.write<Key>(entry.first);
+                index.write<Value>(entry.second);
+            }
+        }
+
+        template <typename Key, typename Value>
+        WriteOnceMap<Key, Value> readMap(IndexReader& index)
+        {
+            Vector<typename WriteOnceMap<Key, Value>::Entry> entries(index.readCount(sizeof(Key) + sizeof(Value)));
+            for (auto& entry : entries)
+            {
+                entry.first  = index.read<Key>();
+                entry.second = index.read<Value>();
+            }
+            return WriteOnceMap<Key, Value>(std::move(entries));
+        }
+
+        void writeTrackInfoInSegment(IndexWriter& index, const TrackInfoInSegment& info)
+        {
+            index.write<std::uint32_t>(info.itemIdBase.get());
+            info.samples.writeIndex(index);
+            index.write<std::int64_t>(info.durationTS);
+            index.write<std::int64_t>(info.earliestPTSTS);
+            index.write<std::int64_t>(info.noSidxFallbackPTSTS);
+            index.write<std::int64_t>(info.nextPTSTS);
+            writeMap(index, info.pMap);
+            writeMap(index, info.pMapTS);
+            index.write<std::int64_t>(info.repetition.period);
+            index.write<std::uint64_t>(info.repetition.periodTS);
+            index.write<std::int64_t>(info.repetition.end);
+            index.write<std::uint8_t>(info.hasEditList);
+            index.write<std::uint8_t>(info.hasTtyp);
+            if (info.hasTtyp)
+            {
+                writeBox(index, info.ttyp);
+            }
+            index.write<double>(info.duration);
+            index.write<double>(info.repetitions);
+        }
+
+        void readTrackInfoInSegment(IndexReader& index, TrackInfoInSegment& info)
+        {
+            info.itemIdBase = index.read<std::uint32_t>();
+            info.samples.readIndex(index);
+            info.durationTS          = index.read<std::int64_t>();
+            info.earliestPTSTS       = index.read<std::int64_t>();
+            info.noSidxFallbackPTSTS = index.read<std::int64_t>();
+            info.nextPTSTS           = index.read<std::int64_t>();
+            info.pMap                = readMap<DecodePts::PresentationTime, DecodePts::SampleIndex>(index);
+            info.pMapTS              = readMap<DecodePts::PresentationTimeTS, DecodePts::SampleIndex>(index);
+            info.repetition.period   = index.read<std::int64_t>();
+            info.repetition.periodTS = index.read<std::uint64_t>();
+            info.repetition.end      = index.read<std::int64_t>();
+            info.hasEditList         = index.read<std::uint8_t>() != 0;
+            info.hasTtyp             = index.read<std::uint8_t>() != 0;
+            if (info.hasTtyp)
+            {
+                readBox(index, info.ttyp);
+            }
+            info.duration    = index.read<double>();
+            info.repetitions = index.read<double>();
+
+            // Composition times are stored per sample by these indices, see SamplePropertyTable::setCompositionTimes().
+            const std::size_t sampleCount = info.samples.size();
+            for (const auto& entry : info.pMap)
+            {
+                if (entry.second >= sampleCount)
+                {
+                    throw RuntimeError("Index cache: invalid sample index in presentation times");
+                }
+            }
+            for (const auto& entry : info.pMapTS)
+            {
+                if (entry.second >= sampleCount)
+                {
+                    throw RuntimeError("Index cache: invalid sample index in presentation times");
+                }
+            }
+        }
+
+        void writeMoovProperties(IndexWriter& index, const MoovProperties& moov)
+        {
+            index.write<std::uint8_t>(moov.moovFeature.hasFeature(MoovFeature::HasMoovLevelMetaBox));
+            index.write<std::uint8_t>(moov.moovFeature.hasFeature(MoovFeature::HasCoverImage));
+            index.write<std::uint32_t>(moov.movieTimescale);
+            index.writeVector(moov.mMatrix);
+            index.write<std::uint64_t>(moov.fragmentDuration);
+            index.write<std::uint64_t>(moov.fragmentSampleDefaults.size());
+            for (const auto& defaults : moov.fragmentSampleDefaults)
+            {
+                index.write<std::uint32_t>(defaults.trackId);
+                index.write<std::uint32_t>(defaults.defaultSampleDescriptionIndex);
+                index.write<std::uint32_t>(defaults.defaultSampleDuration);
+                index.write<std::uint32_t>(defaults.defaultSampleSize);
+                index.write<std::uint32_t>(defaults.defaultSampleFlags.flagsAsUInt);
+            }
+        }
+
+        void readMoovProperties(IndexReader& index, MoovProperties& moov)
+        {
+            if (index.read<std::uint8_t>() != 0)
+            {
+                moov.moovFeature.setFeature(MoovFeature::HasMoovLevelMetaBox);
+            }
+            if (index.read<std::uint8_t>() != 0)
+            {
+                moov.moovFeature.setFeature(MoovFeature::HasCoverImage);
+            }
+            moov.movieTimescale = index.read<std::uint32_t>();
+            index.readVector(moov.mMatrix);
+            moov.fragmentDuration = index.read<std::uint64_t>();
+            moov.fragmentSampleDefaults.resize(index.readCount(5 * 4));
+            for (auto& defaults : moov.fragmentSampleDefaults)
+            {
+                defaults.trackId                        = index.read<std::uint32_t>();
+                defaults.defaultSampleDescriptionIndex  = index.read<std::uint32_t>();
+                defaults.defaultSampleDuration          = index.read<std::uint32_t>();
+                defaults.defaultSampleSize              = index.read<std::uint32_t>();
+                defaults.defaultSampleFlags.flagsAsUInt = index.read<std::uint32_t>();
+            }
+        }
+    }  // anonymous namespace
+
+    ErrorCode HeifReaderImpl::getIndexCache(const uint64_t contentKey, Array<uint8_t>& indexCache) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getIndexCache");
+        if (isInitialized() != ErrorCode::OK)
+        {
+            return ErrorCode::UNINITIALIZED;
+        }
+        ErrorCode error = loadPendingMoov();
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        // Only the state initialize() builds from a single file can be restored.
+        if (mHeaderBoxes.empty() || (mFileProperties.segmentPropertiesMap.size() != 1) ||
+            (mFileProperties.segmentIndex.size != 0))
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+        const SegmentProperties& segment = mFileProperties.segmentPropertiesMap.at(0);
+
+        IndexWriter index;
+        index.write<std::uint32_t>(INDEX_CACHE_MAGIC);
+        index.write<std::uint32_t>(INDEX_CACHE_VERSION);
+        index.writeVector(libraryVersion());
+        index.write<std::uint64_t>(static_cast<std::uint64_t>(segment.io.size));
+        index.write<std::uint64_t>(contentKey);
+
+        // The boxes read to memory by initialize() are stored as they are, and parsed again when the cache is loaded.
+        index.write<std::uint64_t>(mHeaderBoxes.size());
+        for (const auto& box : mHeaderBoxes)
+        {
+            Vector<std::uint8_t> data(static_cast<std::size_t>(box.second));
+            if (!segment.io.stream->readAt(box.first, reinterpret_cast<char*>(data.data()), box.second))
+            {
+                return ErrorCode::FILE_READ_ERROR;
+            }
+            index.write<std::int64_t>(box.first);
+            index.writeVector(data);
+        }
+        index.write<std::uint64_t>(mMetaBoxLocation.offset);
+        index.write<std::uint64_t>(mMetaBoxLocation.space);
+
+        writeMoovProperties(index, mFileProperties.moovProperties);
+        index.write<std::uint64_t>(mFileProperties.initTrackInfos.size());
+        for (const auto& info : mFileProperties.initTrackInfos)
+        {
+            writeInitTrackInfo(index, info.second);
+        }
+
+        writeIds(index, segment.sequences);
+        index.write<std::uint64_t>(segment.trackInfos.size());
+        for (const auto& info : segment.trackInfos)
+        {
+            index.write<std::uint32_t>(info.first.get());
+            writeTrackInfoInSegment(index, info.second);
+        }
+        index.write<std::uint64_t>(mFileProperties.sequenceToSegment.size());
+        for (const auto& sequence : mFileProperties.sequenceToSegment)
+        {
+            index.write<std::uint32_t>(sequence.first.get());
+            index.write<std::uint32_t>(sequence.second.get());
+        }
+        index.write<std::uint64_t>(mFileProperties.segmentsByItemIdBase.size());
+        for (const auto& track : mFileProperties.segmentsByItemIdBase)
+        {
+            index.write<std::uint32_t>(track.first.get());
+            index.write<std::uint64_t>(track.second.size());
+            for (const auto& segmentOfItems : track.second)
+            {
+                index.write<std::uint32_t>(segmentOfItems.first.get());
+                index.write<std::uint32_t>(segmentOfItems.second.get());
+            }
+        }
+        index.write<std::uint32_t>(mNextSequence.get());
+
+        // Hand the cache over without copying it element by element.
+        const Vector<std::uint8_t>& data = index.data();
+        Array<uint8_t> cache(data.size());
+        std::memcpy(cache.elements, data.data(), data.size());
+        std::swap(indexCache.elements, cache.elements);
+        std::swap(indexCache.size, cache.size);
+        return ErrorCode::OK;
+    }
+
+    ErrorCode HeifReaderImpl::loadIndexCache()
+    {
+        StreamIO& io = mFileProperties.segmentPropertiesMap.at(0).io;
+        IndexReader index(mConfig.indexCache, mConfig.indexCacheSize);
+        try
+        {
+            if ((index.read<std::uint32_t>() != INDEX_CACHE_MAGIC) ||
+                (index.read<std::uint32_t>() != INDEX_CACHE_VERSION))
+            {
+                logInfo() << "Index cache is of another format or version, parsing the file." << std::endl;
+                return ErrorCode::NOT_APPLICABLE;
+            }
+            Vector<std::uint8_t> version;
+            index.readVector(version);
+            if (version != libraryVersion())
+            {
+                logInfo() << "Index cache is of another version of the library, parsing the file." << std::endl;
+                return ErrorCode::NOT_APPLICABLE;
+            }
+            if ((index.read<std::uint64_t>() != static_cast<std::uint64_t>(io.size)) ||
+                (index.read<std::uint64_t>() != mConfig.indexCacheKey))
+            {
+                logInfo() << "Index cache is of another file, parsing the file." << std::endl;
+                return ErrorCode::NOT_APPLICABLE;
+            }
+        }
+        catch (const ISOBMFF::Exception&)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+
+        StatisticsScope statisticsScope(mStatistics.get(), "load index cache", StatisticsScope::Kind::PHASE);
+        mState          = State::INITIALIZING;
+        ErrorCode error = ErrorCode::OK;
+        try
+        {
+            for (std::size_t count = index.readCount(8 + 8); (count > 0) && (error == ErrorCode::OK); --count)
+            {
+                const std::int64_t offset = index.read<std::int64_t>();
+                Vector<std::uint8_t> data;
+                index.readVector(data);
+                if (data.size() < 8)
+                {
+                    throw RuntimeError("Index cache: invalid header box");
+                }
+
+                MemoryStream boxStream(data);
+                StreamIO boxIo;
+                boxIo.stream.reset(CUSTOM_NEW(InternalStream, (&boxStream)));
+                boxIo.size = boxStream.size();
+                const String boxType(data.begin() + 4, data.begin() + 8);
+                if (boxType == "ftyp")
+                {
+                    error = handleFtyp(boxIo);
+                }
+                else if (boxType == "etyp")
+                {
+                    error = handleEtyp(boxIo);
+                }
+                else if (boxType == "meta")
+                {
+                    error = handleMeta(boxIo);
+                }
+                else
+                {
+                    throw RuntimeError("Index cache: invalid header box");
+                }
+                mHeaderBoxes.push_back(std::make_pair(offset, static_cast<std::int64_t>(data.size())));
+            }
+            if (error == ErrorCode::OK)
+            {
+                mMetaBoxLocation.offset = index.read<std::uint64_t>();
+                mMetaBoxLocation.space  = index.read<std::uint64_t>();
+
+                readMoovProperties(index, mFileProperties.moovProperties);
+                for (std::size_t count = index.readCount(4); count > 0; --count)
+                {
+                    InitTrackInfo info;
+                    readInitTrackInfo(index, info);
+                    const SequenceId trackId                = info.trackId;
+                    mFileProperties.initTrackInfos[trackId] = std::move(info);
+                }
+
+                SegmentProperties& segment = mFileProperties.segmentPropertiesMap.at(0);
+                segment.segmentId          = 0;
+                for (const auto sequence : readIds<Vector<Sequence>>(index))
+                {
+                    segment.sequences.insert(sequence);
+                }
+                for (std::size_t count = index.readCount(4); count > 0; --count)
+                {
+                    const SequenceId trackId = index.read<std::uint32_t>();
+                    if (mFileProperties.initTrackInfos.count(trackId) == 0)
+                    {
+                        throw RuntimeError("Index cache: samples of an unknown track");
+                    }
+                    readTrackInfoInSegment(index, segment.trackInfos[trackId]);
+                }
+                for (std::size_t count = index.readCount(4 + 4); count > 0; --count)
+                {
+                    const Sequence sequence   = index.read<std::uint32_t>();
+                    const SegmentId segmentId = index.read<std::uint32_t>();
+                    if ((segmentId != 0) || (segment.sequences.count(sequence) == 0))
+                    {
+                        throw RuntimeError("Index cache: invalid segment sequence");
+                    }
+                    mFileProperties.sequenceToSegment[sequence] = segmentId;
+                }
+                for (std::size_t count = index.readCount(4 + 8); count > 0; --count)
+                {
+                    const SequenceId trackId = index.read<std::uint32_t>();
+                    if (segment.trackInfos.count(trackId) == 0)
+                    {
+                        throw RuntimeError("Index cache: segments of an unknown track");
+                    }
+                    auto& segments = mFileProperties.segmentsByItemIdBase[trackId];
+                    for (std::size_t items = index.readCount(4 + 4); items > 0; --items)
+                    {
+                        const SequenceImageId itemIdBase = index.read<std::uint32_t>();
+                        const SegmentId segmentId        = index.read<std::uint32_t>();
+                        if (segmentId != 0)
+                        {
+                            throw RuntimeError("Index cache: invalid segment of samples");
+                        }
+                        segments[itemIdBase] = segmentId;
+                    }
+                }
+                mNextSequence = index.read<std::uint32_t>();
+
+                if (!index.atEnd())
+                {
+                    throw RuntimeError("Index cache: unexpected data after the index");
+                }
+            }
+        }
+        catch (const ISOBMFF::Exception& exc)
+        {
+            logError() << "loadIndexCache Exception Error: " << exc.what() << std::endl;
+            error = ErrorCode::FILE_READ_ERROR;
+        }
+        catch (const std::exception& e)
+        {
+            logError() << "loadIndexCache std::exception Error: " << e.what() << std::endl;
+            error = ErrorCode::FILE_READ_ERROR;
+        }
+
+        if (error != ErrorCode::OK)
+        {
+            // Drop what was restored, but keep the input stream, so that the file can be parsed instead.
+            const ReaderConfig config = mConfig;
+            StreamIO fileIo           = std::move(io);
+            reset();
+            mConfig                                    = config;
+            mFileProperties.segmentPropertiesMap[0].io = std::move(fileIo);
+            return error;
+        }
+
+        mFileProperties.fileFeature = getFileFeatures();
+        mMetaBoxLocation.fileSize   = static_cast<std::uint64_t>(io.size);
+        mState                      = State::READY;
+        return ErrorCode::OK;
+    }
+}  // namespace HEIF
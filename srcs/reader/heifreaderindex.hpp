@@ -0,0 +1,143 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef HEIFREADERINDEX_HPP
+#define HEIFREADERINDEX_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "customallocator.hpp"
+
+namespace HEIF
+{
+    /**
+     * Index caches start with this value, written in the byte order of the platform, so that caches of another byte
+     * order are rejected along with caches of other formats. */
+    static const std::uint32_t INDEX_CACHE_MAGIC = 0x48494458;  // "HIDX"
+
+    /**
+     * Version of the index cache format. Increment when the layout of the cache or the parse state in it changes. The
+     * version of the library is written after it too, so that caches of other releases are rejected also when the
+     * parse state changed without this being incremented. */
+    static const std::uint32_t INDEX_CACHE_VERSION = 1;
+
+    /** @brief Serializes parse state of the reader to an index cache, see Reader::getIndexCache().
+     *
+     * Values are written in the byte order of the platform, and vectors of plain values are written as counts followed
+     * by their contents, so that they are restored with a single copy. */
+    class IndexWriter
+    {
+    public:
+        template <typename T>
+        void write(const T value)
+        {
+            static_assert(std::is_arithmetic<T>::value, "IndexWriter::write() takes arithmetic values");
+            append(&value, sizeof(T));
+        }
+
+        template <typename T>
+        void writeVector(const Vector<T>& values)
+        {
+            static_assert(std::is_arithmetic<T>::value, "IndexWriter::writeVector() takes arithmetic values");
+            write<std::uint64_t>(values.size());
+            append(values.data(), values.size() * sizeof(T));
+        }
+
+        /// @return The serialized data
+        const Vector<std::uint8_t>& data() const
+        {
+            return mData;
+        }
+
+    private:
+        void append(const void* data, const std::size_t size)
+        {
+            const auto bytes = static_cast<const std::uint8_t*>(data);
+            mData.insert(mData.end(), bytes, bytes + size);
+        }
+
+        Vector<std::uint8_t> mData;
+    };
+
+    /** @brief Reads parse state written by IndexWriter from an index cache.
+     *
+     * @throws RuntimeError from all read methods if the cache ends before the value, so that a truncated or corrupted
+     *         cache never makes the reader allocate or read more than the cache holds. */
+    class IndexReader
+    {
+    public:
+        IndexReader(const std::uint8_t* data, const std::uint64_t size)
+            : mData(data)
+            , mRemaining(size)
+        {
+        }
+
+        template <typename T>
+        T read()
+        {
+            static_assert(std::is_arithmetic<T>::value, "IndexReader::read() returns arithmetic values");
+            T value;
+            take(&value, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void readVector(Vector<T>& values)
+        {
+            static_assert(std::is_arithmetic<T>::value, "IndexReader::readVector() takes arithmetic values");
+            values.resize(readCount(sizeof(T)));
+            take(values.data(), values.size() * sizeof(T));
+        }
+
+        /** @brief Reads the element count of a sequence.
+         *  @param [in] minimumElementSize Bytes each element takes at least in the cache.
+         *  @return The count, checked to fit in the rest of the cache. */
+        std::size_t readCount(const std::uint64_t minimumElementSize)
+        {
+            const auto count = read<std::uint64_t>();
+            if (count > mRemaining / (minimumElementSize > 0 ? minimumElementSize : 1))
+            {
+                throw RuntimeError("IndexReader: index cache is truncated");
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+        /// @return True if all of the cache has been read
+        bool atEnd() const
+        {
+            return mRemaining == 0;
+        }
+
+    private:
+        void take(void* value, const std::uint64_t size)
+        {
+            if (size > mRemaining)
+            {
+                throw RuntimeError("IndexReader: index cache is truncated");
+            }
+            if (size > 0)
+            {
+                std::memcpy(value, mData, static_cast<std::size_t>(size));
+            }
+            mData += size;
+            mRemaining -= size;
+        }
+
+        const std::uint8_t* mData;
+        std::uint64_t mRemaining;
+    };
+}  // namespace HEIF
+
+#endif /* HEIFREADERINDEX_HPP */
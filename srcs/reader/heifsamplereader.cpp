@@ -0,0 +1,281 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "heifsamplereader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "nalutil.hpp"
+
+namespace HEIF
+{
+    HEIF_DLL_PUBLIC void SampleReader::Destroy(SampleReader* sampleReader)
+    {
+        CUSTOM_DELETE(sampleReader, SampleReader);
+    }
+
+    SampleReaderImpl::SampleReaderImpl(Vector<Sample>&& samples, const SampleReaderConfig& config)
+        : mSamples(std::move(samples))
+        , mMaxMergedReadSize(config.maxMergedReadSize)
+        , mBuffers(std::max(config.prefetchCount, 2u))
+        , mMergedBlock()
+        , mMutex()
+        , mSampleRead()
+        , mBufferFreed()
+        , mNext(0)
+        , mReadCount(0)
+        , mStopping(false)
+        , mThread()
+    {
+        start(0);
+    }
+
+    SampleReaderImpl::~SampleReaderImpl()
+    {
+        stop();
+        for (const Buffer& buffer : mBuffers)
+        {
+            customDeallocate(buffer.block.data);
+        }
+        customDeallocate(mMergedBlock.data);
+    }
+
+    ErrorCode SampleReaderImpl::nextSample(SampleData& sample)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mNext >= mSamples.size())
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+        mSampleRead.wait(lock, [this]() { return mReadCount > mNext; });
+
+        const Buffer& buffer = mBuffers[mNext % mBuffers.size()];
+        sample.sampleId      = mSamples[mNext].sampleId;
+        sample.timeStamp     = mSamples[mNext].timeStamp;
+        sample.data          = buffer.block.data;
+        sample.size          = buffer.size;
+
+        const ErrorCode error = buffer.error;
+
+        // The buffer of the previously returned sample becomes free.
+        ++mNext;
+        lock.unlock();
+        mBufferFreed.notify_one();
+        return error;
+    }
+
+    ErrorCode SampleReaderImpl::seek(const SequenceImageId& sampleId)
+    {
+        const auto sample = std::find_if(mSamples.cbegin(), mSamples.cend(),
+                                         [&](const Sample& entry) { return entry.sampleId == sampleId; });
+        if (sample == mSamples.cend())
+        {
+            return ErrorCode::INVALID_SEQUENCE_IMAGE_ID;
+        }
+        const auto index = static_cast<std::size_t>(sample - mSamples.cbegin());
+
+        {
+            // Short forward seeks only skip samples already read ahead.
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (index >= mNext && index <= mReadCount)
+            {
+                mNext = index;
+                mBufferFreed.notify_one();
+                return ErrorCode::OK;
+            }
+        }
+
+        stop();
+        start(index);
+        return ErrorCode::OK;
+    }
+
+    void SampleReaderImpl::start(const std::size_t index)
+    {
+        mNext      = index;
+        mReadCount = index;
+        mStopping  = false;
+        mThread    = std::thread(&SampleReaderImpl::run, this);
+    }
+
+    void SampleReaderImpl::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mBufferFreed.notify_one();
+        if (mThread.joinable())
+        {
+            mThread.join();
+        }
+    }
+
+    void SampleReaderImpl::run()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mStopping)
+        {
+            // Buffers of all samples after the one held by the consumer are free, up to the size of the ring.
+            const std::size_t held  = (mNext > 0) ? mNext - 1 : 0;
+            const std::size_t limit = std::min(mSamples.size(), held + mBuffers.size());
+            if (mReadCount >= limit)
+            {
+                mBufferFreed.wait(lock);
+                continue;
+            }
+
+            const std::size_t first = mReadCount;
+            lock.unlock();
+            // An exception would terminate the process on this thread, so the failure is handed to the consumer with
+            // the first sample instead. The following samples are read again on the next round.
+            std::size_t count = 0;
+            try
+            {
+                count = readSamples(first, limit - first);
+            }
+            catch (...)
+            {
+                failSample(first, ErrorCode::FILE_READ_ERROR);
+                count = 1;
+            }
+            lock.lock();
+
+            mReadCount = first + count;
+            mSampleRead.notify_one();
+        }
+    }
+
+    void SampleReaderImpl::failSample(const std::size_t index, const ErrorCode error)
+    {
+        Buffer& buffer = mBuffers[index % mBuffers.size()];
+        buffer.size    = 0;
+        buffer.error   = error;
+    }
+
+    bool SampleReaderImpl::reserve(Block& block, const std::uint64_t size, const std::uint64_t keep)
+    {
+        if (block.capacity >= size)
+        {
+            return true;
+        }
+        auto* data = static_cast<std::uint8_t*>(customAllocate(static_cast<std::size_t>(size)));
+        if (!data)
+        {
+            return false;
+        }
+        if (keep)
+        {
+            std::memcpy(data, block.data, static_cast<std::size_t>(keep));
+        }
+        customDeallocate(block.data);
+        block.data     = data;
+        block.capacity = size;
+        return true;
+    }
+
+    std::size_t SampleReaderImpl::readSamples(const std::size_t first, const std::size_t count)
+    {
+        // Merge the reads of samples which follow each other in the stream, e.g. samples of the same chunk.
+        std::size_t end          = first + 1;
+        std::uint64_t mergedSize = mSamples[first].size;
+        while ((end < first + count) && (mSamples[end].stream == mSamples[first].stream) &&
+               (mSamples[end - 1].offset + mSamples[end - 1].size == mSamples[end].offset) &&
+               (mergedSize + mSamples[end].size <= mMaxMergedReadSize))
+        {
+            mergedSize += mSamples[end].size;
+            ++end;
+        }
+        // Without memory for the merged read the samples are read one by one.
+        if ((end - first > 1) && !reserve(mMergedBlock, mergedSize))
+        {
+            end = first + 1;
+        }
+
+        if (end - first == 1)
+        {
+            const Sample& sample = mSamples[first];
+            Buffer& buffer       = mBuffers[first % mBuffers.size()];
+            if (!reserve(buffer.block, sample.size))
+            {
+                failSample(first, ErrorCode::MEMORY_ALLOCATION_FAILED);
+                return 1;
+            }
+            buffer.size  = sample.size;
+            buffer.error = ErrorCode::OK;
+            if (sample.size && !sample.stream->readAt(static_cast<std::int64_t>(sample.offset),
+                                                      reinterpret_cast<char*>(buffer.block.data),
+                                                      static_cast<std::int64_t>(sample.size)))
+            {
+                buffer.error = ErrorCode::FILE_READ_ERROR;
+            }
+            convertSample(sample, buffer);
+            return 1;
+        }
+
+        const bool readOk = mSamples[first].stream->readAt(static_cast<std::int64_t>(mSamples[first].offset),
+                                                           reinterpret_cast<char*>(mMergedBlock.data),
+                                                           static_cast<std::int64_t>(mergedSize));
+        std::uint64_t offset = 0;
+        for (std::size_t index = first; index < end; ++index)
+        {
+            const Sample& sample = mSamples[index];
+            Buffer& buffer       = mBuffers[index % mBuffers.size()];
+            if (!reserve(buffer.block, sample.size))
+            {
+                failSample(index, ErrorCode::MEMORY_ALLOCATION_FAILED);
+            }
+            else
+            {
+                buffer.size  = sample.size;
+                buffer.error = readOk ? ErrorCode::OK : ErrorCode::FILE_READ_ERROR;
+                if (readOk && sample.size)
+                {
+                    std::memcpy(buffer.block.data, mMergedBlock.data + offset, sample.size);
+                }
+                convertSample(sample, buffer);
+            }
+            offset += sample.size;
+        }
+        return end - first;
+    }
+
+    void SampleReaderImpl::convertSample(const Sample& sample, Buffer& buffer)
+    {
+        if ((buffer.error != ErrorCode::OK) || (sample.nalLengthSize == 0))
+        {
+            return;
+        }
+
+        // Data grows if nal-length values are shorter than bytestream headers.
+        std::uint64_t byteStreamSize = buffer.size;
+        if ((sample.nalLengthSize != 4) &&
+            !getByteStreamSize(buffer.block.data, buffer.size, sample.nalLengthSize, byteStreamSize))
+        {
+            buffer.error = ErrorCode::FILE_READ_ERROR;
+            return;
+        }
+        if (!reserve(buffer.block, byteStreamSize, buffer.size))
+        {
+            buffer.size  = 0;
+            buffer.error = ErrorCode::MEMORY_ALLOCATION_FAILED;
+            return;
+        }
+        if (!convertLengthPrefixedToByteStream(buffer.block.data, buffer.size, buffer.block.capacity,
+                                               sample.nalLengthSize))
+        {
+            buffer.error = ErrorCode::FILE_READ_ERROR;
+        }
+    }
+}  // namespace HEIF
@@ -0,0 +1,117 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef HEIFSAMPLEREADER_HPP
+#define HEIFSAMPLEREADER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "customallocator.hpp"
+#include "heifreader.h"
+#include "heifstreaminternal.hpp"
+
+namespace HEIF
+{
+    /** @brief Implementation of SampleReader.
+     *
+     * Sample i of the decoding order is read to buffer i % N of a ring of N buffers. The background thread may fill
+     * the buffers of up to N - 1 samples after the one the consumer currently holds, so the held buffer is never
+     * written to. */
+    class SampleReaderImpl : public SampleReader
+    {
+    public:
+        /// Location of a sample in decoding order, resolved by the reader before the background thread starts.
+        struct Sample
+        {
+            SequenceImageId sampleId;
+            std::int64_t timeStamp;
+            InternalStream* stream;      ///< Stream of the segment containing the sample.
+            std::uint64_t offset;        ///< Offset of the sample data in the stream.
+            std::uint32_t size;          ///< Size of the sample data in the stream.
+            unsigned int nalLengthSize;  ///< Size of nal-length fields to substitute, 0 to keep data as is.
+        };
+
+        SampleReaderImpl(Vector<Sample>&& samples, const SampleReaderConfig& config);
+        ~SampleReaderImpl() override;
+
+        /// @see SampleReader::nextSample()
+        ErrorCode nextSample(SampleData& sample) override;
+
+        /// @see SampleReader::seek()
+        ErrorCode seek(const SequenceImageId& sampleId) override;
+
+    private:
+        /// Memory allocated with customAllocate(), so that a failed allocation can be reported for the sample.
+        struct Block
+        {
+            std::uint8_t* data;      ///< Null until first reserved.
+            std::uint64_t capacity;  ///< Kept, so blocks are reallocated only for larger samples.
+        };
+
+        struct Buffer
+        {
+            Block block;         ///< Sample data.
+            std::uint64_t size;  ///< Size of the sample data in the block.
+            ErrorCode error;     ///< Result of reading the sample.
+        };
+
+        /**
+         * Make block hold at least size bytes.
+         * @param [in,out] block  Block to grow.
+         * @param [in] size       Required capacity.
+         * @param [in] keep       Number of bytes to keep from the beginning of the block when it is reallocated.
+         * @return False if the memory could not be allocated. The block is unchanged then. */
+        static bool reserve(Block& block, std::uint64_t size, std::uint64_t keep = 0);
+
+        /// Start the background thread from sample index.
+        void start(std::size_t index);
+
+        /// Stop the background thread. Samples read ahead are discarded.
+        void stop();
+
+        /// Background thread main loop.
+        void run();
+
+        /// Mark the sample at index as failed with error, without data.
+        void failSample(std::size_t index, ErrorCode error);
+
+        /**
+         * Read samples starting from first, merging reads of samples which are adjacent in the stream. Called without
+         * holding the lock, only for samples whose buffers the consumer does not access.
+         * @param [in] first  Index of the first sample to read.
+         * @param [in] count  Number of samples with free buffers.
+         * @return Number of samples read, at least 1. */
+        std::size_t readSamples(std::size_t first, std::size_t count);
+
+        /// Substitute nal-length values of the sample in buffer with bytestream headers, if requested.
+        void convertSample(const Sample& sample, Buffer& buffer);
+
+        const Vector<Sample> mSamples;
+        const std::uint64_t mMaxMergedReadSize;
+        Vector<Buffer> mBuffers;  ///< Ring of reusable sample buffers.
+        Block mMergedBlock;       ///< Data of merged reads, used only by the background thread.
+
+        std::mutex mMutex;
+        std::condition_variable mSampleRead;   ///< Signaled when mReadCount grows.
+        std::condition_variable mBufferFreed;  ///< Signaled when mNext grows or the thread is to stop.
+        std::size_t mNext;                     ///< Index of the sample returned by the next nextSample() call.
+        std::size_t mReadCount;                ///< Index of the next sample the background thread reads.
+        bool mStopping;                        ///< True when the background thread is to stop.
+        std::thread mThread;
+    };
+}  // namespace HEIF
+
+#endif /* HEIFSAMPLEREADER_HPP */
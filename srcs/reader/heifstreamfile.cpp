@@ -13,6 +13,10 @@
 
 #include "heifstreamfile.hpp"
 
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#endif
+
 #include "customallocator.hpp"
 
 
@@ -122,6 +126,37 @@ namespace HEIF
         }
     }
 
+    FileStream::offset_t FileStream::readAt(offset_t offset, char* buffer, offset_t size_)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        // ReadFile() with an explicit offset moves the file pointer of synchronous handles, so let the caller fall
+        // back to serialized seek and read.
+        (void) offset;
+        (void) buffer;
+        (void) size_;
+        return -1;
+#else
+        if (!m_file)
+        {
+            return 0;
+        }
+
+        // pread() bypasses the stdio buffer, which is fine as the file is never written to.
+        const int handle = fileno(m_file);
+        offset_t total   = 0;
+        while (total < size_)
+        {
+            const ssize_t n = pread(handle, buffer + total, size_t(size_ - total), off_t(offset + total));
+            if (n <= 0)
+            {
+                break;
+            }
+            total += n;
+        }
+        return total;
+#endif
+    }
+
     FileStream::offset_t FileStream::tell()
     {
         return m_file ? m_curOffset : 0;
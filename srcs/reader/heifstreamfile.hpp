@@ -55,6 +55,14 @@ namespace HEIF
         FileStream::StreamSize if the file size cannot be determinEOF*/
         offset_t size() override;
 
+        /** Reads data from the given offset without changing the current
+        offset of the file. Not supported on Windows.
+        @param [offset] Offset to read from
+        @param [buffer] The buffer to write the data into
+        @param [size]   The number of bytes to read from the stream
+        @returns The number of bytes read, 0 on EOF, or -1 if not supported. */
+        offset_t readAt(offset_t offset, char* buffer, offset_t size) override;
+
         /** Was the file successfully opened? */
         bool isOpen() const;
 
@@ -15,6 +15,7 @@
 
 #include "customallocator.hpp"
 #include "heifstreamfile.hpp"
+#include "heifstreammmap.hpp"
 
 #ifdef HEIF_USE_LINUX_FILESTREAM
 #include "heifstreamlinux.hpp"
@@ -22,8 +23,20 @@
 
 namespace HEIF
 {
-    StreamInterface* openFile(const char* filename)
+    StreamInterface* openFile(const char* filename, const bool memoryMap)
     {
+        // A memory mapping lets item data be accessed without copying. Fall back to buffered reads for files that
+        // cannot be mapped (empty or special files, exhausted address space).
+        if (memoryMap)
+        {
+            MemoryMappedStream* mappedStream = CUSTOM_NEW(MemoryMappedStream, (filename));
+            if (mappedStream->isOpen())
+            {
+                return mappedStream;
+            }
+            CUSTOM_DELETE(mappedStream, MemoryMappedStream);
+        }
+
 #ifdef HEIF_USE_LINUX_FILESTREAM
         return CUSTOM_NEW(LinuxStream, (filename));
 #else
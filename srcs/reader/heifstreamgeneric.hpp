@@ -18,7 +18,10 @@ namespace HEIF
 {
     class StreamInterface;
 
-    StreamInterface* openFile(const char* filename);
+    /** Open a file for reading.
+     *  @param [in] filename  Name of the file.
+     *  @param [in] memoryMap Map the file to memory if possible, instead of reading it with buffered reads. */
+    StreamInterface* openFile(const char* filename, bool memoryMap);
 }  // namespace HEIF
 
 #endif  // HEIFSTREAMGENERIC_HPP_
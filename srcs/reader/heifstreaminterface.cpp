@@ -24,4 +24,14 @@ namespace HEIF
     {
         // nothing
     }
+
+    StreamInterface::offset_t StreamInterface::readAt(offset_t /*offset*/, char* /*buffer*/, offset_t /*size*/)
+    {
+        return -1;
+    }
+
+    const char* StreamInterface::data()
+    {
+        return nullptr;
+    }
 }  // namespace HEIF
@@ -13,10 +13,13 @@
 
 #include "heifstreaminternal.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include "customallocator.hpp"
 #include "log.hpp"
+#include "statistics.hpp"
 
 namespace HEIF
 {
@@ -26,18 +29,84 @@ namespace HEIF
     } while (0)
     //#define TRACE(x) x
 
-    InternalStream::InternalStream(StreamInterface* stream)
+    InternalStream::InternalStream(StreamInterface* stream, const std::uint32_t readAheadSize)
         : m_stream(stream)
         , m_error(false)
         , m_eof(false)
+        , m_positionalReads(true)
+        , m_mutex()
+        , m_readAhead(false)
+        , m_size(StreamInterface::IndeterminateSize)
+        , m_position(0)
+        , m_streamPosition(0)
+        , m_cache()
+        , m_cacheOffset(0)
+        , m_cacheSize(0)
     {
         m_error = !stream || !stream->absoluteSeek(0);
+        countSeek();
+        if (!m_error)
+        {
+            m_size = stream->size();
+
+            // Memory backed streams are not accessed with read calls, so there is nothing to coalesce.
+            m_readAhead = (readAheadSize > 0) && (stream->data() == nullptr);
+            if (m_readAhead)
+            {
+                m_cache.resize(readAheadSize);
+            }
+        }
     }
 
     void InternalStream::read(char* buffer, StreamInterface::offset_t size_)
     {
+        if (m_readAhead)
+        {
+            TRACE(logInfo() << "Reading " << size_ << " at " << m_position << std::endl);
+            const auto blockSize          = static_cast<StreamInterface::offset_t>(m_cache.size());
+            StreamInterface::offset_t got = 0;
+            while (got < size_)
+            {
+                if (isCached(m_position))
+                {
+                    const StreamInterface::offset_t count =
+                        std::min(size_ - got, m_cacheOffset + m_cacheSize - m_position);
+                    std::memcpy(buffer + got, m_cache.data() + (m_position - m_cacheOffset),
+                                static_cast<size_t>(count));
+                    m_position += count;
+                    got += count;
+                }
+                else if (size_ - got >= blockSize)
+                {
+                    // Large reads, like whole 'moov' boxes, bypass the read-ahead block.
+                    const StreamInterface::offset_t count = readFromStream(m_position, buffer + got, size_ - got);
+                    m_position += count;
+                    got += count;
+                    if (got < size_)
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    fillCache();
+                    if (!isCached(m_position))
+                    {
+                        break;
+                    }
+                }
+            }
+            if (got < size_)
+            {
+                m_eof   = true;
+                m_error = true;
+            }
+            return;
+        }
+
         TRACE(logInfo() << "Reading " << size_ << " at " << m_stream->tell() << " ");
         StreamInterface::offset_t got = m_stream->read(buffer, size_);
+        countRead(got);
         if (got < size_)
         {
             TRACE(logInfo() << "FAIL!" << std::endl);
@@ -52,9 +121,23 @@ namespace HEIF
 
     int InternalStream::get()
     {
+        if (m_readAhead)
+        {
+            fillCache();
+            if (isCached(m_position))
+            {
+                const char ch = m_cache[static_cast<size_t>(m_position - m_cacheOffset)];
+                ++m_position;
+                return static_cast<unsigned char>(ch);
+            }
+            m_eof = true;
+            return 0;
+        }
+
         char ch;
         TRACE(logInfo() << "Getting at " << m_stream->tell() << " ");
         StreamInterface::offset_t got = m_stream->read(&ch, sizeof(ch));
+        countRead(got);
         if (got)
         {
             TRACE(logInfo() << "OK!" << std::endl);
@@ -70,10 +153,23 @@ namespace HEIF
 
     bool InternalStream::peekEof()
     {
+        if (m_size != StreamInterface::IndeterminateSize)
+        {
+            return tell() >= m_size;
+        }
+
+        if (m_readAhead)
+        {
+            fillCache();
+            return !isCached(m_position);
+        }
+
         char buffer;
         TRACE(logInfo() << "Peek EOF at " << m_stream->tell() << " ");
         auto was = m_stream->tell();
-        if (m_stream->read(&buffer, sizeof(buffer)) == 0)
+        const StreamInterface::offset_t got = m_stream->read(&buffer, sizeof(buffer));
+        countRead(got);
+        if (got == 0)
         {
             TRACE(logInfo() << "EOF!" << std::endl);
             return true;
@@ -82,13 +178,31 @@ namespace HEIF
         {
             TRACE(logInfo() << "No EOF!" << std::endl);
             m_stream->absoluteSeek(was);
+            countSeek();
             return false;
         }
     }
 
     void InternalStream::seek(StreamInterface::offset_t offset)
     {
+        if (m_readAhead)
+        {
+            // The stream itself is seeked only when data is read from it.
+            TRACE(logInfo() << "Seeking to " << offset << " at " << m_position << std::endl);
+            if (offset < 0 || offset > m_size)
+            {
+                m_eof   = true;
+                m_error = true;
+            }
+            else
+            {
+                m_position = offset;
+            }
+            return;
+        }
+
         TRACE(logInfo() << "Seeking to " << offset << " at " << m_stream->tell() << " ");
+        countSeek();
         if (!m_stream->absoluteSeek(offset))
         {
             TRACE(logInfo() << "FAIL!" << std::endl);
@@ -103,7 +217,7 @@ namespace HEIF
 
     StreamInterface::offset_t InternalStream::tell()
     {
-        return m_stream->tell();
+        return m_readAhead ? m_position : m_stream->tell();
     }
 
     StreamInterface::offset_t InternalStream::size()
@@ -111,6 +225,131 @@ namespace HEIF
         return m_stream->size();
     }
 
+    bool InternalStream::readAt(StreamInterface::offset_t offset, char* buffer, StreamInterface::offset_t size_)
+    {
+        TRACE(logInfo() << "Reading " << size_ << " at " << offset << std::endl);
+        if (m_positionalReads)
+        {
+            StreamInterface::offset_t got = m_stream->readAt(offset, buffer, size_);
+            if (got >= 0)
+            {
+                countRead(got);
+                return got == size_;
+            }
+            m_positionalReads = false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const StreamInterface::offset_t was = m_stream->tell();
+        bool success                        = m_stream->absoluteSeek(offset);
+        StreamInterface::offset_t total     = 0;
+        countSeek();
+        while (success && total < size_)
+        {
+            StreamInterface::offset_t got = m_stream->read(buffer + total, size_ - total);
+            countRead(got);
+            success = got > 0;
+            total += got;
+        }
+        m_stream->absoluteSeek(was);
+        countSeek();
+        return success;
+    }
+
+    StreamInterface::offset_t InternalStream::readFromStream(StreamInterface::offset_t offset,
+                                                             char* buffer,
+                                                             StreamInterface::offset_t size_)
+    {
+        TRACE(logInfo() << "Reading block of " << size_ << " at " << offset << std::endl);
+        StreamInterface::offset_t total = 0;
+        if (m_positionalReads)
+        {
+            while (total < size_)
+            {
+                const StreamInterface::offset_t got = m_stream->readAt(offset + total, buffer + total, size_ - total);
+                if (got < 0 && total == 0)
+                {
+                    m_positionalReads = false;
+                    break;
+                }
+                countRead(got);
+                if (got <= 0)
+                {
+                    return total;
+                }
+                total += got;
+            }
+            if (m_positionalReads)
+            {
+                return total;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_streamPosition != offset)
+        {
+            m_streamPosition = -1;
+            countSeek();
+            if (!m_stream->absoluteSeek(offset))
+            {
+                return 0;
+            }
+        }
+        while (total < size_)
+        {
+            const StreamInterface::offset_t got = m_stream->read(buffer + total, size_ - total);
+            countRead(got);
+            if (got <= 0)
+            {
+                break;
+            }
+            total += got;
+        }
+        m_streamPosition = offset + total;
+        return total;
+    }
+
+    void InternalStream::fillCache()
+    {
+        if (isCached(m_position))
+        {
+            return;
+        }
+        const auto blockSize = static_cast<StreamInterface::offset_t>(m_cache.size());
+        m_cacheOffset        = m_position;
+        m_cacheSize          = readFromStream(m_position, m_cache.data(), blockSize);
+    }
+
+    void InternalStream::countRead(const StreamInterface::offset_t got)
+    {
+        if (ThreadCounters* counters = getThreadCounters())
+        {
+            ++counters->streamReads;
+            if (got > 0)
+            {
+                counters->bytesRead += static_cast<std::uint64_t>(got);
+            }
+        }
+    }
+
+    void InternalStream::countSeek()
+    {
+        if (ThreadCounters* counters = getThreadCounters())
+        {
+            ++counters->streamSeeks;
+        }
+    }
+
+    bool InternalStream::isCached(const StreamInterface::offset_t offset) const
+    {
+        return offset >= m_cacheOffset && offset < m_cacheOffset + m_cacheSize;
+    }
+
+    const char* InternalStream::data()
+    {
+        return m_stream->data();
+    }
+
     void InternalStream::clear()
     {
         m_eof   = false;
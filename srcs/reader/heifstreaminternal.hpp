@@ -14,6 +14,9 @@
 #ifndef HEIFSTREAMINTERNAL_HPP_
 #define HEIFSTREAMINTERNAL_HPP_
 
+#include <atomic>
+#include <mutex>
+
 #include "customallocator.hpp"
 #include "heifstreaminterface.h"
 
@@ -22,7 +25,10 @@ namespace HEIF
     class InternalStream
     {
     public:
-        InternalStream(StreamInterface* stream = nullptr);
+        /** @param [stream]        Stream to read from
+        @param [readAheadSize] Size of the read-ahead block used by read(), get() and peekEof(), or 0 to
+                               pass all reads directly to the stream. */
+        InternalStream(StreamInterface* stream = nullptr, std::uint32_t readAheadSize = 0);
         ~InternalStream() = default;
 
         /** Returns the number of bytes read. A short read sets the EOF flag.
@@ -47,10 +53,23 @@ namespace HEIF
         /// @see StreamInterface::size
         StreamInterface::offset_t size();
 
+        /// @see StreamInterface::data
+        const char* data();
+
+        /** Reads data from the given offset. Does not change the current
+        offset nor the error and eof status, so it can be called
+        concurrently from multiple threads. Streams not supporting
+        positional reads are accessed with seek and read under a lock.
+        @param [offset] Offset to read from
+        @param [buffer] The buffer to write the data into
+        @param [size]   The number of bytes to read from the stream
+        @return Returns true if all requested bytes were read. */
+        bool readAt(StreamInterface::offset_t offset, char* buffer, StreamInterface::offset_t size);
+
         /** Returns false if we can read at least one byte from the
         current position of the file.  In other words, returns true if
         we have reached the end of the file (but before have read
-        it). */
+        it). Streams with a known size are not read. */
         bool peekEof();
 
         /** Returns true if there is no error in the file. End-of-file is
@@ -64,9 +83,41 @@ namespace HEIF
         void clear();
 
     private:
+        /** Reads from the stream at the given offset, using positional
+        reads when supported.
+        @return Returns the number of bytes read. */
+        StreamInterface::offset_t readFromStream(StreamInterface::offset_t offset,
+                                                 char* buffer,
+                                                 StreamInterface::offset_t size);
+
+        /** Reads a read-ahead block starting at the current position to
+        the cache, unless the position is already cached. */
+        void fillCache();
+
+        /// Returns true if the byte at the given offset is in the read-ahead block.
+        bool isCached(StreamInterface::offset_t offset) const;
+
+        /// Counts a read or readAt call of the stream returning got bytes, when statistics are collected.
+        static void countRead(StreamInterface::offset_t got);
+
+        /// Counts an absoluteSeek call of the stream, when statistics are collected.
+        static void countSeek();
+
         StreamInterface* m_stream;
         bool m_error;
         bool m_eof;
+        std::atomic<bool> m_positionalReads;  ///< False after the stream has reported readAt() as unsupported.
+        std::mutex m_mutex;                   ///< Serializes fallback seek and read calls of readAt().
+
+        // Read-ahead state. When enabled, m_position is the current position, and the position of the stream
+        // itself is only tracked in m_streamPosition.
+        bool m_readAhead;                            ///< True if read-ahead is enabled.
+        StreamInterface::offset_t m_size;            ///< Stream size, read once at construction.
+        StreamInterface::offset_t m_position;        ///< Current position of this stream.
+        StreamInterface::offset_t m_streamPosition;  ///< Known position of m_stream, or -1.
+        Vector<char> m_cache;                        ///< Read-ahead block.
+        StreamInterface::offset_t m_cacheOffset;     ///< Stream offset of the first byte of m_cache.
+        StreamInterface::offset_t m_cacheSize;       ///< Number of valid bytes in m_cache.
     };
 }  // namespace HEIF
 
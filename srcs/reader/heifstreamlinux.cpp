@@ -180,6 +180,30 @@ namespace HEIF
         }
     }
 
+    LinuxStream::offset_t LinuxStream::readAt(offset_t offset, char* buffer, offset_t size_)
+    {
+        if (m_handle < 0)
+        {
+            return 0;
+        }
+
+        offset_t total = 0;
+        while (total < size_)
+        {
+            auto n = pread64(m_handle, buffer + total, size_t(size_ - total), offset + total);
+            if (n > 0)
+            {
+                total += n;
+            }
+            else if (!(n < 0 && (errno == EAGAIN || errno == EINTR)))
+            {
+                // Error or end of file
+                break;
+            }
+        }
+        return total;
+    }
+
     LinuxStream::offset_t LinuxStream::tell()
     {
         return m_bufFileOffset + m_bufRead;
@@ -55,6 +55,14 @@ namespace HEIF
         LinuxStream::StreamSize if the file size cannot be determined. */
         offset_t size() override;
 
+        /** Reads data from the given offset without changing the current
+        offset of the file.
+        @param [offset] Offset to read from
+        @param [buffer] The buffer to write the data into
+        @param [size]   The number of bytes to read from the stream
+        @returns The number of bytes read, or 0 on EOF. */
+        offset_t readAt(offset_t offset, char* buffer, offset_t size) override;
+
     private:
         int m_handle;
         offset_t m_size;
@@ -0,0 +1,189 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "heifstreammmap.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN64)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace HEIF
+{
+    MemoryMappedStream::MemoryMappedStream()
+        : m_data(nullptr)
+        , m_curOffset(0)
+        , m_size(0)
+#if defined(_WIN32) || defined(_WIN64)
+        , m_fileHandle(nullptr)
+        , m_mappingHandle(nullptr)
+#endif
+    {
+        // nothing
+    }
+
+#if defined(_WIN32) || defined(_WIN64)
+    MemoryMappedStream::MemoryMappedStream(const char* filename)
+        : MemoryMappedStream()
+    {
+        HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+            static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<unsigned long long>(SIZE_MAX))
+        {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return;
+        }
+
+        m_fileHandle    = file;
+        m_mappingHandle = mapping;
+        m_data          = static_cast<const char*>(view);
+        m_size          = fileSize.QuadPart;
+    }
+
+    MemoryMappedStream::~MemoryMappedStream()
+    {
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mappingHandle)
+        {
+            CloseHandle(m_mappingHandle);
+        }
+        if (m_fileHandle)
+        {
+            CloseHandle(m_fileHandle);
+        }
+    }
+#else
+    MemoryMappedStream::MemoryMappedStream(const char* filename)
+        : MemoryMappedStream()
+    {
+        int handle = open(filename, O_RDONLY);
+        if (handle < 0)
+        {
+            return;
+        }
+
+        struct stat fileStat;
+        if (fstat(handle, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0 ||
+            static_cast<unsigned long long>(fileStat.st_size) > static_cast<unsigned long long>(SIZE_MAX))
+        {
+            close(handle);
+            return;
+        }
+
+        void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, handle, 0);
+        // The mapping stays valid after the descriptor is closed.
+        close(handle);
+        if (mapping == MAP_FAILED)
+        {
+            return;
+        }
+
+        m_data = static_cast<const char*>(mapping);
+        m_size = fileStat.st_size;
+    }
+
+    MemoryMappedStream::~MemoryMappedStream()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<char*>(m_data), static_cast<size_t>(m_size));
+        }
+    }
+#endif
+
+    MemoryMappedStream::offset_t MemoryMappedStream::read(char* buffer, offset_t size_)
+    {
+        const offset_t n = readAt(m_curOffset, buffer, size_);
+        m_curOffset += n;
+        return n;
+    }
+
+    MemoryMappedStream::offset_t MemoryMappedStream::readAt(offset_t offset, char* buffer, offset_t size_)
+    {
+        if (m_data == nullptr || size_ <= 0 || offset < 0 || offset >= m_size)
+        {
+            return 0;
+        }
+
+        const offset_t available = m_size - offset;
+        const offset_t n         = size_ < available ? size_ : available;
+        std::memcpy(buffer, m_data + offset, static_cast<size_t>(n));
+        return n;
+    }
+
+    bool MemoryMappedStream::absoluteSeek(offset_t offset)
+    {
+        if (m_data == nullptr || offset < 0)
+        {
+            return false;
+        }
+        m_curOffset = offset;
+        return true;
+    }
+
+    MemoryMappedStream::offset_t MemoryMappedStream::tell()
+    {
+        return m_curOffset;
+    }
+
+    MemoryMappedStream::offset_t MemoryMappedStream::size()
+    {
+        return m_size;
+    }
+
+    const char* MemoryMappedStream::data()
+    {
+        return m_data;
+    }
+
+    bool MemoryMappedStream::isOpen() const
+    {
+        return m_data != nullptr;
+    }
+}  // namespace HEIF
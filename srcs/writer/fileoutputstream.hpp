@@ -28,7 +28,9 @@ namespace HEIF
     class FileOutputStream : public OutputStreamInterface
     {
     public:
-        FileOutputStream(const char* aFilename);
+        /** @param aFilename  Name of the file.
+         *  @param aUpdate    If true, an existing file is opened for updating instead of creating an empty file. */
+        FileOutputStream(const char* aFilename, bool aUpdate = false);
 
         ~FileOutputStream() override;
 
@@ -42,6 +44,10 @@ namespace HEIF
 
         void remove() override;
 
+        /** Compare data already written to the file with a buffer. The write position is kept.
+         *  @return True if the file has the bytes of aBuf at aPos. */
+        bool compare(std::uint64_t aPos, const void* aBuf, std::uint64_t aCount);
+
         String getFileName() const;
 
     private:
@@ -53,7 +59,7 @@ namespace HEIF
         HANDLE hFile;
         std::uint64_t mPos;
 #else
-        std::ofstream mFile;
+        std::fstream mFile;
 #endif
     };
 }  // namespace HEIF
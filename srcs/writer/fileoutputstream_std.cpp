@@ -11,6 +11,7 @@
  * written consent of Nokia.
  */
 
+#include <cstring>
 #include <fstream>
 
 #include "OutputStreamInterface.h"
@@ -20,9 +21,11 @@
 
 namespace HEIF
 {
-    FileOutputStream::FileOutputStream(const char* aFilename)
+    FileOutputStream::FileOutputStream(const char* aFilename, const bool aUpdate)
         : mFilename(aFilename)
-        , mFile(mFilename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc)
+        , mFile(mFilename.c_str(), aUpdate ? (std::fstream::in | std::fstream::out | std::fstream::binary)
+                                           : (std::fstream::in | std::fstream::out | std::fstream::binary |
+                                              std::fstream::trunc))
     {
     }
 
@@ -67,14 +70,39 @@ namespace HEIF
         }
     }
 
+    bool FileOutputStream::compare(const std::uint64_t aPos, const void* aBuf, const std::uint64_t aCount)
+    {
+        const std::streamoff position = mFile.tellp();
+        mFile.seekg(static_cast<std::streamoff>(aPos));
+
+        const size_t BLOCK_SIZE = 64 * 1024;
+        char block[BLOCK_SIZE];
+        std::uint64_t compared = 0;
+        bool equal             = !mFile.fail();
+        while (equal && compared < aCount)
+        {
+            const std::uint64_t remaining = aCount - compared;
+            const size_t blockSize        = remaining < BLOCK_SIZE ? static_cast<size_t>(remaining) : BLOCK_SIZE;
+            mFile.read(block, static_cast<std::streamsize>(blockSize));
+            equal = mFile.gcount() == static_cast<std::streamsize>(blockSize) &&
+                    std::memcmp(block, static_cast<const char*>(aBuf) + compared, blockSize) == 0;
+            compared += blockSize;
+        }
+
+        // Switching from reading back to writing requires a seek.
+        mFile.clear();
+        mFile.seekp(position);
+        return equal;
+    }
+
     String FileOutputStream::getFileName() const
     {
         return mFilename;
     }
 
-    OutputStreamInterface* ConstructFileStream(const char* aFilename)
+    OutputStreamInterface* ConstructFileStream(const char* aFilename, const bool aUpdate)
     {
-        OutputStreamInterface* aFile = new FileOutputStream(aFilename);
+        OutputStreamInterface* aFile = new FileOutputStream(aFilename, aUpdate);
         if (!static_cast<FileOutputStream*>(aFile)->is_open())
         {
             delete aFile;
@@ -12,6 +12,7 @@
  */
 
 #include <Windows.h>
+#include <cstring>
 
 #include "OutputStreamInterface.h"
 #include "customallocator.hpp"
@@ -19,11 +20,12 @@
 
 namespace HEIF
 {
-    FileOutputStream::FileOutputStream(const char* aFilename)
+    FileOutputStream::FileOutputStream(const char* aFilename, const bool aUpdate)
         : mFilename(aFilename)
     {
         mPos  = 0;
-        hFile = CreateFileA(mFilename.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        hFile = CreateFileA(mFilename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                            aUpdate ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
     }
 
     FileOutputStream::~FileOutputStream()
@@ -50,6 +52,7 @@ namespace HEIF
         LARGE_INTEGER pos;
         pos.QuadPart = aPos;
         SetFilePointerEx(hFile, pos, NULL, FILE_BEGIN);
+        mPos = aPos;
     }
 
     std::uint64_t FileOutputStream::FileOutputStream::tellp()
@@ -74,14 +77,37 @@ namespace HEIF
         }
     }
 
+    bool FileOutputStream::compare(const std::uint64_t aPos, const void* aBuf, const std::uint64_t aCount)
+    {
+        LARGE_INTEGER pos;
+        pos.QuadPart = aPos;
+        bool equal   = SetFilePointerEx(hFile, pos, NULL, FILE_BEGIN) != 0;
+
+        const DWORD BLOCK_SIZE = 64 * 1024;
+        char block[BLOCK_SIZE];
+        std::uint64_t compared = 0;
+        while (equal && compared < aCount)
+        {
+            const std::uint64_t remaining = aCount - compared;
+            const DWORD blockSize         = remaining < BLOCK_SIZE ? static_cast<DWORD>(remaining) : BLOCK_SIZE;
+            DWORD read                    = 0;
+            equal = ReadFile(hFile, block, blockSize, &read, NULL) && read == blockSize &&
+                    std::memcmp(block, static_cast<const char*>(aBuf) + compared, blockSize) == 0;
+            compared += blockSize;
+        }
+
+        seekp(mPos);
+        return equal;
+    }
+
     String FileOutputStream::getFileName() const
     {
         return mFilename;
     }
 
-    OutputStreamInterface* ConstructFileStream(const char* aFilename)
+    OutputStreamInterface* ConstructFileStream(const char* aFilename, const bool aUpdate)
     {
-        OutputStreamInterface* aFile = new FileOutputStream(aFilename);
+        OutputStreamInterface* aFile = new FileOutputStream(aFilename, aUpdate);
         if (!((FileOutputStream*) aFile)->is_open())
         {
             delete aFile;
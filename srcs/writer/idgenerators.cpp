@@ -13,70 +13,155 @@
 
 #include "idgenerators.hpp"
 
-namespace Context
+#include <cstring>
+
+const ContextId ContextIdGenerator::INITIAL_VALUE;
+
+ContextId ContextIdGenerator::getValue()
+{
+    return mValue++;
+}
+
+void ContextIdGenerator::reset()
 {
-    static const int INITIAL_VALUE = 1000;
-    ContextId mValue               = INITIAL_VALUE;
+    mValue = INITIAL_VALUE;
+}
+
+const std::uint32_t TrackIdGenerator::INITIAL_VALUE;
 
-    ContextId getValue()
+TrackIdGenerator::TrackIdGenerator(ContextIdGenerator& contextIds)
+    : mContextIds(contextIds)
+{
+}
+
+HEIF::TrackId TrackIdGenerator::createTrackId()
+{
+    if (mTrackIdValue < ContextIdGenerator::INITIAL_VALUE)
     {
-        return mValue++;
+        return mTrackIdValue++;
     }
-
-    void reset()
+    else
     {
-        mValue = INITIAL_VALUE;
+        mTrackIdValue = mContextIds.getValue();
+        return mTrackIdValue;
     }
-}  // namespace Context
+}
+
+HEIF::AlternateGroupId TrackIdGenerator::createAlternateGroupId()
+{
+    return mAlternateGroupValue++;
+}
 
-namespace Track
+void TrackIdGenerator::reset()
 {
-    static const int INITIAL_VALUE = 1;
-    uint32_t mTrackIdValue         = INITIAL_VALUE;
-    uint16_t mAlternateGroupValue  = INITIAL_VALUE;
+    mTrackIdValue        = INITIAL_VALUE;
+    mAlternateGroupValue = INITIAL_VALUE;
+}
 
-    HEIF::TrackId createTrackId()
+namespace ContentHash
+{
+    namespace
     {
-        if (mTrackIdValue < Context::INITIAL_VALUE)
+        const std::uint64_t PRIME1 = 11400714785074694791ull;
+        const std::uint64_t PRIME2 = 14029467366897019727ull;
+        const std::uint64_t PRIME3 = 1609587929392839161ull;
+        const std::uint64_t PRIME4 = 9650029242287828579ull;
+        const std::uint64_t PRIME5 = 2870177450012600261ull;
+
+        inline std::uint64_t rotateLeft(const std::uint64_t value, const unsigned int bits)
         {
-            return mTrackIdValue++;
+            return (value << bits) | (value >> (64 - bits));
         }
-        else
+
+        inline std::uint64_t read64(const std::uint8_t* data)
         {
-            mTrackIdValue = Context::getValue();
-            return mTrackIdValue;
+            std::uint64_t value;
+            std::memcpy(&value, data, sizeof(value));  // Unaligned load, compiles to a single instruction.
+            return value;
         }
-    }
 
-    HEIF::AlternateGroupId createAlternateGroupId()
-    {
-        return mAlternateGroupValue++;
-    }
+        inline std::uint32_t read32(const std::uint8_t* data)
+        {
+            std::uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
 
-    void reset()
-    {
-        mTrackIdValue        = INITIAL_VALUE;
-        mAlternateGroupValue = INITIAL_VALUE;
-    }
-}  // namespace Track
+        inline std::uint64_t round(std::uint64_t accumulator, const std::uint64_t input)
+        {
+            accumulator += input * PRIME2;
+            accumulator = rotateLeft(accumulator, 31);
+            return accumulator * PRIME1;
+        }
 
-namespace FNVHash
-{
-    // Calculate FNV-1a hash for null-terminated C-string, http://isthe.com/chongo/tech/comp/fnv/
-    uint64_t generate(const uint8_t* aData, uint64_t aSize)
+        inline std::uint64_t mergeRound(std::uint64_t hash, const std::uint64_t lane)
+        {
+            hash ^= round(0, lane);
+            return hash * PRIME1 + PRIME4;
+        }
+    }  // namespace
+
+    std::uint64_t generate(const std::uint8_t* aData, const std::uint64_t aSize, const std::uint64_t aSeed)
     {
-        static uint64_t offset = 2166136261u;
-        static uint64_t prime  = 16777619u;
+        const std::uint8_t* position = aData;
+        const std::uint8_t* end      = aData + aSize;
+        std::uint64_t hash;
+
+        if (aSize >= 32)
+        {
+            std::uint64_t lane1 = aSeed + PRIME1 + PRIME2;
+            std::uint64_t lane2 = aSeed + PRIME2;
+            std::uint64_t lane3 = aSeed;
+            std::uint64_t lane4 = aSeed - PRIME1;
+
+            const std::uint8_t* const stripesEnd = end - 32;
+            do
+            {
+                lane1 = round(lane1, read64(position));
+                lane2 = round(lane2, read64(position + 8));
+                lane3 = round(lane3, read64(position + 16));
+                lane4 = round(lane4, read64(position + 24));
+                position += 32;
+            } while (position <= stripesEnd);
 
-        uint64_t hash  = offset;
-        uint64_t index = 0;
-        while (index < aSize)
+            hash = rotateLeft(lane1, 1) + rotateLeft(lane2, 7) + rotateLeft(lane3, 12) + rotateLeft(lane4, 18);
+            hash = mergeRound(hash, lane1);
+            hash = mergeRound(hash, lane2);
+            hash = mergeRound(hash, lane3);
+            hash = mergeRound(hash, lane4);
+        }
+        else
+        {
+            hash = aSeed + PRIME5;
+        }
+
+        hash += aSize;
+
+        while (position + 8 <= end)
+        {
+            hash ^= round(0, read64(position));
+            hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+            position += 8;
+        }
+        if (position + 4 <= end)
+        {
+            hash ^= static_cast<std::uint64_t>(read32(position)) * PRIME1;
+            hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+            position += 4;
+        }
+        while (position < end)
         {
-            hash ^= static_cast<uint64_t>(aData[index]);
-            hash *= prime;
-            index++;
+            hash ^= static_cast<std::uint64_t>(*position) * PRIME5;
+            hash = rotateLeft(hash, 11) * PRIME1;
+            ++position;
         }
 
+        // Final avalanche
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
         return hash;
     }
-}  // namespace FNVHash
+}  // namespace ContentHash
@@ -20,18 +20,36 @@
 #include "writerdatatypesinternal.hpp"
 
 typedef std::uint32_t ContextId;
-namespace Context
+
+/**
+ * @brief Generator of context IDs (item, sequence, sample, group and decoder configuration IDs) of one writer.
+ * @details Each writer has its own generator, so writers running concurrently do not share ID value spaces. */
+class ContextIdGenerator
 {
+public:
+    static const ContextId INITIAL_VALUE = 1000;
+
+    ContextIdGenerator() = default;
+
     /** @brief Generate a context ID.
      * @return A new context ID. It will be unique, unless reset() has been called. */
     ContextId getValue();
 
     /** Reset ContextId value space. */
     void reset();
-}  // namespace Context
 
-namespace Track
+private:
+    ContextId mValue = INITIAL_VALUE;
+};
+
+/**
+ * @brief Generator of track and alternate group IDs of one writer.
+ * @details Track IDs above ContextIdGenerator::INITIAL_VALUE are taken from the context ID value space. */
+class TrackIdGenerator
 {
+public:
+    explicit TrackIdGenerator(ContextIdGenerator& contextIds);
+
     /** @brief Generate a track ID.
      * @return A new track ID. It will be unique, unless reset() has been called. */
     HEIF::TrackId createTrackId();
@@ -40,14 +58,29 @@ namespace Track
      * @return A new alternate group ID. It will be unique, unless reset() has been called. */
     HEIF::AlternateGroupId createAlternateGroupId();
 
-    /** Reset ContextId value space. */
+    /** Reset TrackId and AlternateGroupId value spaces. */
     void reset();
-}  // namespace Track
 
-namespace FNVHash
+private:
+    static const std::uint32_t INITIAL_VALUE = 1;
+
+    ContextIdGenerator& mContextIds;
+    std::uint32_t mTrackIdValue        = INITIAL_VALUE;
+    std::uint16_t mAlternateGroupValue = INITIAL_VALUE;
+};
+
+namespace ContentHash
 {
-    std::uint64_t generate(const uint8_t* aData, uint64_t aSize);
-}
+    /** @brief Calculate a 64-bit content hash of a buffer (xxHash64 algorithm).
+     * @details Input is consumed 32 bytes at a time in four independent 64-bit lanes, so the hash runs close to
+     * memory bandwidth on large buffers. The hash is used only within one process, so no byte order conversion is
+     * done for the input words.
+     * @param [in] aData Data to hash.
+     * @param [in] aSize Size of the data in bytes.
+     * @param [in] aSeed Seed value, different seeds give independent hash values.
+     * @return Hash value. */
+    std::uint64_t generate(const std::uint8_t* aData, std::uint64_t aSize, std::uint64_t aSeed = 0);
+}  // namespace ContentHash
 
 
 #endif /* end of include guard: IDGENERATORS_HPP */
@@ -0,0 +1,140 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "mediadataspillfile.hpp"
+
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define HEIF_FSEEK _fseeki64
+typedef __int64 FileOffset;
+#else
+#include <sys/types.h>
+#define HEIF_FSEEK fseeko
+typedef off_t FileOffset;
+#endif
+
+namespace HEIF
+{
+    MediaDataSpillFile::~MediaDataSpillFile()
+    {
+        close();
+    }
+
+    bool MediaDataSpillFile::open(const char* fileName)
+    {
+        close();
+        if (fileName && fileName[0] != 0)
+        {
+#if defined(_WIN32) || defined(_WIN64)
+            fopen_s(&mFile, fileName, "w+b");
+#else
+            mFile = std::fopen(fileName, "w+b");
+#endif
+            if (mFile)
+            {
+                mFileName = fileName;
+            }
+        }
+        else
+        {
+            // Anonymous temporary file is removed automatically when closed.
+            mFile = std::tmpfile();
+        }
+        return mFile != nullptr;
+    }
+
+    bool MediaDataSpillFile::isOpen() const
+    {
+        return mFile != nullptr;
+    }
+
+    bool MediaDataSpillFile::append(const std::uint8_t* data, const std::uint64_t size)
+    {
+        if (!mFile)
+        {
+            return false;
+        }
+        const size_t written = std::fwrite(data, 1, static_cast<size_t>(size), mFile);
+        mSize += written;
+        return written == size;
+    }
+
+    std::uint64_t MediaDataSpillFile::getSize() const
+    {
+        return mSize;
+    }
+
+    bool MediaDataSpillFile::compare(const std::uint64_t offset, const std::uint8_t* data, const std::uint64_t size)
+    {
+        if (!mFile || offset + size > mSize || HEIF_FSEEK(mFile, static_cast<FileOffset>(offset), SEEK_SET) != 0)
+        {
+            return false;
+        }
+
+        const size_t BLOCK_SIZE = 64 * 1024;
+        std::uint8_t block[BLOCK_SIZE];
+        std::uint64_t compared = 0;
+        bool equal             = true;
+        while (equal && compared < size)
+        {
+            const std::uint64_t remaining = size - compared;
+            const size_t blockSize        = remaining < BLOCK_SIZE ? static_cast<size_t>(remaining) : BLOCK_SIZE;
+            equal = std::fread(block, 1, blockSize, mFile) == blockSize &&
+                    std::memcmp(block, data + compared, blockSize) == 0;
+            compared += blockSize;
+        }
+
+        // Switching from reading back to appending requires a seek.
+        return HEIF_FSEEK(mFile, 0, SEEK_END) == 0 && equal;
+    }
+
+    bool MediaDataSpillFile::copyTo(OutputStreamInterface* output)
+    {
+        if (!mFile || std::fflush(mFile) != 0)
+        {
+            return false;
+        }
+        std::rewind(mFile);
+
+        const size_t BLOCK_SIZE = 1 << 20;
+        Vector<std::uint8_t> block(BLOCK_SIZE);
+        std::uint64_t remaining = mSize;
+        while (remaining)
+        {
+            const size_t blockSize = remaining < BLOCK_SIZE ? static_cast<size_t>(remaining) : BLOCK_SIZE;
+            if (std::fread(block.data(), 1, blockSize, mFile) != blockSize)
+            {
+                return false;
+            }
+            output->write(block.data(), static_cast<std::uint64_t>(blockSize));
+            remaining -= blockSize;
+        }
+        return true;
+    }
+
+    void MediaDataSpillFile::close()
+    {
+        if (mFile)
+        {
+            std::fclose(mFile);
+            mFile = nullptr;
+        }
+        if (!mFileName.empty())
+        {
+            std::remove(mFileName.c_str());
+            mFileName.clear();
+        }
+        mSize = 0;
+    }
+}  // namespace HEIF
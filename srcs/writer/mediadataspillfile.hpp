@@ -0,0 +1,77 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef MEDIADATASPILLFILE_HPP
+#define MEDIADATASPILLFILE_HPP
+
+#include <cstdint>
+#include <cstdio>
+
+#include "OutputStreamInterface.h"
+#include "customallocator.hpp"
+
+namespace HEIF
+{
+    /**
+     * @brief Temporary file holding 'mdat' payload of a progressive file until it is copied after 'meta' and 'moov'.
+     * @details Media data is appended sequentially and read back once from the beginning, so peak memory use of the
+     * writer does not depend on the amount of fed media data. */
+    class MediaDataSpillFile
+    {
+    public:
+        MediaDataSpillFile() = default;
+        ~MediaDataSpillFile();
+
+        /** @brief Open the spill file.
+         *  @param [in] fileName Name of the file to create, or nullptr/empty for an anonymous temporary file.
+         *  @return True if the file was opened. */
+        bool open(const char* fileName);
+
+        /** @return True if the spill file is open. */
+        bool isOpen() const;
+
+        /** @brief Append media data to the end of the spill file.
+         *  @param [in] data Media data to append.
+         *  @param [in] size Size of the media data in bytes.
+         *  @return True if all data was written. */
+        bool append(const std::uint8_t* data, std::uint64_t size);
+
+        /** @return Total size of media data appended to the spill file in bytes. */
+        std::uint64_t getSize() const;
+
+        /** @brief Compare spilled media data with a buffer.
+         *  @param [in] offset Offset of the spilled media data in the spill file.
+         *  @param [in] data Buffer to compare with.
+         *  @param [in] size Size of the buffer in bytes.
+         *  @return True if spilled data at offset equals the buffer. */
+        bool compare(std::uint64_t offset, const std::uint8_t* data, std::uint64_t size);
+
+        /** @brief Copy all spilled media data to the output in sequential blocks.
+         *  @param [in] output Stream to write the media data to.
+         *  @return True if all data was read back and written. */
+        bool copyTo(OutputStreamInterface* output);
+
+        /** @brief Close the spill file and remove it from the file system. */
+        void close();
+
+    private:
+        MediaDataSpillFile(const MediaDataSpillFile&) = delete;
+        MediaDataSpillFile& operator=(const MediaDataSpillFile&) = delete;
+
+        std::FILE* mFile    = nullptr;  ///< Spill file handle, nullptr if not open.
+        String mFileName;               ///< Name of a named spill file, empty for an anonymous temporary file.
+        std::uint64_t mSize = 0;        ///< Bytes appended to the spill file.
+    };
+}  // namespace HEIF
+
+#endif /* end of include guard: MEDIADATASPILLFILE_HPP */
@@ -0,0 +1,62 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include "statisticsoutputstream.hpp"
+
+#include "statistics.hpp"
+
+namespace HEIF
+{
+    StatisticsOutputStream::StatisticsOutputStream(OutputStreamInterface* stream, const bool ownsStream)
+        : mStream(stream)
+        , mOwnsStream(ownsStream)
+    {
+    }
+
+    StatisticsOutputStream::~StatisticsOutputStream()
+    {
+        if (mOwnsStream)
+        {
+            delete mStream;
+        }
+    }
+
+    void StatisticsOutputStream::seekp(const std::uint64_t aPos)
+    {
+        if (ThreadCounters* counters = getThreadCounters())
+        {
+            ++counters->streamSeeks;
+        }
+        mStream->seekp(aPos);
+    }
+
+    std::uint64_t StatisticsOutputStream::tellp()
+    {
+        return mStream->tellp();
+    }
+
+    void StatisticsOutputStream::write(const void* aBuf, const std::uint64_t aCount)
+    {
+        if (ThreadCounters* counters = getThreadCounters())
+        {
+            ++counters->streamWrites;
+            counters->bytesWritten += aCount;
+        }
+        mStream->write(aBuf, aCount);
+    }
+
+    void StatisticsOutputStream::remove()
+    {
+        mStream->remove();
+    }
+}  // namespace HEIF
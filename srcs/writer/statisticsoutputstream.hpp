@@ -0,0 +1,46 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#ifndef STATISTICSOUTPUTSTREAM_HPP
+#define STATISTICSOUTPUTSTREAM_HPP
+
+#include "OutputStreamInterface.h"
+
+namespace HEIF
+{
+    /** Output stream which forwards all calls to another stream, and counts write and seek calls to the thread
+     * counters of statistics. Used only when the writer collects statistics. */
+    class StatisticsOutputStream : public OutputStreamInterface
+    {
+    public:
+        /** @param [in] stream     Stream to forward the calls to.
+         *  @param [in] ownsStream True if stream is deleted together with this stream. */
+        StatisticsOutputStream(OutputStreamInterface* stream, bool ownsStream);
+
+        ~StatisticsOutputStream() override;
+
+        void seekp(std::uint64_t aPos) override;
+
+        std::uint64_t tellp() override;
+
+        void write(const void* aBuf, std::uint64_t aCount) override;
+
+        void remove() override;
+
+    private:
+        OutputStreamInterface* mStream;
+        bool mOwnsStream;
+    };
+}  // namespace HEIF
+
+#endif
@@ -32,6 +32,8 @@ namespace HEIF
         uint64_t offset;  ///< Data offset. When mdat is after ftyp this is fileoffset. When mdat is lcoated after moov
                           ///< this is offset from mdat start.
         size_t size;
+        const Vector<uint8_t>* data;  ///< Data held in memory until finalize(), or a copy kept for deduplication.
+        uint64_t spillOffset;         ///< Offset of the data in the spill file, if spilled.
     };
 
     struct Dimensions
@@ -82,6 +84,7 @@ namespace HEIF
             Set<MetadataItemId> metadataItemsIds;
         };
         Vector<Sample> samples;
+        uint32_t fragmentedSampleCount;  ///< Number of samples already written to movie fragments
         Vector<DecoderConfigId> decoderConfigs;
         bool anyNonSyncSample;
         CodingConstraints codingConstraints;  // for image sequences.
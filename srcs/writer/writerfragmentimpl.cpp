@@ -0,0 +1,321 @@
+/* This file is part of Nokia HEIF library
+ *
+ * Copyright (c) 2015-2025 Nokia Corporation and/or its subsidiary(-ies). All rights reserved.
+ *
+ * Contact: heif@nokia.com
+ *
+ * This software, including documentation, is protected by copyright controlled by Nokia Corporation and/ or its
+ * subsidiaries. All rights are reserved.
+ *
+ * Copying, including reproducing, storing, adapting or translating, any or all of this material requires the prior
+ * written consent of Nokia.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "customallocator.hpp"
+#include "movieextendsbox.hpp"
+#include "moviefragmentbox.hpp"
+#include "segmentindexbox.hpp"
+#include "trackextendsbox.hpp"
+#include "trackfragmentbasemediadecodetimebox.hpp"
+#include "trackfragmentbox.hpp"
+#include "trackfragmentheaderbox.hpp"
+#include "trackrunbox.hpp"
+#include "writerimpl.hpp"
+
+using namespace std;
+
+namespace HEIF
+{
+    namespace
+    {
+        void writeBitstream(BitStream& input, OutputStreamInterface* output)
+        {
+            const Vector<uint8_t>& data = input.getStorage();
+            output->write(data.data(), static_cast<uint64_t>(data.size()));
+        }
+    }  // namespace
+
+    /* *************************************************************** */
+    /* *********************** private methods *********************** */
+    /* *************************************************************** */
+    bool WriterImpl::isFragmentDue(const ImageSequence& sequence) const
+    {
+        if (sequence.samples.empty())
+        {
+            return false;
+        }
+
+        if (mFragmentSampleCount && sequence.samples.size() >= mFragmentSampleCount)
+        {
+            return true;
+        }
+        if (mFragmentDuration)
+        {
+            // Sample times are in sequence.timeBase.den units.
+            const uint64_t fragmentDuration = sequence.duration - sequence.samples.front().dts;
+            return fragmentDuration * 1000 >= static_cast<uint64_t>(mFragmentDuration) * sequence.timeBase.den;
+        }
+        return false;
+    }
+
+    ErrorCode WriterImpl::writeInitSegment()
+    {
+        if ((mFileTypeBox.getMajorBrand() == 0) || (mFileTypeBox.getCompatibleBrands().size() == 0))
+        {
+            return ErrorCode::BRANDS_NOT_SET;
+        }
+
+        ErrorCode error = generateMoovBox();
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        // Movie Extends Box 'mvex' tells that the movie continues in movie fragments.
+        UniquePtr<MovieExtendsBox> movieExtendsBox = makeCustomUnique<MovieExtendsBox, MovieExtendsBox>();
+        for (const auto& imageSequence : mImageSequences)
+        {
+            MOVIEFRAGMENTS::SampleDefaults sampleDefaults{};
+            sampleDefaults.trackId                       = imageSequence.second.trackId.get();
+            sampleDefaults.defaultSampleDescriptionIndex = 1;
+
+            UniquePtr<TrackExtendsBox> trackExtendsBox = makeCustomUnique<TrackExtendsBox, TrackExtendsBox>();
+            trackExtendsBox->setFragmentSampleDefaults(sampleDefaults);
+            movieExtendsBox->addTrackExtendsBox(std::move(trackExtendsBox));
+        }
+        mMovieBox.addMovieExtendsBox(std::move(movieExtendsBox));
+
+        BitStream output;
+        mFileTypeBox.writeBox(output);
+        if (!mExtendedTypeBox.getTypeCombinationBoxes().empty())
+        {
+            mExtendedTypeBox.writeBox(output);
+        }
+        mMovieBox.writeBox(output);
+        writeBitstream(output, mFile);
+
+        mInitSegmentWritten = true;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode WriterImpl::writeFragment()
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "write fragment", StatisticsScope::Kind::PHASE);
+        if (!mInitSegmentWritten)
+        {
+            ErrorCode error = writeInitSegment();
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+        }
+
+        Vector<MOVIEFRAGMENTS::SampleDefaults> sampleDefaults;
+        MovieFragmentBox moof(sampleDefaults);
+        moof.getMovieFragmentHeaderBox().setSequenceNumber(mFragmentSequenceNumber + 1);
+
+        Vector<TrackRunBox*> trackRuns;
+        Vector<uint64_t> trackRunOffsets;  // Offsets of track run data from the start of 'mdat' payload.
+        Vector<MediaDataId> sampleDataIds;  // Sample data in 'mdat' payload order.
+        uint64_t payloadSize                   = 0;
+        const ImageSequence* referenceSequence = nullptr;
+
+        for (const auto& imageSequence : mImageSequences)
+        {
+            const ImageSequence& sequence = imageSequence.second;
+            if (sequence.samples.empty())
+            {
+                continue;
+            }
+            if (referenceSequence == nullptr)
+            {
+                referenceSequence = &sequence;
+            }
+
+            // One track fragment for each run of samples sharing a sample description.
+            auto sample = sequence.samples.cbegin();
+            while (sample != sequence.samples.cend())
+            {
+                const uint32_t decoderConfigIndex = sample->decoderConfigIndex;
+                const auto runEnd =
+                    std::find_if(sample, sequence.samples.cend(), [&](const ImageSequence::Sample& runSample) {
+                        return runSample.decoderConfigIndex != decoderConfigIndex;
+                    });
+
+                bool negativeOffsets    = false;
+                bool compositionOffsets = false;
+                for (auto runSample = sample; runSample != runEnd; ++runSample)
+                {
+                    negativeOffsets |= runSample->isHidden || runSample->compositionOffset < 0;
+                    compositionOffsets |= runSample->isHidden || runSample->compositionOffset != 0;
+                }
+
+                UniquePtr<TrackFragmentBox> traf(CUSTOM_NEW(TrackFragmentBox, (sampleDefaults)));
+                TrackFragmentHeaderBox& tfhd = traf->getTrackFragmentHeaderBox();
+                tfhd.setFlags(TrackFragmentHeaderBox::DefaultBaseIsMoof |
+                              TrackFragmentHeaderBox::SampleDescriptionIndexPresent);
+                tfhd.setTrackId(sequence.trackId.get());
+                tfhd.setSampleDescriptionIndex(decoderConfigIndex);
+
+                UniquePtr<TrackFragmentBaseMediaDecodeTimeBox> tfdt =
+                    makeCustomUnique<TrackFragmentBaseMediaDecodeTimeBox, TrackFragmentBaseMediaDecodeTimeBox>();
+                tfdt->setVersion(1);
+                tfdt->setBaseMediaDecodeTime(sample->dts);
+                traf->setTrackFragmentDecodeTimeBox(std::move(tfdt));
+
+                std::uint32_t trunFlags = TrackRunBox::DataOffsetPresent | TrackRunBox::SampleDurationPresent |
+                                          TrackRunBox::SampleSizePresent | TrackRunBox::SampleFlagsPresent;
+                if (compositionOffsets)
+                {
+                    trunFlags |= TrackRunBox::SampleCompositionTimeOffsetsPresent;
+                }
+                UniquePtr<TrackRunBox> trun(CUSTOM_NEW(TrackRunBox, (negativeOffsets ? 1 : 0, trunFlags)));
+                trackRunOffsets.push_back(payloadSize);
+
+                uint32_t sampleCount = 0;
+                for (; sample != runEnd; ++sample)
+                {
+                    const MediaData& sampleData = mMediaData.at(sample->mediaDataId);
+
+                    TrackRunBox::SampleDetails details{};
+                    details.version0.sampleDuration = sample->sampleDuration;
+                    details.version0.sampleSize     = static_cast<uint32_t>(sampleData.size);
+                    // sample_depends_on: 2 = does not depend on others (I picture), 1 = depends on others.
+                    details.version0.sampleFlags.flags.sample_depends_on         = sample->isSyncSample ? 2 : 1;
+                    details.version0.sampleFlags.flags.sample_is_non_sync_sample = sample->isSyncSample ? 0 : 1;
+                    if (sample->isHidden)
+                    {
+                        details.version1.sampleCompositionTimeOffset = std::numeric_limits<std::int32_t>::min();
+                    }
+                    else if (negativeOffsets)
+                    {
+                        if ((sample->compositionOffset < std::numeric_limits<std::int32_t>::min()) ||
+                            (sample->compositionOffset > std::numeric_limits<std::int32_t>::max()))
+                        {
+                            return ErrorCode::INVALID_FUNCTION_PARAMETER;
+                        }
+                        details.version1.sampleCompositionTimeOffset = static_cast<int32_t>(sample->compositionOffset);
+                    }
+                    else
+                    {
+                        if (sample->compositionOffset > std::numeric_limits<std::uint32_t>::max())
+                        {
+                            return ErrorCode::INVALID_FUNCTION_PARAMETER;
+                        }
+                        details.version0.sampleCompositionTimeOffset = static_cast<uint32_t>(sample->compositionOffset);
+                    }
+                    trun->addSampleDetails(details);
+
+                    sampleDataIds.push_back(sample->mediaDataId);
+                    payloadSize += sampleData.size;
+                    ++sampleCount;
+                }
+                trun->setSampleCount(sampleCount);
+
+                trackRuns.push_back(trun.get());
+                traf->addTrackRunBox(std::move(trun));
+                moof.addTrackFragmentBox(std::move(traf));
+            }
+        }
+
+        if (referenceSequence == nullptr)
+        {
+            return ErrorCode::OK;
+        }
+
+        // Data offsets are relative to the first byte of 'moof', and they do not change the size of 'moof' as
+        // DataOffsetPresent flag is already set.
+        BitStream moofBitstr;
+        moof.writeBox(moofBitstr);
+        const uint64_t moofSize       = moofBitstr.getSize();
+        const bool largeMdat          = payloadSize + 8 > std::numeric_limits<std::uint32_t>::max();
+        const uint64_t mdatHeaderSize = largeMdat ? 16 : 8;
+        if (moofSize + mdatHeaderSize + payloadSize > static_cast<uint64_t>(std::numeric_limits<std::int32_t>::max()))
+        {
+            return ErrorCode::INVALID_FUNCTION_PARAMETER;
+        }
+        for (size_t i = 0; i < trackRuns.size(); ++i)
+        {
+            trackRuns.at(i)->setDataOffset(static_cast<int32_t>(moofSize + mdatHeaderSize + trackRunOffsets.at(i)));
+        }
+
+        BitStream output;
+        if (mFragmentSegmentIndex)
+        {
+            // Index the whole fragment as one subsegment of the first track in it.
+            const ImageSequence& sequence = *referenceSequence;
+            uint64_t earliestPresentation = std::numeric_limits<std::uint64_t>::max();
+            uint64_t subsegmentDuration   = 0;
+            for (const auto& sample : sequence.samples)
+            {
+                if (!sample.isHidden)
+                {
+                    const int64_t presentationTime = static_cast<int64_t>(sample.dts) + sample.compositionOffset;
+                    earliestPresentation =
+                        std::min(earliestPresentation, static_cast<uint64_t>(std::max(presentationTime, int64_t(0))));
+                }
+                subsegmentDuration += sample.sampleDuration;
+            }
+            if (earliestPresentation == std::numeric_limits<std::uint64_t>::max())
+            {
+                earliestPresentation = sequence.samples.front().dts;
+            }
+
+            SegmentIndexBox sidx(1);
+            sidx.setReferenceId(sequence.trackId.get());
+            sidx.setTimescale(static_cast<uint32_t>(sequence.timeBase.den));
+            sidx.setEarliestPresentationTime(earliestPresentation);
+            sidx.setFirstOffset(0);
+
+            SegmentIndexBox::Reference reference{};
+            reference.referenceType      = false;
+            reference.referencedSize     = static_cast<uint32_t>(moofSize + mdatHeaderSize + payloadSize);
+            reference.subsegmentDuration = static_cast<uint32_t>(subsegmentDuration);
+            reference.startsWithSAP      = sequence.samples.front().isSyncSample;
+            reference.sapType            = reference.startsWithSAP ? 1 : 0;
+            reference.sapDeltaTime       = 0;
+            sidx.addReference(reference);
+            sidx.writeBox(output);
+        }
+
+        moof.writeBox(output);
+        if (largeMdat)
+        {
+            output.write32Bits(1);  // size field, value 1 implies using largesize field instead.
+            output.write32Bits(FourCCInt("mdat").getUInt32());
+            output.write64Bits(mdatHeaderSize + payloadSize);
+        }
+        else
+        {
+            output.write32Bits(static_cast<uint32_t>(mdatHeaderSize + payloadSize));
+            output.write32Bits(FourCCInt("mdat").getUInt32());
+        }
+        writeBitstream(output, mFile);
+
+        for (const auto& mediaDataId : sampleDataIds)
+        {
+            const Vector<uint8_t>& data = mFragmentMediaData.at(mediaDataId);
+            mFile->write(data.data(), static_cast<uint64_t>(data.size()));
+        }
+
+        // Release written samples and their data, only sample counts and durations are needed for later fragments.
+        ++mFragmentSequenceNumber;
+        for (auto& imageSequence : mImageSequences)
+        {
+            ImageSequence& sequence = imageSequence.second;
+            sequence.fragmentedSampleCount += static_cast<uint32_t>(sequence.samples.size());
+            sequence.samples.clear();
+        }
+        for (const auto& mediaDataId : sampleDataIds)
+        {
+            mMediaData.erase(mediaDataId);
+            mFragmentMediaData.erase(mediaDataId);
+        }
+
+        return ErrorCode::OK;
+    }
+
+}  // namespace HEIF
@@ -13,13 +13,16 @@
 
 #include "writerimpl.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <limits>
 
 #include "buildinfo.hpp"
 #include "customallocator.hpp"
+#include "fileoutputstream.hpp"
 #include "jpegparser.hpp"
+#include "statisticsoutputstream.hpp"
 
 using namespace std;
 
@@ -49,6 +52,14 @@ namespace HEIF
             const Vector<uint8_t>& data = input.getStorage();
             output->write(data.data(), static_cast<uint64_t>(data.size()));
         }
+
+        /** File offsets in the boxes are computed from box sizes given by getSerializedSize(), so a box serialized to
+         * another size would point to wrong data. Checked before the box is written to the output. */
+        ErrorCode checkSerializedSize(const BitStream& box, const uint64_t serializedSize)
+        {
+            assert(box.getSize() == serializedSize);
+            return (box.getSize() == serializedSize) ? ErrorCode::OK : ErrorCode::FILE_HEADER_ERROR;
+        }
     }  // namespace
 
     HEIF_DLL_PUBLIC ErrorCode Writer::SetCustomAllocator(CustomAllocator* customAllocator)
@@ -80,9 +91,12 @@ namespace HEIF
 
     WriterImpl::WriterImpl()
         : mState(State::UNINITIALIZED)
+        , mContextIds()
+        , mTrackIds(mContextIds)
         , mAllDecoderConfigs()
         , mMediaData()
         , mMediaDataHashes()
+        , mRetainedMediaData()
         , mImageSequences()
         , mImageCollection()
         , mEntityGroups()
@@ -110,12 +124,17 @@ namespace HEIF
 
     void WriterImpl::clear()
     {
-        Context::reset();
-        Track::reset();
+        mContextIds.reset();
+        mTrackIds.reset();
 
         mAllDecoderConfigs.clear();
         mMediaData.clear();
         mMediaDataHashes.clear();
+        mRetainedMediaData.clear();
+        mRetainedMediaDataSize  = 0;
+        mRetainedMediaDataLimit = 0;
+        mDeduplicateMediaData   = true;
+        mMediaDataStatistics    = {};
         mImageSequences.clear();
         mImageCollection = {};
         mEntityGroups.clear();
@@ -133,19 +152,45 @@ namespace HEIF
         mMetaBox         = {};
         mMediaDataBox    = {};
         mMovieBox.clear();
+        mSpillFile.close();
 
-        mMdatOffset     = 0;
         mInitialMdat    = false;
         mPrimaryItemSet = false;
 
         mPredRrefPropertyId = 0;
 
+        mFragmented             = false;
+        mInitSegmentWritten     = false;
+        mFragmentSegmentIndex   = false;
+        mFragmentSampleCount    = 0;
+        mFragmentDuration       = 0;
+        mFragmentSequenceNumber = 0;
+        mFragmentMediaData.clear();
+
         if (mState == State::WRITING)
         {
-            mFile->remove();
+            if (mUpdateFile)
+            {
+                // The existing file stays valid with its old 'meta' box, once appended media data is a complete box.
+                if (mMdatOffset != 0)
+                {
+                    finalizeMdatBox();
+                }
+            }
+            else
+            {
+                mFile->remove();
+            }
             delete mFile;
             mFile = nullptr;
         }
+        mOutputFile = nullptr;
+
+        mMdatOffset       = 0;
+        mUpdateFile       = false;
+        mUpdateMetaOffset = 0;
+        mUpdateMetaSpace  = 0;
+        mUpdateFileSize   = 0;
 
         mState = State::UNINITIALIZED;
     }
@@ -158,12 +203,46 @@ namespace HEIF
         }
 
         clear();
-        Context::reset();
-        Track::reset();
+        mContextIds.reset();
+        mTrackIds.reset();
+
+        mStatistics.reset(createStatisticsCollector(outputConfig.collectStatistics));
+        StatisticsScope statisticsScope(mStatistics.get(), "initialize");
 
-        if (outputConfig.progressiveFile)
+        if (outputConfig.updateFile)
+        {
+            if ((outputConfig.updateMetaSpace == 0) ||
+                (outputConfig.updateMetaOffset > outputConfig.updateFileSize) ||
+                (outputConfig.updateMetaSpace > outputConfig.updateFileSize - outputConfig.updateMetaOffset))
+            {
+                return ErrorCode::INVALID_FUNCTION_PARAMETER;
+            }
+            // 'ftyp' of the updated file is kept, so brands are treated as already written.
+            mInitialMdat      = true;
+            mUpdateFile       = true;
+            mUpdateMetaOffset = outputConfig.updateMetaOffset;
+            mUpdateMetaSpace  = outputConfig.updateMetaSpace;
+            mUpdateFileSize   = outputConfig.updateFileSize;
+        }
+        else if (outputConfig.fragmentedFile)
+        {
+            if ((outputConfig.fragmentSampleCount == 0) && (outputConfig.fragmentDuration == 0))
+            {
+                return ErrorCode::INVALID_FUNCTION_PARAMETER;
+            }
+            mInitialMdat          = false;
+            mFragmented           = true;
+            mFragmentSampleCount  = outputConfig.fragmentSampleCount;
+            mFragmentDuration     = outputConfig.fragmentDuration;
+            mFragmentSegmentIndex = outputConfig.fragmentSegmentIndex;
+        }
+        else if (outputConfig.progressiveFile)
         {
             mInitialMdat = false;
+            if (outputConfig.spillMediaData && !mSpillFile.open(outputConfig.spillFileName))
+            {
+                return ErrorCode::FILE_OPEN_ERROR;
+            }
         }
         else
         {
@@ -175,6 +254,8 @@ namespace HEIF
         }
 
         mWriteItemCreationTimes = outputConfig.itemCreationTimes;
+        mDeduplicateMediaData   = outputConfig.deduplicateMediaData;
+        mRetainedMediaDataLimit = outputConfig.deduplicationMemoryLimit;
 
         mFile = nullptr;
         if (outputConfig.outputStream)
@@ -184,13 +265,20 @@ namespace HEIF
         }
         else if ((outputConfig.fileName) && (outputConfig.fileName[0] != 0))
         {
-            mFile             = ConstructFileStream(outputConfig.fileName);
+            mFile             = ConstructFileStream(outputConfig.fileName, mUpdateFile);
+            mOutputFile       = static_cast<FileOutputStream*>(mFile);
             mOwnsOutputHandle = true;
         }
         if (mFile == nullptr)
         {
             return ErrorCode::FILE_OPEN_ERROR;
         }
+        if (mStatistics)
+        {
+            // Output stream calls are counted by a forwarding stream, which takes over the ownership of the output.
+            mFile             = new StatisticsOutputStream(mFile, mOwnsOutputHandle);
+            mOwnsOutputHandle = true;
+        }
 
         for (const auto& brand : outputConfig.compatibleBrands)
         {
@@ -213,7 +301,7 @@ namespace HEIF
             mFileTypeBox.addCompatibleBrand(outputConfig.majorBrand.value);
         }
 
-        if (mInitialMdat)
+        if (mInitialMdat && !mUpdateFile)
         {
             BitStream output;
             mFileTypeBox.writeBox(output);
@@ -222,15 +310,7 @@ namespace HEIF
                 mExtendedTypeBox.writeBox(output);
             }
             writeBitstream(output, mFile);
-
-            // Write Media Data Box 'mdat' header. We can not know input data size, so use 64-bit large size field for
-            // the box.
-            mMdatOffset = static_cast<uint64_t>(mFile->tellp());
-            output.clear();
-            output.write32Bits(1);  // size field, value 1 implies using largesize field instead.
-            output.write32Bits(FourCCInt("mdat").getUInt32());  // boxtype field
-            output.write64Bits(0);                              // largesize field
-            writeBitstream(output, mFile);
+            writeMdatHeader();
         }
 
         mState = State::WRITING;
@@ -239,19 +319,21 @@ namespace HEIF
 
     ErrorCode WriterImpl::feedDecoderConfig(const Array<DecoderSpecificInfo>& config, DecoderConfigId& decoderConfigId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "feedDecoderConfig");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
         /// @todo Check parameter set integrity?
-        decoderConfigId                     = Context::getValue();
+        decoderConfigId                     = mContextIds.getValue();
         mAllDecoderConfigs[decoderConfigId] = config;
         return ErrorCode::OK;
     }
 
     ErrorCode WriterImpl::feedMediaData(const Data& aData, MediaDataId& aMediaDataId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "feedMediaData");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -266,6 +348,70 @@ namespace HEIF
         return storeFedMediaData(aData, aMediaDataId);
     }
 
+    ErrorCode WriterImpl::feedExistingMediaData(const Data& aData,
+                                                const std::uint64_t aOffset,
+                                                MediaDataId& aMediaDataId)
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "feedExistingMediaData");
+        if (mState != State::WRITING)
+        {
+            return ErrorCode::UNINITIALIZED;
+        }
+        if (!mUpdateFile)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+        if ((aData.size == 0) || (aOffset > mUpdateFileSize) || (aData.size > mUpdateFileSize - aOffset) ||
+            ((aData.mediaFormat == MediaFormat::JPEG) && (aData.data == nullptr)))
+        {
+            return ErrorCode::INVALID_FUNCTION_PARAMETER;
+        }
+
+        ErrorCode error = validateFedMediaData(aData);
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        // The data is already in the file, so it is only referenced, and not considered for deduplication.
+        MediaData mediaData       = {};
+        mediaData.id              = mContextIds.getValue();
+        mediaData.mediaFormat     = aData.mediaFormat;
+        mediaData.decoderConfigId = aData.decoderConfigId;
+        mediaData.offset          = aOffset;
+        mediaData.size            = aData.size;
+        if (aData.mediaFormat == MediaFormat::JPEG)
+        {
+            error = parseJpegDimensions(aData, mediaData.id);
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+        }
+
+        mMediaData[mediaData.id] = mediaData;
+        aMediaDataId             = mediaData.id;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode WriterImpl::getMediaDataStatistics(MediaDataStatistics& statistics) const
+    {
+        StatisticsScope statisticsScope(mStatistics.get(), "getMediaDataStatistics");
+        statistics = mMediaDataStatistics;
+        return ErrorCode::OK;
+    }
+
+    ErrorCode WriterImpl::getStatistics(WriterStatistics& statistics) const
+    {
+        if (!mStatistics)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+        mStatistics->get(statistics.total, statistics.calls, statistics.phases);
+        statistics.mediaData = mMediaDataStatistics;
+        return ErrorCode::OK;
+    }
+
     ErrorCode WriterImpl::validateFedMediaData(const Data& aData)
     {
         if ((((aData.mediaFormat == MediaFormat::AVC) || (aData.mediaFormat == MediaFormat::HEVC) ||
@@ -358,15 +504,21 @@ namespace HEIF
 
     ErrorCode WriterImpl::storeFedMediaData(const Data& aData, MediaDataId& aMediaDataId)
     {
-        uint64_t hash = FNVHash::generate(aData.data, aData.size);
-        if (mMediaDataHashes.count(hash))
+        ++mMediaDataStatistics.fedCount;
+        mMediaDataStatistics.fedBytes += aData.size;
+
+        // Media data of fragmented files is released when written, so it can not be shared by later samples.
+        const bool deduplicate = mDeduplicateMediaData && !mFragmented;
+        const uint64_t hash    = deduplicate ? ContentHash::generate(aData.data, aData.size) : 0;
+        if (deduplicate && findFedMediaData(hash, aData, aMediaDataId))
         {
-            aMediaDataId = mMediaDataHashes.at(hash);
+            ++mMediaDataStatistics.deduplicatedCount;
+            mMediaDataStatistics.deduplicatedBytes += aData.size;
         }
         else
         {
             MediaData mediaData       = {};
-            mediaData.id              = Context::getValue();
+            mediaData.id              = mContextIds.getValue();
             mediaData.mediaFormat     = aData.mediaFormat;
             mediaData.decoderConfigId = aData.decoderConfigId;
             mediaData.size            = aData.size;
@@ -375,65 +527,157 @@ namespace HEIF
 
             if (aData.mediaFormat == MediaFormat::JPEG)
             {
-                JpegParser parser;
-                JpegParser::JpegInfo info;
-
-                const Array<DecoderSpecificInfo>* decoderSpecInfo = mAllDecoderConfigs.count(aData.decoderConfigId)
-                                                                        ? &mAllDecoderConfigs.at(aData.decoderConfigId)
-                                                                        : nullptr;
-                // Compose a complete image out of decoder specific info and the data
-                if (decoderSpecInfo && decoderSpecInfo->size == 1)
+                ErrorCode error = parseJpegDimensions(aData, mediaData.id);
+                if (error != ErrorCode::OK)
                 {
-                    // TODO: JpegParser::parse should work completely as a state machine, so the input can
-                    // be provided in arbitrary units, ie. provide bytes until its state is "header
-                    // parsed". Now we need to construct an intermediate data that includes the decoder
-                    // configuration to do the verification.
-
-                    auto completeImage = embedJPEGDecoderConfig(decoderSpecInfo->elements[0], aData);
-
-                    info = parser.parse(completeImage.data(), completeImage.size());
+                    return error;
                 }
-                else if (decoderSpecInfo && decoderSpecInfo->size > 1)
+            }
+
+            if (mFragmented)
+            {
+                mediaData.offset = 0;  // Offset is known only when the fragment is written.
+                mFragmentMediaData[mediaData.id].assign(aData.data, aData.data + aData.size);
+            }
+            else if (mInitialMdat)
+            {
+                if (mUpdateFile && (mMdatOffset == 0))
                 {
-                    // we don't really expect this, the error should have occurred earlier
-                    return ErrorCode::INVALID_DECODER_CONFIG_ID;
+                    // New media data of an updated file is appended after the existing content in a new 'mdat'.
+                    mFile->seekp(mUpdateFileSize);
+                    writeMdatHeader();
                 }
-                else
+                mediaData.offset = mFile->tellp();
+                mFile->write(aData.data, static_cast<uint64_t>(aData.size));
+            }
+            else if (mSpillFile.isOpen())
+            {
+                mediaData.spillOffset = mSpillFile.getSize();
+                if (!mSpillFile.append(aData.data, aData.size))
                 {
-                    // But if there's no decoder specific info, just work on the original data
-                    info = parser.parse(aData.data, static_cast<unsigned int>(aData.size));
+                    return ErrorCode::FILE_OPEN_ERROR;  // Spill file is not writable.
                 }
-
-                if (!info.parsingOk)
+                mediaData.offset = mMediaDataBox.addExternalData(aData.size);
+                if (mMediaDataSize > std::numeric_limits<std::uint32_t>::max())
                 {
-                    return ErrorCode::MEDIA_PARSING_ERROR;
+                    mMediaDataBox.setLargeSize();
                 }
-                mJpegDimensions[mediaData.id] = {info.imageWidth, info.imageHeight};
-            }
-
-            if (mInitialMdat)
-            {
-                mediaData.offset = mFile->tellp();
-                mFile->write(aData.data, static_cast<uint64_t>(aData.size));
             }
             else
             {
                 mediaData.offset = mMediaDataBox.addData(aData.data, aData.size);
+                mediaData.data   = &mMediaDataBox.getLastData();
                 if (mMediaDataSize > std::numeric_limits<std::uint32_t>::max())
                 {
                     mMediaDataBox.setLargeSize();
                 }
             }
 
+            if (deduplicate && mInitialMdat && !mOutputFile &&
+                (mRetainedMediaDataSize + aData.size <= mRetainedMediaDataLimit))
+            {
+                // Data written to an output stream given by the caller can not be read back, so a copy is compared
+                // with instead.
+                Vector<uint8_t>& copy = mRetainedMediaData[mediaData.id];
+                copy.assign(aData.data, aData.data + aData.size);
+                mRetainedMediaDataSize += aData.size;
+                mediaData.data = &copy;
+            }
+            if (deduplicate && (mediaData.data || mSpillFile.isOpen() || (mInitialMdat && mOutputFile)))
+            {
+                mMediaDataHashes[hash].push_back(mediaData.id);
+            }
+
             mMediaData[mediaData.id] = mediaData;
             aMediaDataId             = mediaData.id;
-            mMediaDataHashes[hash]   = mediaData.id;
         }
         return ErrorCode::OK;
     }
 
+    ErrorCode WriterImpl::parseJpegDimensions(const Data& aData, const MediaDataId& aMediaDataId)
+    {
+        JpegParser parser;
+        JpegParser::JpegInfo info;
+
+        const Array<DecoderSpecificInfo>* decoderSpecInfo = mAllDecoderConfigs.count(aData.decoderConfigId)
+                                                                ? &mAllDecoderConfigs.at(aData.decoderConfigId)
+                                                                : nullptr;
+        // Compose a complete image out of decoder specific info and the data
+        if (decoderSpecInfo && decoderSpecInfo->size == 1)
+        {
+            // TODO: JpegParser::parse should work completely as a state machine, so the input can
+            // be provided in arbitrary units, ie. provide bytes until its state is "header
+            // parsed". Now we need to construct an intermediate data that includes the decoder
+            // configuration to do the verification.
+
+            auto completeImage = embedJPEGDecoderConfig(decoderSpecInfo->elements[0], aData);
+
+            info = parser.parse(completeImage.data(), completeImage.size());
+        }
+        else if (decoderSpecInfo && decoderSpecInfo->size > 1)
+        {
+            // we don't really expect this, the error should have occurred earlier
+            return ErrorCode::INVALID_DECODER_CONFIG_ID;
+        }
+        else
+        {
+            // But if there's no decoder specific info, just work on the original data
+            info = parser.parse(aData.data, static_cast<unsigned int>(aData.size));
+        }
+
+        if (!info.parsingOk)
+        {
+            return ErrorCode::MEDIA_PARSING_ERROR;
+        }
+        mJpegDimensions[aMediaDataId] = {info.imageWidth, info.imageHeight};
+        return ErrorCode::OK;
+    }
+
+    bool WriterImpl::findFedMediaData(const uint64_t hash, const Data& aData, MediaDataId& aMediaDataId)
+    {
+        const auto candidates = mMediaDataHashes.find(hash);
+        if (candidates == mMediaDataHashes.end())
+        {
+            return false;
+        }
+
+        for (const auto& candidateId : candidates->second)
+        {
+            const MediaData& candidate = mMediaData.at(candidateId);
+            if ((candidate.size != aData.size) || (candidate.mediaFormat != aData.mediaFormat) ||
+                (candidate.decoderConfigId != aData.decoderConfigId))
+            {
+                continue;
+            }
+
+            // Only data which can be compared byte by byte is indexed by its hash.
+            bool equal = false;
+            if (candidate.data)
+            {
+                equal = std::memcmp(candidate.data->data(), aData.data, candidate.size) == 0;
+            }
+            else if (mInitialMdat)
+            {
+                equal = mOutputFile->compare(candidate.offset, aData.data, aData.size);
+            }
+            else
+            {
+                equal = mSpillFile.compare(candidate.spillOffset, aData.data, aData.size);
+            }
+
+            if (equal)
+            {
+                aMediaDataId = candidateId;
+                return true;
+            }
+            ++mMediaDataStatistics.hashCollisions;
+        }
+        return false;
+    }
+
     ErrorCode WriterImpl::createEntityGroup(const FourCC& type, GroupId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "createEntityGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -441,7 +685,7 @@ namespace HEIF
 
         EntityGroup group;
         group.type = type;
-        group.id   = Context::getValue();
+        group.id   = mContextIds.getValue();
 
         mEntityGroups[group.id] = group;
 
@@ -451,6 +695,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::createAlternativesGroup(GroupId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "createAlternativesGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -461,6 +706,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::createEquivalenceGroup(GroupId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "createEquivalenceGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -471,6 +717,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addToGroup(const GroupId& groupId, const ImageId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addToGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -495,6 +742,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::createTrackGroup(const FourCC& type, TrackGroupId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "createTrackGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -502,7 +750,7 @@ namespace HEIF
 
         TrackGroup group;
         group.type = type;
-        group.id   = Context::getValue();
+        group.id   = mContextIds.getValue();
 
         mTrackGroups[group.id] = group;
 
@@ -512,6 +760,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addToGroup(const TrackGroupId& trackGroupId, const SequenceId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addToGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -534,12 +783,13 @@ namespace HEIF
 
     ErrorCode WriterImpl::setMajorBrand(const FourCC& brand)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setMajorBrand");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
-        if (mInitialMdat)
+        if (mInitialMdat || mInitSegmentWritten)
         {
             return ErrorCode::FTYP_ALREADY_WRITTEN;
         }
@@ -551,12 +801,13 @@ namespace HEIF
 
     ErrorCode WriterImpl::addCompatibleBrand(const FourCC& brand)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addCompatibleBrand");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
-        if (mInitialMdat)
+        if (mInitialMdat || mInitSegmentWritten)
         {
             return ErrorCode::FTYP_ALREADY_WRITTEN;
         }
@@ -567,6 +818,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addCompatibleBrandCombination(const Array<FourCC>& compatibleBrandCombination)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addCompatibleBrandCombination");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -574,7 +826,7 @@ namespace HEIF
 
         // Check if file type box has already been written. If so, return error in case a new type combination box would
         // be needed.
-        if (mInitialMdat)
+        if (mInitialMdat || mInitSegmentWritten)
         {
             Vector<FourCCInt> brandVector;
             for (const auto& brand : compatibleBrandCombination)
@@ -604,13 +856,30 @@ namespace HEIF
 
     ErrorCode WriterImpl::finalize()
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "finalize");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
         BitStream output;
-        if (mInitialMdat)
+        if (mFragmented)
+        {
+            ErrorCode error = writeFragment();
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+        }
+        else if (mUpdateFile)
+        {
+            ErrorCode error = finalizeUpdatedFile();
+            if (error != ErrorCode::OK)
+            {
+                return error;
+            }
+        }
+        else if (mInitialMdat)
         {
             finalizeMdatBox();
             ErrorCode error = finalizeMetaBox();
@@ -624,11 +893,15 @@ namespace HEIF
                 return error;
             }
 
-            mMetaBox.writeBox(output);
-            writeBitstream(output, mFile);
-            output.clear();
+            {
+                StatisticsScope phaseScope(mStatistics.get(), "write meta", StatisticsScope::Kind::PHASE);
+                mMetaBox.writeBox(output);
+                writeBitstream(output, mFile);
+                output.clear();
+            }
             if (mMovieBox.getTrackBoxes().size() > 0)
             {
+                StatisticsScope phaseScope(mStatistics.get(), "write moov", StatisticsScope::Kind::PHASE);
                 mMovieBox.writeBox(output);
                 writeBitstream(output, mFile);
             }
@@ -661,32 +934,55 @@ namespace HEIF
             writeBitstream(output, mFile);
             mdatOffset = output.getSize();
             output.clear();
-            // Calculate meta box size.
-            mMetaBox.writeBox(output);
-            mdatOffset += output.getSize();
-            output.clear();
-            // Calculate optional moov box size.
-            if (mMovieBox.getTrackBoxes().size() > 0)
+
+            // Chunk offsets switch 'stco' to 'co64' when they do not fit 32 bits, which makes 'moov' larger and moves
+            // mdat further. Sizes are measured again after each offset update until they no longer change, so each box
+            // is still serialized only once. Sizes only grow with the offsets, so this ends after a few rounds.
+            const bool hasMoov         = mMovieBox.getTrackBoxes().size() > 0;
+            const uint64_t headerSize  = mdatOffset;
+            uint64_t metaSize          = 0;
+            uint64_t moovSize          = 0;
+            uint64_t appliedMdatOffset = 0;
+            bool sizesChanged          = true;
+            while (sizesChanged)
             {
-                mMovieBox.writeBox(output);
-                mdatOffset += output.getSize();
-                output.clear();
+                mdatOffset = headerSize + metaSize + moovSize;
+                mMetaBox.setItemFileOffsetBase(mdatOffset);
+                updateMoovBox(mdatOffset - appliedMdatOffset);
+                appliedMdatOffset = mdatOffset;
+
+                const uint64_t newMetaSize = mMetaBox.getSerializedSize();
+                const uint64_t newMoovSize = hasMoov ? mMovieBox.getSerializedSize() : 0;
+                sizesChanged               = (newMetaSize != metaSize) || (newMoovSize != moovSize);
+                metaSize                   = newMetaSize;
+                moovSize                   = newMoovSize;
             }
-            mMetaBox.setItemFileOffsetBase(mdatOffset);
-            updateMoovBox(mdatOffset);
+            output.reserve(std::max(metaSize, moovSize));
 
-            // Serialize meta box again, now with correct mdat offset, and write it.
-            mMetaBox.writeBox(output);
-            writeBitstream(output, mFile);
-            output.clear();
+            {
+                StatisticsScope phaseScope(mStatistics.get(), "write meta", StatisticsScope::Kind::PHASE);
+                mMetaBox.writeBox(output);
+                if ((error = checkSerializedSize(output, metaSize)) != ErrorCode::OK)
+                {
+                    return error;
+                }
+                writeBitstream(output, mFile);
+                output.clear();
+            }
             // Write optional moov box.
-            if (mMovieBox.getTrackBoxes().size() > 0)
+            if (hasMoov)
             {
+                StatisticsScope phaseScope(mStatistics.get(), "write moov", StatisticsScope::Kind::PHASE);
                 mMovieBox.writeBox(output);
+                if ((error = checkSerializedSize(output, moovSize)) != ErrorCode::OK)
+                {
+                    return error;
+                }
                 writeBitstream(output, mFile);
                 output.clear();
             }
             // Finally write mdat.
+            StatisticsScope phaseScope(mStatistics.get(), "write mdat", StatisticsScope::Kind::PHASE);
 
             const std::pair<const ISOBMFF::BitStream&, const List<Vector<uint8_t>>&>& data =
                 mMediaDataBox.getSerializedData();
@@ -695,21 +991,109 @@ namespace HEIF
             {
                 mFile->write(dataBlock.data(), static_cast<uint64_t>(dataBlock.size()));
             }
+            if (mSpillFile.isOpen())
+            {
+                const bool copied = mSpillFile.copyTo(mFile);
+                mSpillFile.close();
+                if (!copied)
+                {
+                    return ErrorCode::FILE_READ_ERROR;
+                }
+            }
         }
         if (mOwnsOutputHandle)
         {
             delete mFile;
         }
 
-        mFile = nullptr;
+        mFile       = nullptr;
+        mOutputFile = nullptr;
 
         mState = State::UNINITIALIZED;
 
         return ErrorCode::OK;
     }
 
+    void WriterImpl::writeMdatHeader()
+    {
+        // Write Media Data Box 'mdat' header. We can not know input data size, so use 64-bit large size field for
+        // the box.
+        BitStream output;
+        mMdatOffset = static_cast<uint64_t>(mFile->tellp());
+        output.write32Bits(1);  // size field, value 1 implies using largesize field instead.
+        output.write32Bits(FourCCInt("mdat").getUInt32());  // boxtype field
+        output.write64Bits(0);                              // largesize field
+        writeBitstream(output, mFile);
+    }
+
+    ErrorCode WriterImpl::finalizeUpdatedFile()
+    {
+        // Media data of an updated file is appended only when new media data was fed.
+        if (mMdatOffset != 0)
+        {
+            finalizeMdatBox();
+        }
+        else
+        {
+            mFile->seekp(mUpdateFileSize);
+        }
+        ErrorCode error = finalizeMetaBox();
+        if (error != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        StatisticsScope phaseScope(mStatistics.get(), "write meta", StatisticsScope::Kind::PHASE);
+        const uint64_t FREE_HEADER_SIZE = 8;
+        const uint64_t metaSize         = mMetaBox.getSerializedSize();
+        const uint64_t freeSize         = mUpdateMetaSpace - std::min(metaSize, mUpdateMetaSpace);
+        BitStream output;
+        output.reserve(metaSize + FREE_HEADER_SIZE);
+        mMetaBox.writeBox(output);
+        if ((error = checkSerializedSize(output, metaSize)) != ErrorCode::OK)
+        {
+            return error;
+        }
+
+        // Item offsets are absolute file offsets, so the 'meta' box can be moved without changing its content.
+        if ((metaSize == mUpdateMetaSpace) ||
+            ((metaSize < mUpdateMetaSpace) && (freeSize >= FREE_HEADER_SIZE) &&
+             (freeSize <= std::numeric_limits<std::uint32_t>::max())))
+        {
+            // Replace the old 'meta' box in place, and mark the rest of its space as a 'free' box.
+            if (freeSize > 0)
+            {
+                output.write32Bits(static_cast<uint32_t>(freeSize));
+                output.write32Bits(FourCCInt("free").getUInt32());
+            }
+            mFile->seekp(mUpdateMetaOffset);
+            writeBitstream(output, mFile);
+        }
+        else
+        {
+            // Append the new 'meta' box first, so the file is not left without one if the update is interrupted.
+            writeBitstream(output, mFile);
+            output.clear();
+            if (mUpdateMetaSpace <= std::numeric_limits<std::uint32_t>::max())
+            {
+                output.write32Bits(static_cast<uint32_t>(mUpdateMetaSpace));
+                output.write32Bits(FourCCInt("free").getUInt32());
+            }
+            else
+            {
+                output.write32Bits(1);  // size field, value 1 implies using largesize field instead.
+                output.write32Bits(FourCCInt("free").getUInt32());
+                output.write64Bits(mUpdateMetaSpace);
+            }
+            mFile->seekp(mUpdateMetaOffset);
+            writeBitstream(output, mFile);
+        }
+        return ErrorCode::OK;
+    }
+
     void WriterImpl::finalizeMdatBox()
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "write mdat", StatisticsScope::Kind::PHASE);
         BitStream output;
         const uint64_t position = mFile->tellp();
         output.write64Bits(position - mMdatOffset);
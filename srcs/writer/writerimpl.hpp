@@ -21,12 +21,16 @@
 #include "heifwriter.h"
 #include "idgenerators.hpp"
 #include "mediadatabox.hpp"
+#include "mediadataspillfile.hpp"
 #include "metabox.hpp"
 #include "moviebox.hpp"
+#include "statistics.hpp"
 #include "writerdatatypesinternal.hpp"
 
 namespace HEIF
 {
+    class FileOutputStream;
+
     class WriterImpl : public Writer
     {
     public:
@@ -43,6 +47,9 @@ namespace HEIF
         ErrorCode feedDecoderConfig(const Array<DecoderSpecificInfo>& config,
                                     DecoderConfigId& decoderConfigId) override;
         ErrorCode feedMediaData(const Data& data, MediaDataId& mediaDataId) override;
+        ErrorCode feedExistingMediaData(const Data& data, std::uint64_t offset, MediaDataId& mediaDataId) override;
+        ErrorCode getMediaDataStatistics(MediaDataStatistics& statistics) const override;
+        ErrorCode getStatistics(WriterStatistics& statistics) const override;
 
         ErrorCode addImage(const MediaDataId& mediaDataId, ImageId& imageId) override;
         ErrorCode addImage(const MediaDataId& mediaDataId,
@@ -135,9 +142,11 @@ namespace HEIF
     private:
         ErrorCode isValidSequenceImage(const SequenceId& sequenceId, const SequenceImageId& sequenceImageId) const;
 
+        void writeMdatHeader();                        // Write a 'mdat' box header with a 64-bit size field.
         void finalizeMdatBox();                        // Set media data box size.
+        ErrorCode finalizeUpdatedFile();               // Write the 'meta' box of an updated file.
         ErrorCode generateMoovBox();                   // Fill movie box from intermediate HeifWriterImpl structures.
-        ErrorCode updateMoovBox(uint64_t mdatOffset);  // Update moov box internal offset values to mdat data
+        ErrorCode updateMoovBox(uint64_t mdatOffset);  // Add mdatOffset to moov box chunk offsets, cumulatively
         ErrorCode finalizeMetaBox();                   // Fill metabox from intermediate HeifWriterImpl structures.
 
         // writermoovimpl defines for moov writer helpers
@@ -145,12 +154,20 @@ namespace HEIF
         ErrorCode writeMoovSampleTable(ImageSequence& sequence);
         void writeEquivalenceSampleGroup(ImageSequence& sequence);
         void writeRefSampleList(ImageSequence& sequence);
+        ErrorCode writeMoovSampleDescriptions(ImageSequence& sequence);
         void writeMetadataItemGroups(ImageSequence& sequence);
         void writeTrackGroups(ImageSequence& imageSequence);
 
+        // writerfragmentimpl defines for fragmented file writing
+        bool isFragmentDue(const ImageSequence& sequence) const;  // Check fragment limits before adding a sync sample
+        ErrorCode writeInitSegment();  // Write 'ftyp' and 'moov' boxes of a fragmented file.
+        ErrorCode writeFragment();     // Write samples added since the previous fragment as 'moof' and 'mdat' boxes.
+
         // helpers for handling fed mediaData
         ErrorCode validateFedMediaData(const Data& aData);
         ErrorCode storeFedMediaData(const Data& aData, MediaDataId& aMediaDataId);
+        ErrorCode parseJpegDimensions(const Data& aData, const MediaDataId& aMediaDataId);
+        bool findFedMediaData(std::uint64_t hash, const Data& aData, MediaDataId& aMediaDataId);
 
         /**
          * Creates new metadataitem & id for given mediaDataId
@@ -170,6 +187,18 @@ namespace HEIF
          */
         bool checkImageIds(const Array<ImageId>& imageIds) const;
 
+        /**
+         * @return OK if items can be added to the root level 'meta' box, NOT_APPLICABLE for a fragmented file, which
+         * has no root level 'meta' box.
+         */
+        ErrorCode checkMetaAllowed() const;
+
+        /**
+         * @return OK if tracks can be added, NOT_APPLICABLE after 'moov' of a fragmented file has been written or when
+         * updating a file.
+         */
+        ErrorCode checkTrackAllowed() const;
+
         /**
          * @brief getIspe Get index of an 'ispe' property with given dimensions. If matching one does not already exist,
          * a new property is created and added to the metabox.
@@ -254,9 +283,18 @@ namespace HEIF
     private:
         State mState;  ///< Running state of the reader API implementation
 
+        ContextIdGenerator mContextIds;  ///< Item, sequence, sample, group and decoder config IDs of this writer.
+        TrackIdGenerator mTrackIds;      ///< Track and alternate group IDs of this writer.
+
         Map<DecoderConfigId, Array<DecoderSpecificInfo>> mAllDecoderConfigs;
         Map<MediaDataId, MediaData> mMediaData;
-        Map<std::uint64_t, MediaDataId> mMediaDataHashes;
+        Map<std::uint64_t, Vector<MediaDataId>> mMediaDataHashes;   ///< Fed media data by content hash.
+        Map<MediaDataId, Vector<std::uint8_t>> mRetainedMediaData;  ///< Copies of written data, for comparison.
+        std::uint64_t mRetainedMediaDataSize  = 0;                  ///< Bytes in mRetainedMediaData.
+        std::uint64_t mRetainedMediaDataLimit = 0;                  ///< OutputConfig::deduplicationMemoryLimit.
+        bool mDeduplicateMediaData            = true;               ///< Store identical fed media data only once.
+        MediaDataStatistics mMediaDataStatistics;                   ///< Counters of fed and deduplicated media data.
+        UniquePtr<StatisticsCollector> mStatistics;                 ///< Statistics, or null if they are not collected.
 
         Map<SequenceId, ImageSequence> mImageSequences;
         ImageCollection mImageCollection;
@@ -278,8 +316,10 @@ namespace HEIF
         MetaBox mMetaBox;
         MovieBox mMovieBox;
         MediaDataBox mMediaDataBox;
+        MediaDataSpillFile mSpillFile;  ///< 'mdat' payload of a progressive file, if spilled to disk.
 
         OutputStreamInterface* mFile;
+        FileOutputStream* mOutputFile = nullptr;  ///< Output file opened by the writer, read back for deduplication.
 
         std::uint64_t mMdatOffset    = 0;  ///< 'mdat' offset in the stream
         std::uint64_t mMediaDataSize = 8;  ///< Data size in 'mdat' box in bytes.
@@ -289,11 +329,24 @@ namespace HEIF
                                     ///< after meta and moov boxes.
         bool mPrimaryItemSet = false;  ///< True after a primary item has been set.
 
+        bool mUpdateFile                = false;  ///< True if the 'meta' box of an existing file is updated.
+        std::uint64_t mUpdateMetaOffset = 0;      ///< Offset of the 'meta' box to replace in an updated file.
+        std::uint64_t mUpdateMetaSpace  = 0;      ///< Space available for the 'meta' box in an updated file.
+        std::uint64_t mUpdateFileSize   = 0;      ///< Size of an updated file before the update.
+
         bool mOwnsOutputHandle = false;  ///< True if the writer owns the output handle
 
         bool mWriteItemCreationTimes = false;  ///< Create and associate CreationTimeProperty to added image items.
 
         PropertyId mPredRrefPropertyId = 0;  ///< ID of 'pred' Required reference types property. 0 if not created.
+
+        bool mFragmented                      = false;  ///< True if the file is written as movie fragments.
+        bool mInitSegmentWritten              = false;  ///< True after 'ftyp' and 'moov' have been written.
+        bool mFragmentSegmentIndex            = false;  ///< Write a 'sidx' box before each movie fragment.
+        std::uint32_t mFragmentSampleCount    = 0;      ///< Sample count limit of a fragment, 0 if not set.
+        std::uint32_t mFragmentDuration       = 0;      ///< Duration limit of a fragment in ms, 0 if not set.
+        std::uint32_t mFragmentSequenceNumber = 0;      ///< Sequence number of the previous movie fragment.
+        Map<MediaDataId, Vector<std::uint8_t>> mFragmentMediaData;  ///< Media data not yet written to a fragment.
     };
 
     namespace
@@ -143,6 +143,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setPrimaryItem(const ImageId& imageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setPrimaryItem");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -166,11 +167,18 @@ namespace HEIF
 
     ErrorCode WriterImpl::addImage(const MediaDataId& aMediaDataId, ImageId& aImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addImage");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode metaAllowed = checkMetaAllowed();
+        if (metaAllowed != ErrorCode::OK)
+        {
+            return metaAllowed;
+        }
+
         if (mMediaData.count(aMediaDataId) == 0)
         {
             return ErrorCode::INVALID_MEDIADATA_ID;
@@ -178,7 +186,7 @@ namespace HEIF
 
         const MediaData& mediaData = mMediaData.at(aMediaDataId);
 
-        aImageId = Context::getValue();
+        aImageId = mContextIds.getValue();
 
         ImageCollection::Image newImage;
         newImage.imageId                  = aImageId;
@@ -247,6 +255,7 @@ namespace HEIF
                                    const Array<ImageId>& referenceImageIds,
                                    ImageId& imageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addImage");
         if (!checkImageIds({referenceImageIds}))
         {
             return ErrorCode::INVALID_ITEM_ID;
@@ -290,6 +299,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setItemDescription(const ImageId& imageId, const ItemDescription& itemDescription)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setItemDescription");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -309,6 +319,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setImageHidden(const ImageId& imageId, const bool hidden)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setImageHidden");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -327,6 +338,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addAuxiliaryReference(const ImageId& fromImageId, const ImageId& toImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addAuxiliaryReference");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -344,6 +356,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addThumbnail(const ImageId& thumbImageId, const ImageId& masterImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addThumbnail");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -361,6 +374,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::finalizeMetaBox()
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "build meta", StatisticsScope::Kind::PHASE);
         mMetaBox.setHandlerType("pict");
 
         // If primary item was not set, default to the first non-hidden image.
@@ -426,6 +440,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const CleanAperture& clap, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -456,6 +471,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const Mirror& imir, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -474,6 +490,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const Rotate& irot, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -492,6 +509,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const Scale& iscl, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -522,6 +540,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const RelativeLocation& rloc, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -541,6 +560,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const PixelAspectRatio& pasp, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -561,6 +581,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const PixelInformation& pixi, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -584,6 +605,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const ColourInformation& colr, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -621,6 +643,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const AuxiliaryType& auxC, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -645,6 +668,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const RequiredReferenceTypes& rref, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -667,6 +691,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const UserDescription& udes, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -689,6 +714,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const AccessibilityText& altt, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -709,6 +735,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const CreationTimeInformation& crtt, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -728,6 +755,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const ModificationTimeInformation& mdft, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -747,6 +775,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const RawProperty& property, const bool isTransformative, PropertyId& propertyId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -767,16 +796,23 @@ namespace HEIF
 
     ErrorCode WriterImpl::addDerivedImage(const ImageId& imageId, ImageId& derivedImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addDerivedImage");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode metaAllowed = checkMetaAllowed();
+        if (metaAllowed != ErrorCode::OK)
+        {
+            return metaAllowed;
+        }
+
         if (!checkImageIds({imageId}))
         {
             return ErrorCode::INVALID_ITEM_ID;
         }
-        derivedImageId = Context::getValue();
+        derivedImageId = mContextIds.getValue();
         ImageCollection::Image newImage;
         newImage.isHidden                       = false;
         newImage.imageId                        = derivedImageId;
@@ -803,6 +839,7 @@ namespace HEIF
                                             const PropertyId& propertyId,
                                             const bool isEssential)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "associateProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -838,6 +875,7 @@ namespace HEIF
                                             const PropertyId& propertyId,
                                             const bool isEssential)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "associateProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -871,11 +909,18 @@ namespace HEIF
 
     ErrorCode WriterImpl::addDerivedImageItem(const Grid& grid, ImageId& gridId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addDerivedImageItem");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode metaAllowed = checkMetaAllowed();
+        if (metaAllowed != ErrorCode::OK)
+        {
+            return metaAllowed;
+        }
+
         if (!checkImageIds(grid.imageIds))
         {
             return ErrorCode::INVALID_ITEM_ID;
@@ -891,7 +936,7 @@ namespace HEIF
             return ErrorCode::INVALID_FUNCTION_PARAMETER;
         }
 
-        gridId = Context::getValue();
+        gridId = mContextIds.getValue();
         ImageCollection::Image newImage;
         newImage.imageId                = gridId;
         mImageCollection.images[gridId] = newImage;
@@ -922,11 +967,18 @@ namespace HEIF
 
     ErrorCode WriterImpl::addDerivedImageItem(const Overlay& iovl, ImageId& overlayId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addDerivedImageItem");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode metaAllowed = checkMetaAllowed();
+        if (metaAllowed != ErrorCode::OK)
+        {
+            return metaAllowed;
+        }
+
         if (!checkImageIds(iovl.imageIds))
         {
             return ErrorCode::INVALID_ITEM_ID;
@@ -942,7 +994,7 @@ namespace HEIF
             return ErrorCode::INVALID_FUNCTION_PARAMETER;
         }
 
-        overlayId = Context::getValue();
+        overlayId = mContextIds.getValue();
         ImageCollection::Image newImage;
         newImage.imageId                   = overlayId;
         mImageCollection.images[overlayId] = newImage;
@@ -986,6 +1038,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addMetadataItemReference(const MetadataItemId& metadataItemId, const ImageId& toImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addMetadataItemReference");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1017,6 +1070,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addTbasItemReference(const ImageId& fromImageId, const ImageId& toImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addTbasItemReference");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1034,6 +1088,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addBaseItemReference(const ImageId& fromImageId, const Array<ImageId>& toImageIds)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addBaseItemReference");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1054,11 +1109,18 @@ namespace HEIF
 
     ErrorCode WriterImpl::addMetadata(const MediaDataId& mediaDataId, MetadataItemId& metadataItemId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addMetadata");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode metaAllowed = checkMetaAllowed();
+        if (metaAllowed != ErrorCode::OK)
+        {
+            return metaAllowed;
+        }
+
         if (mMediaData.count(mediaDataId) == 0)
         {
             return ErrorCode::INVALID_MEDIADATA_ID;
@@ -1102,7 +1164,7 @@ namespace HEIF
                 {MediaFormat::XMP, {FourCCInt("mime"), "", "application/rdf+xml"}}};
             const FormatNames& format = formatMapping.at(mediaData.mediaFormat);
 
-            mMetadataItems[mediaDataId] = Context::getValue();
+            mMetadataItems[mediaDataId] = mContextIds.getValue();
 
             ItemInfoEntry infe;
             infe.setVersion(2);
@@ -1150,6 +1212,12 @@ namespace HEIF
         return true;
     }
 
+    ErrorCode WriterImpl::checkMetaAllowed() const
+    {
+        // Fragmented files have no root level 'meta' box.
+        return mFragmented ? ErrorCode::NOT_APPLICABLE : ErrorCode::OK;
+    }
+
     uint16_t WriterImpl::getIspeIndex(const std::uint32_t width, const std::uint32_t height)
     {
         ImageSize size = {width, height};
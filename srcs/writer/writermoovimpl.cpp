@@ -11,6 +11,7 @@
  * written consent of Nokia.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -287,11 +288,18 @@ namespace HEIF
                                            const CodingConstraints& aCodingConstraints,
                                            SequenceId& aId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addImageSequence");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode trackAllowed = checkTrackAllowed();
+        if (trackAllowed != ErrorCode::OK)
+        {
+            return trackAllowed;
+        }
+
         if (aTimeBase.den == 0 || aTimeBase.num == 0)
         {
             return ErrorCode::INVALID_FUNCTION_PARAMETER;  // timebase / timebase can't be zero
@@ -304,9 +312,9 @@ namespace HEIF
         }
 
         ImageSequence sequence{};
-        sequence.id          = Context::getValue();
+        sequence.id          = mContextIds.getValue();
         aId                  = sequence.id;
-        sequence.trackId     = Track::createTrackId();
+        sequence.trackId     = mTrackIds.createTrackId();
         sequence.handlerType = PICT_HANDLER;
         // sequence.mediaId is filled when first sample is fed to Image Sequence
         sequence.timeBase = aTimeBase;
@@ -362,6 +370,7 @@ namespace HEIF
                                    const SampleInfo& aSampleInfo,
                                    SequenceImageId& aSequenceImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addImage");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -381,7 +390,8 @@ namespace HEIF
         }
 
         ImageSequence& sequence = mImageSequences.at(aSequenceId);
-        if (sequence.samples.size() && mMediaData.at(aMediaDataId).mediaFormat != sequence.mediaFormat)
+        if ((sequence.samples.size() || sequence.fragmentedSampleCount) &&
+            mMediaData.at(aMediaDataId).mediaFormat != sequence.mediaFormat)
         {  // do not allow mediaData from different media formats
             return ErrorCode::INVALID_MEDIA_FORMAT;
         }
@@ -390,6 +400,34 @@ namespace HEIF
             sequence.mediaFormat = mMediaData.at(aMediaDataId).mediaFormat;
         }
 
+        if (mFragmented)
+        {
+            if (aSampleInfo.referenceSamples.size)
+            {
+                return ErrorCode::NOT_APPLICABLE;
+            }
+            // Sample descriptions are in the already written 'moov', so new decoder configurations can't be added.
+            const DecoderConfigId decoderConfigId = mMediaData.at(aMediaDataId).decoderConfigId;
+            if (mInitSegmentWritten && std::find(sequence.decoderConfigs.cbegin(), sequence.decoderConfigs.cend(),
+                                                 decoderConfigId) == sequence.decoderConfigs.cend())
+            {
+                return ErrorCode::INVALID_DECODER_CONFIG_ID;
+            }
+            if (aSampleInfo.isSyncSample && isFragmentDue(sequence))
+            {
+                ErrorCode error = writeFragment();
+                if (error != ErrorCode::OK)
+                {
+                    return error;
+                }
+                // Media data shared with a sample of the written fragment has been released with it.
+                if (!mMediaData.count(aMediaDataId))
+                {
+                    return ErrorCode::INVALID_MEDIADATA_ID;
+                }
+            }
+        }
+
         ImageSequence::Sample sample = {};
         if (sequence.samples.size())
         {
@@ -397,7 +435,7 @@ namespace HEIF
         }
         else
         {
-            sample.sampleIndex = 0;
+            sample.sampleIndex = sequence.fragmentedSampleCount;
         }
 
         for (const auto& refSample : aSampleInfo.referenceSamples)
@@ -419,10 +457,11 @@ namespace HEIF
         }
 
         sample.mediaDataId     = aMediaDataId;
-        sample.sequenceImageId = Context::getValue();
+        sample.sequenceImageId = mContextIds.getValue();
         aSequenceImageId       = sample.sequenceImageId;
         sample.sampleDuration  = static_cast<uint32_t>(aSampleInfo.duration * sequence.timeBase.num);
-        sample.dts = sequence.samples.size() ? sequence.samples.back().dts + sequence.samples.back().sampleDuration : 0;
+        sample.dts = sequence.samples.size() ? sequence.samples.back().dts + sequence.samples.back().sampleDuration
+                                             : sequence.duration;
         sample.compositionOffset = aSampleInfo.compositionOffset * static_cast<int64_t>(sequence.timeBase.num);
         sample.isSyncSample      = aSampleInfo.isSyncSample;
 
@@ -476,11 +515,17 @@ namespace HEIF
                                                    const SequenceId& sequenceId,
                                                    const SequenceImageId& sequenceImageId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addMetadataItemReference");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        if (mFragmented)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+
         ErrorCode error(ErrorCode::OK);
         if ((error = isValidSequenceImage(sequenceId, sequenceImageId)) != ErrorCode::OK)
         {
@@ -517,6 +562,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addThumbnails(const SequenceId& thumbSequenceId, const SequenceId& sequenceId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addThumbnails");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -538,7 +584,7 @@ namespace HEIF
         // Add tracks to same Alternate Group
         if (imageSequence.alternateGroup.get() == 0)
         {  // create new
-            imageSequence.alternateGroup = Track::createAlternateGroupId();
+            imageSequence.alternateGroup = mTrackIds.createAlternateGroupId();
         }
         thumpSequence.alternateGroup = imageSequence.alternateGroup;
 
@@ -551,6 +597,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setImageHidden(const SequenceImageId& sequenceImageId, const bool hidden)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setImageHidden");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -592,6 +639,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addProperty(const CleanAperture& clap, const SequenceId& sequenceId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addProperty");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -617,6 +665,7 @@ namespace HEIF
                                                 const SequenceId& auxiliarySequenceId,
                                                 const SequenceId& sequenceId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addAuxiliaryReference");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -645,6 +694,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setAlternateGrouping(const SequenceId& sequenceId1, const SequenceId& sequenceId2)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setAlternateGrouping");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -661,7 +711,7 @@ namespace HEIF
         if (sequence1.alternateGroup.get() == 0 && sequence2.alternateGroup.get() == 0)
         {
             // create new
-            sequence1.alternateGroup = Track::createAlternateGroupId();
+            sequence1.alternateGroup = mTrackIds.createAlternateGroupId();
             sequence2.alternateGroup = sequence1.alternateGroup;
         }
         else if (sequence1.alternateGroup.get() == 0 && sequence2.alternateGroup.get() != 0)
@@ -681,6 +731,7 @@ namespace HEIF
     /* *************************************************************** */
     ErrorCode WriterImpl::generateMoovBox()
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "build moov", StatisticsScope::Kind::PHASE);
         uint32_t modificationTime = TimeUtility::getSecondsSince1904();
         uint64_t movieDuration    = 0;
         uint32_t movieTimescale   = 1000;
@@ -733,7 +784,23 @@ namespace HEIF
             }
 
             // Sample Table writing:
-            if (sequence.samples.size())
+            if (mFragmented)
+            {
+                // Samples of fragmented files are described in movie fragments, so only sample descriptions are
+                // written. Modifies sequence.maxDimensions so needs to be done before trackHeaderBox dimensions
+                // setting.
+                if (sequence.handlerType == PICT_HANDLER)
+                {
+                    mFileTypeBox.addCompatibleBrand("msf1");
+                    mFileTypeBox.addCompatibleBrand("iso8");
+                }
+                ErrorCode stsdError = writeMoovSampleDescriptions(sequence);
+                if (stsdError != ErrorCode::OK)
+                {
+                    return stsdError;
+                }
+            }
+            else if (sequence.samples.size())
             {
                 if (sequence.handlerType != SOUN_HANDLER)  // rest are pict/vide specific
                 {
@@ -773,13 +840,17 @@ namespace HEIF
             trackHeaderBox.setWidth(sequence.maxDimensions.width << 16);    // to fixed point 16.16 value
             trackHeaderBox.setHeight(sequence.maxDimensions.height << 16);  // to fixed point 16.16 value
 
-            // Media duration:
-            track->getMediaBox().getMediaHeaderBox().setDuration(sequence.duration);
+            // Media duration, fragmented files have no samples in the movie box:
+            track->getMediaBox().getMediaHeaderBox().setDuration(mFragmented ? 0 : sequence.duration);
 
             // Track duration:
             uint64_t trackDuration;
+            if (mFragmented)
+            {
+                trackDuration = 0;
+            }
             // Use track duration from edit list if it has been set.
-            if (track->getEditBox() == nullptr)
+            else if (track->getEditBox() == nullptr)
             {
                 trackDuration = sequence.duration * movieTimescale / sequence.timeBase.den;
             }
@@ -800,7 +871,7 @@ namespace HEIF
         mMovieBox.getMovieHeaderBox().setTimeScale(movieTimescale);
         mMovieBox.getMovieHeaderBox().setDuration(movieDuration);
         mMovieBox.getMovieHeaderBox().setModificationTime(modificationTime);
-        mMovieBox.getMovieHeaderBox().setNextTrackID(Track::createTrackId().get());
+        mMovieBox.getMovieHeaderBox().setNextTrackID(mTrackIds.createTrackId().get());
         if (mMatrix.size())
         {
             mMovieBox.getMovieHeaderBox().setMatrix(mMatrix);
@@ -829,6 +900,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::addToGroup(const GroupId& groupId, const SequenceId& id)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addToGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -862,11 +934,17 @@ namespace HEIF
                                                 const SequenceImageId& id,
                                                 const EquivalenceTimeOffset& offset)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addToEquivalenceGroup");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        if (mFragmented)
+        {
+            return ErrorCode::NOT_APPLICABLE;
+        }
+
         if (mEntityGroups.count(equivalenceGroupId) == 0)
         {
             return ErrorCode::INVALID_GROUP_ID;
@@ -924,16 +1002,24 @@ namespace HEIF
 
             TrackBox* track      = mMovieBox.getTrackBox(sequence.trackId.get());
             SampleTableBox& stbl = track->getMediaBox().getMediaInformationBox().getSampleTableBox();
-            for (auto& offset : stbl.getChunkOffsetBox().getChunkOffsets())
+            Vector<std::uint64_t> chunkOffsets(stbl.getChunkOffsetBox().getChunkOffsets());
+            if (chunkOffsets.empty())
+            {
+                continue;
+            }
+            for (auto& offset : chunkOffsets)
             {
                 offset += mdatOffset;
             }
+            // Set again, so that 'co64' is used once an offset does not fit 32 bits.
+            stbl.getChunkOffsetBox().setChunkOffsets(chunkOffsets);
         }
         return ErrorCode::OK;
     }
 
     ErrorCode WriterImpl::setEditList(const SequenceId& sequenceId, const EditList& editList)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setEditList");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -988,6 +1074,12 @@ namespace HEIF
         return ErrorCode::INVALID_SEQUENCE_IMAGE_ID;
     }
 
+    ErrorCode WriterImpl::checkTrackAllowed() const
+    {
+        // Tracks can not be added after 'moov' of a fragmented file has been written, nor to an updated file.
+        return (mInitSegmentWritten || mUpdateFile) ? ErrorCode::NOT_APPLICABLE : ErrorCode::OK;
+    }
+
     void WriterImpl::writeMoovHiddenSamples(ImageSequence& sequence)
     {
         TrackBox* track      = mMovieBox.getTrackBox(sequence.trackId.get());
@@ -1183,41 +1275,49 @@ namespace HEIF
                 stsc.addChunkEntry(chunk);
             }
             // stsd
-            SampleDescriptionBox& stsd = stbl.getSampleDescriptionBox();
-            for (auto& decoderConfig : sequence.decoderConfigs)
+            return writeMoovSampleDescriptions(sequence);
+        }
+        return ErrorCode::OK;
+    }
+
+    ErrorCode WriterImpl::writeMoovSampleDescriptions(ImageSequence& sequence)
+    {
+        TrackBox* track            = mMovieBox.getTrackBox(sequence.trackId.get());
+        SampleTableBox& stbl       = track->getMediaBox().getMediaInformationBox().getSampleTableBox();
+        SampleDescriptionBox& stsd = stbl.getSampleDescriptionBox();
+        for (auto& decoderConfig : sequence.decoderConfigs)
+        {
+            UniquePtr<SampleEntryBox> sampleEntryBox;
+            if (sequence.mediaFormat == MediaFormat::AVC)
             {
-                UniquePtr<SampleEntryBox> sampleEntryBox;
-                if (sequence.mediaFormat == MediaFormat::AVC)
+                ErrorCode error =
+                    makeAVCVideoSampleEntryBox(sequence, mAllDecoderConfigs.at(decoderConfig), sampleEntryBox);
+                if (error != ErrorCode::OK)
                 {
-                    ErrorCode error =
-                        makeAVCVideoSampleEntryBox(sequence, mAllDecoderConfigs.at(decoderConfig), sampleEntryBox);
-                    if (error != ErrorCode::OK)
-                    {
-                        return error;
-                    }
-
-                    stsd.addSampleEntry(std::move(sampleEntryBox));
+                    return error;
                 }
-                else if (sequence.mediaFormat == MediaFormat::HEVC)
+
+                stsd.addSampleEntry(std::move(sampleEntryBox));
+            }
+            else if (sequence.mediaFormat == MediaFormat::HEVC)
+            {
+                ErrorCode error =
+                    makeHEVCVideoSampleEntryBox(sequence, mAllDecoderConfigs.at(decoderConfig), sampleEntryBox);
+                if (error != ErrorCode::OK)
                 {
-                    ErrorCode error =
-                        makeHEVCVideoSampleEntryBox(sequence, mAllDecoderConfigs.at(decoderConfig), sampleEntryBox);
-                    if (error != ErrorCode::OK)
-                    {
-                        return error;
-                    }
-                    stsd.addSampleEntry(std::move(sampleEntryBox));
+                    return error;
                 }
-                else if (sequence.mediaFormat == MediaFormat::AAC)
+                stsd.addSampleEntry(std::move(sampleEntryBox));
+            }
+            else if (sequence.mediaFormat == MediaFormat::AAC)
+            {
+                ErrorCode error =
+                    makeMP4AudioSampleEntryBox(sequence, mAllDecoderConfigs.at(decoderConfig), sampleEntryBox);
+                if (error != ErrorCode::OK)
                 {
-                    ErrorCode error =
-                        makeMP4AudioSampleEntryBox(sequence, mAllDecoderConfigs.at(decoderConfig), sampleEntryBox);
-                    if (error != ErrorCode::OK)
-                    {
-                        return error;
-                    }
-                    stsd.addSampleEntry(std::move(sampleEntryBox));
+                    return error;
                 }
+                stsd.addSampleEntry(std::move(sampleEntryBox));
             }
         }
         return ErrorCode::OK;
@@ -1577,6 +1677,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setMatrix(const Array<int32_t>& matrix)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setMatrix");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1592,6 +1693,7 @@ namespace HEIF
 
     ErrorCode WriterImpl::setMatrix(const SequenceId& aSequenceId, const Array<int32_t>& matrix)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "setMatrix");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
@@ -1613,11 +1715,18 @@ namespace HEIF
 
     ErrorCode WriterImpl::addVideoTrack(const Rational& aTimeBase, SequenceId& aId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addVideoTrack");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode trackAllowed = checkTrackAllowed();
+        if (trackAllowed != ErrorCode::OK)
+        {
+            return trackAllowed;
+        }
+
         if (aTimeBase.den == 0 || aTimeBase.num == 0)
         {
             return ErrorCode::INVALID_FUNCTION_PARAMETER;  // timebase / timebase can't be zero
@@ -1630,9 +1739,9 @@ namespace HEIF
         }
 
         ImageSequence sequence{};
-        sequence.id          = Context::getValue();
+        sequence.id          = mContextIds.getValue();
         aId                  = sequence.id;
-        sequence.trackId     = Track::createTrackId();
+        sequence.trackId     = mTrackIds.createTrackId();
         sequence.handlerType = VIDE_HANDLER;
         // sequence.mediaId is filled when first sample is fed to Image Sequence
         sequence.timeBase = aTimeBase;
@@ -1684,11 +1793,18 @@ namespace HEIF
 
     ErrorCode WriterImpl::addAudioTrack(const Rational& aTimeBase, const AudioParams& aConfig, SequenceId& aId)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addAudioTrack");
         if (mState != State::WRITING)
         {
             return ErrorCode::UNINITIALIZED;
         }
 
+        const ErrorCode trackAllowed = checkTrackAllowed();
+        if (trackAllowed != ErrorCode::OK)
+        {
+            return trackAllowed;
+        }
+
         if (aTimeBase.den == 0 || aTimeBase.num == 0)
         {
             return ErrorCode::INVALID_FUNCTION_PARAMETER;  // timebase / timebase can't be zero
@@ -1701,9 +1817,9 @@ namespace HEIF
         }
 
         ImageSequence sequence{};
-        sequence.id          = Context::getValue();
+        sequence.id          = mContextIds.getValue();
         aId                  = sequence.id;
-        sequence.trackId     = Track::createTrackId();
+        sequence.trackId     = mTrackIds.createTrackId();
         sequence.handlerType = SOUN_HANDLER;
         // sequence.mediaId is filled when first sample is fed to Image Sequence
         sequence.timeBase = aTimeBase;
@@ -1760,6 +1876,7 @@ namespace HEIF
                                    const SampleInfo& sampleInfo,
                                    SequenceImageId& sampleid)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addVideo");
         return addImage(sequenceId, mediaDataId, sampleInfo,
                         sampleid);  // use addImage() as internal functionality for samples is the same.
     }
@@ -1769,6 +1886,7 @@ namespace HEIF
                                    const SampleInfo& sampleInfo,
                                    SequenceImageId& sampleid)
     {
+        StatisticsScope statisticsScope(mStatistics.get(), "addAudio");
         return addImage(sequenceId, mediaDataId, sampleInfo,
                         sampleid);  // use addImage() as internal functionality for samples is the same.
     }